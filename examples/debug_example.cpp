@@ -1,5 +1,9 @@
 #include <miko/miko.h>
+#include <atomic>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <new>
 
 // Prevent Windows API macros from interfering with our method names
 #ifdef CreateWindow
@@ -8,6 +12,25 @@
 
 using namespace miko;
 
+// Count global heap allocations so the steady-state frame loop can be checked
+static std::atomic<size_t> g_allocationCount{ 0 };
+
+void* operator new(std::size_t size) {
+    g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
 class DebugExampleApp : public Application {
 public:
     bool Initialize() override {
@@ -27,6 +50,25 @@ public:
         }
         std::cout << "CreateWindow succeeded" << std::endl;
         
+        // A small widget tree exercising stack/grid layout and text rendering
+        auto rootPanel = std::make_shared<Panel>();
+        auto rootLayout = std::make_shared<StackLayout>(Orientation::Vertical);
+        rootLayout->SetSpacing(8.0f);
+        rootPanel->SetLayout(rootLayout);
+        window->SetRootWidget(rootPanel);
+        
+        rootPanel->AddChild(std::make_shared<Label>("Allocation check"));
+        
+        auto password = std::make_shared<TextBox>("secret");
+        password->SetPasswordMode(true);
+        rootPanel->AddChild(password);
+        
+        auto gridPanel = std::make_shared<Panel>();
+        gridPanel->SetLayout(std::make_shared<GridLayout>(2, 2));
+        gridPanel->AddChild(std::make_shared<Button>("OK"));
+        gridPanel->AddChild(std::make_shared<Button>("Cancel"));
+        rootPanel->AddChild(gridPanel);
+        
         // Show the window
         window->Show();
         std::cout << "Window shown" << std::endl;
@@ -35,12 +77,44 @@ public:
     }
     
     void Update(float deltaTime) override {
-        // Empty for now
+        // Allocations made since the last Update cover one full frame:
+        // message processing, rendering and the frame arena reset
+        size_t allocations = g_allocationCount.exchange(0, std::memory_order_relaxed);
+        
+        // Give caches and the frame arena a few frames to reach their peak size
+        if (++frameCount <= WarmupFrames) return;
+        
+        if (allocations > 0) {
+            std::cout << "FAILED: frame " << frameCount << " made " << allocations
+                      << " heap allocations in steady state" << std::endl;
+            failed = true;
+            Quit();
+        } else if (frameCount == WarmupFrames + CheckedFrames) {
+            std::cout << "PASSED: " << CheckedFrames << " steady-state frames without heap allocations" << std::endl;
+            Quit();
+        }
     }
     
+    bool Failed() const { return failed; }
+    
     void Render() override {
         // Empty for now
     }
+    
+private:
+    static constexpr size_t WarmupFrames = 60;
+    static constexpr size_t CheckedFrames = 240;
+    size_t frameCount = 0;
+    bool failed = false;
 };
 
-MIKO_IMPLEMENT_APPLICATION(DebugExampleApp)
\ No newline at end of file
+// As MIKO_IMPLEMENT_APPLICATION, but the exit code reports the allocation check
+int main() {
+    auto app = std::make_unique<DebugExampleApp>();
+    if (!app->Initialize()) {
+        return -1;
+    }
+    app->Run();
+    app->Shutdown();
+    return app->Failed() ? 1 : 0;
+}
\ No newline at end of file
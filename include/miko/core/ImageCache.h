@@ -0,0 +1,144 @@
+#pragma once
+
+#ifndef MIKO_IMAGECACHE_H
+#define MIKO_IMAGECACHE_H
+
+#include "Renderer.h"
+#include "../utils/ImageDecoder.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace miko {
+
+    enum class ImageState : uint8_t {
+        // Not in memory and not waiting to be decoded
+        Unloaded,
+        // Waiting for or being decoded
+        Queued,
+        Ready,
+        // The file could not be read or decoded
+        Failed
+    };
+
+    /**
+     * @brief Image file as handed out by ImageCache
+     *
+     * A handle stays valid for the life of the cache whatever happens to
+     * the decoded pixels: an image evicted to stay within the budget is
+     * decoded again the next time it is drawn.
+     */
+    class CachedImage {
+    public:
+        explicit CachedImage(const std::string& path);
+
+        CachedImage(const CachedImage&) = delete;
+        CachedImage& operator=(const CachedImage&) = delete;
+
+        const std::string& GetPath() const { return path; }
+        ImageState GetState() const { return state.load(std::memory_order_acquire); }
+        // Size of the full picture; 0 until first decoded
+        int GetWidth() const { return width; }
+        int GetHeight() const { return height; }
+
+    private:
+        friend class ImageCache;
+
+        std::string path;
+        std::atomic<ImageState> state;
+        // Written by the decoding worker before state becomes Ready, then unchanged until evicted
+        std::vector<ImageSurface> mips;
+        size_t byteSize;
+        int width;
+        int height;
+
+        // UI thread only: renderer bitmaps of the mips drawn so far, and the place in the LRU list
+        std::vector<BitmapHandle> bitmaps;
+        std::list<CachedImage*>::iterator lruPosition;
+        bool inLru;
+    };
+
+    using ImageHandle = std::shared_ptr<CachedImage>;
+
+    /**
+     * @brief Decodes image files in the background and keeps them within a memory budget
+     *
+     * Get returns a handle at once; the file is read and decoded on the
+     * shared ThreadPool into premultiplied BGRA, along with a chain of
+     * half-size mips so thumbnails are drawn from a small copy. Until the
+     * pixels are ready, Draw fills the rect with a placeholder colour, so
+     * the UI thread never waits for a decode.
+     *
+     * Waiting requests are taken newest first and only the newest
+     * MAX_QUEUED are kept, so after a fast scroll the images now in view
+     * are decoded first and those scrolled past are dropped. Decoded bytes
+     * are kept under the budget by evicting the least recently drawn images.
+     *
+     * All members are for the UI thread.
+     */
+    class ImageCache {
+    public:
+        static constexpr size_t DEFAULT_BUDGET_BYTES = 256 * 1024 * 1024;
+        // Requests kept waiting for a worker; older ones are dropped
+        static constexpr size_t MAX_QUEUED = 256;
+
+        explicit ImageCache(size_t budgetBytes = DEFAULT_BUDGET_BYTES);
+        // Queued decodes are dropped; one already running finishes on its worker and is discarded
+        ~ImageCache();
+
+        ImageCache(const ImageCache&) = delete;
+        ImageCache& operator=(const ImageCache&) = delete;
+
+        // Handle for the file at path (UTF-8); the same path always gives the same handle
+        ImageHandle Get(const std::string& path);
+
+        // Draws the smallest mip that covers destination, or the placeholder while the image is not ready
+        void Draw(const std::shared_ptr<Renderer>& renderer, const ImageHandle& image, const Rect& destination);
+
+        void SetBudget(size_t bytes);
+        size_t GetBudget() const { return budget; }
+        // Bytes of decoded pixels held; the renderer's bitmaps of drawn mips come on top
+        size_t GetBytesUsed() const { return bytesUsed; }
+
+        void SetPlaceholderColor(const Color& color) { placeholderColor = color; }
+        const Color& GetPlaceholderColor() const { return placeholderColor; }
+
+    private:
+        // Shared with the decoding tasks, which may outlive the cache
+        struct Shared {
+            std::mutex mutex;
+            // Newest last
+            std::vector<ImageHandle> queue;
+            // Decoded but not yet accounted for by the UI thread
+            std::vector<ImageHandle> finished;
+            bool closed = false;
+        };
+
+        std::shared_ptr<Shared> shared;
+        std::unordered_map<std::string, ImageHandle> images;
+        // Ready images, most recently drawn first
+        std::list<CachedImage*> lru;
+        size_t budget;
+        size_t bytesUsed;
+        Color placeholderColor;
+        // Renderer that made the bitmaps held by images, the only one that can draw them
+        std::weak_ptr<Renderer> bitmapRenderer;
+
+        void Request(const ImageHandle& image);
+        void CollectFinished();
+        void EnforceBudget();
+        void Evict(CachedImage& image);
+        void ReleaseBitmaps(CachedImage& image);
+
+        static void DecodeNext(const std::shared_ptr<Shared>& shared);
+    };
+
+} // namespace miko
+
+#endif // MIKO_IMAGECACHE_H
@@ -4,8 +4,12 @@
 #define MIKO_RENDERER_H
 
 #include "../utils/Math.h"
+#include "../utils/Geometry.h"
 #include "../utils/Color.h"
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <memory>
 
 // Prevent Windows API macros from interfering with our method names
@@ -66,6 +70,16 @@ namespace miko {
         Pen(const Color& color, float width = 1.0f) : color(color), width(width) {}
     };
 
+    // Frees a renderer bitmap without going through the renderer, so it works after the renderer is gone
+    struct BitmapDeleter {
+        void (*release)(void* bitmap) = nullptr;
+        
+        void operator()(void* bitmap) const { if (release) release(bitmap); }
+    };
+
+    // A renderer bitmap, released when the handle is reset or destroyed
+    using BitmapHandle = std::unique_ptr<void, BitmapDeleter>;
+
     class Renderer {
     public:
         Renderer() = default;
@@ -85,14 +99,29 @@ namespace miko {
         virtual void DrawLine(const Point& start, const Point& end, const Pen& pen) = 0;
         virtual void DrawRectangle(const Rect& rect, const Pen& pen) = 0;
         virtual void FillRectangle(const Rect& rect, const Brush& brush) = 0;
+        // Fills many rectangles with one brush; the default calls FillRectangle for each
+        virtual void FillRectangles(const Rect* rects, size_t count, const Brush& brush);
+        // Draws one connected line through count points; the default calls DrawLine for each segment
+        virtual void DrawPolyline(const Point* points, size_t count, const Pen& pen);
         virtual void DrawRoundedRectangle(const Rect& rect, float radiusX, float radiusY, const Pen& pen) = 0;
         virtual void FillRoundedRectangle(const Rect& rect, float radiusX, float radiusY, const Brush& brush) = 0;
         virtual void DrawEllipse(const Point& center, float radiusX, float radiusY, const Pen& pen) = 0;
         virtual void FillEllipse(const Point& center, float radiusX, float radiusY, const Brush& brush) = 0;
         
-        // Text rendering
-        virtual void DrawText(const std::string& text, const Rect& rect, const Font& font, const Brush& brush, TextAlignment alignment = TextAlignment::Left) = 0;
-        virtual Size MeasureText(const std::string& text, const Font& font, float maxWidth = 0.0f) = 0;
+        // Text rendering (text only needs to outlive the call, so frame arena views are fine)
+        virtual void DrawText(std::string_view text, const Rect& rect, const Font& font, const Brush& brush, TextAlignment alignment = TextAlignment::Left) = 0;
+        virtual Size MeasureText(std::string_view text, const Font& font, float maxWidth = 0.0f) = 0;
+        // Width of every grapheme cluster in text, stored at the cluster's last byte (other bytes get 0).
+        // The default measures cluster by cluster with MeasureText; renderers override it with one shaping pass.
+        virtual void MeasureCharacterAdvances(std::string_view text, const Font& font, float* advances);
+        
+        // Bitmaps hold 32-bit BGRA pixels, with premultiplied alpha or, when opaque, alpha ignored.
+        // Renderers without bitmap support keep the defaults: CreateBitmap returns an empty handle and the rest do nothing.
+        // A bitmap is only drawn by the renderer that created it, but may be released at any time.
+        virtual BitmapHandle CreateBitmap(int width, int height, bool opaque);
+        // Copies region of pixels into the bitmap; pixels is the bitmap's (0, 0) and rows are stride bytes apart
+        virtual void UpdateBitmap(void* bitmap, const PixelRect& region, const uint32_t* pixels, size_t stride);
+        virtual void DrawBitmap(void* bitmap, const Rect& destination, bool smooth = true);
         
         // Clipping
         virtual void PushClipRect(const Rect& rect) = 0;
@@ -104,6 +133,7 @@ namespace miko {
         virtual void Translate(float x, float y) = 0;
         virtual void Scale(float x, float y) = 0;
         virtual void Rotate(float angle) = 0;
+        virtual Matrix3x2 GetTransform() const = 0;
         
         // Properties
         virtual Size GetSize() const = 0;
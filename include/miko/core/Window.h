@@ -5,6 +5,7 @@
 
 #include "../utils/Math.h"
 #include "../utils/Event.h"
+#include "../layout/LayoutScheduler.h"
 #include <string>
 #include <memory>
 #include <functional>
@@ -70,9 +71,12 @@ namespace miko {
         virtual void Present() = 0;
         
         // Widget management
-        virtual void SetRootWidget(std::shared_ptr<Widget> widget) { rootWidget = widget; }
+        virtual void SetRootWidget(std::shared_ptr<Widget> widget);
         virtual std::shared_ptr<Widget> GetRootWidget() const { return rootWidget; }
         
+        // Layout changes in the root widget's tree wait here until the next frame
+        LayoutScheduler& GetLayoutScheduler() const { return *layoutScheduler; }
+        
         // Menu bar
         virtual void SetMenuBar(void* menuBar) = 0;
         virtual void* GetMenuBar() const = 0;
@@ -89,9 +93,14 @@ namespace miko {
         
     protected:
         std::shared_ptr<Widget> rootWidget;
+        std::shared_ptr<LayoutScheduler> layoutScheduler = std::make_shared<LayoutScheduler>();
+        // The client size the root widget was last arranged at
+        Size rootLayoutSize;
+        bool rootLayoutValid = false;
         
         // Helper methods for derived classes
         virtual void DispatchEvent(const Event& event);
+        // Arranges the root at the client size if it changed, then runs the layout scheduler; call before drawing
         virtual void UpdateLayout();
         virtual void RenderWidgets();
     };
@@ -0,0 +1,149 @@
+#pragma once
+
+#ifndef MIKO_FLEXLAYOUT_H
+#define MIKO_FLEXLAYOUT_H
+
+#include "Layout.h"
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace miko {
+
+    enum class FlexDirection {
+        Row,
+        Column
+    };
+
+    // Where a line's free space goes along the main axis, or the free cross space between wrapped lines
+    enum class FlexJustify {
+        Start,
+        Center,
+        End,
+        SpaceBetween,
+        SpaceAround,
+        SpaceEvenly
+    };
+
+    // Placement across the line; Auto on an item defers to the layout's item alignment
+    enum class FlexAlign {
+        Auto,
+        Start,
+        Center,
+        End,
+        Stretch
+    };
+
+    /**
+     * @brief How one child of a FlexLayout sizes itself along the main axis
+     *
+     * The basis is the child's main size before free space is shared out,
+     * margin excluded; AUTO_BASIS uses its measured size. Free space is
+     * then added in proportion to grow, or taken away in proportion to
+     * shrink times the basis, within the child's min and max size.
+     */
+    struct FlexItem {
+        static constexpr float AUTO_BASIS = -1.0f;
+
+        float grow = 0.0f;
+        float shrink = 1.0f;
+        float basis = AUTO_BASIS;
+        FlexAlign alignSelf = FlexAlign::Auto;
+
+        FlexItem() = default;
+        FlexItem(float grow, float shrink = 1.0f, float basis = AUTO_BASIS) : grow(grow), shrink(shrink), basis(basis) {}
+    };
+
+    /**
+     * @brief Flexbox-style layout along a row or column, optionally wrapping
+     *
+     * One FlexLayout covers what otherwise takes nested StackLayouts: items
+     * grow into free space or shrink to fit by weight, wrap onto further
+     * lines, and are spaced and aligned along and across each line. The
+     * layout's spacing is the gap between items in a line, and the line
+     * spacing the gap between lines. Collapsed children take no space.
+     *
+     * Each child is measured once per measure pass and the sizes are kept
+     * for the arrange pass that follows at the same size, so a container
+     * measured and then arranged asks its children once rather than twice.
+     * Resolving the flexible sizes takes at most a few passes over each
+     * line however the min and max sizes interact.
+     */
+    class FlexLayout : public Layout {
+    public:
+        explicit FlexLayout(FlexDirection direction = FlexDirection::Row);
+        virtual ~FlexLayout() = default;
+
+        // Layout interface
+        Size MeasureDesiredSize(const std::vector<std::shared_ptr<Widget>>& children, const Size& availableSize) override;
+        void ArrangeChildren(const std::vector<std::shared_ptr<Widget>>& children, const Rect& finalRect) override;
+
+        void SetDirection(FlexDirection direction) { this->direction = direction; }
+        FlexDirection GetDirection() const { return direction; }
+
+        void SetWrap(bool wrap) { this->wrap = wrap; }
+        bool GetWrap() const { return wrap; }
+
+        void SetJustifyContent(FlexJustify justify) { justifyContent = justify; }
+        FlexJustify GetJustifyContent() const { return justifyContent; }
+
+        void SetAlignItems(FlexAlign align) { alignItems = align; }
+        FlexAlign GetAlignItems() const { return alignItems; }
+
+        void SetAlignContent(FlexJustify align) { alignContent = align; }
+        FlexJustify GetAlignContent() const { return alignContent; }
+
+        void SetLineSpacing(float spacing) { lineSpacing = spacing; }
+        float GetLineSpacing() const { return lineSpacing; }
+
+        // Per-child settings; children without any use FlexItem's defaults
+        void SetItem(const std::shared_ptr<Widget>& widget, const FlexItem& item);
+        FlexItem GetItem(const Widget* widget) const;
+        void ClearItem(const Widget* widget) { items.erase(widget); }
+
+    private:
+        FlexDirection direction;
+        bool wrap;
+        FlexJustify justifyContent;
+        FlexAlign alignItems;
+        FlexJustify alignContent;
+        float lineSpacing;
+
+        // Keyed by address; the weak pointer tells a stale entry from a new widget at the same address
+        struct ItemEntry {
+            std::weak_ptr<Widget> widget;
+            FlexItem item;
+        };
+        std::unordered_map<const Widget*, ItemEntry> items;
+        size_t pruneThreshold;
+
+        // A child as measured, its sizes including its margin
+        struct Entry {
+            Widget* widget;
+            FlexItem item;
+            float base;
+            float minMain;
+            float maxMain;
+            float main;
+            float cross;
+            float minCross;
+            float maxCross;
+            bool frozen;
+        };
+        struct Line;
+
+        // The last measure pass, for the arrange pass that follows at the same size
+        std::vector<Entry> measured;
+        Size measuredAvailable;
+        bool measureValid;
+
+        void MeasureChildren(const std::vector<std::shared_ptr<Widget>>& children, const Size& available);
+        bool CanReuseMeasure(const std::vector<std::shared_ptr<Widget>>& children, const Size& available) const;
+        void ResolveFlexibleSizes(Entry* entries, size_t count, float available) const;
+        float MainOf(const Size& size) const { return direction == FlexDirection::Row ? size.width : size.height; }
+        float CrossOf(const Size& size) const { return direction == FlexDirection::Row ? size.height : size.width; }
+    };
+
+} // namespace miko
+
+#endif // MIKO_FLEXLAYOUT_H
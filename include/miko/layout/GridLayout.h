@@ -4,6 +4,8 @@
 #define MIKO_GRIDLAYOUT_H
 
 #include "Layout.h"
+#include "../utils/FrameArena.h"
+#include <limits>
 #include <vector>
 
 namespace miko {
@@ -76,22 +78,23 @@ namespace miko {
         std::vector<GridDefinition> rowDefinitions;
         std::vector<GridDefinition> columnDefinitions;
         
+        // Per-pass scratch data; all of it lives in the frame arena
         struct CellInfo {
-            std::shared_ptr<Widget> widget;
+            Widget* widget = nullptr;
             GridPosition position;
             Size desiredSize;
         };
         
-        std::vector<CellInfo> GetCellInfos(const std::vector<std::shared_ptr<Widget>>& children) const;
-        std::vector<float> CalculateRowHeights(const std::vector<CellInfo>& cells, float availableHeight) const;
-        std::vector<float> CalculateColumnWidths(const std::vector<CellInfo>& cells, float availableWidth) const;
+        ArenaVector<CellInfo> GetCellInfos(const std::vector<std::shared_ptr<Widget>>& children, FrameArena& arena) const;
+        ArenaVector<float> CalculateRowHeights(const ArenaVector<CellInfo>& cells, float availableHeight, FrameArena& arena) const;
+        ArenaVector<float> CalculateColumnWidths(const ArenaVector<CellInfo>& cells, float availableWidth, FrameArena& arena) const;
         
-        void DistributeAutoSize(std::vector<float>& sizes, const std::vector<GridDefinition>& definitions, 
-                               const std::vector<float>& desiredSizes) const;
-        void DistributeStarSize(std::vector<float>& sizes, const std::vector<GridDefinition>& definitions, 
-                               float availableSize) const;
+        void DistributeAutoSize(ArenaVector<float>& sizes, const std::vector<GridDefinition>& definitions, 
+                               const ArenaVector<float>& desiredSizes) const;
+        void DistributeStarSize(ArenaVector<float>& sizes, const std::vector<GridDefinition>& definitions, 
+                               float availableSize, FrameArena& arena) const;
         
-        Rect ApplyAlignment(std::shared_ptr<Widget> widget, const Rect& cellRect, const Size& desiredSize) const;
+        Rect ApplyAlignment(const Widget* widget, const Rect& cellRect, const Size& desiredSize) const;
         void EnsureGridSize(int rows, int columns);
     };
 
@@ -21,6 +21,8 @@ namespace miko {
         // Layout interface
         virtual Size MeasureDesiredSize(const std::vector<std::shared_ptr<Widget>>& children, const Size& availableSize) = 0;
         virtual void ArrangeChildren(const std::vector<std::shared_ptr<Widget>>& children, const Rect& finalRect) = 0;
+        // False when the desired size never depends on the children's, making each child a relayout boundary
+        virtual bool MeasuresChildren() const { return true; }
         
         // Layout properties
     void SetSpacing(float spacing) { this->spacing = spacing; }
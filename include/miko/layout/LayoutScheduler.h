@@ -0,0 +1,53 @@
+#pragma once
+
+#ifndef MIKO_LAYOUTSCHEDULER_H
+#define MIKO_LAYOUTSCHEDULER_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace miko {
+
+    class Widget;
+
+    /**
+     * @brief Collects a window's layout invalidations and lays them out once per frame
+     *
+     * The root widget of a window holds its scheduler. When a change makes
+     * a relayout boundary dirty, the boundary is queued here the first time
+     * only, so any number of changes inside it before the next frame cost
+     * one layout. Run lays out the queued boundaries outermost first;
+     * a boundary nested in one already laid out is clean by then and is
+     * skipped, so no subtree is laid out twice in a pass.
+     */
+    class LayoutScheduler {
+    public:
+        LayoutScheduler() = default;
+
+        // Queues a boundary that has just become dirty
+        void Schedule(const std::shared_ptr<Widget>& boundary);
+        bool HasPendingLayout() const { return !pending.empty(); }
+
+        /**
+         * @brief Lays out every queued boundary that is still dirty
+         *
+         * Boundaries dirtied by the layout itself are laid out in further
+         * rounds, up to a limit; any left after that wait for the next frame.
+         * @return The number of boundaries laid out
+         */
+        size_t Run();
+
+        // Boundaries laid out by all runs so far
+        size_t GetLayoutCount() const { return layoutCount; }
+
+    private:
+        std::vector<std::weak_ptr<Widget>> pending;
+        // Reused by Run
+        std::vector<std::shared_ptr<Widget>> running;
+        size_t layoutCount = 0;
+    };
+
+} // namespace miko
+
+#endif // MIKO_LAYOUTSCHEDULER_H
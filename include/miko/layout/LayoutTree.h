@@ -0,0 +1,125 @@
+#pragma once
+
+#ifndef MIKO_LAYOUTTREE_H
+#define MIKO_LAYOUTTREE_H
+
+#include "../utils/Geometry.h"
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace miko {
+
+    class Widget;
+
+    /**
+     * @brief Scalar geometry fields stored per layout node
+     */
+    enum class LayoutField : uint8_t {
+        X, Y, Width, Height,
+        MarginLeft, MarginTop, MarginRight, MarginBottom,
+        PaddingLeft, PaddingTop, PaddingRight, PaddingBottom,
+        MinWidth, MinHeight, MaxWidth, MaxHeight,
+        Count
+    };
+
+    /**
+     * @brief Flattened, structure-of-arrays storage for a widget tree
+     *
+     * Nodes are kept in pre-order, so the subtree of node n occupies the
+     * contiguous range [n, GetSubtreeEnd(n)). Each geometry field is its own
+     * array, which turns hit testing into a linear scan over
+     * contiguous floats instead of pointer chasing through children vectors.
+     *
+     * Widget owns no geometry of its own: its accessors read and write the
+     * node it is bound to. Every widget belongs to exactly one tree; a widget
+     * without a parent is node 0 of its own tree, and AddChild/RemoveChild
+     * splice whole subtrees between trees.
+     */
+    class LayoutTree {
+    public:
+        using NodeId = uint32_t;
+        static constexpr NodeId InvalidNode = std::numeric_limits<NodeId>::max();
+
+        LayoutTree() = default;
+
+        // Structure
+        NodeId CreateNode(Widget* widget);
+        void ReleaseNode(NodeId node) { widgets[node] = nullptr; }
+
+        /**
+         * @brief Moves all nodes of source (rooted at its node 0) in as the last child of parentNode
+         * @return The first node index whose position changed; callers rebind widgets from there.
+         * Only nodes from there on, plus the parent's ancestors, are touched
+         */
+        NodeId AppendSubtree(NodeId parentNode, LayoutTree& source);
+
+        /**
+         * @brief Moves the subtree rooted at node into the empty destination tree
+         * @return The first node index in this tree whose position changed
+         */
+        NodeId ExtractSubtree(NodeId node, LayoutTree& destination);
+
+        size_t GetNodeCount() const { return widgets.size(); }
+        Widget* GetWidget(NodeId node) const { return widgets[node]; }
+        NodeId GetParent(NodeId node) const { return parents[node]; }
+        NodeId GetNextSibling(NodeId node) const { return nextSiblings[node]; }
+        NodeId GetSubtreeEnd(NodeId node) const { return subtreeEnds[node]; }
+        NodeId GetFirstChild(NodeId node) const { return node + 1 < subtreeEnds[node] ? node + 1 : InvalidNode; }
+
+        // Geometry
+        float Get(NodeId node, LayoutField field) const { return Column(field)[node]; }
+        void Set(NodeId node, LayoutField field, float value) { fields[static_cast<size_t>(field)][node] = value; }
+
+        Rect GetBounds(NodeId node) const;
+        void SetBounds(NodeId node, const Rect& bounds);
+
+        Spacing GetMargin(NodeId node) const;
+        void SetMargin(NodeId node, const Spacing& margin);
+
+        Spacing GetPadding(NodeId node) const;
+        void SetPadding(NodeId node, const Spacing& padding);
+
+        Size GetMinSize(NodeId node) const;
+        void SetMinSize(NodeId node, const Size& size);
+
+        Size GetMaxSize(NodeId node) const;
+        void SetMaxSize(NodeId node, const Size& size);
+
+        bool IsVisible(NodeId node) const { return visible[node] != 0; }
+        void SetVisible(NodeId node, bool isVisible) { visible[node] = isVisible ? 1 : 0; }
+
+        // Raw column access for batch kernels
+        const float* Column(LayoutField field) const { return fields[static_cast<size_t>(field)].data(); }
+
+        // Bounds of the nodes in [begin, end) as a view for the geometry kernels
+        RectArrayView GetRectView(NodeId begin, NodeId end) const;
+
+        // Linear scan over a subtree
+        /**
+         * @brief Finds the topmost visible node under point within the subtree of root
+         *
+         * Later nodes in pre-order are drawn on top, so the last match wins.
+         * Hidden nodes prune their whole subtree.
+         */
+        NodeId HitTest(NodeId root, const Point& point) const;
+
+    private:
+        static constexpr size_t FieldCount = static_cast<size_t>(LayoutField::Count);
+
+        std::array<std::vector<float>, FieldCount> fields;
+        std::vector<NodeId> parents;
+        std::vector<NodeId> nextSiblings;
+        std::vector<NodeId> subtreeEnds;
+        std::vector<uint8_t> visible;
+        std::vector<Widget*> widgets;
+
+        void Clear();
+        NodeId FindPreviousSibling(NodeId node) const;
+        NodeId FindLastChild(NodeId node) const;
+    };
+
+} // namespace miko
+
+#endif // MIKO_LAYOUTTREE_H
@@ -0,0 +1,82 @@
+#pragma once
+
+#ifndef MIKO_UNIFORMGRIDLAYOUT_H
+#define MIKO_UNIFORMGRIDLAYOUT_H
+
+#include "Layout.h"
+#include <cstddef>
+#include <limits>
+
+namespace miko {
+
+    /**
+     * @brief Grid of equally sized cells filled row by row
+     *
+     * Every cell has the same size, so where an item goes follows from its
+     * index alone and no child is measured. Cells are either a fixed size,
+     * with as many columns as fit the width, or a fixed number of columns
+     * sharing the width. The layout's spacing separates cells both ways.
+     *
+     * Besides arranging children, the index functions answer where item i
+     * is, which item is under a point and which items a scrolled window
+     * shows in constant time, so a virtualizing view such as TileView only
+     * creates widgets for the visible items. They take the same rectangle
+     * ArrangeChildren would be given, plus how far its content is scrolled
+     * up; offsets are computed in double so that millions of rows stay
+     * exact.
+     */
+    class UniformGridLayout : public Layout {
+    public:
+        static constexpr size_t NO_INDEX = std::numeric_limits<size_t>::max();
+
+        UniformGridLayout();
+        explicit UniformGridLayout(const Size& itemSize);
+        virtual ~UniformGridLayout() = default;
+
+        // Layout interface; child i takes cell i whether or not it is visible
+        Size MeasureDesiredSize(const std::vector<std::shared_ptr<Widget>>& children, const Size& availableSize) override;
+        void ArrangeChildren(const std::vector<std::shared_ptr<Widget>>& children, const Rect& finalRect) override;
+        // Cells are sized by the layout, whatever the children want
+        bool MeasuresChildren() const override { return false; }
+
+        // A zero width shares the width between the columns, and a zero height makes cells square
+        void SetItemSize(const Size& size) { itemSize = size; }
+        const Size& GetItemSize() const { return itemSize; }
+
+        // 0 fits as many columns of the item width as there is room for
+        void SetColumnCount(int count) { columnCount = count > 0 ? count : 0; }
+        int GetColumnCount() const { return columnCount; }
+
+        // Columns and cell size for a layout rectangle of the given width
+        int GetColumnsForWidth(float width) const;
+        Size GetCellSize(float width) const;
+
+        // Size the content of count items needs at the given width, margin and padding included
+        Size GetExtent(size_t count, float width) const;
+
+        Rect GetItemRect(size_t index, const Rect& layoutRect, double scrollOffset = 0.0) const;
+        // Item whose cell contains point, or NO_INDEX for the gaps between cells and past the last item
+        size_t GetIndexAt(const Point& point, const Rect& layoutRect, size_t count, double scrollOffset = 0.0) const;
+        // Items [first, last) in the rows that show within layoutRect's height
+        void GetVisibleRange(const Rect& layoutRect, size_t count, double scrollOffset, size_t& first, size_t& last) const;
+
+    private:
+        Size itemSize;
+        int columnCount;
+
+        struct Metrics {
+            double left;
+            double top;
+            size_t columns;
+            double cellWidth;
+            double cellHeight;
+            double strideX;
+            double strideY;
+        };
+
+        Metrics ComputeMetrics(const Rect& layoutRect) const;
+    };
+
+} // namespace miko
+
+#endif // MIKO_UNIFORMGRIDLAYOUT_H
@@ -13,7 +13,7 @@
  * Key Features:
  * - Hardware-accelerated rendering with Direct2D
  * - Modern C++17 design with smart pointers
- * - Flexible layout system (Stack and Grid layouts)
+ * - Flexible layout system (Stack, Grid, UniformGrid and Flex layouts)
  * - Event-driven architecture
  * - DWM integration for modern window effects
  * - Comprehensive widget library
@@ -43,23 +43,67 @@
 #include "core/Application.h"
 #include "core/Window.h"
 #include "core/Renderer.h"
+#include "core/ImageCache.h"
 
 // Widget system headers
 #include "widgets/Widget.h"
 #include "widgets/Button.h"
 #include "widgets/Label.h"
 #include "widgets/TextBox.h"
+#include "widgets/FileView.h"
+#include "widgets/LogView.h"
+#include "widgets/TerminalView.h"
+#include "widgets/DataGrid.h"
+#include "widgets/TreeView.h"
+#include "widgets/ChartView.h"
+#include "widgets/PixelBufferView.h"
+#include "widgets/ImageTileView.h"
+#include "widgets/CanvasView.h"
+#include "widgets/TileView.h"
 #include "widgets/Panel.h"
 
 // Layout system headers
 #include "layout/Layout.h"
 #include "layout/StackLayout.h"
 #include "layout/GridLayout.h"
+#include "layout/UniformGridLayout.h"
+#include "layout/FlexLayout.h"
+#include "layout/LayoutTree.h"
+#include "layout/LayoutScheduler.h"
+
+// Text headers
+#include "text/GapBuffer.h"
+#include "text/LineIndex.h"
+#include "text/GlyphAdvanceIndex.h"
+#include "text/Utf8.h"
+#include "text/TextChange.h"
+#include "text/UndoJournal.h"
+#include "text/Tokenizer.h"
+#include "text/LineTokenCache.h"
+#include "text/TextSearch.h"
+#include "text/ChunkedLineIndex.h"
+#include "text/VtParser.h"
+#include "text/TerminalGrid.h"
 
 // Utility headers
 #include "utils/Math.h"
 #include "utils/Color.h"
 #include "utils/Event.h"
+#include "utils/FrameArena.h"
+#include "utils/Geometry.h"
+#include "utils/ThreadPool.h"
+#include "utils/MappedFile.h"
+#include "utils/Clipboard.h"
+#include "utils/MpscQueue.h"
+#include "utils/DataTable.h"
+#include "utils/ImplicitTreap.h"
+#include "utils/TreeModel.h"
+#include "utils/MinMaxPyramid.h"
+#include "utils/PixelBuffer.h"
+#include "utils/ImageDecoder.h"
+#include "utils/TiledImage.h"
+#include "utils/QuadTree.h"
+#include "utils/CanvasModel.h"
 
 // Platform specific headers
 #ifdef _WIN32
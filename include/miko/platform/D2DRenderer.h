@@ -12,6 +12,7 @@
 #include <wrl/client.h>
 #include <stack>
 #include <unordered_map>
+#include <vector>
 
 // Prevent UNICODE macros from affecting our method names
 #ifdef DrawText
@@ -43,14 +44,22 @@ namespace miko {
         void DrawLine(const Point& start, const Point& end, const Pen& pen) override;
         void DrawRectangle(const Rect& rect, const Pen& pen) override;
         void FillRectangle(const Rect& rect, const Brush& brush) override;
+        void FillRectangles(const Rect* rects, size_t count, const Brush& brush) override;
+        void DrawPolyline(const Point* points, size_t count, const Pen& pen) override;
         void DrawRoundedRectangle(const Rect& rect, float radiusX, float radiusY, const Pen& pen) override;
         void FillRoundedRectangle(const Rect& rect, float radiusX, float radiusY, const Brush& brush) override;
         void DrawEllipse(const Point& center, float radiusX, float radiusY, const Pen& pen) override;
         void FillEllipse(const Point& center, float radiusX, float radiusY, const Brush& brush) override;
         
         // Text rendering
-        void DrawText(const std::string& text, const Rect& rect, const Font& font, const Brush& brush, TextAlignment alignment = TextAlignment::Left) override;
-        Size MeasureText(const std::string& text, const Font& font, float maxWidth = 0.0f) override;
+        void DrawText(std::string_view text, const Rect& rect, const Font& font, const Brush& brush, TextAlignment alignment = TextAlignment::Left) override;
+        Size MeasureText(std::string_view text, const Font& font, float maxWidth = 0.0f) override;
+        void MeasureCharacterAdvances(std::string_view text, const Font& font, float* advances) override;
+        
+        // Bitmaps
+        BitmapHandle CreateBitmap(int width, int height, bool opaque) override;
+        void UpdateBitmap(void* bitmap, const PixelRect& region, const uint32_t* pixels, size_t stride) override;
+        void DrawBitmap(void* bitmap, const Rect& destination, bool smooth = true) override;
         
         // Clipping
         void PushClipRect(const Rect& rect) override;
@@ -62,6 +71,7 @@ namespace miko {
         void Translate(float x, float y) override;
         void Scale(float x, float y) override;
         void Rotate(float angle) override;
+        Matrix3x2 GetTransform() const override;
         
         // Properties
         Size GetSize() const override;
@@ -86,12 +96,24 @@ namespace miko {
         ComPtr<IDWriteFactory> writeFactory;
         ComPtr<IWICImagingFactory> wicFactory;
         
+        // Text formats are keyed by the whole font, so fonts whose hashes collide still get their own
+        struct FontKeyHash {
+            size_t operator()(const Font& font) const { return FontToHash(font); }
+        };
+        struct FontKeyEqual {
+            bool operator()(const Font& a, const Font& b) const {
+                return a.size == b.size && a.weight == b.weight && a.style == b.style && a.family == b.family;
+            }
+        };
+        
         // Resource caches
         std::unordered_map<uint32_t, ComPtr<ID2D1SolidColorBrush>> brushCache;
-        std::unordered_map<std::string, ComPtr<IDWriteTextFormat>> fontCache;
+        std::unordered_map<Font, ComPtr<IDWriteTextFormat>, FontKeyHash, FontKeyEqual> fontCache;
         
-        // Transform and clipping stacks
-        std::stack<D2D1::Matrix3x2F> transformStack;
+        // Transform and clipping stacks; the transform is tracked on the CPU
+        // so it can be queried without a round trip to the render target
+        Matrix3x2 currentTransform;
+        std::vector<Matrix3x2> transformStack;
         std::stack<D2D1_RECT_F> clipStack;
         
         float dpiScaleX;
@@ -102,6 +124,8 @@ namespace miko {
         bool CreateDeviceDependentResources();
         void DiscardDeviceDependentResources();
         
+        void ApplyTransform();
+
         D2D1_COLOR_F ColorToD2D(const Color& color);
         D2D1_RECT_F RectToD2D(const Rect& rect);
         D2D1_POINT_2F PointToD2D(const Point& point);
@@ -116,8 +140,9 @@ namespace miko {
         ComPtr<IDWriteTextFormat> GetOrCreateTextFormat(const Font& font);
         
         std::wstring StringToWString(const std::string& str);
+        const wchar_t* StringToArenaWString(std::string_view str, UINT32& length);
         uint32_t ColorToHash(const Color& color);
-        std::string FontToString(const Font& font);
+        static size_t FontToHash(const Font& font);
     };
 
 } // namespace miko
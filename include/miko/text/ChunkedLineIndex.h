@@ -0,0 +1,65 @@
+#pragma once
+
+#ifndef MIKO_CHUNKEDLINEINDEX_H
+#define MIKO_CHUNKEDLINEINDEX_H
+
+#include "../utils/MappedFile.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace miko {
+
+    /**
+     * @brief Line index of a large read-only file, built on the shared thread pool
+     *
+     * Instead of one entry per line, the file is split into fixed-size chunks
+     * and only the number of line breaks before each chunk is kept, so the
+     * index of a 4 GB file is a few hundred kilobytes. Finding a line start
+     * is a binary search over the chunks and a scan of one chunk.
+     *
+     * Lines become available as the background scan reaches them; pages
+     * are evicted after they are counted so the scan does not keep the
+     * file resident.
+     */
+    class ChunkedLineIndex {
+    public:
+        ChunkedLineIndex() = default;
+        ~ChunkedLineIndex() { Stop(); }
+
+        ChunkedLineIndex(const ChunkedLineIndex&) = delete;
+        ChunkedLineIndex& operator=(const ChunkedLineIndex&) = delete;
+
+        // Starts indexing file, stopping any previous scan; the index keeps the file alive
+        void Start(std::shared_ptr<const MappedFile> file);
+        void Stop();
+
+        bool IsComplete() const;
+        // Bytes scanned so far
+        size_t GetIndexedLength() const;
+
+        // Lines known so far; while indexing, the last one may continue past the scanned bytes
+        size_t GetLineCount() const;
+        // Byte offset where line starts; line must be below GetLineCount()
+        size_t GetLineStart(size_t line) const;
+
+    private:
+        struct State {
+            std::shared_ptr<const MappedFile> file;
+            // newlinesBefore[i] is the number of line breaks in chunks [0, i)
+            std::vector<size_t> newlinesBefore;
+            size_t chunkCount = 0;
+            // Entries up to newlinesBefore[indexedChunks] are final
+            std::atomic<size_t> indexedChunks{ 0 };
+            std::atomic<bool> cancelled{ false };
+        };
+
+        std::shared_ptr<State> state;
+
+        static void Run(const std::shared_ptr<State>& state);
+    };
+
+} // namespace miko
+
+#endif // MIKO_CHUNKEDLINEINDEX_H
@@ -0,0 +1,95 @@
+#pragma once
+
+#ifndef MIKO_GAPBUFFER_H
+#define MIKO_GAPBUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace miko {
+
+    /**
+     * @brief Editable byte storage with a movable gap at the edit point
+     *
+     * Text lives in one allocation split into [0, gapStart) and
+     * [gapEnd, capacity). Edits move the gap to the edit position and then
+     * consume or grow it, so a run of edits at nearby positions (typing,
+     * backspacing) costs O(1) amortized regardless of document size. Moving
+     * the gap is a single memmove of the bytes between the old and new
+     * positions.
+     *
+     * Str() returns a contiguous copy that is cached until the next edit,
+     * so repeated reads of unchanged text are O(1).
+     */
+    class GapBuffer {
+    public:
+        GapBuffer() = default;
+        explicit GapBuffer(std::string_view text);
+
+        // Size
+        size_t GetLength() const { return buffer.size() - GetGapLength(); }
+        bool IsEmpty() const { return GetLength() == 0; }
+        size_t GetCapacity() const { return buffer.size(); }
+
+        // Monotonic counter bumped by every edit; callers use it to validate their own caches
+        uint64_t GetVersion() const { return version; }
+
+        // Access
+        char At(size_t position) const {
+            return position < gapStart ? buffer[position] : buffer[position + GetGapLength()];
+        }
+        char operator[](size_t position) const { return At(position); }
+
+        /**
+         * @brief Returns the text before and after the gap without copying
+         *
+         * Concatenating first and second yields the full text. Either part may be empty.
+         */
+        std::string_view GetFirstSegment() const { return std::string_view(buffer.data(), gapStart); }
+        std::string_view GetSecondSegment() const {
+            return std::string_view(buffer.data() + gapEnd, buffer.size() - gapEnd);
+        }
+
+        /**
+         * @brief Returns the whole text as one contiguous string
+         *
+         * Rebuilt lazily after an edit and cached until the next one.
+         */
+        const std::string& Str() const;
+
+        std::string Substr(size_t position, size_t count) const;
+        void CopyTo(size_t position, size_t count, char* destination) const;
+
+        // Editing
+        void Insert(size_t position, std::string_view text);
+        void Erase(size_t position, size_t count);
+        void Replace(size_t position, size_t count, std::string_view text);
+        void Assign(std::string_view text);
+        void Clear();
+
+        // Makes room for at least totalLength bytes of text so a bulk insert moves no data twice
+        void Reserve(size_t totalLength);
+
+    private:
+        static constexpr size_t MinimumGap = 64;
+
+        std::vector<char> buffer;
+        size_t gapStart = 0;
+        size_t gapEnd = 0;
+        uint64_t version = 0;
+
+        mutable std::string flattened;
+        mutable uint64_t flattenedVersion = 0;
+
+        size_t GetGapLength() const { return gapEnd - gapStart; }
+        void MoveGap(size_t position);
+        void GrowGap(size_t minimumGap);
+        void MarkChanged();
+    };
+
+} // namespace miko
+
+#endif // MIKO_GAPBUFFER_H
@@ -0,0 +1,73 @@
+#pragma once
+
+#ifndef MIKO_GLYPHADVANCEINDEX_H
+#define MIKO_GLYPHADVANCEINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace miko {
+
+    /**
+     * @brief Cache of cumulative glyph advances for the lines of a text
+     *
+     * For a cached line of n bytes, GetOffsets() returns n + 1 x positions:
+     * offsets[i] is where a caret before byte i is drawn. Bytes inside a
+     * grapheme cluster share the x of the cluster start, so index-to-x is
+     * a single array read and x-to-index is a binary search.
+     *
+     * Only lines that are asked for are measured. An edit inside one line
+     * splices the cached advances: the inserted text is measured, the removed
+     * advances dropped, and the prefix sums after the edit point rebuilt
+     * without going back to the font.
+     */
+    class GlyphAdvanceIndex {
+    public:
+        /**
+         * Fills advances[i] for every byte of text. A cluster's width is stored at
+         * its last byte; the other bytes of the cluster get 0.
+         */
+        using MeasureFunction = std::function<void(std::string_view text, float* advances)>;
+
+        void Clear() { lines.clear(); }
+
+        // Offsets for line, measuring lineText if the line is not cached
+        const std::vector<float>& GetOffsets(size_t line, std::string_view lineText, const MeasureFunction& measure);
+
+        // Cached offsets for line, or nullptr
+        const std::vector<float>* FindOffsets(size_t line) const;
+
+        /**
+         * @brief Applies an edit that stays within one line
+         *
+         * inserted must not contain a line break. Does nothing if the line is not cached.
+         */
+        void SpliceLine(size_t line, size_t column, size_t removedLength, std::string_view inserted,
+                        const MeasureFunction& measure);
+
+        /**
+         * @brief Applies an edit that adds or removes line breaks
+         *
+         * Lines [firstLine, lastLine] were touched by the edit and are dropped;
+         * lines after lastLine are renumbered by lineDelta.
+         */
+        void ReplaceLines(size_t firstLine, size_t lastLine, ptrdiff_t lineDelta);
+
+        // Drops cached lines outside [firstLine, lastLine) except keepLine
+        void Retain(size_t firstLine, size_t lastLine, size_t keepLine);
+
+        // Byte column closest to x, never inside a cluster
+        static size_t HitTest(const std::vector<float>& offsets, float x);
+
+    private:
+        std::unordered_map<size_t, std::vector<float>> lines;
+        std::vector<float> scratch;
+    };
+
+} // namespace miko
+
+#endif // MIKO_GLYPHADVANCEINDEX_H
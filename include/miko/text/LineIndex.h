@@ -0,0 +1,75 @@
+#pragma once
+
+#ifndef MIKO_LINEINDEX_H
+#define MIKO_LINEINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace miko {
+
+    class GapBuffer;
+
+    /**
+     * @brief Byte offsets of the first character of every line
+     *
+     * Line starts are kept in a gap array positioned at the last edited
+     * line. Entries after the gap are stored relative to a shared delta, so
+     * an edit that changes the text length updates every following line in
+     * O(1) instead of rewriting them. Moving the gap folds the delta into the
+     * entries it passes over, which for edits near the previous one is a
+     * handful of lines.
+     *
+     * Lookups (line start, line containing an offset) are O(1) and
+     * O(log lines) respectively. Lines are separated by '\n'; a trailing '\r'
+     * is left in the line for the caller to trim.
+     */
+    class LineIndex {
+    public:
+        LineIndex();
+
+        void Rebuild(const GapBuffer& text);
+
+        /**
+         * @brief Updates the index for text[position, position + removedLength) being replaced by inserted
+         *
+         * Only the inserted text is scanned; removed line breaks are found by offset.
+         */
+        void Replace(size_t position, size_t removedLength, std::string_view inserted);
+
+        size_t GetLineCount() const { return starts.size() - GetGapLength(); }
+        size_t GetTextLength() const { return textLength; }
+
+        size_t GetLineStart(size_t line) const {
+            return line < gapStart ? starts[line] : static_cast<size_t>(starts[line + GetGapLength()] + delta);
+        }
+
+        // End of the line's content, excluding its '\n'
+        size_t GetLineEnd(size_t line) const {
+            return line + 1 < GetLineCount() ? GetLineStart(line + 1) - 1 : textLength;
+        }
+        size_t GetLineLength(size_t line) const { return GetLineEnd(line) - GetLineStart(line); }
+
+        // Line containing offset; offsets on a '\n' belong to the line it ends
+        size_t FindLine(size_t offset) const;
+
+    private:
+        static constexpr size_t MinimumGap = 16;
+
+        std::vector<size_t> starts;
+        size_t gapStart;
+        size_t gapEnd;
+        // Added to every entry at or after gapEnd
+        ptrdiff_t delta;
+        size_t textLength;
+
+        size_t GetGapLength() const { return gapEnd - gapStart; }
+        void MoveGap(size_t line);
+        void GrowGap(size_t minimumGap);
+    };
+
+} // namespace miko
+
+#endif // MIKO_LINEINDEX_H
@@ -0,0 +1,63 @@
+#pragma once
+
+#ifndef MIKO_LINETOKENCACHE_H
+#define MIKO_LINETOKENCACHE_H
+
+#include "Tokenizer.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <string_view>
+#include <vector>
+
+namespace miko {
+
+    /**
+     * @brief Token runs and start states for the lines of a text
+     *
+     * Lines are tokenized from the top, and only as far down as has been
+     * asked for. An edit marks just the lines it touched as stale; updating
+     * re-tokenizes those and moves on to the following line only while its
+     * start state changes, so a keystroke usually costs one line.
+     */
+    class LineTokenCache {
+    public:
+        using LineSource = std::function<std::string_view(size_t line)>;
+
+        // Forgets all lines, e.g. after the tokenizer changes
+        void Reset();
+
+        /**
+         * @brief Applies an edit that touched lines [firstLine, lastLine]
+         *
+         * Those lines become lines [firstLine, lastLine + lineDelta] and are
+         * re-tokenized on the next update; later lines are renumbered.
+         */
+        void ReplaceLines(size_t firstLine, size_t lastLine, ptrdiff_t lineDelta);
+
+        // Brings lines [0, endLine) of a lineCount-line text up to date
+        void Update(Tokenizer& tokenizer, size_t endLine, size_t lineCount, const LineSource& lineText);
+
+        // Runs of line, or nullptr if it has not been tokenized since its last change
+        const std::vector<TokenSpan>* FindSpans(size_t line) const;
+
+    private:
+        struct Line {
+            uint32_t startState = 0;
+            std::vector<TokenSpan> spans;
+        };
+
+        // The tokenized prefix of the text; lines past it have never been needed
+        std::vector<Line> lines;
+        // Start state of the first line past the prefix
+        uint32_t nextState = 0;
+        // Lines in the prefix to tokenize again, in text order
+        std::set<size_t> staleLines;
+
+        uint32_t TokenizeLine(Tokenizer& tokenizer, size_t line, const LineSource& lineText);
+    };
+
+} // namespace miko
+
+#endif // MIKO_LINETOKENCACHE_H
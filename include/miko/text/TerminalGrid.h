@@ -0,0 +1,210 @@
+#pragma once
+
+#ifndef MIKO_TERMINALGRID_H
+#define MIKO_TERMINALGRID_H
+
+#include "VtParser.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace miko {
+
+    /**
+     * @brief Screen and scrollback of a terminal, driven by a VT byte stream
+     *
+     * Cells are stored as separate arrays of code points, foreground and
+     * background colors and attribute bits, one fixed-width row per slot.
+     * The screen and the scrollback are lists of slot numbers: scrolling
+     * the screen rotates a ring of slot numbers, and the line leaving the
+     * top is handed to the scrollback ring as it is, so output scrolls
+     * without moving any cells. Each slot also records how many of its
+     * cells are in use, so recycling or erasing a line to its end is O(1)
+     * and only the written part of a line is ever touched. A slot's
+     * contents only change when it is written, erased or recycled, and each
+     * slot has a dirty bit that is set when that happens, so a view can
+     * cache per-slot rendering work.
+     *
+     * Every character occupies one cell; zero-width marks are dropped.
+     */
+    class TerminalGrid : public VtHandler {
+    public:
+        enum Attribute : uint8_t {
+            Bold = 1 << 0,
+            Faint = 1 << 1,
+            Italic = 1 << 2,
+            Underline = 1 << 3,
+            Blink = 1 << 4,
+            Inverse = 1 << 5,
+            Hidden = 1 << 6,
+            Strikethrough = 1 << 7
+        };
+
+        // Cell colors are DEFAULT_COLOR, an entry of the 256-color palette or a 24-bit RGB value
+        static constexpr uint32_t DEFAULT_COLOR = 0;
+        static uint32_t PaletteColor(uint8_t index) { return 0x01000000u | index; }
+        static uint32_t RgbColor(uint8_t r, uint8_t g, uint8_t b) { return 0x02000000u | (r << 16) | (g << 8) | b; }
+        static bool IsPaletteColor(uint32_t color) { return (color >> 24) == 1; }
+        static bool IsRgbColor(uint32_t color) { return (color >> 24) == 2; }
+
+        TerminalGrid(size_t columns = 80, size_t rows = 24, size_t scrollbackCapacity = 10000);
+
+        TerminalGrid(const TerminalGrid&) = delete;
+        TerminalGrid& operator=(const TerminalGrid&) = delete;
+
+        // Parses and applies program output
+        void Write(std::string_view bytes) { parser.Feed(bytes); }
+        // Full reset, keeping the size and the scrollback
+        void Reset();
+
+        /**
+         * @brief Changes the screen size
+         *
+         * Lines are cut or padded on the right. When the screen gets shorter,
+         * lines above the cursor move into the scrollback so the cursor stays
+         * on screen. The alternate screen is cleared.
+         */
+        void Resize(size_t columns, size_t rows);
+        size_t GetColumns() const { return columns; }
+        size_t GetRows() const { return rows; }
+
+        void SetScrollbackCapacity(size_t capacity);
+        size_t GetScrollbackCapacity() const { return scrollbackCapacity; }
+        size_t GetScrollbackLineCount() const { return scrollbackCount; }
+        void ClearScrollback();
+        // Lines ever moved into the scrollback, including ones since dropped
+        uint64_t GetScrolledLineCount() const { return scrolledLineCount; }
+
+        // Lines are the scrollback, oldest first, followed by the screen rows
+        size_t GetLineCount() const { return scrollbackCount + rows; }
+        uint32_t GetLineSlot(size_t line) const;
+        uint32_t GetRowSlot(size_t row) const { return screen[(screenOrigin + row) % rows]; }
+
+        // Cells of a slot past its length are blank, with default colors and no attributes
+        size_t GetLength(uint32_t slot) const { return lengths[slot]; }
+        // The GetLength() cells of a slot; code point 0 is a blank cell
+        const uint32_t* GetCodePoints(uint32_t slot) const { return &codePoints[slot * columns]; }
+        const uint32_t* GetForeground(uint32_t slot) const { return &foreground[slot * columns]; }
+        const uint32_t* GetBackground(uint32_t slot) const { return &background[slot * columns]; }
+        const uint8_t* GetAttributes(uint32_t slot) const { return &attributes[slot * columns]; }
+
+        size_t GetSlotCount() const { return dirty.size(); }
+        bool IsSlotDirty(uint32_t slot) const { return dirty[slot] != 0; }
+        void ClearSlotDirty(uint32_t slot) { dirty[slot] = 0; }
+
+        size_t GetCursorRow() const { return cursorRow; }
+        size_t GetCursorColumn() const { return cursorColumn; }
+        bool IsCursorVisible() const { return cursorVisible; }
+        bool IsAlternateScreen() const { return alternateActive; }
+        bool IsApplicationCursorKeys() const { return applicationCursorKeys; }
+
+        // When set, line feeds also return the cursor to the first column
+        void SetNewLineMode(bool enabled) { newLineMode = enabled; }
+        bool IsNewLineMode() const { return newLineMode; }
+
+        const std::string& GetTitle() const { return title; }
+        // True once after the program changes the title
+        bool TakeTitleChanged() { bool changed = titleChanged; titleChanged = false; return changed; }
+        // True once after the program rings the bell
+        bool TakeBell() { bool rang = bellRang; bellRang = false; return rang; }
+        // Replies owed to the program, such as cursor position reports; send them back as input
+        std::string TakeResponses() { std::string taken; taken.swap(responses); return taken; }
+
+        // VtHandler
+        void Print(std::string_view text) override;
+        void Execute(unsigned char control) override;
+        void CsiDispatch(const VtParams& params, std::string_view intermediates, char final) override;
+        void EscDispatch(std::string_view intermediates, char final) override;
+        void OscDispatch(std::string_view data) override;
+
+    private:
+        struct Pen {
+            uint32_t foreground = DEFAULT_COLOR;
+            uint32_t background = DEFAULT_COLOR;
+            uint8_t attributes = 0;
+        };
+
+        struct SavedCursor {
+            size_t row = 0;
+            size_t column = 0;
+            Pen pen;
+        };
+
+        VtParser parser;
+        size_t columns;
+        size_t rows;
+
+        // Cell arrays, columns entries per slot
+        std::vector<uint32_t> codePoints;
+        std::vector<uint32_t> foreground;
+        std::vector<uint32_t> background;
+        std::vector<uint8_t> attributes;
+        std::vector<uint32_t> lengths;
+        std::vector<uint8_t> dirty;
+        std::vector<uint32_t> freeSlots;
+
+        // Screen row r is screen[(screenOrigin + r) % rows]
+        std::vector<uint32_t> screen;
+        size_t screenOrigin;
+        // The inactive one of the main and alternate screens; empty until first used
+        std::vector<uint32_t> otherScreen;
+        size_t otherScreenOrigin;
+        bool alternateActive;
+
+        // Ring of slots holding the lines that scrolled off the main screen
+        std::vector<uint32_t> scrollback;
+        size_t scrollbackCapacity;
+        size_t scrollbackStart;
+        size_t scrollbackCount;
+        uint64_t scrolledLineCount;
+
+        size_t cursorRow;
+        size_t cursorColumn;
+        // The cursor is past the last column; the next character wraps first
+        bool pendingWrap;
+        Pen pen;
+        SavedCursor savedCursor;
+        size_t scrollTop;
+        size_t scrollBottom;
+
+        bool autoWrap;
+        bool cursorVisible;
+        bool applicationCursorKeys;
+        bool newLineMode;
+
+        std::string title;
+        bool titleChanged;
+        bool bellRang;
+        std::string responses;
+
+        void Rebuild(size_t newColumns, size_t newRows);
+        void ResetState();
+        uint32_t AllocateSlot();
+        void ClearCells(uint32_t slot, size_t first, size_t last);
+        void FillBlank(size_t start, size_t count);
+        // Makes every cell of the slot physically valid, for edits that shift cells
+        void ExtendToFullWidth(uint32_t slot);
+        uint32_t& RowSlot(size_t row) { return screen[(screenOrigin + row) % rows]; }
+
+        void LineFeed();
+        void ReverseIndex();
+        // Lines scrolled off the top of the whole main screen go to the scrollback if toScrollback is set
+        void ScrollUp(size_t top, size_t bottom, size_t count, bool toScrollback);
+        void ScrollDown(size_t top, size_t bottom, size_t count);
+        void MoveCursor(ptrdiff_t row, ptrdiff_t column);
+        void EraseInDisplay(int mode);
+        void EraseInLine(int mode);
+        void InsertCharacters(size_t count);
+        void DeleteCharacters(size_t count);
+        void SelectGraphicRendition(const VtParams& params);
+        void SetPrivateMode(int mode, bool enabled);
+        void SetAlternateScreen(bool enabled);
+        void SaveCursor();
+        void RestoreCursor();
+    };
+
+} // namespace miko
+
+#endif // MIKO_TERMINALGRID_H
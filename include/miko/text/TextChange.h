@@ -0,0 +1,53 @@
+#pragma once
+
+#ifndef MIKO_TEXTCHANGE_H
+#define MIKO_TEXTCHANGE_H
+
+#include <cstddef>
+#include <string>
+
+namespace miko {
+
+    /**
+     * @brief One edit of a text buffer, in byte offsets
+     *
+     * Replaces text[offset, offset + removedLength) with insertedText.
+     * Offsets refer to the text as it was before this change, so a list
+     * of changes is applied in order.
+     */
+    struct TextChange {
+        size_t offset = 0;
+        size_t removedLength = 0;
+        std::string insertedText;
+
+        TextChange() = default;
+        TextChange(size_t offset, size_t removedLength, std::string insertedText)
+            : offset(offset), removedLength(removedLength), insertedText(std::move(insertedText)) {}
+
+        size_t GetInsertedEnd() const { return offset + insertedText.size(); }
+
+        /**
+         * @brief Folds next into this change when the two touch
+         *
+         * Handles the typing patterns that dominate interactive edits:
+         * inserting right after this change's inserted text, and deleting
+         * backwards into it. Returns false, leaving this change untouched,
+         * for anything else.
+         */
+        bool TryMerge(const TextChange& next) {
+            if (next.removedLength == 0 && next.offset == GetInsertedEnd()) {
+                insertedText += next.insertedText;
+                return true;
+            }
+            if (next.insertedText.empty() && next.offset >= offset &&
+                next.offset + next.removedLength == GetInsertedEnd()) {
+                insertedText.resize(next.offset - offset);
+                return true;
+            }
+            return false;
+        }
+    };
+
+} // namespace miko
+
+#endif // MIKO_TEXTCHANGE_H
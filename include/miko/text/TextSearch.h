@@ -0,0 +1,87 @@
+#pragma once
+
+#ifndef MIKO_TEXTSEARCH_H
+#define MIKO_TEXTSEARCH_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace miko {
+
+    /**
+     * @brief Offset of the first occurrence of needle in text at or after from
+     *
+     * Returns std::string_view::npos when there is none. Candidates are found
+     * a vector at a time by comparing the needle's first and last bytes at
+     * every position, and only those are compared in full, so common bytes
+     * in the text rarely cost a memcmp.
+     */
+    size_t FindSubstring(std::string_view text, std::string_view needle, size_t from = 0);
+
+    // Which FindSubstring implementation was compiled in ("AVX2", "SSE2", "NEON" or "Scalar")
+    const char* GetTextSearchKernelName();
+
+    /**
+     * @brief Searches a text for non-overlapping occurrences on the shared thread pool
+     *
+     * The text is read in place as two pieces, so a gap buffer is searched
+     * without flattening it. The worker reads one chunk at a time and
+     * publishes the matches of each chunk as it goes. The pieces must not
+     * change until the search has finished or Cancel() has returned; Cancel()
+     * waits for at most the chunk in flight.
+     */
+    class BackgroundSearch {
+    public:
+        BackgroundSearch() = default;
+        ~BackgroundSearch() { Cancel(); }
+
+        BackgroundSearch(const BackgroundSearch&) = delete;
+        BackgroundSearch& operator=(const BackgroundSearch&) = delete;
+
+        /**
+         * @brief Starts searching first + second for needle, cancelling any previous search
+         *
+         * The search covers [from, end) and then wraps around to [0, from), so
+         * matches are reported in that order. It stops after maxMatches.
+         */
+        void Start(std::string_view first, std::string_view second, std::string_view needle,
+                   size_t from = 0, size_t maxMatches = SIZE_MAX);
+        void Cancel();
+
+        /**
+         * @brief Appends the matches found since the last call
+         *
+         * Returns true while the search is still running. Once it returns
+         * false every match has been delivered and the search is idle.
+         */
+        bool TakeMatches(std::vector<size_t>& matches);
+        bool IsRunning() const { return state != nullptr; }
+        // Needle of the last search started, kept after it finishes
+        const std::string& GetNeedle() const { return needle; }
+
+    private:
+        struct State {
+            // Held by the worker while it reads the text
+            std::mutex textMutex;
+            std::mutex resultMutex;
+            std::vector<size_t> found;
+            std::atomic<bool> cancelled{ false };
+            std::atomic<bool> finished{ false };
+        };
+
+        std::shared_ptr<State> state;
+        std::string needle;
+
+        static void Run(const std::shared_ptr<State>& state, std::string_view first, std::string_view second,
+                        const std::string& needle, size_t from, size_t maxMatches);
+    };
+
+} // namespace miko
+
+#endif // MIKO_TEXTSEARCH_H
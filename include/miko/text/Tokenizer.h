@@ -0,0 +1,52 @@
+#pragma once
+
+#ifndef MIKO_TOKENIZER_H
+#define MIKO_TOKENIZER_H
+
+#include "../utils/Color.h"
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace miko {
+
+    // A colored run of one line, in bytes from the start of the line
+    struct TokenSpan {
+        uint32_t start = 0;
+        uint32_t length = 0;
+        Color color;
+
+        TokenSpan() = default;
+        TokenSpan(uint32_t start, uint32_t length, const Color& color)
+            : start(start), length(length), color(color) {}
+    };
+
+    /**
+     * @brief Splits text into colored runs, one line at a time
+     *
+     * Tokenizing is resumable: the state returned for one line is passed in
+     * for the next, so constructs spanning lines (block comments, strings)
+     * are carried as a small integer. Lines are re-tokenized after edits
+     * until the state at a line start stops changing, so equal states must
+     * mean the rest of the text tokenizes the same way.
+     */
+    class Tokenizer {
+    public:
+        virtual ~Tokenizer() = default;
+
+        // State at the start of the first line
+        virtual uint32_t GetInitialState() const { return 0; }
+
+        /**
+         * @brief Appends the runs of line to spans and returns the state at its end
+         *
+         * line excludes the line break. Runs must be sorted, must not overlap
+         * and should start and end on character boundaries; bytes not covered
+         * by a run are drawn in the text color.
+         */
+        virtual uint32_t TokenizeLine(std::string_view line, uint32_t state, std::vector<TokenSpan>& spans) = 0;
+    };
+
+} // namespace miko
+
+#endif // MIKO_TOKENIZER_H
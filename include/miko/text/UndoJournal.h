@@ -0,0 +1,99 @@
+#pragma once
+
+#ifndef MIKO_UNDOJOURNAL_H
+#define MIKO_UNDOJOURNAL_H
+
+#include "TextChange.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string_view>
+#include <vector>
+
+namespace miko {
+
+    /**
+     * @brief Bounded undo/redo history of text edits
+     *
+     * Each edit is stored as a small record plus the removed and inserted
+     * bytes. The bytes live in one circular buffer, newest at the head, so
+     * recording, undoing and redoing cost O(edit size) and never touch the
+     * rest of the document. When the byte limit is reached the oldest
+     * records are dropped.
+     *
+     * Runs of typing, pasting, backspacing or forward deleting at a moving position
+     * coalesce into a single record until Seal() is called (the owner does
+     * this when the caret is moved some other way).
+     */
+    class UndoJournal {
+    public:
+        enum class EditKind : uint8_t {
+            Other,
+            Typing,
+            Backspace,
+            ForwardDelete,
+            // The pieces of one paste, inserted one after another
+            Paste
+        };
+
+        explicit UndoJournal(size_t byteLimit = 1024 * 1024);
+
+        void SetByteLimit(size_t byteLimit);
+        size_t GetByteLimit() const { return byteLimit; }
+        size_t GetBytesUsed() const { return payloadUsed + records.size() * sizeof(Entry); }
+
+        /**
+         * @brief Records that text[offset, offset + removed.size()) was replaced by inserted
+         *
+         * Discards any redo history. An edit larger than the whole limit
+         * clears the journal, since it could never be undone completely.
+         */
+        void Record(size_t offset, std::string_view removed, std::string_view inserted, EditKind kind);
+
+        // Ends the current coalescing run
+        void Seal() { sealed = true; }
+        void Clear();
+
+        bool CanUndo() const { return current > 0; }
+        bool CanRedo() const { return current < records.size(); }
+
+        // The change to apply to the text to step back or forward; false when there is none
+        bool Undo(TextChange& change);
+        bool Redo(TextChange& change);
+
+    private:
+        struct Entry {
+            size_t offset;
+            // Payload is removed bytes followed by inserted bytes, starting payloadStart bytes into the ring
+            size_t payloadStart;
+            uint32_t removedLength;
+            uint32_t insertedLength;
+            EditKind kind;
+        };
+
+        std::deque<Entry> records;
+        // Records [0, current) can be undone, [current, size) redone
+        size_t current;
+        bool sealed;
+
+        // Grows on demand up to the byte limit, then wraps
+        std::vector<char> ring;
+        size_t ringHead;
+        size_t payloadUsed;
+        size_t byteLimit;
+
+        bool TryCoalesce(size_t offset, std::string_view removed, std::string_view inserted, EditKind kind);
+        bool MakeRoom(size_t bytes);
+        void DropRedo();
+        void DropOldest();
+        void WritePayload(std::string_view bytes);
+        void WritePayloadReversed(std::string_view bytes);
+        void ReadPayload(size_t start, size_t length, std::string& destination) const;
+        void GrowRing(size_t minimumFree);
+        std::string ReadRemoved(const Entry& entry) const;
+        std::string ReadInserted(const Entry& entry) const;
+    };
+
+} // namespace miko
+
+#endif // MIKO_UNDOJOURNAL_H
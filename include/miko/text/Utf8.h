@@ -0,0 +1,49 @@
+#pragma once
+
+#ifndef MIKO_UTF8_H
+#define MIKO_UTF8_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace miko {
+
+    // Decodes the code point starting at position and advances position past it.
+    // Malformed sequences decode as U+FFFD and consume a single byte.
+    uint32_t DecodeUtf8(std::string_view text, size_t& position);
+
+    // Writes the UTF-8 form of codePoint (U+FFFD if it is not a valid scalar value)
+    // to out, which must have room for 4 bytes, and returns the number of bytes written
+    size_t EncodeUtf8(uint32_t codePoint, char* out);
+
+    // Number of leading bytes of text below 0x80
+    size_t GetAsciiPrefixLength(std::string_view text);
+
+    // Number of bytes the UTF-8 sequence starting with lead occupies (1 for invalid leads)
+    size_t GetUtf8SequenceLength(unsigned char lead);
+
+    inline bool IsUtf8Continuation(unsigned char byte) { return (byte & 0xC0) == 0x80; }
+
+    // First line of text, cut to at most maxLength bytes without splitting a character
+    std::string_view GetFirstLine(std::string_view text, size_t maxLength);
+
+    // Combining marks, joiners, variation selectors and emoji modifiers that
+    // attach to the preceding character
+    bool IsGraphemeExtender(uint32_t codePoint);
+
+    /**
+     * Byte length of the grapheme cluster starting at position.
+     *
+     * Covers the cases that matter for caret placement: multi-byte code
+     * points, combining marks, variation selectors, emoji modifiers, ZWJ
+     * sequences and CR LF. It is not a full UAX #29 segmenter.
+     */
+    size_t GetGraphemeLength(std::string_view text, size_t position);
+
+    // Start of the grapheme cluster that ends at position (position itself if it is 0)
+    size_t GetPreviousGraphemeStart(std::string_view text, size_t position);
+
+} // namespace miko
+
+#endif // MIKO_UTF8_H
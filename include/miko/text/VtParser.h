@@ -0,0 +1,106 @@
+#pragma once
+
+#ifndef MIKO_VTPARSER_H
+#define MIKO_VTPARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace miko {
+
+    // Numeric parameters of a control sequence; omitted ones read as the caller's default
+    struct VtParams {
+        static const size_t MAX_COUNT = 16;
+
+        int32_t values[MAX_COUNT] = {};
+        size_t count = 0;
+
+        int32_t Get(size_t index, int32_t defaultValue) const {
+            return index < count && values[index] > 0 ? values[index] : defaultValue;
+        }
+    };
+
+    // Receives what a VtParser recognizes in the byte stream
+    class VtHandler {
+    public:
+        virtual ~VtHandler() = default;
+
+        // A run of printable UTF-8 text with no control bytes in it
+        virtual void Print(std::string_view text) = 0;
+        // A C0 control byte such as CR, LF, BS or BEL
+        virtual void Execute(unsigned char control) = 0;
+        // CSI intermediates final; private markers such as '?' come first in intermediates
+        virtual void CsiDispatch(const VtParams& params, std::string_view intermediates, char final) = 0;
+        // ESC intermediates final
+        virtual void EscDispatch(std::string_view intermediates, char final) = 0;
+        // Operating system command, without the introducer and terminator (for example "2;title")
+        virtual void OscDispatch(std::string_view data) {}
+    };
+
+    /**
+     * @brief VT/ANSI escape sequence parser
+     *
+     * The state machine follows the DEC VT500 parser model. Each state has
+     * a 256-entry table of packed (action, next state) bytes, so a byte
+     * costs one lookup. Runs of printable bytes in the ground state, which
+     * is nearly all of the output of ordinary programs, skip the table and
+     * reach the handler as one span.
+     *
+     * Bytes may be fed in arbitrary pieces; sequences and UTF-8 characters
+     * split between calls are carried over. Input is taken as UTF-8, so
+     * bytes 0x80-0x9F are text rather than C1 controls. DCS, SOS, PM and
+     * APC strings are consumed and ignored.
+     */
+    class VtParser {
+    public:
+        explicit VtParser(VtHandler& handler);
+
+        void Feed(std::string_view bytes);
+        // Returns to the ground state, dropping any partial sequence
+        void Reset();
+
+        enum class State : uint8_t {
+            Ground,
+            Escape,
+            EscapeIntermediate,
+            CsiEntry,
+            CsiParam,
+            CsiIntermediate,
+            CsiIgnore,
+            OscString,
+            // DCS, SOS, PM and APC strings up to their terminator
+            StringIgnore,
+            Count
+        };
+
+        State GetState() const { return state; }
+
+    private:
+        static const size_t MAX_INTERMEDIATES = 4;
+        static const size_t MAX_OSC_LENGTH = 4096;
+
+        VtHandler& handler;
+        State state;
+
+        VtParams params;
+        char intermediates[MAX_INTERMEDIATES];
+        size_t intermediateCount;
+        std::string osc;
+
+        // Leading bytes of a UTF-8 character cut off by the end of the previous Feed
+        char utf8Carry[4];
+        size_t utf8CarryLength;
+
+        size_t CompleteCarriedCharacter(std::string_view bytes);
+        void PrintRun(std::string_view run, bool atEnd);
+        void Clear();
+        void Collect(char byte);
+        void Param(char byte);
+        void PerformAction(uint8_t action, unsigned char byte);
+    };
+
+} // namespace miko
+
+#endif // MIKO_VTPARSER_H
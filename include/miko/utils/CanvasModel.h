@@ -0,0 +1,112 @@
+#pragma once
+
+#ifndef MIKO_CANVASMODEL_H
+#define MIKO_CANVASMODEL_H
+
+#include "Color.h"
+#include "Math.h"
+#include "QuadTree.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace miko {
+
+    enum class CanvasShape : uint8_t {
+        Rectangle,
+        Ellipse,
+        Line,
+        Text
+    };
+
+    /**
+     * @brief Shape drawn by a CanvasView, in world coordinates
+     *
+     * A plain value rather than a widget: a rectangle, ellipse or text
+     * fills bounds, and a line runs from start to end. Text is drawn in
+     * strokeColor over fillColor, centred in bounds. A transparent fill
+     * or stroke is not drawn.
+     */
+    struct CanvasItem {
+        CanvasShape shape = CanvasShape::Rectangle;
+        Rect bounds;
+        Point start;
+        Point end;
+        Color fillColor = Color::Transparent;
+        Color strokeColor = Color::Black;
+        float strokeWidth = 1.0f;
+        std::string text;
+        float fontSize = 12.0f;
+        // For the application's use
+        uint64_t tag = 0;
+
+        static CanvasItem MakeRectangle(const Rect& bounds, const Color& fill, const Color& stroke = Color::Transparent, float strokeWidth = 1.0f);
+        static CanvasItem MakeEllipse(const Rect& bounds, const Color& fill, const Color& stroke = Color::Transparent, float strokeWidth = 1.0f);
+        static CanvasItem MakeLine(const Point& start, const Point& end, const Color& color, float width = 1.0f);
+        static CanvasItem MakeText(const Rect& bounds, const std::string& text, float fontSize, const Color& color);
+    };
+
+    /**
+     * @brief Flat list of canvas items indexed by a QuadTree
+     *
+     * Items are numbered in the order they are added, which is also the
+     * order they are drawn in, so later items are on top. Removing an item
+     * leaves its number unused rather than renumbering the rest.
+     *
+     * The index is kept up to date on every change, so queries and
+     * picking only look at the items near the area or point asked about.
+     * When items are added well outside the indexed area it is rebuilt
+     * around all of them, which happens a logarithmic number of times
+     * however the items are added.
+     */
+    class CanvasModel {
+    public:
+        using ItemId = QuadTree::ItemId;
+
+        static constexpr ItemId NO_ITEM = UINT32_MAX;
+
+        CanvasModel();
+
+        ItemId AddItem(const CanvasItem& item);
+        // Replaces an item, keeping its number and so its place in the drawing order
+        bool UpdateItem(ItemId id, const CanvasItem& item);
+        bool RemoveItem(ItemId id);
+        void Clear();
+        void Reserve(size_t itemCount);
+
+        bool IsValid(ItemId id) const { return id < items.size() && alive[id]; }
+        const CanvasItem& GetItem(ItemId id) const { return items[id]; }
+        // World-space box the item covers, its stroke included
+        const Rect& GetItemBounds(ItemId id) const { return itemBounds[id]; }
+        size_t GetItemCount() const { return liveCount; }
+        // One past the highest number handed out
+        size_t GetIdLimit() const { return items.size(); }
+        // Bounding box of all items
+        Rect GetBounds() const { return tree.GetItemBounds(); }
+
+        // Appends the items whose bounds intersect area, in no particular order
+        void Query(const Rect& area, std::vector<ItemId>& ids) const { tree.Query(area, ids); }
+        void QueryClustered(const Rect& area, float minSize, std::vector<ItemId>& ids, std::vector<QuadTree::Cluster>& clusters) const {
+            tree.QueryClustered(area, minSize, ids, clusters);
+        }
+
+        // Topmost item whose shape passes within tolerance of point, or NO_ITEM
+        ItemId HitTest(const Point& point, float tolerance) const;
+
+        static Rect ComputeBounds(const CanvasItem& item);
+
+    private:
+        std::vector<CanvasItem> items;
+        std::vector<Rect> itemBounds;
+        std::vector<bool> alive;
+        size_t liveCount;
+        QuadTree tree;
+
+        void RebuildIfOutgrown();
+        static bool HitsShape(const CanvasItem& item, const Point& point, float tolerance);
+    };
+
+} // namespace miko
+
+#endif // MIKO_CANVASMODEL_H
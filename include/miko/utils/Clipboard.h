@@ -0,0 +1,29 @@
+#pragma once
+
+#ifndef MIKO_CLIPBOARD_H
+#define MIKO_CLIPBOARD_H
+
+#include <cstddef>
+#include <functional>
+#include <string_view>
+
+namespace miko {
+
+    // Replaces the system clipboard contents with UTF-8 text
+    bool SetClipboardText(std::string_view text);
+
+    /**
+     * @brief Reads the clipboard text as UTF-8, a bounded piece at a time
+     *
+     * onChunk is called with consecutive pieces of the text, each ending on
+     * a character boundary, plus the length of the whole text so the
+     * receiver can make room for it once. Nothing the size of the whole
+     * text is allocated on the way, however much was copied. Line breaks
+     * arrive as LF whatever the platform stores.
+     * @return false if the clipboard holds no text
+     */
+    bool ReadClipboardText(const std::function<void(std::string_view chunk, size_t totalLength)>& onChunk);
+
+} // namespace miko
+
+#endif // MIKO_CLIPBOARD_H
@@ -0,0 +1,137 @@
+#pragma once
+
+#ifndef MIKO_DATATABLE_H
+#define MIKO_DATATABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace miko {
+
+    /**
+     * @brief Column-oriented table of numbers and strings
+     *
+     * Each column stores its values contiguously: numbers as an array of
+     * doubles, strings as one character buffer plus an offset per row. A
+     * table with millions of cells is then a few allocations rather than
+     * one object per cell, and sorting on a column reads one array.
+     *
+     * A table is meant to be built once and shared read-only, typically as
+     * std::shared_ptr<const DataTable>, so that background sorting can read
+     * it while the UI thread draws from it.
+     */
+    class DataTable {
+    public:
+        enum class ColumnType : uint8_t {
+            Number,
+            Text
+        };
+
+        DataTable() : rowCount(0) {}
+
+        /**
+         * @brief Appends a column and returns its index
+         *
+         * Every column must have the same number of rows as the first one
+         * added; a column of a different length is rejected and SIZE_MAX is
+         * returned. Numbers are displayed with the given number of decimals.
+         */
+        size_t AddNumberColumn(std::string name, std::vector<double> values, int decimals = 2);
+        size_t AddTextColumn(std::string name, const std::vector<std::string>& values);
+
+        size_t GetRowCount() const { return rowCount; }
+        size_t GetColumnCount() const { return columns.size(); }
+        const std::string& GetColumnName(size_t column) const { return columns[column].name; }
+        ColumnType GetColumnType(size_t column) const { return columns[column].type; }
+
+        // Value of a number column
+        double GetNumber(size_t row, size_t column) const { return columns[column].numbers[row]; }
+        // Value of a text column
+        std::string_view GetText(size_t row, size_t column) const;
+
+        // Text displayed for a cell; number columns are formatted into scratch
+        std::string_view FormatCell(size_t row, size_t column, std::string& scratch) const;
+
+        // Negative, zero or positive as cell (a, column) sorts before, with or after cell (b, column)
+        int CompareRows(size_t column, size_t a, size_t b) const;
+
+    private:
+        struct Column {
+            std::string name;
+            ColumnType type;
+            int decimals;
+            std::vector<double> numbers;
+            // Row r of a text column is text[textOffsets[r], textOffsets[r + 1])
+            std::string text;
+            std::vector<size_t> textOffsets;
+        };
+
+        std::vector<Column> columns;
+        size_t rowCount;
+
+        bool AcceptRowCount(size_t count);
+    };
+
+    /**
+     * @brief Filters and sorts the rows of a DataTable on the shared thread pool
+     *
+     * The result is a permutation index: the numbers of the rows that pass
+     * the filter, in sorted order. Filtering and sorting are split into
+     * chunks that run in parallel on the pool, and the finished index is
+     * handed over whole, so a view can keep drawing the previous order
+     * until it swaps in the new one. Starting a new job cancels the last.
+     */
+    class BackgroundRowOrder {
+    public:
+        // Returns true for the rows to keep; called from pool threads
+        using RowFilter = std::function<bool(const DataTable& table, size_t row)>;
+        using RowIndex = std::vector<uint32_t>;
+
+        // Sort column meaning the rows stay in table order
+        static const size_t NO_COLUMN = SIZE_MAX;
+
+        BackgroundRowOrder() = default;
+        ~BackgroundRowOrder() { Cancel(); }
+
+        BackgroundRowOrder(const BackgroundRowOrder&) = delete;
+        BackgroundRowOrder& operator=(const BackgroundRowOrder&) = delete;
+
+        /**
+         * @brief Starts computing the row index of table, cancelling any previous job
+         *
+         * Rows for which filter returns false are left out; an empty filter
+         * keeps every row. Rows are ordered by sortColumn, with equal values
+         * kept in table order, or left in table order for NO_COLUMN.
+         */
+        void Start(std::shared_ptr<const DataTable> table, RowFilter filter,
+                   size_t sortColumn, bool ascending);
+        void Cancel();
+        bool IsRunning() const { return state != nullptr; }
+
+        // When the job has finished, moves its index into rows and returns true
+        bool TakeResult(std::shared_ptr<const RowIndex>& rows);
+
+    private:
+        struct State {
+            std::atomic<bool> cancelled{ false };
+            std::atomic<bool> finished{ false };
+            std::mutex resultMutex;
+            std::shared_ptr<const RowIndex> result;
+        };
+
+        std::shared_ptr<State> state;
+
+        static void Run(const std::shared_ptr<State>& state, const DataTable& table, const RowFilter& filter,
+                        size_t sortColumn, bool ascending);
+    };
+
+} // namespace miko
+
+#endif // MIKO_DATATABLE_H
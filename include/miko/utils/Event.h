@@ -73,6 +73,12 @@ namespace miko {
         Right = 39,
         Down = 40,
         
+        // Navigation keys
+        PageUp = 33,
+        PageDown = 34,
+        End = 35,
+        Home = 36,
+        
         // Modifier keys
         Shift = 16,
         Control = 17,
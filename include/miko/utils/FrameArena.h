@@ -0,0 +1,129 @@
+#pragma once
+
+#ifndef MIKO_FRAMEARENA_H
+#define MIKO_FRAMEARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <vector>
+
+namespace miko {
+
+    /**
+     * @brief Per-frame bump allocator for transient scratch data
+     *
+     * Layouts, widgets and renderers allocate short-lived buffers from the
+     * frame arena instead of the global heap. Allocation is a pointer bump;
+     * nothing is freed individually. Memory is reclaimed either by rewinding
+     * a Scope or by Reset() at the end of the frame. After Reset() all blocks
+     * are merged into one, so once the arena has seen its peak frame the
+     * steady-state frame loop performs no heap allocations at all.
+     */
+    class FrameArena {
+    public:
+        struct Marker {
+            size_t block = 0;
+            size_t offset = 0;
+        };
+
+        /**
+         * @brief Rewinds the arena to its state at construction when destroyed
+         *
+         * Used by layout passes so that scratch memory is released as soon as
+         * a container has finished arranging its children.
+         */
+        class Scope {
+        public:
+            explicit Scope(FrameArena& arena) : arena(arena), marker(arena.GetMarker()) {}
+            ~Scope() { arena.Rewind(marker); }
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            FrameArena& arena;
+            Marker marker;
+        };
+
+        explicit FrameArena(size_t initialCapacity = 64 * 1024);
+        ~FrameArena();
+
+        FrameArena(const FrameArena&) = delete;
+        FrameArena& operator=(const FrameArena&) = delete;
+
+        // Allocation
+        void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+        template<typename T>
+        T* AllocateArray(size_t count) {
+            return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+        }
+
+        // Copies a string into the arena; the view stays valid until the arena is rewound past it
+        std::string_view CopyString(std::string_view text);
+
+        // Lifetime
+        Marker GetMarker() const { return Marker{ currentBlock, currentOffset }; }
+        void Rewind(const Marker& marker);
+        void Reset();
+
+        // Statistics
+        size_t GetBytesUsed() const;
+        size_t GetCapacity() const;
+        size_t GetPeakBytesUsed() const { return peakBytesUsed; }
+
+    private:
+        struct Block {
+            char* data = nullptr;
+            size_t size = 0;
+        };
+
+        std::vector<Block> blocks;
+        size_t currentBlock;
+        size_t currentOffset;
+        size_t peakBytesUsed;
+
+        void AddBlock(size_t minimumSize);
+        void ReleaseBlocks();
+    };
+
+    /**
+     * @brief STL allocator adaptor over a FrameArena
+     *
+     * deallocate() is a no-op; storage lives until the owning arena is rewound.
+     */
+    template<typename T>
+    class ArenaAllocator {
+    public:
+        using value_type = T;
+
+        explicit ArenaAllocator(FrameArena& arena) noexcept : arena(&arena) {}
+
+        template<typename U>
+        ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.GetArena()) {}
+
+        T* allocate(size_t count) { return arena->AllocateArray<T>(count); }
+        void deallocate(T*, size_t) noexcept {}
+
+        FrameArena* GetArena() const noexcept { return arena; }
+
+        template<typename U>
+        bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena == other.GetArena(); }
+        template<typename U>
+        bool operator!=(const ArenaAllocator<U>& other) const noexcept { return arena != other.GetArena(); }
+
+    private:
+        FrameArena* arena;
+    };
+
+    template<typename T>
+    using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+    // Frame arena for the calling thread; reset by Application at the end of each frame
+    FrameArena& GetFrameArena();
+
+} // namespace miko
+
+#endif // MIKO_FRAMEARENA_H
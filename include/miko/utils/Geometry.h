@@ -0,0 +1,145 @@
+#pragma once
+
+#ifndef MIKO_GEOMETRY_H
+#define MIKO_GEOMETRY_H
+
+#include "Math.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace miko {
+
+    /**
+     * @brief Portable 2D affine transform
+     *
+     * Uses the same row-vector convention and member layout as
+     * D2D1_MATRIX_3X2_F, so a point maps as
+     *   x' = x * m11 + y * m21 + dx
+     *   y' = x * m12 + y * m22 + dy
+     * and A * B applies A first, then B.
+     */
+    struct Matrix3x2 {
+        float m11, m12;
+        float m21, m22;
+        float dx, dy;
+
+        constexpr Matrix3x2() : m11(1.0f), m12(0.0f), m21(0.0f), m22(1.0f), dx(0.0f), dy(0.0f) {}
+        constexpr Matrix3x2(float m11, float m12, float m21, float m22, float dx, float dy)
+            : m11(m11), m12(m12), m21(m21), m22(m22), dx(dx), dy(dy) {}
+
+        // Factories
+        static constexpr Matrix3x2 Identity() { return Matrix3x2(); }
+        static constexpr Matrix3x2 Translation(float x, float y) { return Matrix3x2(1.0f, 0.0f, 0.0f, 1.0f, x, y); }
+        static constexpr Matrix3x2 Scale(float x, float y, const Point& center = Point()) {
+            return Matrix3x2(x, 0.0f, 0.0f, y, center.x - x * center.x, center.y - y * center.y);
+        }
+        static Matrix3x2 Rotation(float degrees, const Point& center = Point());
+
+        // Composition: applies this transform, then other
+        constexpr Matrix3x2 operator*(const Matrix3x2& other) const {
+            return Matrix3x2(
+                m11 * other.m11 + m12 * other.m21,
+                m11 * other.m12 + m12 * other.m22,
+                m21 * other.m11 + m22 * other.m21,
+                m21 * other.m12 + m22 * other.m22,
+                dx * other.m11 + dy * other.m21 + other.dx,
+                dx * other.m12 + dy * other.m22 + other.dy
+            );
+        }
+        constexpr Matrix3x2& operator*=(const Matrix3x2& other) { return *this = *this * other; }
+
+        constexpr float Determinant() const { return m11 * m22 - m12 * m21; }
+        constexpr bool IsInvertible() const { return Determinant() != 0.0f; }
+        constexpr bool IsIdentity() const {
+            return m11 == 1.0f && m12 == 0.0f && m21 == 0.0f && m22 == 1.0f && dx == 0.0f && dy == 0.0f;
+        }
+        // Translation and scale only, so rects stay axis-aligned exactly
+        constexpr bool IsAxisAligned() const { return m12 == 0.0f && m21 == 0.0f; }
+
+        /**
+         * @brief Computes the inverse transform
+         * @return False (leaving result untouched) when the matrix is singular
+         */
+        constexpr bool Invert(Matrix3x2& result) const {
+            const float det = Determinant();
+            if (det == 0.0f) {
+                return false;
+            }
+            const float invDet = 1.0f / det;
+            result = Matrix3x2(
+                m22 * invDet,
+                -m12 * invDet,
+                -m21 * invDet,
+                m11 * invDet,
+                (m21 * dy - m22 * dx) * invDet,
+                (m12 * dx - m11 * dy) * invDet
+            );
+            return true;
+        }
+
+        constexpr Point TransformPoint(const Point& point) const {
+            return Point(point.x * m11 + point.y * m21 + dx, point.x * m12 + point.y * m22 + dy);
+        }
+
+        // Axis-aligned bounding box of the transformed rectangle
+        constexpr Rect TransformRect(const Rect& rect) const {
+            const Point p0 = TransformPoint(rect.TopLeft());
+            const Point p1 = TransformPoint(rect.TopRight());
+            const Point p2 = TransformPoint(rect.BottomLeft());
+            const Point p3 = TransformPoint(rect.BottomRight());
+            const float left = std::min(std::min(p0.x, p1.x), std::min(p2.x, p3.x));
+            const float top = std::min(std::min(p0.y, p1.y), std::min(p2.y, p3.y));
+            const float right = std::max(std::max(p0.x, p1.x), std::max(p2.x, p3.x));
+            const float bottom = std::max(std::max(p0.y, p1.y), std::max(p2.y, p3.y));
+            return Rect(left, top, right - left, bottom - top);
+        }
+    };
+
+    /**
+     * @brief Read-only view over rectangles stored as separate x/y/width/height arrays
+     *
+     * Matches the column layout of LayoutTree, so its columns can be passed straight in.
+     */
+    struct RectArrayView {
+        const float* x = nullptr;
+        const float* y = nullptr;
+        const float* width = nullptr;
+        const float* height = nullptr;
+        size_t count = 0;
+    };
+
+    /**
+     * @brief Writable rectangle arrays for kernels that produce rects
+     */
+    struct RectArrayOutput {
+        float* x = nullptr;
+        float* y = nullptr;
+        float* width = nullptr;
+        float* height = nullptr;
+    };
+
+    // Batch kernels. Each uses AVX2, SSE2 or NEON when the build targets it and
+    // falls back to scalar code otherwise; results match the scalar Rect methods.
+
+    // result[i] = rects[i].Intersects(query) ? 1 : 0
+    void BatchIntersects(const RectArrayView& rects, const Rect& query, uint8_t* result);
+
+    // result[i] = rects[i].Contains(point) ? 1 : 0
+    void BatchContains(const RectArrayView& rects, const Point& point, uint8_t* result);
+
+    // output[i] = intersection of rects[i] and clip, with empty results collapsed to zero size
+    void BatchIntersect(const RectArrayView& rects, const Rect& clip, const RectArrayOutput& output);
+
+    // Bounding rectangle of all rects (the fold of Rect::Union); empty Rect when count is zero
+    Rect BatchUnion(const RectArrayView& rects);
+
+    // Transforms count points; output arrays may alias the input arrays
+    void TransformPoints(const Matrix3x2& matrix, const float* xs, const float* ys,
+                         float* outXs, float* outYs, size_t count);
+
+    // Name of the instruction set the batch kernels were compiled for
+    const char* GetGeometryKernelName();
+
+} // namespace miko
+
+#endif // MIKO_GEOMETRY_H
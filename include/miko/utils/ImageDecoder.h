@@ -0,0 +1,49 @@
+#pragma once
+
+#ifndef MIKO_IMAGEDECODER_H
+#define MIKO_IMAGEDECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace miko {
+
+    /**
+     * @brief Decoded picture in the layout renderer bitmaps take
+     *
+     * Pixels are 32-bit BGRA with premultiplied alpha, rows of width pixels
+     * from the top. Opaque surfaces have alpha 255 everywhere.
+     */
+    struct ImageSurface {
+        int width = 0;
+        int height = 0;
+        bool opaque = true;
+        std::vector<uint32_t> pixels;
+
+        size_t GetByteSize() const { return pixels.size() * sizeof(uint32_t); }
+    };
+
+    // Largest picture the decoders accept, in pixels, so a corrupt header cannot ask for gigabytes
+    constexpr size_t MAX_IMAGE_PIXELS = 64 * 1024 * 1024;
+
+    /**
+     * @brief Decodes a BMP, PPM/PGM or QOI file held in memory
+     *
+     * The format is told from the data. BMP covers 1, 4, 8, 16, 24 and
+     * 32 bits per pixel, uncompressed or with bit fields; PPM/PGM covers
+     * P2, P3, P5 and P6 at up to 16 bits per channel. Returns false for
+     * other formats and for truncated or corrupt data.
+     */
+    bool DecodeImage(const uint8_t* data, size_t size, ImageSurface& surface);
+
+    bool DecodeBmp(const uint8_t* data, size_t size, ImageSurface& surface);
+    bool DecodePpm(const uint8_t* data, size_t size, ImageSurface& surface);
+    bool DecodeQoi(const uint8_t* data, size_t size, ImageSurface& surface);
+
+    // Half the size, rounded up, each pixel the average of the 2x2 block it covers
+    void DownscaleHalf(const ImageSurface& source, ImageSurface& result);
+
+} // namespace miko
+
+#endif // MIKO_IMAGEDECODER_H
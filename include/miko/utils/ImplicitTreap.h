@@ -0,0 +1,83 @@
+#pragma once
+
+#ifndef MIKO_IMPLICITTREAP_H
+#define MIKO_IMPLICITTREAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace miko {
+
+    /**
+     * @brief Sequences of item numbers with O(log n) split, merge and index lookup
+     *
+     * Items are the numbers [0, itemCount) and each is in at most one
+     * sequence at a time. A sequence is a treap ordered by position, so
+     * cutting a range out of a list of millions of items, or splicing one
+     * in, costs O(log n) whatever the length of the range, and an item's
+     * position is found by walking up from the item.
+     *
+     * Each item carries a key, and every tree node keeps the smallest key
+     * below it, so the first item after a position with a key at or under
+     * a limit is also found in O(log n). With tree depths as keys, that is
+     * where a node's subtree ends in a flattened tree.
+     *
+     * A sequence is named by its root item; NIL is the empty sequence.
+     * Priorities are a hash of the item number, so no random state is kept.
+     */
+    class ImplicitTreap {
+    public:
+        static constexpr uint32_t NIL = UINT32_MAX;
+
+        // Makes room for items [0, itemCount), all outside any sequence
+        void Reset(size_t itemCount);
+        size_t GetItemCount() const { return nodes.size(); }
+
+        // Sequence of the given items in order, built in O(count); none of them may be in a sequence
+        uint32_t Build(const uint32_t* items, const uint32_t* keys, size_t count);
+        // Sequence of first followed by second
+        uint32_t Merge(uint32_t first, uint32_t second);
+        // Cuts a sequence after its first count items
+        void Split(uint32_t root, size_t count, uint32_t& first, uint32_t& second);
+
+        size_t GetSize(uint32_t root) const { return root == NIL ? 0 : nodes[root].size; }
+        bool IsInSequence(uint32_t item) const { return nodes[item].size != 0; }
+        uint32_t GetKey(uint32_t item) const { return nodes[item].key; }
+
+        // Item at a position of a sequence
+        uint32_t GetItem(uint32_t root, size_t index) const;
+        // Position of an item in its sequence
+        size_t GetIndex(uint32_t item) const;
+        // Root of the sequence holding an item
+        uint32_t GetRoot(uint32_t item) const;
+        // Item after this one in its sequence, or NIL; O(1) amortized when walking a sequence
+        uint32_t GetNext(uint32_t item) const;
+
+        // Position of the first item at or after from whose key is at most limit, or GetSize(root)
+        size_t FindFirstAtMost(uint32_t root, size_t from, uint32_t limit) const;
+
+    private:
+        struct Node {
+            uint32_t left;
+            uint32_t right;
+            uint32_t parent;
+            // Items in this subtree; 0 while the item is in no sequence
+            uint32_t size;
+            uint32_t key;
+            uint32_t minKey;
+        };
+
+        std::vector<Node> nodes;
+        std::vector<uint32_t> buildStack;
+
+        static bool IsHigher(uint32_t a, uint32_t b);
+        void Update(uint32_t node);
+        uint32_t MergeNodes(uint32_t first, uint32_t second);
+        void SplitNodes(uint32_t root, size_t count, uint32_t& first, uint32_t& second);
+        size_t FindNodes(uint32_t root, size_t offset, size_t from, uint32_t limit) const;
+    };
+
+} // namespace miko
+
+#endif // MIKO_IMPLICITTREAP_H
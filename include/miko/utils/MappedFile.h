@@ -0,0 +1,58 @@
+#pragma once
+
+#ifndef MIKO_MAPPEDFILE_H
+#define MIKO_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace miko {
+
+    /**
+     * @brief Read-only memory mapping of a whole file
+     *
+     * Pages are read from disk when first touched, so opening is cheap
+     * regardless of the file size and memory use follows what has been
+     * read. Safe to read from several threads.
+     */
+    class MappedFile {
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // path is UTF-8. Returns false if the file cannot be opened or mapped.
+        bool Open(const std::string& path);
+        void Close();
+
+        bool IsOpen() const { return isOpen; }
+        const char* GetData() const { return data; }
+        size_t GetSize() const { return size; }
+        std::string_view GetView() const { return std::string_view(data, size); }
+
+        /**
+         * @brief Drops the pages of a range from the process's resident memory
+         *
+         * For data that was read once, such as by a background scan. The
+         * contents stay valid and are read back from the file if touched again.
+         */
+        void Evict(size_t offset, size_t length) const;
+
+    private:
+        const char* data;
+        size_t size;
+        bool isOpen;
+#ifdef _WIN32
+        void* fileHandle;
+        void* mappingHandle;
+#else
+        int fileDescriptor;
+#endif
+    };
+
+} // namespace miko
+
+#endif // MIKO_MAPPEDFILE_H
@@ -9,12 +9,12 @@ namespace miko {
 
 struct Spacing {
     float left, top, right, bottom;
-    Spacing() : left(0.0f), top(0.0f), right(0.0f), bottom(0.0f) {}
-    Spacing(float all) : left(all), top(all), right(all), bottom(all) {}
-    Spacing(float horizontal, float vertical) : left(horizontal), top(vertical), right(horizontal), bottom(vertical) {}
-    Spacing(float left, float top, float right, float bottom) : left(left), top(top), right(right), bottom(bottom) {}
-    float Horizontal() const { return left + right; }
-    float Vertical() const { return top + bottom; }
+    constexpr Spacing() : left(0.0f), top(0.0f), right(0.0f), bottom(0.0f) {}
+    constexpr Spacing(float all) : left(all), top(all), right(all), bottom(all) {}
+    constexpr Spacing(float horizontal, float vertical) : left(horizontal), top(vertical), right(horizontal), bottom(vertical) {}
+    constexpr Spacing(float left, float top, float right, float bottom) : left(left), top(top), right(right), bottom(bottom) {}
+    constexpr float Horizontal() const { return left + right; }
+    constexpr float Vertical() const { return top + bottom; }
     bool operator==(const Spacing& other) const {
         return std::abs(left - other.left) < 0.001f && std::abs(top - other.top) < 0.001f &&
                std::abs(right - other.right) < 0.001f && std::abs(bottom - other.bottom) < 0.001f;
@@ -26,9 +26,9 @@ struct Spacing {
 
 struct Size {
     float width, height;
-    Size() : width(0.0f), height(0.0f) {}
-    Size(float width, float height) : width(width), height(height) {}
-    bool IsEmpty() const { return width <= 0.0f || height <= 0.0f; }
+    constexpr Size() : width(0.0f), height(0.0f) {}
+    constexpr Size(float width, float height) : width(width), height(height) {}
+    constexpr bool IsEmpty() const { return width <= 0.0f || height <= 0.0f; }
     bool operator==(const Size& other) const {
         return std::abs(width - other.width) < 0.001f && std::abs(height - other.height) < 0.001f;
     }
@@ -37,8 +37,8 @@ struct Size {
 
 struct Point {
     float x, y;
-    Point() : x(0.0f), y(0.0f) {}
-    Point(float x, float y) : x(x), y(y) {}
+    constexpr Point() : x(0.0f), y(0.0f) {}
+    constexpr Point(float x, float y) : x(x), y(y) {}
     bool operator==(const Point& other) const {
         return std::abs(x - other.x) < 0.001f && std::abs(y - other.y) < 0.001f;
     }
@@ -47,34 +47,34 @@ struct Point {
 
 struct Rect {
     float x, y, width, height;
-    Rect() : x(0.0f), y(0.0f), width(0.0f), height(0.0f) {}
-    Rect(float x, float y, float width, float height) : x(x), y(y), width(width), height(height) {}
-    Rect(const Point& position, const Size& size) : x(position.x), y(position.y), width(size.width), height(size.height) {}
-    float Left() const { return x; }
-    float Top() const { return y; }
-    float Right() const { return x + width; }
-    float Bottom() const { return y + height; }
-    Point TopLeft() const { return Point(x, y); }
-    Point TopRight() const { return Point(x + width, y); }
-    Point BottomLeft() const { return Point(x, y + height); }
-    Point BottomRight() const { return Point(x + width, y + height); }
-    Point Center() const { return Point(x + width * 0.5f, y + height * 0.5f); }
-    Size GetSize() const { return Size(width, height); }
-    bool Contains(const Point& point) const {
+    constexpr Rect() : x(0.0f), y(0.0f), width(0.0f), height(0.0f) {}
+    constexpr Rect(float x, float y, float width, float height) : x(x), y(y), width(width), height(height) {}
+    constexpr Rect(const Point& position, const Size& size) : x(position.x), y(position.y), width(size.width), height(size.height) {}
+    constexpr float Left() const { return x; }
+    constexpr float Top() const { return y; }
+    constexpr float Right() const { return x + width; }
+    constexpr float Bottom() const { return y + height; }
+    constexpr Point TopLeft() const { return Point(x, y); }
+    constexpr Point TopRight() const { return Point(x + width, y); }
+    constexpr Point BottomLeft() const { return Point(x, y + height); }
+    constexpr Point BottomRight() const { return Point(x + width, y + height); }
+    constexpr Point Center() const { return Point(x + width * 0.5f, y + height * 0.5f); }
+    constexpr Size GetSize() const { return Size(width, height); }
+    constexpr bool Contains(const Point& point) const {
         return point.x >= x && point.x <= x + width && point.y >= y && point.y <= y + height;
     }
-    bool Intersects(const Rect& other) const {
+    constexpr bool Intersects(const Rect& other) const {
         return !(other.x > x + width || other.x + other.width < x ||
                  other.y > y + height || other.y + other.height < y);
     }
-    Rect Union(const Rect& other) const {
+    constexpr Rect Union(const Rect& other) const {
         float left = std::min(x, other.x);
         float top = std::min(y, other.y);
         float right = std::max(x + width, other.x + other.width);
         float bottom = std::max(y + height, other.y + other.height);
         return Rect(left, top, right - left, bottom - top);
     }
-    bool IsEmpty() const { return width <= 0.0f || height <= 0.0f; }
+    constexpr bool IsEmpty() const { return width <= 0.0f || height <= 0.0f; }
     bool operator==(const Rect& other) const {
         return std::abs(x - other.x) < 0.001f && std::abs(y - other.y) < 0.001f &&
                std::abs(width - other.width) < 0.001f && std::abs(height - other.height) < 0.001f;
@@ -82,11 +82,40 @@ struct Rect {
     bool operator!=(const Rect& other) const { return !(*this == other); }
 };
 
+// Rectangle of whole pixels, for bitmap regions
+struct PixelRect {
+    int x, y, width, height;
+    constexpr PixelRect() : x(0), y(0), width(0), height(0) {}
+    constexpr PixelRect(int x, int y, int width, int height) : x(x), y(y), width(width), height(height) {}
+    constexpr int Right() const { return x + width; }
+    constexpr int Bottom() const { return y + height; }
+    constexpr bool IsEmpty() const { return width <= 0 || height <= 0; }
+    constexpr bool Contains(const PixelRect& other) const {
+        return other.x >= x && other.y >= y && other.Right() <= Right() && other.Bottom() <= Bottom();
+    }
+    constexpr PixelRect Union(const PixelRect& other) const {
+        const int left = std::min(x, other.x);
+        const int top = std::min(y, other.y);
+        return PixelRect(left, top, std::max(Right(), other.Right()) - left, std::max(Bottom(), other.Bottom()) - top);
+    }
+    // Overlap of the two rects; empty rects come out with zero size
+    constexpr PixelRect Intersection(const PixelRect& other) const {
+        const int left = std::max(x, other.x);
+        const int top = std::max(y, other.y);
+        return PixelRect(left, top, std::max(0, std::min(Right(), other.Right()) - left),
+                         std::max(0, std::min(Bottom(), other.Bottom()) - top));
+    }
+    bool operator==(const PixelRect& other) const {
+        return x == other.x && y == other.y && width == other.width && height == other.height;
+    }
+    bool operator!=(const PixelRect& other) const { return !(*this == other); }
+};
+
 // Utility functions
-inline float Clamp(float value, float min, float max) {
+constexpr float Clamp(float value, float min, float max) {
     return std::max(min, std::min(max, value));
 }
-inline float Lerp(float a, float b, float t) {
+constexpr float Lerp(float a, float b, float t) {
     return a + t * (b - a);
 }
 inline float Distance(const Point& a, const Point& b) {
@@ -0,0 +1,64 @@
+#pragma once
+
+#ifndef MIKO_MINMAXPYRAMID_H
+#define MIKO_MINMAXPYRAMID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace miko {
+
+    /**
+     * @brief Sample series with a min/max summary at every power of FAN_IN
+     *
+     * Level 0 is the samples themselves. Each bucket of level k + 1 holds
+     * the smallest and largest value of FAN_IN buckets of level k, so a
+     * bucket of level k covers FAN_IN^k samples. Drawing a range at any
+     * zoom picks the level whose buckets are about one pixel column wide
+     * and reads a few buckets per column, whatever the series length.
+     *
+     * Appending only recomputes the buckets the new samples fall in. The
+     * reduction uses SSE2 or NEON when the build targets it. Samples must
+     * not be NaN; replace gaps before appending.
+     */
+    class MinMaxPyramid {
+    public:
+        static constexpr size_t FAN_IN = 4;
+
+        void Clear();
+        void Append(const float* values, size_t count);
+
+        size_t GetSampleCount() const { return samples.size(); }
+        const float* GetSamples() const { return samples.data(); }
+
+        // Levels including level 0, the samples
+        size_t GetLevelCount() const { return levels.size() + 1; }
+        // Samples covered by one bucket of a level
+        static size_t GetBucketSize(size_t level);
+        // Coarsest level whose buckets cover at most maxBucketSize samples
+        size_t PickLevel(double maxBucketSize) const;
+
+        /**
+         * @brief Smallest and largest sample in [begin, end) as seen from a level
+         *
+         * The range is widened to whole buckets of the level, so the result
+         * may include a few samples on either side. Returns false, leaving
+         * min and max untouched, when the range holds no samples.
+         */
+        bool GetRange(size_t level, size_t begin, size_t end, float& min, float& max) const;
+
+    private:
+        struct Level {
+            std::vector<float> mins;
+            std::vector<float> maxs;
+        };
+
+        std::vector<float> samples;
+        // levels[k] is level k + 1
+        std::vector<Level> levels;
+    };
+
+} // namespace miko
+
+#endif // MIKO_MINMAXPYRAMID_H
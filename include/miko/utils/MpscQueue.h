@@ -0,0 +1,83 @@
+#pragma once
+
+#ifndef MIKO_MPSCQUEUE_H
+#define MIKO_MPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace miko {
+
+    /**
+     * @brief Unbounded lock-free queue for many producer threads and one consumer
+     *
+     * Producers push onto an atomic list head with a single CAS. The
+     * consumer takes the whole list with one exchange and hands the items
+     * out oldest first, so it suits a UI thread that drains once per frame
+     * whatever the producers' rate.
+     */
+    template <typename T>
+    class MpscQueue {
+    public:
+        MpscQueue() : head(nullptr) {}
+        ~MpscQueue() { Drain([](T&&) {}); }
+
+        MpscQueue(const MpscQueue&) = delete;
+        MpscQueue& operator=(const MpscQueue&) = delete;
+
+        // Safe from any thread
+        void Push(T value) {
+            Node* node = new Node{ std::move(value), head.load(std::memory_order_relaxed) };
+            while (!head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+            }
+        }
+
+        bool IsEmpty() const { return head.load(std::memory_order_relaxed) == nullptr; }
+
+        /**
+         * @brief Passes everything pushed so far to consume, oldest first
+         *
+         * Consumer thread only. When more than keepNewest items are waiting,
+         * the older ones are discarded without being passed on. Returns the
+         * number of items taken off the queue, including discarded ones.
+         */
+        template <typename Consume>
+        size_t Drain(Consume&& consume, size_t keepNewest = SIZE_MAX) {
+            // The list is newest first; keep a prefix of it and reverse that
+            Node* node = head.exchange(nullptr, std::memory_order_acquire);
+            Node* kept = nullptr;
+            size_t taken = 0;
+            while (node) {
+                Node* next = node->next;
+                if (taken < keepNewest) {
+                    node->next = kept;
+                    kept = node;
+                } else {
+                    delete node;
+                }
+                node = next;
+                ++taken;
+            }
+            while (kept) {
+                Node* next = kept->next;
+                consume(std::move(kept->value));
+                delete kept;
+                kept = next;
+            }
+            return taken;
+        }
+
+    private:
+        struct Node {
+            T value;
+            Node* next;
+        };
+
+        std::atomic<Node*> head;
+    };
+
+} // namespace miko
+
+#endif // MIKO_MPSCQUEUE_H
@@ -0,0 +1,106 @@
+#pragma once
+
+#ifndef MIKO_PIXELBUFFER_H
+#define MIKO_PIXELBUFFER_H
+
+#include "Math.h"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace miko {
+
+    /**
+     * @brief Triple-buffered BGRA picture written by one thread and shown by another
+     *
+     * The writer draws a frame into the back buffer between BeginFrame and
+     * EndFrame and marks the pixels it changed. Publishing swaps buffers
+     * under a short lock, so the writer never waits for the reader to finish
+     * a frame and the reader always gets the newest complete one.
+     *
+     * Nothing is copied whole. A buffer coming back to the writer is brought
+     * up to date by copying only the rects marked since it was last written,
+     * and the reader is handed the rects changed since its previous frame,
+     * which is all it has to upload. A frame that changes one column costs
+     * about one column of copying on either side.
+     *
+     * Pixels are 32-bit BGRA, premultiplied unless the buffer is opaque, in
+     * rows of GetWidth() pixels. The three buffers are allocated and zeroed
+     * by the PixelBuffer, or supplied by the caller, for instance to write
+     * frames straight into memory shared with a capture device.
+     */
+    class PixelBuffer {
+    public:
+        // Dirty rects kept per buffer before they are merged into their bounding box
+        static constexpr size_t MAX_DIRTY_RECTS = 16;
+
+        PixelBuffer(int width, int height, bool opaque = true);
+
+        /**
+         * @brief Uses three caller-owned buffers of width * height pixels each
+         *
+         * The memory must outlive the PixelBuffer and is only touched through
+         * it from then on. The picture in buffers[0] is copied into the other
+         * two, so the caller may start from any picture.
+         */
+        PixelBuffer(int width, int height, uint32_t* const buffers[3], bool opaque = true);
+
+        PixelBuffer(const PixelBuffer&) = delete;
+        PixelBuffer& operator=(const PixelBuffer&) = delete;
+
+        int GetWidth() const { return width; }
+        int GetHeight() const { return height; }
+        bool IsOpaque() const { return opaque; }
+        // Bytes from one row to the next
+        size_t GetStride() const { return (size_t)width * 4; }
+
+        // Writer side, one thread at a time. The returned back buffer already holds the newest published picture.
+        uint32_t* BeginFrame();
+        // Marks pixels changed in this frame; the rect is clipped to the buffer
+        void MarkDirty(const PixelRect& rect);
+        // Publishes the frame, even if nothing was marked
+        void EndFrame();
+
+        /**
+         * @brief Takes the newest published frame (reader side)
+         *
+         * pixels receives the reader's buffer, which stays unchanged until
+         * the next call. dirty receives the rects changed since the previous
+         * call. Returns false, leaving dirty empty, when nothing was published
+         * in between; pixels is then the same picture as before.
+         */
+        bool AcquireFrame(const uint32_t*& pixels, std::vector<PixelRect>& dirty);
+
+    private:
+        struct Slot {
+            // Points into owned, or at caller memory when owned is empty
+            uint32_t* pixels = nullptr;
+            std::vector<uint32_t> owned;
+            // Changed by frames published after this buffer's picture
+            std::vector<PixelRect> stale;
+        };
+
+        int width;
+        int height;
+        bool opaque;
+
+        std::mutex mutex;
+        Slot slots[3];
+        int backSlot;
+        int readySlot;
+        int frontSlot;
+        bool readyIsNew;
+        // Slot holding the most recently published frame
+        int latestSlot;
+        // Changed since the reader's last AcquireFrame
+        std::vector<PixelRect> unread;
+
+        // Writer only
+        std::vector<PixelRect> frameDirty;
+        std::vector<PixelRect> catchUp;
+    };
+
+} // namespace miko
+
+#endif // MIKO_PIXELBUFFER_H
@@ -0,0 +1,104 @@
+#pragma once
+
+#ifndef MIKO_QUADTREE_H
+#define MIKO_QUADTREE_H
+
+#include "Math.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace miko {
+
+    /**
+     * @brief Loose quadtree of rectangles for culling and picking
+     *
+     * Each item is stored in one node: the deepest whose cell is at least
+     * as large as the item and holds the item's centre. Cells are read as
+     * twice their size, so an item never has to stay high up in the tree
+     * for straddling a cell border, and the node is found in O(depth) by
+     * arithmetic rather than by testing. Each node also keeps the count
+     * and the bounding box of the items below it, which queries use to
+     * skip empty or distant branches and to report a whole branch as one
+     * cluster once it is too small to matter.
+     *
+     * Items outside the tree's bounds are kept in the root, where every
+     * query checks them; an owner adding items anywhere should Reset the
+     * tree to larger bounds once GetOutsideCount grows.
+     */
+    class QuadTree {
+    public:
+        using ItemId = uint32_t;
+
+        static constexpr int MAX_DEPTH = 20;
+
+        // A branch of the tree reported whole by QueryClustered
+        struct Cluster {
+            // Bounding box of the items in it
+            Rect bounds;
+            uint32_t count;
+            // One of the items, to stand in for the rest
+            ItemId representative;
+        };
+
+        explicit QuadTree(const Rect& bounds = Rect(0.0f, 0.0f, 1024.0f, 1024.0f));
+
+        // Removes every item and sets the area divided, grown to a square
+        void Reset(const Rect& bounds);
+
+        void Insert(ItemId id, const Rect& rect);
+        // rect must be the one the item was inserted with. Returns false if the item is not there.
+        bool Remove(ItemId id, const Rect& rect);
+
+        size_t GetCount() const { return nodes[0].count; }
+        const Rect& GetBounds() const { return bounds; }
+        size_t GetOutsideCount() const { return outsideCount; }
+        // Bounding box of the items; it grows as items are added but does not shrink as they are removed
+        Rect GetItemBounds() const { return nodes[0].count > 0 ? nodes[0].itemBounds : Rect(); }
+
+        // Appends the items whose rects intersect area, in no particular order
+        void Query(const Rect& area, std::vector<ItemId>& ids) const;
+
+        /**
+         * @brief As Query, but reports branches smaller than minSize as clusters
+         *
+         * A branch holding more than one item whose cell, or the bounding
+         * box of whose items, is under minSize across is appended to
+         * clusters instead of its items being appended to ids. Items kept
+         * above such branches are at least a quarter of minSize across, so
+         * the cost of a query is bounded by the area over minSize squared
+         * however many items there are.
+         */
+        void QueryClustered(const Rect& area, float minSize, std::vector<ItemId>& ids, std::vector<Cluster>& clusters) const;
+
+    private:
+        struct Entry {
+            ItemId id;
+            Rect rect;
+        };
+
+        struct Node {
+            std::vector<Entry> entries;
+            // Index in nodes, or 0 for none (the root is no one's child)
+            uint32_t children[4] = {0, 0, 0, 0};
+            // Items in this node and below, and their bounding box
+            uint32_t count = 0;
+            Rect itemBounds;
+        };
+
+        // Square
+        Rect bounds;
+        std::vector<Node> nodes;
+        size_t outsideCount;
+
+        // Walks to the node rect belongs in, changing the count of each node passed; UINT32_MAX if missing and not created
+        uint32_t Descend(const Rect& rect, bool create, int countChange);
+        void AdjustNode(uint32_t node, const Rect& rect, int countChange);
+        bool IsOutside(const Rect& rect) const;
+        void QueryNode(uint32_t node, float cell, const Rect& area, float minSize, std::vector<ItemId>& ids, std::vector<Cluster>* clusters) const;
+        ItemId FindRepresentative(uint32_t node) const;
+    };
+
+} // namespace miko
+
+#endif // MIKO_QUADTREE_H
@@ -0,0 +1,61 @@
+#pragma once
+
+#ifndef MIKO_THREADPOOL_H
+#define MIKO_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace miko {
+
+    /**
+     * @brief Fixed set of worker threads running queued tasks in FIFO order
+     *
+     * Widgets hand long-running work (searching, sorting, decoding) to
+     * the shared pool and pick up the results on the UI thread when they
+     * next render. Tasks must not touch widgets directly.
+     */
+    class ThreadPool {
+    public:
+        // threadCount 0 uses one thread per core, leaving one for the UI thread
+        explicit ThreadPool(size_t threadCount = 0);
+        // Runs the tasks still queued, then joins the workers
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        void Submit(std::function<void()> task);
+        size_t GetThreadCount() const { return workers.size(); }
+
+        /**
+         * @brief Calls body(i) for every i in [0, count) in parallel and waits for all of them
+         *
+         * The calling thread works through the indices alongside the pool,
+         * so a pool task may use this without waiting on itself.
+         */
+        void ParallelFor(size_t count, const std::function<void(size_t index)>& body);
+
+        // Pool shared by the whole library, created on first use
+        static ThreadPool& GetShared();
+
+    private:
+        std::vector<std::thread> workers;
+        std::deque<std::function<void()>> tasks;
+        std::mutex mutex;
+        std::condition_variable wake;
+        bool stopping;
+
+        void WorkerLoop();
+    };
+
+} // namespace miko
+
+#endif // MIKO_THREADPOOL_H
@@ -0,0 +1,83 @@
+#pragma once
+
+#ifndef MIKO_TILEDIMAGE_H
+#define MIKO_TILEDIMAGE_H
+
+#include "ImageDecoder.h"
+#include "MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace miko {
+
+    /**
+     * @brief Read-only, memory-mapped multi-resolution tile pyramid
+     *
+     * File layout, all integers little-endian:
+     *
+     *     header      "MKTI", u32 version (1), u32 width, u32 height,
+     *                 u32 tileSize, u32 levelCount
+     *     tile index  for level 0, 1, ... in turn, that level's tiles row
+     *                 by row, each as u64 offset, u32 size, u32 reserved
+     *     tile data   anywhere after the index
+     *
+     * Level 0 is the full picture; level n is the picture at 1 / 2^n of
+     * its size, rounded up, so the last level should fit in one tile. Each
+     * level is cut into tileSize squares from the top left, those on the
+     * right and bottom edges being smaller. A tile's data is an image file
+     * DecodeImage reads (QOI is the natural choice) of exactly the tile's
+     * size; a size of 0 means the tile is left blank.
+     *
+     * Opening reads only the header, so it costs the same for any picture
+     * size, and tiles are read from the mapping as they are asked for. The
+     * const members are safe to call from several threads.
+     */
+    class TiledImage {
+    public:
+        static constexpr uint32_t VERSION = 1;
+        static constexpr size_t HEADER_SIZE = 24;
+        static constexpr size_t INDEX_ENTRY_SIZE = 16;
+        static constexpr int MIN_TILE_SIZE = 16;
+        static constexpr int MAX_TILE_SIZE = 4096;
+        static constexpr int MAX_LEVELS = 32;
+
+        TiledImage();
+
+        TiledImage(const TiledImage&) = delete;
+        TiledImage& operator=(const TiledImage&) = delete;
+
+        // path is UTF-8. Returns false if the file cannot be mapped or its header or index is invalid.
+        bool Open(const std::string& path);
+        void Close();
+        bool IsOpen() const { return file.IsOpen(); }
+
+        int GetWidth() const { return width; }
+        int GetHeight() const { return height; }
+        int GetTileSize() const { return tileSize; }
+        int GetLevelCount() const { return levelCount; }
+
+        int GetLevelWidth(int level) const;
+        int GetLevelHeight(int level) const;
+        int GetColumns(int level) const;
+        int GetRows(int level) const;
+
+        // Encoded bytes of a tile; false if it is out of range, blank, or lies outside the file
+        bool GetTileData(int level, int column, int row, const uint8_t*& data, size_t& size) const;
+        // False for a blank tile as well as a corrupt one or one of the wrong size
+        bool DecodeTile(int level, int column, int row, ImageSurface& surface) const;
+
+    private:
+        MappedFile file;
+        int width;
+        int height;
+        int tileSize;
+        int levelCount;
+        // Index entry of each level's first tile
+        std::vector<uint64_t> levelStart;
+    };
+
+} // namespace miko
+
+#endif // MIKO_TILEDIMAGE_H
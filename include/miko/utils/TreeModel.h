@@ -0,0 +1,66 @@
+#pragma once
+
+#ifndef MIKO_TREEMODEL_H
+#define MIKO_TREEMODEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace miko {
+
+    /**
+     * @brief Hierarchy of text nodes stored as flat arrays
+     *
+     * Nodes are numbered in the order they are added and linked to their
+     * parent, first and last child and next sibling by number, with all
+     * labels in one character buffer, so a tree of millions of nodes is a
+     * few arrays rather than millions of objects. Nodes can only be added.
+     *
+     * Node ROOT is an unlabelled root; its children are the top-level
+     * nodes. Like DataTable, a model is meant to be built and then shared
+     * read-only with the views showing it.
+     */
+    class TreeModel {
+    public:
+        using NodeId = uint32_t;
+
+        static constexpr NodeId ROOT = 0;
+        static constexpr NodeId NO_NODE = UINT32_MAX;
+
+        TreeModel();
+
+        // Appends a node as the last child of parent and returns its number, or NO_NODE if parent does not exist
+        NodeId AddNode(NodeId parent, std::string_view label);
+        void Reserve(size_t nodeCount, size_t textLength);
+
+        // Number of nodes, including the root
+        size_t GetNodeCount() const { return parents.size(); }
+        bool IsValid(NodeId node) const { return node < parents.size(); }
+
+        NodeId GetParent(NodeId node) const { return parents[node]; }
+        NodeId GetFirstChild(NodeId node) const { return firstChildren[node]; }
+        NodeId GetNextSibling(NodeId node) const { return nextSiblings[node]; }
+        size_t GetChildCount(NodeId node) const { return childCounts[node]; }
+        bool HasChildren(NodeId node) const { return firstChildren[node] != NO_NODE; }
+        // Levels below the root; top-level nodes are at depth 1
+        uint32_t GetDepth(NodeId node) const { return depths[node]; }
+        std::string_view GetText(NodeId node) const;
+
+    private:
+        std::vector<NodeId> parents;
+        std::vector<NodeId> firstChildren;
+        std::vector<NodeId> lastChildren;
+        std::vector<NodeId> nextSiblings;
+        std::vector<uint32_t> childCounts;
+        std::vector<uint32_t> depths;
+        // Node n's text is text[textOffsets[n], textOffsets[n + 1])
+        std::string text;
+        std::vector<size_t> textOffsets;
+    };
+
+} // namespace miko
+
+#endif // MIKO_TREEMODEL_H
@@ -0,0 +1,138 @@
+#pragma once
+
+#ifndef MIKO_CANVASVIEW_H
+#define MIKO_CANVASVIEW_H
+
+#include "Widget.h"
+#include "../core/Renderer.h"
+#include "../utils/CanvasModel.h"
+#include "../utils/Geometry.h"
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace miko {
+
+    /**
+     * @brief Zoomable view of a CanvasModel's shapes
+     *
+     * Made for diagrams of hundreds of thousands of shapes, which as child
+     * widgets would all be drawn and hit-tested every frame. A frame asks
+     * the model's quadtree for what is in view and draws only that; a
+     * click asks it for what is near the pointer.
+     *
+     * Level of detail keeps zoomed-out frames cheap as well. Text smaller
+     * than SetMinTextSize on screen is left out, and a quadtree branch
+     * whose shapes together are smaller than SetClusterSize is drawn as
+     * one block in the colour of one of them, so a frame draws at most
+     * about as many clusters as fit on screen however many shapes are in
+     * view.
+     *
+     * Dragging pans, the wheel zooms around the pointer and a click
+     * selects the topmost shape under it. The arrow keys pan, Page Up and
+     * Page Down zoom, Home fits the whole model and Escape clears the
+     * selection.
+     */
+    class CanvasView : public Widget {
+    public:
+        using ItemId = CanvasModel::ItemId;
+        
+        CanvasView();
+        virtual ~CanvasView() = default;
+        
+        void SetModel(std::shared_ptr<CanvasModel> model);
+        const std::shared_ptr<CanvasModel>& GetModel() const { return m_model; }
+        
+        // DIPs per world unit
+        float GetZoom() const { return m_zoom; }
+        // Zooms keeping the world point under anchor, in view coordinates, where it is
+        void SetZoom(float zoom, const Point& anchor);
+        void Zoom(float factor, const Point& anchor);
+        // Moves the drawing by a distance in DIPs
+        void PanBy(float dx, float dy);
+        // Fits the bounds of all items to the view
+        void ZoomToFit();
+        // Shows a world area as large as fits, centred
+        void ZoomToRect(const Rect& worldArea);
+        
+        // World to view coordinates, and back
+        Matrix3x2 GetViewTransform() const;
+        Point ViewToWorld(const Point& viewPoint) const;
+        Point WorldToView(const Point& worldPoint) const;
+        
+        // Topmost item under a point in view coordinates, or CanvasModel::NO_ITEM
+        ItemId HitTestItem(const Point& viewPoint) const;
+        
+        void SetSelectedItem(ItemId item);
+        ItemId GetSelectedItem() const { return m_selectedItem; }
+        void SetSelectionColor(const Color& color) { m_selectionColor = color; Invalidate(); }
+        const Color& GetSelectionColor() const { return m_selectionColor; }
+        
+        // Font for text items; its size is ignored for the item's own
+        void SetFont(const Font& font) { m_font = font; Invalidate(); }
+        const Font& GetFont() const { return m_font; }
+        
+        // Text under this many device pixels high is not drawn
+        void SetMinTextSize(float pixels) { m_minTextSize = pixels; Invalidate(); }
+        float GetMinTextSize() const { return m_minTextSize; }
+        // Branches smaller than this many DIPs are drawn as one block; 0 draws every item
+        void SetClusterSize(float dips) { m_clusterSize = dips; Invalidate(); }
+        float GetClusterSize() const { return m_clusterSize; }
+        
+        // What the last frame drew, for tuning the level of detail
+        size_t GetDrawnItemCount() const { return m_drawnItems; }
+        size_t GetDrawnClusterCount() const { return m_drawnClusters; }
+        
+        // Widget overrides
+        bool OnMouseEvent(const MouseEvent& event) override;
+        bool OnKeyEvent(const KeyEvent& event) override;
+        Size MeasureDesiredSize(const Size& availableSize) override;
+        
+        // Events
+        std::function<void(ItemId item)> OnItemClicked;
+        std::function<void(ItemId item)> OnSelectionChanged;
+        std::function<void()> OnViewChanged;
+        
+    protected:
+        void OnRender(std::shared_ptr<Renderer> renderer) override;
+        
+    private:
+        std::shared_ptr<CanvasModel> m_model;
+        
+        // view = world * m_zoom + m_pan, relative to the top left of the drawing area
+        float m_zoom;
+        Point m_pan;
+        bool m_fitPending;
+        
+        ItemId m_selectedItem;
+        Color m_selectionColor;
+        Font m_font;
+        float m_minTextSize;
+        float m_clusterSize;
+        
+        bool m_dragging;
+        bool m_dragMoved;
+        Point m_dragStart;
+        Point m_dragLast;
+        
+        // Reused each frame
+        std::vector<ItemId> m_visibleItems;
+        std::vector<QuadTree::Cluster> m_clusters;
+        // Each cluster's block with its colour as ARGB, sorted by colour into batches
+        std::vector<std::pair<uint32_t, Rect>> m_clusterFills;
+        std::vector<Rect> m_clusterRects;
+        // m_font at each text item's size
+        Font m_textFont;
+        size_t m_drawnItems;
+        size_t m_drawnClusters;
+        
+        void DrawItem(Renderer& renderer, const CanvasItem& item, const Matrix3x2& toView, float dpiScale);
+        void DrawClusters(Renderer& renderer, const Matrix3x2& toView, float dpiScale);
+        void NotifyViewChanged();
+        Rect GetDrawingArea() const;
+    };
+
+} // namespace miko
+
+#endif // MIKO_CANVASVIEW_H
@@ -0,0 +1,128 @@
+#pragma once
+
+#ifndef MIKO_CHARTVIEW_H
+#define MIKO_CHARTVIEW_H
+
+#include "Widget.h"
+#include "../core/Renderer.h"
+#include "../utils/MinMaxPyramid.h"
+#include "../utils/MpscQueue.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace miko {
+
+    /**
+     * @brief Line chart of sample series that stays fast at any length
+     *
+     * Series share an x axis in sample numbers. Each keeps its samples in
+     * a MinMaxPyramid, and a frame reads the level whose buckets are about
+     * one pixel column wide, drawing the smallest and largest value of each
+     * column: about two points per column in one DrawPolyline call per
+     * series, so panning and zooming cost the same for ten samples or ten
+     * million. Once zoomed in to fewer samples than that, the samples are
+     * drawn as they are.
+     *
+     * Any thread may append samples. As in LogView they are queued without
+     * locking and added once per frame; while the newest samples are in
+     * view the chart scrolls to follow them.
+     */
+    class ChartView : public Widget {
+    public:
+        ChartView();
+        virtual ~ChartView() = default;
+        
+        // Adds an empty series and returns its number; UI thread only
+        size_t AddSeries(const std::string& name, const Color& color);
+        size_t GetSeriesCount() const { return m_series.size(); }
+        const std::string& GetSeriesName(size_t series) const { return m_series[series].name; }
+        const Color& GetSeriesColor(size_t series) const { return m_series[series].color; }
+        const MinMaxPyramid& GetSeriesSamples(size_t series) const { return m_series[series].samples; }
+        
+        // Safe from any thread; the samples appear on the next frame. Samples must not be NaN.
+        void Append(size_t series, const float* values, size_t count);
+        // Moves queued samples into their series; called automatically each frame
+        void FlushAppends();
+        // Drops every series' samples, queued ones included
+        void ClearSamples();
+        
+        // Length of the longest series
+        size_t GetSampleCount() const { return m_sampleCount; }
+        
+        // Visible x range in samples: [start, start + length)
+        void SetVisibleRange(double start, double length);
+        double GetVisibleStart() const { return m_viewStart; }
+        double GetVisibleLength() const { return m_viewLength; }
+        void ZoomToFit();
+        // Zooms around a sample; factors below 1 zoom in
+        void Zoom(double factor, double anchor);
+        
+        // While following, the view keeps its length and ends at the newest sample
+        void SetFollowLatest(bool follow);
+        bool IsFollowLatest() const { return m_followLatest; }
+        
+        // A fixed y range turns off automatic scaling to the visible samples
+        void SetYRange(float min, float max);
+        void SetAutoScaleY(bool autoScale) { m_autoScaleY = autoScale; Invalidate(); }
+        bool IsAutoScaleY() const { return m_autoScaleY; }
+        // The y range drawn last, when scaling automatically
+        float GetYMin() const { return m_yMin; }
+        float GetYMax() const { return m_yMax; }
+        
+        void SetLineWidth(float width) { m_lineWidth = width; Invalidate(); }
+        float GetLineWidth() const { return m_lineWidth; }
+        
+        void SetGridColor(const Color& color) { m_gridColor = color; Invalidate(); }
+        const Color& GetGridColor() const { return m_gridColor; }
+        
+        // Widget overrides
+        bool OnMouseEvent(const MouseEvent& event) override;
+        bool OnKeyEvent(const KeyEvent& event) override;
+        Size MeasureDesiredSize(const Size& availableSize) override;
+        
+        // Events
+        std::function<void(double start, double length)> OnVisibleRangeChanged;
+        
+    protected:
+        void OnRender(std::shared_ptr<Renderer> renderer) override;
+        
+    private:
+        struct Series {
+            std::string name;
+            Color color;
+            MinMaxPyramid samples;
+        };
+        
+        struct PendingSamples {
+            size_t series;
+            std::vector<float> values;
+        };
+        
+        std::vector<Series> m_series;
+        MpscQueue<PendingSamples> m_pending;
+        size_t m_sampleCount;
+        
+        double m_viewStart;
+        double m_viewLength;
+        bool m_followLatest;
+        
+        bool m_autoScaleY;
+        float m_yMin;
+        float m_yMax;
+        float m_lineWidth;
+        Color m_gridColor;
+        
+        bool m_dragging;
+        float m_dragStartX;
+        double m_dragStartView;
+        
+        // Points of the visible part of a series, at most 2 * columns + 4: x in view coordinates, y the sample value
+        size_t DecimateSeries(const MinMaxPyramid& samples, const Rect& plot, size_t columns, Point* points) const;
+        double GetMaxViewStart() const;
+        Rect GetPlotRect() const;
+    };
+
+} // namespace miko
+
+#endif // MIKO_CHARTVIEW_H
@@ -0,0 +1,178 @@
+#pragma once
+
+#ifndef MIKO_DATAGRID_H
+#define MIKO_DATAGRID_H
+
+#include "Widget.h"
+#include "../core/Renderer.h"
+#include "../utils/DataTable.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace miko {
+
+    /**
+     * @brief Scrollable table drawn straight from a DataTable
+     *
+     * There are no per-cell widgets: each frame draws only the rows and
+     * columns in view, so the cost of a frame follows the size of the
+     * widget rather than the size of the table. The header row, a number
+     * of leading rows and a number of leading columns can be frozen so
+     * they stay in place while the rest scrolls.
+     *
+     * Sorting and filtering run on the shared thread pool and produce a
+     * permutation index of table rows. The grid keeps drawing the previous
+     * order until the new index is ready and then swaps it in whole.
+     * Selection follows the table row, so it survives a new order.
+     */
+    class DataGrid : public Widget {
+    public:
+        using RowFilter = BackgroundRowOrder::RowFilter;
+        
+        // Row number meaning no row
+        static const size_t NO_ROW = SIZE_MAX;
+        // Column number meaning no column
+        static const size_t NO_COLUMN = BackgroundRowOrder::NO_COLUMN;
+        
+        DataGrid();
+        virtual ~DataGrid() = default;
+        
+        // Shows a new table; column widths, selection and scrolling are reset, sorting and filtering reapplied
+        void SetTable(std::shared_ptr<const DataTable> table);
+        const std::shared_ptr<const DataTable>& GetTable() const { return m_table; }
+        
+        // Rows shown, after filtering
+        size_t GetRowCount() const;
+        // Table row shown at position row
+        size_t GetTableRow(size_t row) const { return m_order ? (*m_order)[row] : row; }
+        
+        // Sorting and filtering apply once the background job finishes
+        void SortByColumn(size_t column, bool ascending = true);
+        void ClearSort();
+        size_t GetSortColumn() const { return m_sortColumn; }
+        bool IsSortAscending() const { return m_sortAscending; }
+        void SetFilter(RowFilter filter);
+        void ClearFilter() { SetFilter(nullptr); }
+        bool IsUpdatingOrder() const { return m_orderJob.IsRunning(); }
+        
+        void SetColumnWidth(size_t column, float width);
+        float GetColumnWidth(size_t column) const { return m_columnWidths[column]; }
+        
+        // Leading rows and columns that stay in place when the grid scrolls; the header row is always frozen
+        void SetFrozenRowCount(size_t count);
+        size_t GetFrozenRowCount() const { return m_frozenRows; }
+        void SetFrozenColumnCount(size_t count);
+        size_t GetFrozenColumnCount() const { return m_frozenColumns; }
+        
+        // Selection is a table row, or NO_ROW
+        void SetSelectedRow(size_t tableRow);
+        size_t GetSelectedRow() const { return m_selectedRow; }
+        
+        // Scrolls so the given shown row is the first one below the frozen rows
+        void ScrollToRow(size_t row);
+        size_t GetFirstVisibleRow() const { return m_firstRow; }
+        // Scrolls the unfrozen columns horizontally, in pixels
+        void SetHorizontalOffset(float offset);
+        float GetHorizontalOffset() const { return m_scrollX; }
+        
+        void SetFont(const Font& font);
+        const Font& GetFont() const { return m_font; }
+        
+        void SetTextColor(const Color& color) { m_textColor = color; Invalidate(); }
+        const Color& GetTextColor() const { return m_textColor; }
+        
+        void SetHeaderColor(const Color& color) { m_headerColor = color; Invalidate(); }
+        const Color& GetHeaderColor() const { return m_headerColor; }
+        
+        void SetAlternateRowColor(const Color& color) { m_alternateRowColor = color; Invalidate(); }
+        const Color& GetAlternateRowColor() const { return m_alternateRowColor; }
+        
+        void SetSelectionColor(const Color& color) { m_selectionColor = color; Invalidate(); }
+        const Color& GetSelectionColor() const { return m_selectionColor; }
+        
+        void SetGridLineColor(const Color& color) { m_gridLineColor = color; Invalidate(); }
+        const Color& GetGridLineColor() const { return m_gridLineColor; }
+        
+        // Widget overrides
+        bool OnMouseEvent(const MouseEvent& event) override;
+        bool OnKeyEvent(const KeyEvent& event) override;
+        Size MeasureDesiredSize(const Size& availableSize) override;
+        
+        // Events
+        std::function<void(size_t tableRow)> OnSelectionChanged;
+        // A new sort or filter has been applied
+        std::function<void(size_t rowCount)> OnOrderChanged;
+        
+    protected:
+        void OnRender(std::shared_ptr<Renderer> renderer) override;
+        
+    private:
+        std::shared_ptr<const DataTable> m_table;
+        // Shown rows as table rows; null shows every row in table order
+        std::shared_ptr<const BackgroundRowOrder::RowIndex> m_order;
+        BackgroundRowOrder m_orderJob;
+        RowFilter m_filter;
+        size_t m_sortColumn;
+        bool m_sortAscending;
+        
+        std::vector<float> m_columnWidths;
+        // m_columnOffsets[c] is the left edge of column c, with the total width at the end
+        std::vector<float> m_columnOffsets;
+        size_t m_frozenRows;
+        size_t m_frozenColumns;
+        
+        // First shown row below the frozen ones; scrolling is kept in rows like FileView
+        size_t m_firstRow;
+        float m_scrollX;
+        
+        size_t m_selectedRow;
+        // Position of the selected row in the shown rows, or NO_ROW when it is filtered out
+        size_t m_selectedPosition;
+        
+        // Column whose right edge is being dragged, or NO_COLUMN
+        size_t m_resizingColumn;
+        float m_resizeStartX;
+        float m_resizeStartWidth;
+        
+        Font m_font;
+        Font m_headerFont;
+        Color m_textColor;
+        Color m_headerColor;
+        Color m_alternateRowColor;
+        Color m_selectionColor;
+        Color m_gridLineColor;
+        
+        // Per-frame scratch: shown rows and columns on screen, rectangles to fill and formatted cell text
+        std::vector<size_t> m_visibleRows;
+        std::vector<size_t> m_visibleColumns;
+        std::vector<Rect> m_fillRects;
+        std::string m_cellText;
+        
+        void StartOrderJob();
+        // Polls the background job and swaps in its index once it is ready
+        void UpdateOrder();
+        void ApplyOrder(std::shared_ptr<const BackgroundRowOrder::RowIndex> order);
+        void UpdateColumnOffsets();
+        void UpdateSelectedPosition();
+        void MoveSelection(size_t position);
+        void ClampScroll();
+        
+        float GetRowHeight() const;
+        Rect GetGridRect() const;
+        // Shown rows that fit below the header and the frozen rows
+        size_t GetScrollingRowCapacity() const;
+        size_t GetShownFrozenRowCount() const;
+        float GetFrozenWidth() const;
+        // Left edge of a column on screen, taking horizontal scrolling into account
+        float GetColumnX(size_t column, const Rect& grid) const;
+        // Column at x, or NO_COLUMN
+        size_t HitTestColumn(float x, const Rect& grid) const;
+        // Shown row at y below the header, or NO_ROW
+        size_t HitTestRow(float y, const Rect& grid) const;
+    };
+
+} // namespace miko
+
+#endif // MIKO_DATAGRID_H
@@ -0,0 +1,80 @@
+#pragma once
+
+#ifndef MIKO_FILEVIEW_H
+#define MIKO_FILEVIEW_H
+
+#include "Widget.h"
+#include "../core/Renderer.h"
+#include "../utils/MappedFile.h"
+#include "../text/ChunkedLineIndex.h"
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace miko {
+
+    /**
+     * @brief Read-only view of a text file of any size
+     *
+     * The file is memory-mapped rather than loaded, and its lines are
+     * indexed in the background, so the first screen shows right away and
+     * memory use follows the parts that have been scrolled through. Only
+     * the visible lines are read and drawn.
+     */
+    class FileView : public Widget {
+    public:
+        FileView();
+        virtual ~FileView() = default;
+        
+        // Returns false if the file cannot be opened
+        bool Open(const std::string& path);
+        void Close();
+        bool IsOpen() const { return m_file != nullptr; }
+        const std::string& GetPath() const { return m_path; }
+        size_t GetFileSize() const { return m_file ? m_file->GetSize() : 0; }
+        
+        // Lines indexed so far; grows until indexing completes
+        size_t GetLineCount() const { return m_lineIndex.GetLineCount(); }
+        bool IsIndexing() const { return m_file && !m_lineIndex.IsComplete(); }
+        // Fraction of the file indexed, from 0 to 1
+        float GetIndexProgress() const;
+        
+        void ScrollToLine(size_t line);
+        size_t GetFirstVisibleLine() const { return m_firstLine; }
+        size_t GetVisibleLineCount() const;
+        
+        void SetFont(const Font& font) { m_font = font; Invalidate(); }
+        const Font& GetFont() const { return m_font; }
+        
+        void SetTextColor(const Color& color) { m_textColor = color; Invalidate(); }
+        const Color& GetTextColor() const { return m_textColor; }
+        
+        // Widget overrides
+        bool OnMouseEvent(const MouseEvent& event) override;
+        bool OnKeyEvent(const KeyEvent& event) override;
+        Size MeasureDesiredSize(const Size& availableSize) override;
+        
+        // Events
+        std::function<void(size_t lineCount)> OnIndexingCompleted;
+        
+    protected:
+        void OnRender(std::shared_ptr<Renderer> renderer) override;
+        
+    private:
+        std::shared_ptr<MappedFile> m_file;
+        ChunkedLineIndex m_lineIndex;
+        std::string m_path;
+        Font m_font;
+        Color m_textColor;
+        // Scrolling is kept in lines; a pixel offset loses precision in files with millions of lines
+        size_t m_firstLine;
+        bool m_indexingReported;
+        
+        float GetLineHeight() const;
+        Rect GetTextRect() const;
+        std::string_view ReadLine(size_t line, size_t start, size_t& nextStart) const;
+    };
+
+} // namespace miko
+
+#endif // MIKO_FILEVIEW_H
@@ -0,0 +1,154 @@
+#pragma once
+
+#ifndef MIKO_IMAGETILEVIEW_H
+#define MIKO_IMAGETILEVIEW_H
+
+#include "Widget.h"
+#include "../core/Renderer.h"
+#include "../utils/TiledImage.h"
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace miko {
+
+    /**
+     * @brief Pan-and-zoom viewer for pictures too large to hold in memory
+     *
+     * Shows a TiledImage pyramid. Each frame draws the coarsest level
+     * whose pixels are no larger than a screen pixel, and only the tiles
+     * of it that are in view, so panning and zooming cost the same for a
+     * megapixel picture as for a gigapixel one.
+     *
+     * Tiles are decoded on the shared ThreadPool, those nearest the middle
+     * of the view first; tiles scrolled out of view before a worker gets to
+     * them are never decoded. Until a tile is ready the nearest coarser
+     * tile already decoded is drawn in its place, so the view is never
+     * blank after the first moment. Decoded tiles are kept as renderer
+     * bitmaps in an LRU cache of a set number of tiles.
+     *
+     * Dragging pans and the wheel zooms around the pointer; the arrow keys
+     * pan, Page Up and Page Down zoom and Home fits the picture to the view.
+     */
+    class ImageTileView : public Widget {
+    public:
+        static constexpr size_t DEFAULT_TILE_CAPACITY = 512;
+        
+        ImageTileView();
+        virtual ~ImageTileView();
+        
+        // Opens a tiled image file (see TiledImage); false leaves the view empty
+        bool Open(const std::string& path);
+        void SetImage(std::shared_ptr<const TiledImage> image);
+        const std::shared_ptr<const TiledImage>& GetImage() const { return m_image; }
+        
+        // DIPs per pixel of the full picture
+        double GetZoom() const { return m_zoom; }
+        // Zooms keeping the picture point under anchor, in view coordinates, where it is
+        void SetZoom(double zoom, const Point& anchor);
+        void Zoom(double factor, const Point& anchor);
+        void ZoomToFit();
+        // Moves the picture by a distance in DIPs
+        void PanBy(float dx, float dy);
+        
+        // Picture point, in full-size pixels, shown in the middle of the view
+        double GetCenterX() const { return m_centerX; }
+        double GetCenterY() const { return m_centerY; }
+        void SetCenter(double x, double y);
+        
+        // Decoded tiles kept; those drawn in the current frame are kept even over the capacity
+        void SetTileCapacity(size_t tiles);
+        size_t GetTileCapacity() const { return m_tileCapacity; }
+        size_t GetCachedTileCount() const { return m_tiles.size(); }
+        
+        // Widget overrides
+        bool OnMouseEvent(const MouseEvent& event) override;
+        bool OnKeyEvent(const KeyEvent& event) override;
+        Size MeasureDesiredSize(const Size& availableSize) override;
+        
+        // Events
+        std::function<void()> OnViewChanged;
+        
+    protected:
+        void OnRender(std::shared_ptr<Renderer> renderer) override;
+        
+    private:
+        struct DecodedTile {
+            uint64_t key;
+            ImageSurface pixels;
+            bool decoded;
+        };
+        
+        // Shared with the decoding tasks, which may outlive the view
+        struct Loader {
+            std::shared_ptr<const TiledImage> image;
+            std::mutex mutex;
+            // Tile keys to decode, most wanted last
+            std::vector<uint64_t> queue;
+            std::unordered_set<uint64_t> decoding;
+            std::vector<DecodedTile> finished;
+            size_t workers = 0;
+            bool closed = false;
+        };
+        
+        struct Tile {
+            // Pixels wait here until the tile is first drawn, then live in the bitmap
+            ImageSurface pixels;
+            BitmapHandle bitmap;
+            // Blank or undecodable tiles are cached too, so they are not asked for again
+            bool blank = false;
+            uint64_t lastDrawnFrame = 0;
+            std::list<uint64_t>::iterator lruPosition;
+        };
+        
+        std::shared_ptr<const TiledImage> m_image;
+        std::shared_ptr<Loader> m_loader;
+        
+        // Most recently drawn first
+        std::unordered_map<uint64_t, Tile> m_tiles;
+        std::list<uint64_t> m_lru;
+        size_t m_tileCapacity;
+        std::weak_ptr<Renderer> m_bitmapRenderer;
+        uint64_t m_frame;
+        
+        double m_zoom;
+        double m_centerX;
+        double m_centerY;
+        // Fit once the view has a size
+        bool m_fitPending;
+        // Whether the loader's queue may hold tiles from an earlier frame
+        bool m_hasRequests;
+        
+        bool m_dragging;
+        Point m_dragLast;
+        
+        // Reused each frame
+        std::vector<uint64_t> m_wanted;
+        std::vector<uint64_t> m_fallbacks;
+        std::vector<uint64_t> m_coarsest;
+        
+        void CollectFinished();
+        void RequestTiles();
+        void DrawTile(const std::shared_ptr<Renderer>& renderer, uint64_t key, Tile& tile,
+                      double originX, double originY, float dpiScale);
+        void EvictTiles();
+        void ReleaseTiles();
+        void CloseLoader();
+        int PickLevel(float dpiScale) const;
+        double GetMinZoom() const;
+        void ClampView();
+        void NotifyViewChanged();
+        Rect GetPictureArea() const;
+        
+        static void DecodeTiles(const std::shared_ptr<Loader>& loader);
+    };
+
+} // namespace miko
+
+#endif // MIKO_IMAGETILEVIEW_H
@@ -18,7 +18,7 @@ namespace miko {
         void SetText(const std::string& text);
         const std::string& GetText() const { return text; }
         
-        void SetFont(const Font& font) { this->font = font; Invalidate(); InvalidateLayout(); }
+        void SetFont(const Font& font) { this->font = font; Invalidate(); InvalidateTextSize(); }
         const Font& GetFont() const { return font; }
         
         void SetTextColor(const Color& color) { textColor = color; Invalidate(); }
@@ -50,6 +50,7 @@ namespace miko {
         
         void Initialize();
         Rect GetTextRect() const;
+        void InvalidateTextSize();
     };
 
 } // namespace miko
@@ -0,0 +1,93 @@
+#pragma once
+
+#ifndef MIKO_LOGVIEW_H
+#define MIKO_LOGVIEW_H
+
+#include "Widget.h"
+#include "../core/Renderer.h"
+#include "../utils/MpscQueue.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace miko {
+
+    /**
+     * @brief Scrolling view of the most recent lines of a log
+     *
+     * Any thread may append. Appended lines are queued without locking and
+     * moved into a fixed-capacity ring once per frame, so the cost of a
+     * frame does not depend on how fast lines arrive, and the oldest lines
+     * are dropped once the ring is full. Only the visible rows are drawn.
+     * While scrolled to the bottom the view follows new lines.
+     */
+    class LogView : public Widget {
+    public:
+        explicit LogView(size_t capacity = 100000);
+        virtual ~LogView() = default;
+        
+        // Safe from any thread; the line appears on the next frame
+        void Append(std::string_view line);
+        
+        // The rest is UI thread only
+        void Clear();
+        void SetCapacity(size_t capacity);
+        size_t GetCapacity() const { return m_capacity; }
+        
+        // Lines currently kept, oldest first
+        size_t GetLineCount() const { return m_lineCount; }
+        const std::string& GetLine(size_t index) const;
+        // Lines discarded before being shown because the UI thread fell behind the producers
+        uint64_t GetDroppedLineCount() const { return m_droppedLines.load(std::memory_order_relaxed); }
+        
+        // Moves queued lines into the view; called automatically each frame
+        void FlushAppends();
+        
+        void SetStickToBottom(bool stick);
+        bool IsStickToBottom() const { return m_stickToBottom; }
+        void ScrollToLine(size_t line);
+        size_t GetFirstVisibleLine() const { return m_firstLine; }
+        size_t GetVisibleLineCount() const;
+        
+        void SetFont(const Font& font) { m_font = font; Invalidate(); }
+        const Font& GetFont() const { return m_font; }
+        
+        void SetTextColor(const Color& color) { m_textColor = color; Invalidate(); }
+        const Color& GetTextColor() const { return m_textColor; }
+        
+        // Widget overrides
+        bool OnMouseEvent(const MouseEvent& event) override;
+        bool OnKeyEvent(const KeyEvent& event) override;
+        Size MeasureDesiredSize(const Size& availableSize) override;
+        
+    protected:
+        void OnRender(std::shared_ptr<Renderer> renderer) override;
+        
+    private:
+        MpscQueue<std::string> m_pending;
+        std::atomic<size_t> m_pendingCount;
+        // Queued lines past which Append drops; read by producers, so kept apart from m_capacity
+        std::atomic<size_t> m_dropThreshold;
+        std::atomic<uint64_t> m_droppedLines;
+        
+        // Ring of lines; the newest overwrites the oldest once it is full
+        std::vector<std::string> m_lines;
+        size_t m_capacity;
+        size_t m_firstSlot;
+        size_t m_lineCount;
+        
+        Font m_font;
+        Color m_textColor;
+        size_t m_firstLine;
+        bool m_stickToBottom;
+        
+        size_t GetMaxFirstLine() const;
+        float GetLineHeight() const;
+        Rect GetTextRect() const;
+    };
+
+} // namespace miko
+
+#endif // MIKO_LOGVIEW_H
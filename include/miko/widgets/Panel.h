@@ -38,6 +38,8 @@ namespace miko {
     protected:
         void OnRender(std::shared_ptr<Renderer> renderer) override;
         void RenderChildren(std::shared_ptr<Renderer> renderer) override;
+        // Without a layout the panel sizes itself around its children
+        bool MeasuresChildren() const override { return !GetLayout() || Widget::MeasuresChildren(); }
         
         // Scrolling helpers
         virtual void UpdateScrollBars();
@@ -0,0 +1,61 @@
+#pragma once
+
+#ifndef MIKO_PIXELBUFFERVIEW_H
+#define MIKO_PIXELBUFFERVIEW_H
+
+#include "Widget.h"
+#include "../core/Renderer.h"
+#include "../utils/PixelBuffer.h"
+#include <memory>
+#include <vector>
+
+namespace miko {
+
+    /**
+     * @brief Shows a PixelBuffer that the application draws into
+     *
+     * The picture lives in a renderer bitmap. Each frame takes the newest
+     * frame the application published and uploads only the rects it marked
+     * dirty since the previous one, so a spectrogram adding a column per
+     * frame uploads one column however large the bitmap is. The whole
+     * picture is uploaded only when the bitmap is first created.
+     */
+    class PixelBufferView : public Widget {
+    public:
+        PixelBufferView();
+        virtual ~PixelBufferView() = default;
+        
+        void SetPixelBuffer(std::shared_ptr<PixelBuffer> buffer);
+        const std::shared_ptr<PixelBuffer>& GetPixelBuffer() const { return m_buffer; }
+        
+        // Keeps the picture's proportions, centred, instead of filling the view
+        void SetPreserveAspectRatio(bool preserve) { m_preserveAspectRatio = preserve; Invalidate(); }
+        bool IsPreserveAspectRatio() const { return m_preserveAspectRatio; }
+        
+        // Bilinear filtering when scaled; off shows each pixel as a sharp block, as heatmaps want
+        void SetSmoothScaling(bool smooth) { m_smoothScaling = smooth; Invalidate(); }
+        bool IsSmoothScaling() const { return m_smoothScaling; }
+        
+        // Widget overrides
+        Size MeasureDesiredSize(const Size& availableSize) override;
+        
+    protected:
+        void OnRender(std::shared_ptr<Renderer> renderer) override;
+        
+    private:
+        std::shared_ptr<PixelBuffer> m_buffer;
+        // Renderer bitmap holding the picture, drawable by m_bitmapRenderer only
+        BitmapHandle m_bitmap;
+        std::weak_ptr<Renderer> m_bitmapRenderer;
+        // Reused for each frame's dirty rects
+        std::vector<PixelRect> m_dirty;
+        
+        bool m_preserveAspectRatio;
+        bool m_smoothScaling;
+        
+        Rect GetPictureRect() const;
+    };
+
+} // namespace miko
+
+#endif // MIKO_PIXELBUFFERVIEW_H
@@ -0,0 +1,156 @@
+#pragma once
+
+#ifndef MIKO_TERMINALVIEW_H
+#define MIKO_TERMINALVIEW_H
+
+#include "Widget.h"
+#include "../core/Renderer.h"
+#include "../text/TerminalGrid.h"
+#include "../utils/MpscQueue.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace miko {
+
+    /**
+     * @brief Terminal emulator view of a VT byte stream
+     *
+     * Program output may be written from any thread; it is queued and
+     * parsed into a TerminalGrid once per frame. Parsing stops after a
+     * fixed time budget and resumes on the next frame, so a burst of
+     * output delays the screen rather than freezing the window.
+     * Drawing works from cached runs of cells that share colors and
+     * attributes, rebuilt only for grid slots whose dirty bit is set, so
+     * a frame costs one DrawText per run and one FillRectangles call per
+     * background color however fast the output scrolls.
+     *
+     * Keys the user presses are translated to the bytes a terminal would
+     * send and passed to OnInput for the owner to forward to the program.
+     */
+    class TerminalView : public Widget {
+    public:
+        explicit TerminalView(size_t scrollbackCapacity = 10000);
+        virtual ~TerminalView() = default;
+        
+        /**
+         * @brief Queues program output; safe from any thread, applied on the next frames
+         *
+         * Unparsed output is bounded. Once the bound is reached only part of
+         * bytes, or none of it, is taken, and the caller writes the rest
+         * again later, in order: a thread reading the program's output pipe
+         * stops reading, which holds the program back until parsing catches
+         * up. Nothing is ever dropped, so the stream is never cut inside an
+         * escape sequence and no mode change is lost.
+         * @return The number of leading bytes taken
+         */
+        size_t Write(std::string_view bytes);
+        
+        // The rest is UI thread only
+        // Parses queued output, up to the frame's time budget; called automatically each frame
+        void FlushWrites();
+        // Output written but not yet parsed
+        bool HasPendingOutput() const { return !m_backlog.empty() || !m_pending.IsEmpty(); }
+        // Whether Write would take at least one byte
+        bool CanWrite() const;
+        // Clears the screen and the scrollback and resets all modes
+        void Reset();
+        
+        TerminalGrid& GetGrid() { return m_grid; }
+        const TerminalGrid& GetGrid() const { return m_grid; }
+        size_t GetColumns() const { return m_grid.GetColumns(); }
+        size_t GetRows() const { return m_grid.GetRows(); }
+        
+        // Lines scrolled back into the history; 0 shows the live screen
+        void SetScrollOffset(size_t lines);
+        size_t GetScrollOffset() const { return m_scrollOffset; }
+        
+        void SetFont(const Font& font);
+        const Font& GetFont() const { return m_fonts[0]; }
+        
+        // Default foreground; the default background is the widget background color
+        void SetTextColor(const Color& color) { m_textColor = color; Invalidate(); }
+        const Color& GetTextColor() const { return m_textColor; }
+        
+        void SetCursorColor(const Color& color) { m_cursorColor = color; Invalidate(); }
+        const Color& GetCursorColor() const { return m_cursorColor; }
+        
+        // Entries 0-15 are the ANSI colors, 16-255 the xterm color cube and gray ramp
+        void SetPaletteColor(uint8_t index, const Color& color) { m_palette[index] = color; Invalidate(); }
+        const Color& GetPaletteColor(uint8_t index) const { return m_palette[index]; }
+        
+        // Widget overrides
+        bool OnMouseEvent(const MouseEvent& event) override;
+        bool OnKeyEvent(const KeyEvent& event) override;
+        Size MeasureDesiredSize(const Size& availableSize) override;
+        
+        // Events
+        // Bytes to send to the program: typed keys and replies to its status requests
+        std::function<void(const std::string& bytes)> OnInput;
+        std::function<void(size_t columns, size_t rows)> OnResized;
+        std::function<void(const std::string& title)> OnTitleChanged;
+        std::function<void()> OnBell;
+        
+    protected:
+        void OnRender(std::shared_ptr<Renderer> renderer) override;
+        
+    private:
+        // Cells [column, column + cellCount) of a line, drawn with one DrawText call
+        struct Run {
+            uint32_t textStart;
+            uint32_t textLength;
+            uint32_t column;
+            uint32_t cellCount;
+            uint32_t foreground;
+            uint32_t background;
+            uint8_t attributes;
+        };
+        
+        // Runs of one grid slot, valid until the slot's dirty bit is set
+        struct SlotRuns {
+            std::string text;
+            std::vector<Run> runs;
+        };
+        
+        TerminalGrid m_grid;
+        MpscQueue<std::string> m_pending;
+        // Written but not yet parsed, whether still queued or in the backlog
+        std::atomic<size_t> m_pendingBytes;
+        // Drained output left over when a frame's parsing budget ran out
+        std::deque<std::string> m_backlog;
+        size_t m_backlogOffset;
+        
+        std::vector<SlotRuns> m_slotRuns;
+        // Rectangles to fill this frame, each with the color key it is filled with
+        std::vector<std::pair<uint32_t, Rect>> m_fills;
+        std::vector<Rect> m_fillRects;
+        
+        // Regular, bold, italic and bold italic
+        std::array<Font, 4> m_fonts;
+        Size m_cellSize;
+        bool m_cellSizeValid;
+        
+        Color m_textColor;
+        Color m_cursorColor;
+        std::array<Color, 256> m_palette;
+        
+        size_t m_scrollOffset;
+        uint64_t m_scrolledLineCount;
+        
+        void SendInput(const std::string& bytes);
+        void UpdateGridSize(Renderer& renderer);
+        void FillCollectedRects(Renderer& renderer);
+        void BuildRuns(uint32_t slot);
+        Color ResolveColor(uint32_t key) const;
+        Rect GetTextRect() const;
+    };
+
+} // namespace miko
+
+#endif // MIKO_TERMINALVIEW_H
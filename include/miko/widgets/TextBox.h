@@ -5,9 +5,19 @@
 
 #include "Widget.h"
 #include "../core/Renderer.h"
+#include "../text/GapBuffer.h"
+#include "../text/LineIndex.h"
+#include "../text/GlyphAdvanceIndex.h"
+#include "../text/TextChange.h"
+#include "../text/UndoJournal.h"
+#include "../text/LineTokenCache.h"
+#include "../text/TextSearch.h"
 #include <chrono>
 #include <string>
+#include <string_view>
 #include <functional>
+#include <memory>
+#include <vector>
 
 namespace miko {
 
@@ -19,12 +29,13 @@ namespace miko {
         
         // Text properties
         void SetText(const std::string& text);
-        const std::string& GetText() const { return m_text; }
+        const std::string& GetText() const { return m_text.Str(); }
+        size_t GetTextLength() const { return m_text.GetLength(); }
         
         void SetPlaceholderText(const std::string& placeholder);
         const std::string& GetPlaceholderText() const { return m_placeholderText; }
         
-        void SetFont(const Font& font) { this->m_font = font; Invalidate(); InvalidateLayout(); }
+        void SetFont(const Font& font) { this->m_font = font; m_advances.Clear(); Invalidate(); InvalidateMeasure(); }
         const Font& GetFont() const { return m_font; }
         
         void SetTextColor(const Color& color) { m_textColor = color; Invalidate(); }
@@ -43,10 +54,14 @@ namespace miko {
         void SetReadOnly(bool readOnly) { this->m_isReadOnly = readOnly; }
         bool IsReadOnly() const { return m_isReadOnly; }
         
-        void SetMultiline(bool multiline) { this->m_multiline = multiline; InvalidateLayout(); }
+        void SetMultiline(bool multiline) { this->m_multiline = multiline; m_advances.Clear(); m_tokens.Reset(); InvalidateLayout(); }
         bool IsMultiline() const { return m_multiline; }
+        int GetLineCount() const;
         
-        void SetPasswordMode(bool password) { m_passwordMode = password; Invalidate(); }
+        void SetVerticalScrollOffset(float offset);
+        float GetVerticalScrollOffset() const { return m_verticalScrollOffset; }
+        
+        void SetPasswordMode(bool password) { m_passwordMode = password; m_advances.Clear(); Invalidate(); }
         bool IsPasswordMode() const { return m_passwordMode; }
         
         void SetPasswordChar(char passwordChar);
@@ -55,6 +70,24 @@ namespace miko {
         void SetMaxLength(int maxLength) { this->m_maxLength = maxLength; }
         int GetMaxLength() const { return m_maxLength; }
         
+        // Syntax highlighting; lines are tokenized as they come into view and again after edits
+        void SetTokenizer(std::shared_ptr<Tokenizer> tokenizer);
+        const std::shared_ptr<Tokenizer>& GetTokenizer() const { return m_tokenizer; }
+        // Re-tokenizes everything, e.g. after the tokenizer's rules or colors change
+        void RefreshHighlighting() { m_tokens.Reset(); Invalidate(); }
+        
+        // Find; searches run on a worker thread and results arrive over the following frames.
+        // Find selects the next occurrence after the caret, wrapping around; FindAll highlights every occurrence.
+        void Find(const std::string& text);
+        void FindAll(const std::string& text);
+        void ClearFind();
+        bool IsSearching() const { return m_findSearch.IsRunning() || m_findAllSearch.IsRunning(); }
+        // Start offsets of the FindAll matches found so far, in text order
+        const std::vector<size_t>& GetFindMatches() const { return m_findMatches; }
+        
+        void SetFindHighlightColor(const Color& color) { m_findHighlightColor = color; Invalidate(); }
+        const Color& GetFindHighlightColor() const { return m_findHighlightColor; }
+        
         // Selection and caret
         void SetSelection(int start, int end);
         void GetSelection(int& start, int& end) const;
@@ -70,6 +103,19 @@ namespace miko {
         void Delete(int start, int count);
         void Clear();
         
+        // Undo history; SetText starts a fresh one. Typing and deleting runs undo as one step.
+        bool Undo();
+        bool Redo();
+        bool CanUndo() const { return m_undo.CanUndo(); }
+        bool CanRedo() const { return m_undo.CanRedo(); }
+        void ClearUndoHistory() { m_undo.Clear(); }
+        // Bytes of history kept; the oldest steps are dropped past it
+        void SetUndoLimit(size_t bytes) { m_undo.SetByteLimit(bytes); }
+        size_t GetUndoLimit() const { return m_undo.GetByteLimit(); }
+        
+        // Delivers edits queued for OnTextChangesBatched; called automatically each frame
+        void FlushTextChanges();
+        
         std::string GetSelectedText() const;
         void Copy();
         void Cut();
@@ -84,19 +130,45 @@ namespace miko {
         
         // Events
         std::function<void(const std::string&)> OnTextChanged;
+        // Fired after every edit with only the replaced range
+        std::function<void(const TextChange&)> OnTextChange;
+        // When set, edits are merged and delivered once per frame, in order; a box
+        // that is hidden or not in a window delivers them as they happen instead
+        std::function<void(const std::vector<TextChange>&)> OnTextChangesBatched;
         std::function<void()> OnEnterPressed;
+        // Raised when a Find finishes, with whether it selected a match
+        std::function<void(bool)> OnFindCompleted;
+        // Raised when a FindAll finishes, with the number of matches
+        std::function<void(size_t)> OnFindAllCompleted;
         
     protected:
         void OnRender(std::shared_ptr<Renderer> renderer) override;
         
     private:
-        std::string m_text;
+        GapBuffer m_text;
+        LineIndex m_lines;
+        // Measured lazily from const accessors, hence mutable
+        mutable GlyphAdvanceIndex m_advances;
+        std::shared_ptr<Tokenizer> m_tokenizer;
+        LineTokenCache m_tokens;
+        BackgroundSearch m_findSearch;
+        BackgroundSearch m_findAllSearch;
+        std::string m_findText;
+        std::vector<size_t> m_findMatches;
+        std::weak_ptr<Renderer> m_renderer;
+        std::vector<TextChange> m_pendingChanges;
+        UndoJournal m_undo;
+        // Set while an undo or redo is applied, so it is not recorded again
+        bool m_applyingHistory;
+        // Set while a paste inserts its pieces, so the change is raised once for all of them
+        bool m_deferTextNotification;
         std::string m_placeholderText;
         Font m_font;
         Color m_textColor;
         Color m_placeholderColor;
         Color m_selectionColor;
         Color m_caretColor;
+        Color m_findHighlightColor;
         
         bool m_isReadOnly;
         bool m_multiline;
@@ -111,8 +183,9 @@ namespace miko {
         bool m_caretVisible;
         std::chrono::steady_clock::time_point m_lastCaretBlink;
         
-        // Scrolling (for multiline)
+        // Scrolling; vertical only applies to multiline
         float m_scrollOffset;
+        float m_verticalScrollOffset;
         
         void Initialize();
         void UpdateCaret();
@@ -121,18 +194,46 @@ namespace miko {
         Point GetCharacterPosition(int index) const;
         Rect GetCaretRect() const;
         Rect GetSelectionRect(int start, int end) const;
-        std::string GetDisplayText() const;
-        void NotifyTextChanged();
-        
+        std::string_view GetDisplayText(size_t start, size_t count) const;
+        std::string_view GetTextRange(size_t start, size_t count) const;
+        std::string_view MaskText(size_t count) const;
+        void GetLineRange(size_t line, size_t& start, size_t& length) const;
+        size_t GetLineOf(int position) const;
+        const std::vector<float>& GetLineOffsets(size_t line) const;
+        GlyphAdvanceIndex::MeasureFunction GetMeasureFunction() const;
+        float GetCharacterX(int position) const;
+        void UpdateLineCachesForEdit(int start, int removeLength, std::string_view text);
+        int GetNextCaretStop(int position) const;
+        int GetPreviousCaretStop(int position) const;
+        float GetLineHeight() const;
+        Rect GetTextRect() const;
+        void GetVisibleLines(const Rect& textRect, size_t& firstLine, size_t& lastLine) const;
+        void NotifyTextChanged(size_t offset, size_t removedLength, std::string_view insertedText);
+        bool IsRendered() const;
+        void PollFindResults();
+        void StopSearchesForEdit();
+        void UpdateFindMatchesForEdit(size_t start, size_t removeLength, size_t insertLength);
+        
+        // Every edit goes through ReplaceRange, which applies the length limit, records
+        // it for undo, keeps the caret in place relative to the edit and raises the change events
+        void ReplaceRange(int start, int removeLength, std::string_view text,
+                          UndoJournal::EditKind kind = UndoJournal::EditKind::Other);
+        bool ApplyHistoryChange(const TextChange& change);
+
         // Input handling
-        void InsertText(const std::string& text);
+        void InsertText(std::string_view text, UndoJournal::EditKind kind = UndoJournal::EditKind::Other);
         void DeleteSelection();
         void HandleCharacterInput(char c);
         void HandleKeyInput(KeyCode key, bool shift, bool ctrl);
         void HandleMouseSelection(const Point& position, bool extend);
         void MoveCaret(int delta, bool extendSelection);
+        void MoveCaretToLine(int lineDelta, bool extendSelection);
         int GetCaretPositionFromPoint(const Point& point);
+        void DrawLineText(std::shared_ptr<Renderer> renderer, size_t line, size_t start, size_t length,
+                          const Rect& lineRect, const Brush& textBrush);
         void DrawSelection(std::shared_ptr<Renderer> renderer, const Rect& textRect);
+        void DrawFindMatches(std::shared_ptr<Renderer> renderer, const Rect& textRect);
+        void FillTextRange(std::shared_ptr<Renderer> renderer, const Rect& textRect, int start, int end, const Brush& brush);
         void DrawCaret(std::shared_ptr<Renderer> renderer, const Rect& textRect);
     };
 
@@ -0,0 +1,108 @@
+#pragma once
+
+#ifndef MIKO_TILEVIEW_H
+#define MIKO_TILEVIEW_H
+
+#include "Widget.h"
+#include "../core/Renderer.h"
+#include "../layout/UniformGridLayout.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace miko {
+
+    /**
+     * @brief Scrolling grid of equally sized tiles, only the visible ones realized
+     *
+     * The view knows how many items there are but asks the item factory for
+     * a widget only when an item scrolls into view, and hands widgets that
+     * scroll out back to the factory for reuse. A gallery of a million
+     * tiles therefore holds about a screenful of widgets, and since a
+     * UniformGridLayout places items by index, scrolling and clicking cost
+     * the same however many items there are.
+     *
+     * Items are realized once per frame, before drawing. The wheel and the
+     * arrow, Page Up, Page Down, Home and End keys scroll.
+     */
+    class TileView : public Widget {
+    public:
+        // Returns the widget for an item; recycled is a widget that showed another item, or null
+        using ItemFactory = std::function<std::shared_ptr<Widget>(size_t index, std::shared_ptr<Widget> recycled)>;
+        
+        TileView();
+        virtual ~TileView() = default;
+        
+        void SetItemFactory(ItemFactory factory);
+        void SetItemCount(size_t count);
+        size_t GetItemCount() const { return m_itemCount; }
+        // Gives every realized item back to the factory on the next frame, e.g. after items were inserted
+        void RefreshItems();
+        
+        // Grid settings, as on UniformGridLayout
+        void SetItemSize(const Size& size) { m_grid.SetItemSize(size); m_arrangeValid = false; Invalidate(); }
+        const Size& GetItemSize() const { return m_grid.GetItemSize(); }
+        void SetColumnCount(int count) { m_grid.SetColumnCount(count); m_arrangeValid = false; Invalidate(); }
+        int GetColumnCount() const { return m_grid.GetColumnCount(); }
+        void SetItemSpacing(float spacing) { m_grid.SetSpacing(spacing); m_arrangeValid = false; Invalidate(); }
+        float GetItemSpacing() const { return m_grid.GetSpacing(); }
+        const UniformGridLayout& GetGrid() const { return m_grid; }
+        
+        // Scrolling, in DIPs from the top of the content
+        void ScrollTo(double offset);
+        void ScrollBy(double delta) { ScrollTo(m_scrollOffset + delta); }
+        // Scrolls as little as needed to show the whole item
+        void ScrollToItem(size_t index);
+        double GetScrollOffset() const { return m_scrollOffset; }
+        double GetMaxScrollOffset() const;
+        
+        // Item under a point, or UniformGridLayout::NO_INDEX
+        size_t GetItemAt(const Point& point) const;
+        Rect GetItemRect(size_t index) const;
+        // The widget showing an item, or null if it is not realized
+        std::shared_ptr<Widget> GetRealizedItem(size_t index) const;
+        size_t GetFirstRealizedItem() const { return m_firstRealized; }
+        size_t GetRealizedItemCount() const { return m_realized.size(); }
+        
+        // Realizes and places the visible items; called automatically each frame
+        void UpdateItems();
+        
+        // Widget overrides
+        bool OnMouseEvent(const MouseEvent& event) override;
+        bool OnKeyEvent(const KeyEvent& event) override;
+        Size MeasureDesiredSize(const Size& availableSize) override;
+        
+        // Events
+        std::function<void(size_t index)> OnItemClicked;
+        
+    protected:
+        void OnRender(std::shared_ptr<Renderer> renderer) override;
+        
+    private:
+        UniformGridLayout m_grid;
+        ItemFactory m_factory;
+        size_t m_itemCount;
+        double m_scrollOffset;
+        
+        // Widgets for items [m_firstRealized, m_firstRealized + m_realized.size())
+        std::vector<std::shared_ptr<Widget>> m_realized;
+        size_t m_firstRealized;
+        std::vector<std::shared_ptr<Widget>> m_recycled;
+        // Reused by UpdateItems
+        std::vector<std::shared_ptr<Widget>> m_nextRealized;
+        bool m_refreshPending;
+        
+        // Where the realized items were last placed
+        Rect m_arrangedArea;
+        double m_arrangedOffset;
+        bool m_arrangeValid;
+        
+        void RecycleItem(const std::shared_ptr<Widget>& item);
+        std::shared_ptr<Widget> RealizeItem(size_t index);
+        double GetRowHeight() const;
+        Rect GetItemArea() const;
+    };
+
+} // namespace miko
+
+#endif // MIKO_TILEVIEW_H
@@ -0,0 +1,130 @@
+#pragma once
+
+#ifndef MIKO_TREEVIEW_H
+#define MIKO_TREEVIEW_H
+
+#include "Widget.h"
+#include "../core/Renderer.h"
+#include "../utils/ImplicitTreap.h"
+#include "../utils/TreeModel.h"
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace miko {
+
+    /**
+     * @brief Scrollable view of a TreeModel with expandable nodes
+     *
+     * The rows on display form a flattened list of the expanded part of
+     * the tree, kept in an ImplicitTreap so a row is found by position
+     * and a node's row by walking up from the node, both in O(log n).
+     * Expanding a node builds the list of its newly shown descendants in
+     * O(count) and splices it in after the node in O(log n); collapsing
+     * cuts that range out in O(log n) and keeps it, so expanding the same
+     * node again costs O(log n) as well. The list is never rebuilt.
+     *
+     * As in FileView, only the rows in view are drawn and no per-row
+     * objects are kept, so a frame costs the same for any tree size.
+     */
+    class TreeView : public Widget {
+    public:
+        using NodeId = TreeModel::NodeId;
+        
+        // Row number meaning no row
+        static constexpr size_t NO_ROW = SIZE_MAX;
+        
+        TreeView();
+        virtual ~TreeView() = default;
+        
+        // Shows a new model with only its top-level nodes; selection and scrolling are reset
+        void SetModel(std::shared_ptr<const TreeModel> model);
+        const std::shared_ptr<const TreeModel>& GetModel() const { return m_model; }
+        
+        // A node may be expanded while hidden; its children show once its ancestors are expanded too
+        void Expand(NodeId node);
+        void Collapse(NodeId node);
+        void Toggle(NodeId node);
+        bool IsExpanded(NodeId node) const { return node < m_expanded.size() && m_expanded[node] != 0; }
+        // Expands the node's ancestors and scrolls its row into view
+        void EnsureVisible(NodeId node);
+        
+        // Rows shown, counting every node under an expanded ancestor chain
+        size_t GetRowCount() const { return m_rows.GetSize(m_root); }
+        NodeId GetRowNode(size_t row) const;
+        // Row of a node, or NO_ROW if it is hidden under a collapsed ancestor
+        size_t GetNodeRow(NodeId node) const;
+        
+        // Selection is a node, or TreeModel::NO_NODE
+        void SetSelectedNode(NodeId node);
+        NodeId GetSelectedNode() const { return m_selectedNode; }
+        
+        void ScrollToRow(size_t row);
+        size_t GetFirstVisibleRow() const { return m_firstRow; }
+        size_t GetVisibleRowCount() const;
+        
+        void SetFont(const Font& font) { m_font = font; Invalidate(); }
+        const Font& GetFont() const { return m_font; }
+        
+        void SetTextColor(const Color& color) { m_textColor = color; Invalidate(); }
+        const Color& GetTextColor() const { return m_textColor; }
+        
+        void SetSelectionColor(const Color& color) { m_selectionColor = color; Invalidate(); }
+        const Color& GetSelectionColor() const { return m_selectionColor; }
+        
+        // Horizontal step per tree level, also the width of the expander
+        void SetIndent(float indent) { m_indent = indent; Invalidate(); }
+        float GetIndent() const { return m_indent; }
+        
+        // Widget overrides
+        bool OnMouseEvent(const MouseEvent& event) override;
+        bool OnKeyEvent(const KeyEvent& event) override;
+        Size MeasureDesiredSize(const Size& availableSize) override;
+        
+        // Events
+        std::function<void(NodeId node)> OnSelectionChanged;
+        std::function<void(NodeId node)> OnExpanded;
+        std::function<void(NodeId node)> OnCollapsed;
+        // Enter was pressed on the selected node
+        std::function<void(NodeId node)> OnNodeActivated;
+        
+    protected:
+        void OnRender(std::shared_ptr<Renderer> renderer) override;
+        
+    private:
+        std::shared_ptr<const TreeModel> m_model;
+        std::vector<uint8_t> m_expanded;
+        // Rows are node numbers; each row's key is its node's depth, which marks where a subtree's rows end
+        ImplicitTreap m_rows;
+        uint32_t m_root;
+        // Rows cut out when a node was collapsed, put back when it is expanded again
+        std::unordered_map<NodeId, uint32_t> m_collapsedRows;
+        // Scratch for building the rows of a newly expanded node
+        std::vector<uint32_t> m_buildNodes;
+        std::vector<uint32_t> m_buildDepths;
+        std::vector<NodeId> m_buildStack;
+        
+        NodeId m_selectedNode;
+        size_t m_firstRow;
+        
+        Font m_font;
+        Color m_textColor;
+        Color m_selectionColor;
+        float m_indent;
+        
+        // Rows of node's shown descendants, in order
+        uint32_t BuildRows(NodeId node);
+        // Where the root of the row sequence holding root is kept: m_root or a collapsed node's saved rows
+        uint32_t& GetSequenceRoot(uint32_t root);
+        void KeepFirstRow(NodeId anchor, NodeId fallback);
+        void SelectRow(size_t row);
+        void ClampScroll();
+        
+        float GetRowHeight() const;
+        Rect GetTextRect() const;
+    };
+
+} // namespace miko
+
+#endif // MIKO_TREEVIEW_H
@@ -7,6 +7,7 @@
 #include "../utils/Color.h"
 #include "../utils/Event.h"
 #include "../core/Renderer.h"
+#include "../layout/LayoutTree.h"
 #include <memory>
 #include <vector>
 #include <string>
@@ -15,6 +16,7 @@
 namespace miko {
 
     class Layout;
+    class LayoutScheduler;
 
     enum class Visibility {
         Visible,
@@ -48,35 +50,35 @@ namespace miko {
         std::shared_ptr<Widget> GetParent() const { return parent.lock(); }
         const std::vector<std::shared_ptr<Widget>>& GetChildren() const { return children; }
         
-        // Layout and positioning
+        // Layout and positioning (geometry is stored in the shared LayoutTree)
         virtual void SetBounds(const Rect& bounds);
-        const Rect& GetBounds() const { return bounds; }
+        Rect GetBounds() const { return layoutTree->GetBounds(layoutNode); }
         
         void SetPosition(const Point& position);
-        Point GetPosition() const { return Point(bounds.x, bounds.y); }
+        Point GetPosition() const { return Point(layoutTree->Get(layoutNode, LayoutField::X), layoutTree->Get(layoutNode, LayoutField::Y)); }
         
         void SetSize(const Size& size);
-        Size GetSize() const { return Size(bounds.width, bounds.height); }
+        Size GetSize() const { return Size(layoutTree->Get(layoutNode, LayoutField::Width), layoutTree->Get(layoutNode, LayoutField::Height)); }
         
-    void SetMargin(const Spacing& margin) { this->margin = margin; InvalidateLayout(); }
-    const Spacing& GetMargin() const { return margin; }
+    void SetMargin(const Spacing& margin) { layoutTree->SetMargin(layoutNode, margin); InvalidateLayoutSlot(); }
+    Spacing GetMargin() const { return layoutTree->GetMargin(layoutNode); }
 
-    void SetPadding(const Spacing& padding) { this->padding = padding; InvalidateLayout(); }
-    const Spacing& GetPadding() const { return padding; }
+    void SetPadding(const Spacing& padding) { layoutTree->SetPadding(layoutNode, padding); InvalidateLayout(); }
+    Spacing GetPadding() const { return layoutTree->GetPadding(layoutNode); }
         
         // Alignment
-        void SetHorizontalAlignment(HorizontalAlignment alignment) { hAlignment = alignment; InvalidateLayout(); }
+        void SetHorizontalAlignment(HorizontalAlignment alignment) { hAlignment = alignment; InvalidateLayoutSlot(); }
         HorizontalAlignment GetHorizontalAlignment() const { return hAlignment; }
         
-        void SetVerticalAlignment(VerticalAlignment alignment) { vAlignment = alignment; InvalidateLayout(); }
+        void SetVerticalAlignment(VerticalAlignment alignment) { vAlignment = alignment; InvalidateLayoutSlot(); }
         VerticalAlignment GetVerticalAlignment() const { return vAlignment; }
         
         // Size constraints
-        void SetMinSize(const Size& size) { minSize = size; InvalidateLayout(); }
-        const Size& GetMinSize() const { return minSize; }
+        void SetMinSize(const Size& size) { layoutTree->SetMinSize(layoutNode, size); InvalidateLayoutSlot(); }
+        Size GetMinSize() const { return layoutTree->GetMinSize(layoutNode); }
         
-        void SetMaxSize(const Size& size) { maxSize = size; InvalidateLayout(); }
-        const Size& GetMaxSize() const { return maxSize; }
+        void SetMaxSize(const Size& size) { layoutTree->SetMaxSize(layoutNode, size); InvalidateLayoutSlot(); }
+        Size GetMaxSize() const { return layoutTree->GetMaxSize(layoutNode); }
         
         // Visibility and state
         void SetVisibility(Visibility visibility);
@@ -112,8 +114,30 @@ namespace miko {
         // Rendering
         virtual void Render(std::shared_ptr<Renderer> renderer);
         void Invalidate();
+        
+        /**
+         * @brief Marks this widget's layout as out of date
+         *
+         * The mark travels up through the parents whose own size depends on
+         * this one and stops at the first relayout boundary: the root, a
+         * widget marked with SetLayoutBoundary, a widget whose min and max
+         * size are equal, or a child of a parent that never measures its
+         * children. Above the boundary the ancestors only note that a
+         * descendant needs work, so UpdateLayout can find it.
+         */
         void InvalidateLayout();
         
+        // Lays out again the dirty subtrees under their boundaries; the rest of the tree is not visited
+        void UpdateLayout();
+        // Set on a window's root widget; dirty boundaries in the tree are then queued there for the next frame
+        void SetLayoutScheduler(std::shared_ptr<LayoutScheduler> scheduler) { layoutScheduler = std::move(scheduler); }
+        const std::shared_ptr<LayoutScheduler>& GetLayoutScheduler() const { return layoutScheduler; }
+        bool NeedsLayout() const { return layoutInvalid || descendantLayoutInvalid; }
+        
+        // Declares that this widget's size never depends on its content, so its changes stay inside it
+        void SetLayoutBoundary(bool boundary) { layoutBoundary = boundary; }
+        bool IsLayoutBoundary() const;
+        
         // Event handling
         virtual bool OnMouseEvent(const MouseEvent& event);
         virtual bool OnKeyEvent(const KeyEvent& event);
@@ -126,8 +150,14 @@ namespace miko {
         virtual bool HitTest(const Point& point) const;
         std::shared_ptr<Widget> FindWidgetAt(const Point& point);
         
+        // Flattened layout storage
+        const LayoutTree& GetLayoutTree() const { return *layoutTree; }
+        LayoutTree::NodeId GetLayoutNode() const { return layoutNode; }
+        
         // Measurement and layout// Layout helpers
         virtual Size MeasureDesiredSize(const Size& availableSize);
+        // MeasureDesiredSize, remembered until the layout is invalidated; layouts measure children with this
+        Size Measure(const Size& availableSize);
         virtual void ArrangeChildren(const Rect& finalRect);
         virtual void Arrange(const Rect& finalRect);
         
@@ -158,21 +188,22 @@ namespace miko {
         virtual void RenderChildren(std::shared_ptr<Renderer> renderer);
         
         // Layout helpers
-        virtual void UpdateLayout();
         virtual Size CalculateDesiredSize(const Size& availableSize);
+        // Whether this widget's desired size depends on its children's
+        virtual bool MeasuresChildren() const;
+        // For content changes: measures this widget again and invalidates the layout only if its desired size changed
+        void InvalidateMeasure();
+        bool HasFixedSize() const;
         
     private:
+        // Declared before children so the tree outlives them during destruction
+        std::shared_ptr<LayoutTree> layoutTree;
+        LayoutTree::NodeId layoutNode;
+        
         std::weak_ptr<Widget> parent;
         std::vector<std::shared_ptr<Widget>> children;
         std::shared_ptr<Layout> layout;
         
-        // Geometry
-        Rect bounds;
-    Spacing margin;
-    Spacing padding;
-        Size minSize;
-        Size maxSize;
-        
         // Alignment
         HorizontalAlignment hAlignment;
         VerticalAlignment vAlignment;
@@ -185,6 +216,16 @@ namespace miko {
         bool layoutInvalid;
         bool renderInvalid;
         
+        // Layout caching; a clean widget given the slot it had last time is not laid out again
+        bool descendantLayoutInvalid;
+        bool layoutBoundary;
+        bool measureValid;
+        bool arrangeValid;
+        Size measureAvailable;
+        Size measuredSize;
+        Rect arrangeRect;
+        std::shared_ptr<LayoutScheduler> layoutScheduler;
+        
         // Appearance
         Color backgroundColor;
         Color borderColor;
@@ -196,7 +237,12 @@ namespace miko {
         void* tag;
         
         void SetParent(std::shared_ptr<Widget> parent) { this->parent = parent; }
+        void DetachLayoutSubtree();
+        // InvalidateLayout, plus the parent for changes to where and how big this widget is placed
+        void InvalidateLayoutSlot();
+        static void RebindLayoutNodes(const std::shared_ptr<LayoutTree>& tree, LayoutTree::NodeId firstNode);
         friend class Layout;
+        friend class LayoutScheduler;
     };
 
 } // namespace miko
@@ -1,6 +1,7 @@
 #include "miko/core/Application.h"
 #include "miko/platform/Win32Window.h"
 #include "miko/miko.h"
+#include "miko/utils/FrameArena.h"
 #include <windows.h>
 #include <objbase.h>
 #include <chrono>
@@ -85,6 +86,9 @@ void Application::Run() {
             }
         }
         
+        // Release all transient scratch memory used during this frame
+        GetFrameArena().Reset();
+        
         // Small sleep to prevent 100% CPU usage
         Sleep(1);
     }
@@ -0,0 +1,222 @@
+#include "miko/core/ImageCache.h"
+#include "miko/utils/MappedFile.h"
+#include "miko/utils/ThreadPool.h"
+#include <algorithm>
+
+namespace miko {
+
+// Mips stop once the larger side is this small
+static const int MIN_MIP_SIZE = 16;
+
+CachedImage::CachedImage(const std::string& path)
+    : path(path)
+    , state(ImageState::Unloaded)
+    , byteSize(0)
+    , width(0)
+    , height(0)
+    , inLru(false)
+{
+}
+
+ImageCache::ImageCache(size_t budgetBytes)
+    : shared(std::make_shared<Shared>())
+    , budget(budgetBytes)
+    , bytesUsed(0)
+    , placeholderColor(Color::FromRGBA(230, 230, 230))
+{
+}
+
+ImageCache::~ImageCache() {
+    {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        shared->closed = true;
+        shared->queue.clear();
+        shared->finished.clear();
+    }
+    for (CachedImage* image : lru) {
+        ReleaseBitmaps(*image);
+    }
+}
+
+ImageHandle ImageCache::Get(const std::string& path) {
+    CollectFinished();
+
+    ImageHandle& image = images[path];
+    if (!image) {
+        image = std::make_shared<CachedImage>(path);
+    }
+    if (image->GetState() == ImageState::Unloaded) {
+        Request(image);
+    }
+    return image;
+}
+
+void ImageCache::Draw(const std::shared_ptr<Renderer>& renderer, const ImageHandle& image, const Rect& destination) {
+    if (!renderer || !image) return;
+
+    CollectFinished();
+
+    // Bitmaps belong to the renderer that made them
+    if (bitmapRenderer.lock() != renderer) {
+        for (CachedImage* ready : lru) {
+            ReleaseBitmaps(*ready);
+        }
+        bitmapRenderer = renderer;
+    }
+
+    const ImageState state = image->GetState();
+    if (state == ImageState::Unloaded || (state == ImageState::Queued && !image->inLru)) {
+        // Evicted since it was last drawn, or still waiting: in view now, so it goes to the front of the line
+        Request(image);
+    }
+    // An image that became ready since CollectFinished is drawn from the next frame on
+    if (!image->inLru) {
+        renderer->FillRectangle(destination, Brush(placeholderColor));
+        return;
+    }
+
+    lru.splice(lru.begin(), lru, image->lruPosition);
+
+    // Smallest mip at least as large as the destination in pixels
+    const float scale = renderer->GetDpiScale();
+    const float pixelWidth = destination.width * scale;
+    const float pixelHeight = destination.height * scale;
+    size_t level = image->mips.size() - 1;
+    while (level > 0 && (image->mips[level].width < pixelWidth || image->mips[level].height < pixelHeight)) {
+        --level;
+    }
+
+    BitmapHandle& bitmap = image->bitmaps[level];
+    if (!bitmap) {
+        const ImageSurface& mip = image->mips[level];
+        bitmap = renderer->CreateBitmap(mip.width, mip.height, mip.opaque);
+        if (bitmap) {
+            renderer->UpdateBitmap(bitmap.get(), PixelRect(0, 0, mip.width, mip.height), mip.pixels.data(), (size_t)mip.width * 4);
+        }
+    }
+    if (bitmap) {
+        renderer->DrawBitmap(bitmap.get(), destination, true);
+    } else {
+        renderer->FillRectangle(destination, Brush(placeholderColor));
+    }
+}
+
+void ImageCache::SetBudget(size_t bytes) {
+    budget = bytes;
+    EnforceBudget();
+}
+
+void ImageCache::Request(const ImageHandle& image) {
+    {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        auto queued = std::find(shared->queue.begin(), shared->queue.end(), image);
+        if (queued != shared->queue.end()) {
+            // Already waiting with a task of its own; only its place changes
+            std::rotate(queued, queued + 1, shared->queue.end());
+            return;
+        }
+        // A worker may have taken or even finished it since the caller looked
+        if (image->GetState() != ImageState::Unloaded) return;
+        image->state.store(ImageState::Queued, std::memory_order_relaxed);
+        shared->queue.push_back(image);
+        if (shared->queue.size() > MAX_QUEUED) {
+            // The oldest requests are likely scrolled out of view; drawing them again requests them again
+            const size_t dropped = shared->queue.size() - MAX_QUEUED;
+            for (size_t i = 0; i < dropped; ++i) {
+                shared->queue[i]->state.store(ImageState::Unloaded, std::memory_order_relaxed);
+            }
+            shared->queue.erase(shared->queue.begin(), shared->queue.begin() + dropped);
+        }
+    }
+    // One task per request; a task finding the queue empty does nothing
+    ThreadPool::GetShared().Submit([shared = shared]() {
+        DecodeNext(shared);
+    });
+}
+
+void ImageCache::CollectFinished() {
+    std::vector<ImageHandle> finished;
+    {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        if (shared->finished.empty()) return;
+        finished.swap(shared->finished);
+    }
+
+    for (const ImageHandle& image : finished) {
+        if (image->GetState() != ImageState::Ready) continue;
+        image->width = image->mips[0].width;
+        image->height = image->mips[0].height;
+        image->bitmaps.clear();
+        image->bitmaps.resize(image->mips.size());
+        lru.push_front(image.get());
+        image->lruPosition = lru.begin();
+        image->inLru = true;
+        bytesUsed += image->byteSize;
+    }
+    EnforceBudget();
+}
+
+void ImageCache::EnforceBudget() {
+    // The most recently drawn image is kept even if it alone is over the budget
+    while (bytesUsed > budget && lru.size() > 1) {
+        Evict(*lru.back());
+    }
+}
+
+void ImageCache::Evict(CachedImage& image) {
+    ReleaseBitmaps(image);
+    image.bitmaps.clear();
+    lru.erase(image.lruPosition);
+    image.inLru = false;
+    bytesUsed -= image.byteSize;
+    image.byteSize = 0;
+    std::vector<ImageSurface>().swap(image.mips);
+    image.state.store(ImageState::Unloaded, std::memory_order_relaxed);
+}
+
+void ImageCache::ReleaseBitmaps(CachedImage& image) {
+    // Handles free themselves, whether or not the renderer is still around
+    for (BitmapHandle& bitmap : image.bitmaps) {
+        bitmap.reset();
+    }
+}
+
+void ImageCache::DecodeNext(const std::shared_ptr<Shared>& shared) {
+    ImageHandle image;
+    {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        if (shared->closed || shared->queue.empty()) return;
+        // Newest first: that is what is in view now
+        image = std::move(shared->queue.back());
+        shared->queue.pop_back();
+    }
+
+    std::vector<ImageSurface> mips(1);
+    MappedFile file;
+    bool decoded = file.Open(image->path) &&
+                   DecodeImage(reinterpret_cast<const uint8_t*>(file.GetData()), file.GetSize(), mips[0]);
+    file.Close();
+
+    size_t byteSize = 0;
+    if (decoded) {
+        while (std::max(mips.back().width, mips.back().height) > MIN_MIP_SIZE) {
+            ImageSurface smaller;
+            DownscaleHalf(mips.back(), smaller);
+            mips.push_back(std::move(smaller));
+        }
+        for (const ImageSurface& mip : mips) {
+            byteSize += mip.GetByteSize();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(shared->mutex);
+    if (shared->closed) return;
+    if (decoded) {
+        image->mips = std::move(mips);
+        image->byteSize = byteSize;
+    }
+    image->state.store(decoded ? ImageState::Ready : ImageState::Failed, std::memory_order_release);
+    shared->finished.push_back(std::move(image));
+}
+
+} // namespace miko
@@ -1,4 +1,5 @@
 #include "miko/core/Renderer.h"
+#include "miko/text/Utf8.h"
 
 #ifdef _WIN32
 #include "miko/platform/D2DRenderer.h"
@@ -8,4 +9,38 @@ namespace miko {
 
 // Factory function is implemented in platform-specific files
 
+void Renderer::FillRectangles(const Rect* rects, size_t count, const Brush& brush) {
+    for (size_t i = 0; i < count; ++i) {
+        FillRectangle(rects[i], brush);
+    }
+}
+
+void Renderer::DrawPolyline(const Point* points, size_t count, const Pen& pen) {
+    for (size_t i = 1; i < count; ++i) {
+        DrawLine(points[i - 1], points[i], pen);
+    }
+}
+
+void Renderer::MeasureCharacterAdvances(std::string_view text, const Font& font, float* advances) {
+    size_t position = 0;
+    while (position < text.size()) {
+        const size_t length = GetGraphemeLength(text, position);
+        for (size_t i = 0; i + 1 < length; ++i) {
+            advances[position + i] = 0.0f;
+        }
+        advances[position + length - 1] = MeasureText(text.substr(position, length), font).width;
+        position += length;
+    }
+}
+
+BitmapHandle Renderer::CreateBitmap(int width, int height, bool opaque) {
+    return BitmapHandle();
+}
+
+void Renderer::UpdateBitmap(void* bitmap, const PixelRect& region, const uint32_t* pixels, size_t stride) {
+}
+
+void Renderer::DrawBitmap(void* bitmap, const Rect& destination, bool smooth) {
+}
+
 } // namespace miko
\ No newline at end of file
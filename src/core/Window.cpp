@@ -1,4 +1,5 @@
 #include "miko/core/Window.h"
+#include "miko/widgets/Widget.h"
 
 #ifdef _WIN32
 #include "miko/platform/Win32Window.h"
@@ -11,8 +12,29 @@ void Window::DispatchEvent(const Event& event) {
     // Default implementation - can be overridden by derived classes
 }
 
+void Window::SetRootWidget(std::shared_ptr<Widget> widget) {
+    if (rootWidget) {
+        rootWidget->SetLayoutScheduler(nullptr);
+    }
+    rootWidget = widget;
+    if (rootWidget) {
+        rootWidget->SetLayoutScheduler(layoutScheduler);
+    }
+    // Laid out whole on the next pass, as changes made before it joined were not queued
+    rootLayoutValid = false;
+}
+
 void Window::UpdateLayout() {
-    // Default implementation - can be overridden by derived classes
+    if (!rootWidget) return;
+    
+    // A resize gives the root a new slot; its clean subtrees keep theirs and are skipped
+    const Size size = GetSize();
+    if (!rootLayoutValid || size != rootLayoutSize) {
+        rootWidget->Arrange(Rect(0, 0, size.width, size.height));
+        rootLayoutSize = size;
+        rootLayoutValid = true;
+    }
+    layoutScheduler->Run();
 }
 
 void Window::RenderWidgets() {
@@ -0,0 +1,323 @@
+#include "miko/layout/FlexLayout.h"
+#include "miko/widgets/Widget.h"
+#include "miko/utils/FrameArena.h"
+#include <algorithm>
+#include <cmath>
+
+namespace miko {
+
+    // Rounds of freezing items at their min or max size before the sizes are clamped as they are
+    static const int MAX_FLEX_PASSES = 4;
+    static const size_t MIN_PRUNE_THRESHOLD = 64;
+
+    static bool TakesSpace(const std::shared_ptr<Widget>& child) {
+        return child && child->GetVisibility() != Visibility::Collapsed;
+    }
+
+    // Offset of the first item and extra space between items for a justification
+    static void Distribute(FlexJustify justify, float freeSpace, size_t count, float& start, float& between) {
+        start = 0.0f;
+        between = 0.0f;
+        if (count == 0) return;
+
+        // Overflowing content is not spread out, only aligned
+        if (freeSpace < 0.0f) {
+            if (justify == FlexJustify::SpaceBetween) justify = FlexJustify::Start;
+            if (justify == FlexJustify::SpaceAround || justify == FlexJustify::SpaceEvenly) justify = FlexJustify::Center;
+        }
+
+        switch (justify) {
+            case FlexJustify::Center:
+                start = freeSpace / 2;
+                break;
+            case FlexJustify::End:
+                start = freeSpace;
+                break;
+            case FlexJustify::SpaceBetween:
+                between = count > 1 ? freeSpace / (count - 1) : 0.0f;
+                break;
+            case FlexJustify::SpaceAround:
+                between = freeSpace / count;
+                start = between / 2;
+                break;
+            case FlexJustify::SpaceEvenly:
+                between = freeSpace / (count + 1);
+                start = between;
+                break;
+            case FlexJustify::Start:
+            default:
+                break;
+        }
+    }
+
+    struct FlexLayout::Line {
+        size_t begin;
+        size_t end;
+        float cross;
+    };
+
+    FlexLayout::FlexLayout(FlexDirection direction)
+        : direction(direction)
+        , wrap(false)
+        , justifyContent(FlexJustify::Start)
+        , alignItems(FlexAlign::Stretch)
+        , alignContent(FlexJustify::Start)
+        , lineSpacing(0.0f)
+        , pruneThreshold(MIN_PRUNE_THRESHOLD)
+        , measureValid(false)
+    {
+    }
+
+    void FlexLayout::SetItem(const std::shared_ptr<Widget>& widget, const FlexItem& item) {
+        if (!widget) return;
+
+        // Entries of destroyed widgets are dropped now and then rather than tracked
+        if (items.size() >= pruneThreshold) {
+            for (auto it = items.begin(); it != items.end();) {
+                it = it->second.widget.expired() ? items.erase(it) : std::next(it);
+            }
+            pruneThreshold = std::max(MIN_PRUNE_THRESHOLD, items.size() * 2);
+        }
+        items[widget.get()] = ItemEntry{ widget, item };
+    }
+
+    FlexItem FlexLayout::GetItem(const Widget* widget) const {
+        auto found = items.find(widget);
+        if (found == items.end() || found->second.widget.expired()) {
+            return FlexItem();
+        }
+        return found->second.item;
+    }
+
+    Size FlexLayout::MeasureDesiredSize(const std::vector<std::shared_ptr<Widget>>& children, const Size& availableSize) {
+        const Size available = GetAvailableSize(availableSize);
+        MeasureChildren(children, available);
+
+        // The lines ArrangeChildren would make at this size, every item at its hypothetical size
+        const float availableMain = MainOf(available);
+        float desiredMain = 0.0f;
+        float desiredCross = 0.0f;
+        float lineMain = 0.0f;
+        float lineCross = 0.0f;
+        size_t lineItems = 0;
+        for (const Entry& entry : measured) {
+            if (wrap && lineItems > 0 && lineMain + spacing + entry.main > availableMain) {
+                desiredMain = std::max(desiredMain, lineMain);
+                desiredCross += lineCross + lineSpacing;
+                lineMain = 0.0f;
+                lineCross = 0.0f;
+                lineItems = 0;
+            }
+            lineMain += (lineItems > 0 ? spacing : 0.0f) + entry.main;
+            lineCross = std::max(lineCross, entry.cross);
+            ++lineItems;
+        }
+        desiredMain = std::max(desiredMain, lineMain);
+        desiredCross += lineCross;
+
+        const Size content = direction == FlexDirection::Row ? Size(desiredMain, desiredCross) : Size(desiredCross, desiredMain);
+        return Size(
+            content.width + margin.Horizontal() + padding.Horizontal(),
+            content.height + margin.Vertical() + padding.Vertical());
+    }
+
+    void FlexLayout::ArrangeChildren(const std::vector<std::shared_ptr<Widget>>& children, const Rect& finalRect) {
+        const Rect content = GetContentRect(finalRect);
+        if (!CanReuseMeasure(children, content.GetSize())) {
+            MeasureChildren(children, content.GetSize());
+        }
+        // The children may change before the next pass, so a measurement is only used once
+        measureValid = false;
+        if (measured.empty()) return;
+
+        FrameArena& arena = GetFrameArena();
+        FrameArena::Scope scratchScope(arena);
+
+        const bool row = direction == FlexDirection::Row;
+        const float availableMain = MainOf(content.GetSize());
+        const float availableCross = CrossOf(content.GetSize());
+        const float gap = spacing;
+
+        // Copied out, as arranging a child may run this layout again if containers share it
+        ArenaVector<Entry> entries(measured.begin(), measured.end(), ArenaAllocator<Entry>(arena));
+
+        // Break the items into lines at their hypothetical sizes
+        ArenaVector<Line> lines{ ArenaAllocator<Line>(arena) };
+        float lineMain = 0.0f;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            const Entry& entry = entries[i];
+            if (lines.empty() || (wrap && lines.back().end > lines.back().begin && lineMain + gap + entry.main > availableMain)) {
+                lines.push_back(Line{ i, i, 0.0f });
+                lineMain = 0.0f;
+            }
+            lineMain += (lines.back().end > lines.back().begin ? gap : 0.0f) + entry.main;
+            lines.back().end = i + 1;
+        }
+
+        // Flexible sizes, then each line's cross size
+        float totalCross = 0.0f;
+        for (Line& line : lines) {
+            ResolveFlexibleSizes(entries.data() + line.begin, line.end - line.begin, availableMain);
+            for (size_t i = line.begin; i < line.end; ++i) {
+                line.cross = std::max(line.cross, entries[i].cross);
+            }
+            totalCross += line.cross;
+        }
+        // A single unwrapped line spans the container
+        if (!wrap) {
+            lines.front().cross = availableCross;
+            totalCross = availableCross;
+        }
+
+        float crossPosition = 0.0f;
+        float crossBetween = 0.0f;
+        totalCross += lineSpacing * (lines.size() - 1);
+        Distribute(alignContent, availableCross - totalCross, lines.size(), crossPosition, crossBetween);
+
+        for (const Line& line : lines) {
+            const size_t count = line.end - line.begin;
+            float usedMain = gap * (count - 1);
+            for (size_t i = line.begin; i < line.end; ++i) {
+                usedMain += entries[i].main;
+            }
+            float mainPosition = 0.0f;
+            float mainBetween = 0.0f;
+            Distribute(justifyContent, availableMain - usedMain, count, mainPosition, mainBetween);
+
+            for (size_t i = line.begin; i < line.end; ++i) {
+                const Entry& entry = entries[i];
+                const FlexAlign align = entry.item.alignSelf != FlexAlign::Auto ? entry.item.alignSelf
+                    : (alignItems != FlexAlign::Auto ? alignItems : FlexAlign::Stretch);
+
+                float cross = entry.cross;
+                float crossOffset = 0.0f;
+                switch (align) {
+                    case FlexAlign::Center:
+                        crossOffset = (line.cross - cross) / 2;
+                        break;
+                    case FlexAlign::End:
+                        crossOffset = line.cross - cross;
+                        break;
+                    case FlexAlign::Stretch:
+                        cross = std::clamp(line.cross, entry.minCross, entry.maxCross);
+                        break;
+                    default:
+                        break;
+                }
+
+                // The slot includes the child's margin, which Arrange takes off again
+                const float mainStart = (row ? content.x : content.y) + mainPosition;
+                const float crossStart = (row ? content.y : content.x) + crossPosition + crossOffset;
+                entry.widget->Arrange(row
+                    ? Rect(mainStart, crossStart, entry.main, cross)
+                    : Rect(crossStart, mainStart, cross, entry.main));
+                mainPosition += entry.main + gap + mainBetween;
+            }
+            crossPosition += line.cross + lineSpacing + crossBetween;
+        }
+    }
+
+    void FlexLayout::MeasureChildren(const std::vector<std::shared_ptr<Widget>>& children, const Size& available) {
+        const bool row = direction == FlexDirection::Row;
+        measured.clear();
+        for (const auto& child : children) {
+            if (!TakesSpace(child)) continue;
+
+            const Size desired = child->Measure(available);
+            const Spacing margin = child->GetMargin();
+            const float marginMain = row ? margin.Horizontal() : margin.Vertical();
+            const float marginCross = row ? margin.Vertical() : margin.Horizontal();
+            const Size minSize = child->GetMinSize();
+            const Size maxSize = child->GetMaxSize();
+
+            Entry entry;
+            entry.widget = child.get();
+            entry.item = GetItem(child.get());
+            entry.base = entry.item.basis >= 0.0f ? entry.item.basis + marginMain : MainOf(desired) + marginMain;
+            entry.minMain = MainOf(minSize) + marginMain;
+            entry.maxMain = std::max(MainOf(minSize), MainOf(maxSize)) + marginMain;
+            entry.main = std::clamp(entry.base, entry.minMain, entry.maxMain);
+            entry.minCross = CrossOf(minSize) + marginCross;
+            entry.maxCross = std::max(CrossOf(minSize), CrossOf(maxSize)) + marginCross;
+            entry.cross = std::clamp(CrossOf(desired) + marginCross, entry.minCross, entry.maxCross);
+            entry.frozen = false;
+            measured.push_back(entry);
+        }
+        measuredAvailable = available;
+        measureValid = true;
+    }
+
+    bool FlexLayout::CanReuseMeasure(const std::vector<std::shared_ptr<Widget>>& children, const Size& available) const {
+        if (!measureValid || measuredAvailable != available) return false;
+
+        size_t count = 0;
+        for (const auto& child : children) {
+            if (!TakesSpace(child)) continue;
+            if (count == measured.size() || measured[count].widget != child.get()) return false;
+            ++count;
+        }
+        return count == measured.size();
+    }
+
+    void FlexLayout::ResolveFlexibleSizes(Entry* entries, size_t count, float available) const {
+        // Hypothetical sizes, already in main, are final without a definite size to fill
+        if (count == 0 || !std::isfinite(available)) return;
+
+        const float gaps = spacing * (count - 1);
+        float used = gaps;
+        for (size_t i = 0; i < count; ++i) {
+            used += entries[i].main;
+        }
+        const bool growing = used < available;
+
+        // Items that cannot flex in this direction, or whose limits already
+        // moved them against it, keep their hypothetical size
+        for (size_t i = 0; i < count; ++i) {
+            Entry& entry = entries[i];
+            const float factor = growing ? entry.item.grow : entry.item.shrink;
+            entry.frozen = factor <= 0.0f || (growing ? entry.base > entry.main : entry.base < entry.main);
+        }
+
+        // Share the free space by weight; items pushed past a limit are frozen
+        // there and the rest shared again, which settles within a few rounds
+        for (int pass = 0; pass < MAX_FLEX_PASSES; ++pass) {
+            float freeSpace = available - gaps;
+            float weights = 0.0f;
+            for (size_t i = 0; i < count; ++i) {
+                const Entry& entry = entries[i];
+                if (entry.frozen) {
+                    freeSpace -= entry.main;
+                } else {
+                    freeSpace -= entry.base;
+                    weights += growing ? entry.item.grow : entry.item.shrink * entry.base;
+                }
+            }
+            if (weights <= 0.0f) break;
+
+            float violation = 0.0f;
+            for (size_t i = 0; i < count; ++i) {
+                Entry& entry = entries[i];
+                if (entry.frozen) continue;
+
+                const float weight = growing ? entry.item.grow : entry.item.shrink * entry.base;
+                const float target = entry.base + freeSpace * weight / weights;
+                entry.main = std::clamp(target, entry.minMain, entry.maxMain);
+                violation += entry.main - target;
+            }
+            if (violation == 0.0f) break;
+
+            // Positive means items were held at their minimum, negative at their maximum
+            for (size_t i = 0; i < count; ++i) {
+                Entry& entry = entries[i];
+                if (entry.frozen) continue;
+
+                const float weight = growing ? entry.item.grow : entry.item.shrink * entry.base;
+                const float target = entry.base + freeSpace * weight / weights;
+                if (violation > 0.0f ? entry.main > target : entry.main < target) {
+                    entry.frozen = true;
+                }
+            }
+        }
+    }
+
+} // namespace miko
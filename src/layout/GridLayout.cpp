@@ -1,5 +1,6 @@
 #include "miko/layout/GridLayout.h"
 #include "miko/widgets/Widget.h"
+#include "miko/utils/FrameArena.h"
 #include <algorithm>
 #include <numeric>
 
@@ -26,21 +27,24 @@ namespace miko {
             return Size(0, 0);
         }
 
+        FrameArena& arena = GetFrameArena();
+        FrameArena::Scope scratchScope(arena);
+
         // Get cell information for all children
-        auto cellInfos = GetCellInfos(children);
+        auto cellInfos = GetCellInfos(children, arena);
         
         // Calculate desired sizes for each cell
         for (auto& cellInfo : cellInfos) {
             if (cellInfo.widget) {
-                Size childDesired = cellInfo.widget->MeasureDesiredSize(availableSize);
+                Size childDesired = cellInfo.widget->Measure(availableSize);
                 const auto& margin = cellInfo.widget->GetMargin();
                 cellInfo.desiredSize = Size(childDesired.width + margin.Horizontal(), childDesired.height + margin.Vertical());
             }
         }
 
         // Calculate row heights and column widths
-        auto rowHeights = CalculateRowHeights(cellInfos, availableSize.height);
-        auto columnWidths = CalculateColumnWidths(cellInfos, availableSize.width);
+        auto rowHeights = CalculateRowHeights(cellInfos, availableSize.height, arena);
+        auto columnWidths = CalculateColumnWidths(cellInfos, availableSize.width, arena);
 
         // Sum up total size
         float totalWidth = std::accumulate(columnWidths.begin(), columnWidths.end(), 0.0f);
@@ -54,25 +58,28 @@ namespace miko {
             return;
         }
 
+        FrameArena& arena = GetFrameArena();
+        FrameArena::Scope scratchScope(arena);
+
         // Get cell information for all children
-        auto cellInfos = GetCellInfos(children);
+        auto cellInfos = GetCellInfos(children, arena);
         
         // Calculate desired sizes for each cell
         for (auto& cellInfo : cellInfos) {
             if (cellInfo.widget) {
-                Size childDesired = cellInfo.widget->MeasureDesiredSize(finalRect.GetSize());
+                Size childDesired = cellInfo.widget->Measure(finalRect.GetSize());
                 const auto& margin = cellInfo.widget->GetMargin();
                 cellInfo.desiredSize = Size(childDesired.width + margin.Horizontal(), childDesired.height + margin.Vertical());
             }
         }
 
         // Calculate row heights and column widths
-        auto rowHeights = CalculateRowHeights(cellInfos, finalRect.GetSize().height);
-        auto columnWidths = CalculateColumnWidths(cellInfos, finalRect.GetSize().width);
+        auto rowHeights = CalculateRowHeights(cellInfos, finalRect.GetSize().height, arena);
+        auto columnWidths = CalculateColumnWidths(cellInfos, finalRect.GetSize().width, arena);
 
         // Calculate row and column positions
-        std::vector<float> rowPositions(rowHeights.size() + 1, 0.0f);
-        std::vector<float> columnPositions(columnWidths.size() + 1, 0.0f);
+        ArenaVector<float> rowPositions(rowHeights.size() + 1, 0.0f, ArenaAllocator<float>(arena));
+        ArenaVector<float> columnPositions(columnWidths.size() + 1, 0.0f, ArenaAllocator<float>(arena));
         
         for (size_t i = 0; i < rowHeights.size(); ++i) {
             rowPositions[i + 1] = rowPositions[i] + rowHeights[i];
@@ -158,13 +165,14 @@ namespace miko {
         return GridPosition(0, 0, 1, 1);
     }
 
-    std::vector<GridLayout::CellInfo> GridLayout::GetCellInfos(const std::vector<std::shared_ptr<Widget>>& children) const {
-        std::vector<CellInfo> cellInfos;
+    ArenaVector<GridLayout::CellInfo> GridLayout::GetCellInfos(const std::vector<std::shared_ptr<Widget>>& children, FrameArena& arena) const {
+        ArenaVector<CellInfo> cellInfos{ ArenaAllocator<CellInfo>(arena) };
+        cellInfos.reserve(children.size());
         
         for (const auto& child : children) {
             if (child) {
                 CellInfo info;
-                info.widget = child;
+                info.widget = child.get();
                 info.position = GetGridPosition(child);
                 cellInfos.push_back(info);
             }
@@ -173,8 +181,8 @@ namespace miko {
         return cellInfos;
     }
 
-    std::vector<float> GridLayout::CalculateRowHeights(const std::vector<CellInfo>& cells, float availableHeight) const {
-        std::vector<float> heights(rowDefinitions.size(), 0.0f);
+    ArenaVector<float> GridLayout::CalculateRowHeights(const ArenaVector<CellInfo>& cells, float availableHeight, FrameArena& arena) const {
+        ArenaVector<float> heights(rowDefinitions.size(), 0.0f, ArenaAllocator<float>(arena));
         
         // Calculate auto and fixed sizes first
         for (size_t i = 0; i < rowDefinitions.size(); ++i) {
@@ -193,13 +201,13 @@ namespace miko {
         }
         
         // Distribute star sizes
-        DistributeStarSize(heights, rowDefinitions, availableHeight);
+        DistributeStarSize(heights, rowDefinitions, availableHeight, arena);
         
         return heights;
     }
 
-    std::vector<float> GridLayout::CalculateColumnWidths(const std::vector<CellInfo>& cells, float availableWidth) const {
-        std::vector<float> widths(columnDefinitions.size(), 0.0f);
+    ArenaVector<float> GridLayout::CalculateColumnWidths(const ArenaVector<CellInfo>& cells, float availableWidth, FrameArena& arena) const {
+        ArenaVector<float> widths(columnDefinitions.size(), 0.0f, ArenaAllocator<float>(arena));
         
         // Calculate auto and fixed sizes first
         for (size_t i = 0; i < columnDefinitions.size(); ++i) {
@@ -218,18 +226,18 @@ namespace miko {
         }
         
         // Distribute star sizes
-        DistributeStarSize(widths, columnDefinitions, availableWidth);
+        DistributeStarSize(widths, columnDefinitions, availableWidth, arena);
         
         return widths;
     }
 
-    void GridLayout::DistributeAutoSize(std::vector<float>& sizes, const std::vector<GridDefinition>& definitions, 
-                                       const std::vector<float>& desiredSizes) const {
+    void GridLayout::DistributeAutoSize(ArenaVector<float>& sizes, const std::vector<GridDefinition>& definitions, 
+                                       const ArenaVector<float>& desiredSizes) const {
         // Auto sizes are already calculated in CalculateRowHeights/CalculateColumnWidths
     }
 
-    void GridLayout::DistributeStarSize(std::vector<float>& sizes, const std::vector<GridDefinition>& definitions, 
-                                       float availableSize) const {
+    void GridLayout::DistributeStarSize(ArenaVector<float>& sizes, const std::vector<GridDefinition>& definitions, 
+                                       float availableSize, FrameArena& arena) const {
         // Calculate used size by non-star definitions
         float usedSize = 0.0f;
         for (size_t i = 0; i < definitions.size(); ++i) {
@@ -241,7 +249,7 @@ namespace miko {
         float remainingSize = std::max(0.0f, availableSize - usedSize);
         
         // Iterative distribution to handle minimum size constraints
-        std::vector<bool> isFixed(definitions.size(), false);
+        ArenaVector<uint8_t> isFixed(definitions.size(), 0, ArenaAllocator<uint8_t>(arena));
         
         while (remainingSize > 0.0f) {
             // Calculate total star weight for unfixed star definitions
@@ -270,7 +278,7 @@ namespace miko {
                         // Fix this definition at its minimum size
                         remainingSize -= (minSize - sizes[i]);
                         sizes[i] = minSize;
-                        isFixed[i] = true;
+                        isFixed[i] = 1;
                         anyFixed = true;
                     } else {
                         sizes[i] = proposedSize;
@@ -285,7 +293,7 @@ namespace miko {
         }
     }
 
-    Rect GridLayout::ApplyAlignment(std::shared_ptr<Widget> widget, const Rect& cellRect, const Size& desiredSize) const {
+    Rect GridLayout::ApplyAlignment(const Widget* widget, const Rect& cellRect, const Size& desiredSize) const {
         if (!widget) {
             return cellRect;
         }
@@ -0,0 +1,55 @@
+#include "miko/layout/LayoutScheduler.h"
+#include "miko/widgets/Widget.h"
+#include <algorithm>
+#include <functional>
+
+namespace miko {
+
+    // Rounds of laying out boundaries dirtied by the previous round before the rest waits a frame
+    static const int MAX_LAYOUT_ROUNDS = 4;
+
+    void LayoutScheduler::Schedule(const std::shared_ptr<Widget>& boundary) {
+        if (boundary) {
+            pending.push_back(boundary);
+        }
+    }
+
+    size_t LayoutScheduler::Run() {
+        size_t laidOut = 0;
+        for (int round = 0; round < MAX_LAYOUT_ROUNDS && !pending.empty(); ++round) {
+            running.clear();
+            for (const auto& entry : pending) {
+                if (auto boundary = entry.lock()) {
+                    running.push_back(std::move(boundary));
+                }
+            }
+            pending.clear();
+
+            // Trees keep their nodes in pre-order, so ordering by node puts every ancestor first
+            std::sort(running.begin(), running.end(), [](const std::shared_ptr<Widget>& a, const std::shared_ptr<Widget>& b) {
+                const LayoutTree* treeA = &a->GetLayoutTree();
+                const LayoutTree* treeB = &b->GetLayoutTree();
+                if (treeA != treeB) return std::less<const LayoutTree*>()(treeA, treeB);
+                return a->GetLayoutNode() < b->GetLayoutNode();
+            });
+
+            for (const auto& boundary : running) {
+                // Clean already when an enclosing boundary laid it out
+                if (!boundary->layoutInvalid) continue;
+                boundary->UpdateLayout();
+                ++laidOut;
+            }
+
+            // The marks leading down to these boundaries lead nowhere now
+            for (const auto& boundary : running) {
+                for (auto ancestor = boundary->parent.lock(); ancestor && ancestor->descendantLayoutInvalid; ancestor = ancestor->parent.lock()) {
+                    ancestor->descendantLayoutInvalid = false;
+                }
+            }
+        }
+        running.clear();
+        layoutCount += laidOut;
+        return laidOut;
+    }
+
+} // namespace miko
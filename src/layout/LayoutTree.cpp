@@ -0,0 +1,261 @@
+#include "miko/layout/LayoutTree.h"
+#include "miko/utils/FrameArena.h"
+#include <algorithm>
+
+namespace miko {
+
+    LayoutTree::NodeId LayoutTree::CreateNode(Widget* widget) {
+        const NodeId node = static_cast<NodeId>(widgets.size());
+        for (auto& column : fields) {
+            column.push_back(0.0f);
+        }
+        parents.push_back(InvalidNode);
+        nextSiblings.push_back(InvalidNode);
+        subtreeEnds.push_back(node + 1);
+        visible.push_back(1);
+        widgets.push_back(widget);
+        return node;
+    }
+
+    LayoutTree::NodeId LayoutTree::AppendSubtree(NodeId parentNode, LayoutTree& source) {
+        const NodeId count = static_cast<NodeId>(source.GetNodeCount());
+        if (count == 0 || parentNode >= GetNodeCount()) {
+            return InvalidNode;
+        }
+
+        // New nodes go right after the parent's current subtree
+        const NodeId position = subtreeEnds[parentNode];
+        const NodeId lastChild = FindLastChild(parentNode);
+
+        // Only nodes from the insertion point on move; of the nodes before it,
+        // just the ones whose subtree reaches the insertion point store an
+        // index at or past it, and those are the ancestors of its predecessor
+        const size_t existingCount = GetNodeCount();
+        for (size_t i = position; i < existingCount; ++i) {
+            if (parents[i] != InvalidNode && parents[i] >= position) parents[i] += count;
+            if (nextSiblings[i] != InvalidNode) nextSiblings[i] += count;
+            subtreeEnds[i] += count;
+        }
+        for (NodeId node = position - 1; node != InvalidNode; node = parents[node]) {
+            if (nextSiblings[node] != InvalidNode && nextSiblings[node] >= position) nextSiblings[node] += count;
+            if (subtreeEnds[node] > position) subtreeEnds[node] += count;
+        }
+
+        // Subtrees that ended exactly at the insertion point only grow if they contain the parent
+        for (NodeId ancestor = parentNode; ancestor != InvalidNode; ancestor = parents[ancestor]) {
+            if (subtreeEnds[ancestor] == position) {
+                subtreeEnds[ancestor] = position + count;
+            }
+        }
+
+        if (lastChild != InvalidNode) {
+            nextSiblings[lastChild] = position;
+        }
+
+        // Splice the source columns in, rebasing their indices
+        for (size_t f = 0; f < FieldCount; ++f) {
+            fields[f].insert(fields[f].begin() + position, source.fields[f].begin(), source.fields[f].end());
+        }
+        visible.insert(visible.begin() + position, source.visible.begin(), source.visible.end());
+        widgets.insert(widgets.begin() + position, source.widgets.begin(), source.widgets.end());
+
+        parents.insert(parents.begin() + position, count, InvalidNode);
+        nextSiblings.insert(nextSiblings.begin() + position, count, InvalidNode);
+        subtreeEnds.insert(subtreeEnds.begin() + position, count, 0);
+        for (NodeId i = 0; i < count; ++i) {
+            const NodeId node = position + i;
+            parents[node] = (i == 0) ? parentNode : source.parents[i] + position;
+            nextSiblings[node] = (i == 0 || source.nextSiblings[i] == InvalidNode) ? InvalidNode : source.nextSiblings[i] + position;
+            subtreeEnds[node] = source.subtreeEnds[i] + position;
+        }
+
+        source.Clear();
+        return position;
+    }
+
+    LayoutTree::NodeId LayoutTree::ExtractSubtree(NodeId node, LayoutTree& destination) {
+        if (node >= GetNodeCount()) {
+            return InvalidNode;
+        }
+
+        const NodeId end = subtreeEnds[node];
+        const NodeId count = end - node;
+        const NodeId previousSibling = FindPreviousSibling(node);
+
+        // Copy the subtree out with indices rebased to zero
+        destination.Clear();
+        for (size_t f = 0; f < FieldCount; ++f) {
+            destination.fields[f].assign(fields[f].begin() + node, fields[f].begin() + end);
+        }
+        destination.visible.assign(visible.begin() + node, visible.begin() + end);
+        destination.widgets.assign(widgets.begin() + node, widgets.begin() + end);
+        destination.parents.resize(count);
+        destination.nextSiblings.resize(count);
+        destination.subtreeEnds.resize(count);
+        for (NodeId i = 0; i < count; ++i) {
+            const NodeId source = node + i;
+            destination.parents[i] = (i == 0) ? InvalidNode : parents[source] - node;
+            destination.nextSiblings[i] = (i == 0 || nextSiblings[source] == InvalidNode) ? InvalidNode : nextSiblings[source] - node;
+            destination.subtreeEnds[i] = subtreeEnds[source] - node;
+        }
+
+        // Before the range, only its ancestors and previous sibling store indices past it
+        if (previousSibling != InvalidNode) {
+            nextSiblings[previousSibling] = nextSiblings[node] == InvalidNode ? InvalidNode : nextSiblings[node] - count;
+        }
+        for (NodeId ancestor = parents[node]; ancestor != InvalidNode; ancestor = parents[ancestor]) {
+            if (nextSiblings[ancestor] != InvalidNode) nextSiblings[ancestor] -= count;
+            subtreeEnds[ancestor] -= count;
+        }
+
+        // Remove the range and close the gap in the nodes that followed it
+        for (auto& column : fields) {
+            column.erase(column.begin() + node, column.begin() + end);
+        }
+        visible.erase(visible.begin() + node, visible.begin() + end);
+        widgets.erase(widgets.begin() + node, widgets.begin() + end);
+        parents.erase(parents.begin() + node, parents.begin() + end);
+        nextSiblings.erase(nextSiblings.begin() + node, nextSiblings.begin() + end);
+        subtreeEnds.erase(subtreeEnds.begin() + node, subtreeEnds.begin() + end);
+
+        const size_t remainingCount = GetNodeCount();
+        for (size_t i = node; i < remainingCount; ++i) {
+            if (parents[i] != InvalidNode && parents[i] >= end) parents[i] -= count;
+            if (nextSiblings[i] != InvalidNode) nextSiblings[i] -= count;
+            subtreeEnds[i] -= count;
+        }
+
+        return node;
+    }
+
+    Rect LayoutTree::GetBounds(NodeId node) const {
+        return Rect(Get(node, LayoutField::X), Get(node, LayoutField::Y),
+                    Get(node, LayoutField::Width), Get(node, LayoutField::Height));
+    }
+
+    void LayoutTree::SetBounds(NodeId node, const Rect& bounds) {
+        Set(node, LayoutField::X, bounds.x);
+        Set(node, LayoutField::Y, bounds.y);
+        Set(node, LayoutField::Width, bounds.width);
+        Set(node, LayoutField::Height, bounds.height);
+    }
+
+    Spacing LayoutTree::GetMargin(NodeId node) const {
+        return Spacing(Get(node, LayoutField::MarginLeft), Get(node, LayoutField::MarginTop),
+                       Get(node, LayoutField::MarginRight), Get(node, LayoutField::MarginBottom));
+    }
+
+    void LayoutTree::SetMargin(NodeId node, const Spacing& margin) {
+        Set(node, LayoutField::MarginLeft, margin.left);
+        Set(node, LayoutField::MarginTop, margin.top);
+        Set(node, LayoutField::MarginRight, margin.right);
+        Set(node, LayoutField::MarginBottom, margin.bottom);
+    }
+
+    Spacing LayoutTree::GetPadding(NodeId node) const {
+        return Spacing(Get(node, LayoutField::PaddingLeft), Get(node, LayoutField::PaddingTop),
+                       Get(node, LayoutField::PaddingRight), Get(node, LayoutField::PaddingBottom));
+    }
+
+    void LayoutTree::SetPadding(NodeId node, const Spacing& padding) {
+        Set(node, LayoutField::PaddingLeft, padding.left);
+        Set(node, LayoutField::PaddingTop, padding.top);
+        Set(node, LayoutField::PaddingRight, padding.right);
+        Set(node, LayoutField::PaddingBottom, padding.bottom);
+    }
+
+    Size LayoutTree::GetMinSize(NodeId node) const {
+        return Size(Get(node, LayoutField::MinWidth), Get(node, LayoutField::MinHeight));
+    }
+
+    void LayoutTree::SetMinSize(NodeId node, const Size& size) {
+        Set(node, LayoutField::MinWidth, size.width);
+        Set(node, LayoutField::MinHeight, size.height);
+    }
+
+    Size LayoutTree::GetMaxSize(NodeId node) const {
+        return Size(Get(node, LayoutField::MaxWidth), Get(node, LayoutField::MaxHeight));
+    }
+
+    void LayoutTree::SetMaxSize(NodeId node, const Size& size) {
+        Set(node, LayoutField::MaxWidth, size.width);
+        Set(node, LayoutField::MaxHeight, size.height);
+    }
+
+    LayoutTree::NodeId LayoutTree::HitTest(NodeId root, const Point& point) const {
+        if (root >= GetNodeCount()) {
+            return InvalidNode;
+        }
+
+        // Test the whole range with the batch kernel, then walk it once to apply visibility pruning
+        FrameArena& arena = GetFrameArena();
+        FrameArena::Scope scope(arena);
+        const NodeId end = subtreeEnds[root];
+        uint8_t* hits = arena.AllocateArray<uint8_t>(end - root);
+        BatchContains(GetRectView(root, end), point, hits);
+
+        NodeId result = InvalidNode;
+        NodeId node = root;
+        while (node < end) {
+            if (!visible[node]) {
+                node = subtreeEnds[node];
+                continue;
+            }
+            if (hits[node - root]) {
+                result = node;
+            }
+            ++node;
+        }
+        return result;
+    }
+
+    RectArrayView LayoutTree::GetRectView(NodeId begin, NodeId end) const {
+        RectArrayView view;
+        view.x = Column(LayoutField::X) + begin;
+        view.y = Column(LayoutField::Y) + begin;
+        view.width = Column(LayoutField::Width) + begin;
+        view.height = Column(LayoutField::Height) + begin;
+        view.count = end - begin;
+        return view;
+    }
+
+    void LayoutTree::Clear() {
+        for (auto& column : fields) {
+            column.clear();
+        }
+        parents.clear();
+        nextSiblings.clear();
+        subtreeEnds.clear();
+        visible.clear();
+        widgets.clear();
+    }
+
+    LayoutTree::NodeId LayoutTree::FindPreviousSibling(NodeId node) const {
+        const NodeId parent = parents[node];
+        if (parent == InvalidNode || node == parent + 1) {
+            return InvalidNode;
+        }
+
+        // The node just before is inside the previous sibling's subtree; climb
+        // to it rather than walking every earlier sibling
+        NodeId previous = node - 1;
+        while (parents[previous] != parent) {
+            previous = parents[previous];
+        }
+        return previous;
+    }
+
+    LayoutTree::NodeId LayoutTree::FindLastChild(NodeId node) const {
+        if (GetFirstChild(node) == InvalidNode) {
+            return InvalidNode;
+        }
+
+        // The last node of the subtree belongs to the last child's subtree
+        NodeId last = subtreeEnds[node] - 1;
+        while (parents[last] != node) {
+            last = parents[last];
+        }
+        return last;
+    }
+
+} // namespace miko
@@ -1,5 +1,6 @@
 #include "miko/layout/StackLayout.h"
 #include "miko/widgets/Widget.h"
+#include "miko/utils/FrameArena.h"
 #include <algorithm>
 #include <cassert>
 
@@ -86,7 +87,7 @@ namespace miko {
                 continue;
             }
             // Add margin to each child's desired size
-            const Size childDesiredSize = child->MeasureDesiredSize(availableSize);
+            const Size childDesiredSize = child->Measure(availableSize);
             const auto& margin = child->GetMargin();
             totalRequiredWidth += childDesiredSize.width + margin.Horizontal();
             maxRequiredHeight = std::max(maxRequiredHeight, childDesiredSize.height + margin.Vertical());
@@ -110,7 +111,7 @@ namespace miko {
                 continue;
             }
             // Add margin to each child's desired size
-            const Size childDesiredSize = child->MeasureDesiredSize(availableSize);
+            const Size childDesiredSize = child->Measure(availableSize);
             const auto& margin = child->GetMargin();
             maxRequiredWidth = std::max(maxRequiredWidth, childDesiredSize.width + margin.Horizontal());
             totalRequiredHeight += childDesiredSize.height + margin.Vertical();
@@ -128,13 +129,16 @@ namespace miko {
         const float containerWidth = containerSize.width;
         const float containerHeight = containerSize.height;
         
-        // Filter valid children and calculate layout metrics
-        std::vector<std::shared_ptr<Widget>> validChildren;
+        // Filter valid children into frame scratch storage; raw pointers are
+        // enough here since the children vector keeps them alive
+        FrameArena& arena = GetFrameArena();
+        FrameArena::Scope scratchScope(arena);
+        ArenaVector<Widget*> validChildren{ ArenaAllocator<Widget*>(arena) };
         validChildren.reserve(children.size());
         
         for (const auto& child : children) {
             if (IsValidChild(child)) {
-                validChildren.push_back(child);
+                validChildren.push_back(child.get());
             }
         }
         
@@ -150,7 +154,7 @@ namespace miko {
         const size_t measureCount = fillLastChild ? validChildCount - 1 : validChildCount;
         
         for (size_t i = 0; i < measureCount; ++i) {
-            const Size childDesiredSize = validChildren[i]->MeasureDesiredSize(Size(containerWidth, containerHeight));
+            const Size childDesiredSize = validChildren[i]->Measure(Size(containerWidth, containerHeight));
             totalUsedWidth += childDesiredSize.width;
         }
         
@@ -168,7 +172,7 @@ namespace miko {
         
         // Arrange each child
         for (size_t childIndex = 0; childIndex < validChildCount; ++childIndex) {
-            const auto& currentChild = validChildren[childIndex];
+            Widget* currentChild = validChildren[childIndex];
             
             float childActualWidth;
             float childActualHeight = containerHeight;
@@ -183,11 +187,11 @@ namespace miko {
                 if (currentChild->GetVerticalAlignment() == VerticalAlignment::Stretch) {
                     childActualHeight = std::max(childMinSize.height, std::min(childMaxSize.height, containerHeight));
                 } else {
-                    const Size childDesiredSize = currentChild->MeasureDesiredSize(Size(containerWidth, containerHeight));
+                    const Size childDesiredSize = currentChild->Measure(Size(containerWidth, containerHeight));
                     childActualHeight = childDesiredSize.height;
                 }
             } else {
-                const Size childDesiredSize = currentChild->MeasureDesiredSize(Size(containerWidth, containerHeight));
+                const Size childDesiredSize = currentChild->Measure(Size(containerWidth, containerHeight));
                 childActualWidth = childDesiredSize.width;
                 if (currentChild->GetVerticalAlignment() == VerticalAlignment::Stretch) {
                     const Size childMinSize = currentChild->GetMinSize();
@@ -213,13 +217,16 @@ namespace miko {
         const float containerWidth = containerSize.width;
         const float containerHeight = containerSize.height;
         
-        // Filter valid children and calculate layout metrics
-        std::vector<std::shared_ptr<Widget>> validChildren;
+        // Filter valid children into frame scratch storage; raw pointers are
+        // enough here since the children vector keeps them alive
+        FrameArena& arena = GetFrameArena();
+        FrameArena::Scope scratchScope(arena);
+        ArenaVector<Widget*> validChildren{ ArenaAllocator<Widget*>(arena) };
         validChildren.reserve(children.size());
         
         for (const auto& child : children) {
             if (IsValidChild(child)) {
-                validChildren.push_back(child);
+                validChildren.push_back(child.get());
             }
         }
         
@@ -235,7 +242,7 @@ namespace miko {
         const size_t measureCount = fillLastChild ? validChildCount - 1 : validChildCount;
         
         for (size_t i = 0; i < measureCount; ++i) {
-            const Size childDesiredSize = validChildren[i]->MeasureDesiredSize(Size(containerWidth, containerHeight));
+            const Size childDesiredSize = validChildren[i]->Measure(Size(containerWidth, containerHeight));
             totalUsedHeight += childDesiredSize.height;
         }
         
@@ -253,7 +260,7 @@ namespace miko {
         
         // Arrange each child
         for (size_t childIndex = 0; childIndex < validChildCount; ++childIndex) {
-            const auto& currentChild = validChildren[childIndex];
+            Widget* currentChild = validChildren[childIndex];
             
             float childActualHeight;
             float childActualWidth = containerWidth;
@@ -268,11 +275,11 @@ namespace miko {
                 if (currentChild->GetHorizontalAlignment() == HorizontalAlignment::Stretch) {
                     childActualWidth = std::max(childMinSize.width, std::min(childMaxSize.width, containerWidth));
                 } else {
-                    const Size childDesiredSize = currentChild->MeasureDesiredSize(Size(containerWidth, containerHeight));
+                    const Size childDesiredSize = currentChild->Measure(Size(containerWidth, containerHeight));
                     childActualWidth = childDesiredSize.width;
                 }
             } else {
-                const Size childDesiredSize = currentChild->MeasureDesiredSize(Size(containerWidth, containerHeight));
+                const Size childDesiredSize = currentChild->Measure(Size(containerWidth, containerHeight));
                 childActualHeight = childDesiredSize.height;
                 if (currentChild->GetHorizontalAlignment() == HorizontalAlignment::Stretch) {
                     const Size childMinSize = currentChild->GetMinSize();
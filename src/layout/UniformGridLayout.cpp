@@ -0,0 +1,139 @@
+#include "miko/layout/UniformGridLayout.h"
+#include "miko/widgets/Widget.h"
+#include <algorithm>
+#include <cmath>
+
+namespace miko {
+
+    UniformGridLayout::UniformGridLayout()
+        : itemSize(100.0f, 100.0f)
+        , columnCount(0)
+    {
+    }
+
+    UniformGridLayout::UniformGridLayout(const Size& itemSize)
+        : itemSize(itemSize)
+        , columnCount(0)
+    {
+    }
+
+    Size UniformGridLayout::MeasureDesiredSize(const std::vector<std::shared_ptr<Widget>>& children, const Size& availableSize) {
+        return GetExtent(children.size(), availableSize.width);
+    }
+
+    void UniformGridLayout::ArrangeChildren(const std::vector<std::shared_ptr<Widget>>& children, const Rect& finalRect) {
+        const Metrics metrics = ComputeMetrics(finalRect);
+        for (size_t i = 0; i < children.size(); ++i) {
+            if (!children[i]) continue;
+
+            const size_t row = i / metrics.columns;
+            const size_t column = i % metrics.columns;
+            children[i]->Arrange(Rect(
+                (float)(metrics.left + column * metrics.strideX),
+                (float)(metrics.top + row * metrics.strideY),
+                (float)metrics.cellWidth,
+                (float)metrics.cellHeight));
+        }
+    }
+
+    int UniformGridLayout::GetColumnsForWidth(float width) const {
+        return (int)ComputeMetrics(Rect(0.0f, 0.0f, width, 0.0f)).columns;
+    }
+
+    Size UniformGridLayout::GetCellSize(float width) const {
+        const Metrics metrics = ComputeMetrics(Rect(0.0f, 0.0f, width, 0.0f));
+        return Size((float)metrics.cellWidth, (float)metrics.cellHeight);
+    }
+
+    Size UniformGridLayout::GetExtent(size_t count, float width) const {
+        const Metrics metrics = ComputeMetrics(Rect(0.0f, 0.0f, width, 0.0f));
+        const size_t columns = std::min(metrics.columns, count);
+        const size_t rows = (count + metrics.columns - 1) / metrics.columns;
+        // No spacing after the last column and row
+        const double gap = metrics.strideX - metrics.cellWidth;
+        const double contentWidth = columns > 0 ? columns * metrics.strideX - gap : 0.0;
+        const double contentHeight = rows > 0 ? rows * metrics.strideY - gap : 0.0;
+        return Size(
+            (float)contentWidth + margin.Horizontal() + padding.Horizontal(),
+            (float)contentHeight + margin.Vertical() + padding.Vertical());
+    }
+
+    Rect UniformGridLayout::GetItemRect(size_t index, const Rect& layoutRect, double scrollOffset) const {
+        const Metrics metrics = ComputeMetrics(layoutRect);
+        const size_t row = index / metrics.columns;
+        const size_t column = index % metrics.columns;
+        return Rect(
+            (float)(metrics.left + column * metrics.strideX),
+            (float)(metrics.top + row * metrics.strideY - scrollOffset),
+            (float)metrics.cellWidth,
+            (float)metrics.cellHeight);
+    }
+
+    size_t UniformGridLayout::GetIndexAt(const Point& point, const Rect& layoutRect, size_t count, double scrollOffset) const {
+        const Metrics metrics = ComputeMetrics(layoutRect);
+        const double x = point.x - metrics.left;
+        const double y = point.y + scrollOffset - metrics.top;
+        if (!(x >= 0.0 && y >= 0.0) || metrics.strideX <= 0.0 || metrics.strideY <= 0.0) {
+            return NO_INDEX;
+        }
+
+        const double column = std::floor(x / metrics.strideX);
+        const double row = std::floor(y / metrics.strideY);
+        if (column >= (double)metrics.columns || row >= (double)count) return NO_INDEX;
+        // In the spacing after a cell
+        if (x - column * metrics.strideX >= metrics.cellWidth || y - row * metrics.strideY >= metrics.cellHeight) {
+            return NO_INDEX;
+        }
+
+        const size_t index = (size_t)row * metrics.columns + (size_t)column;
+        return index < count ? index : NO_INDEX;
+    }
+
+    void UniformGridLayout::GetVisibleRange(const Rect& layoutRect, size_t count, double scrollOffset, size_t& first, size_t& last) const {
+        first = 0;
+        last = 0;
+        const Metrics metrics = ComputeMetrics(layoutRect);
+        if (count == 0 || metrics.strideY <= 0.0 || layoutRect.height <= 0.0f) return;
+
+        // The window in content coordinates; a row shows if any of its cell height falls inside
+        const size_t rows = (count + metrics.columns - 1) / metrics.columns;
+        const double windowTop = scrollOffset + layoutRect.y - metrics.top;
+        const double windowBottom = windowTop + layoutRect.height;
+        const double firstRow = std::floor((windowTop - metrics.cellHeight) / metrics.strideY) + 1.0;
+        const double endRow = std::ceil(windowBottom / metrics.strideY);
+        if (!(endRow > 0.0) || !(firstRow < (double)rows) || firstRow >= endRow) return;
+
+        first = (size_t)std::max(0.0, firstRow) * metrics.columns;
+        last = std::min(count, (size_t)std::min(endRow, (double)rows) * metrics.columns);
+    }
+
+    UniformGridLayout::Metrics UniformGridLayout::ComputeMetrics(const Rect& layoutRect) const {
+        const Rect content = GetContentRect(layoutRect);
+        const double gap = std::max(0.0f, spacing);
+
+        Metrics metrics;
+        metrics.left = content.x;
+        metrics.top = content.y;
+        if (columnCount > 0) {
+            metrics.columns = (size_t)columnCount;
+            if (itemSize.width > 0.0f) {
+                metrics.cellWidth = itemSize.width;
+            } else if (std::isfinite(content.width)) {
+                metrics.cellWidth = std::max(0.0, (content.width - gap * (columnCount - 1)) / columnCount);
+            } else {
+                metrics.cellWidth = 0.0;
+            }
+        } else {
+            // As many whole cells as fit, but always one
+            metrics.cellWidth = std::max(0.0f, itemSize.width);
+            const double fit = std::floor((content.width + gap) / (metrics.cellWidth + gap));
+            const double maxColumns = (double)std::numeric_limits<int>::max();
+            metrics.columns = fit >= 1.0 ? (size_t)std::min(fit, maxColumns) : 1;
+        }
+        metrics.cellHeight = itemSize.height > 0.0f ? itemSize.height : metrics.cellWidth;
+        metrics.strideX = metrics.cellWidth + gap;
+        metrics.strideY = metrics.cellHeight + gap;
+        return metrics;
+    }
+
+} // namespace miko
@@ -1,7 +1,10 @@
 #include "miko/platform/D2DRenderer.h"
+#include "miko/utils/FrameArena.h"
+#include "miko/text/Utf8.h"
 #include <d2d1.h>
 #include <dwrite.h>
 #include <wincodec.h>
+#include <algorithm>
 
 #pragma comment(lib, "d2d1.lib")
 #pragma comment(lib, "dwrite.lib")
@@ -149,6 +152,43 @@ void D2DRenderer::FillRectangle(const Rect& rect, const Brush& brush) {
     renderTarget->FillRectangle(RectToD2D(rect), d2dBrush.Get());
 }
 
+void D2DRenderer::FillRectangles(const Rect* rects, size_t count, const Brush& brush) {
+    if (!renderTarget || count == 0) return;
+    
+    // One brush lookup for the whole batch
+    ComPtr<ID2D1SolidColorBrush> d2dBrush = GetOrCreateBrush(brush.color);
+    if (!d2dBrush) return;
+    
+    for (size_t i = 0; i < count; ++i) {
+        renderTarget->FillRectangle(RectToD2D(rects[i]), d2dBrush.Get());
+    }
+}
+
+void D2DRenderer::DrawPolyline(const Point* points, size_t count, const Pen& pen) {
+    if (!renderTarget || !d2dFactory || count < 2) return;
+    
+    ComPtr<ID2D1SolidColorBrush> brush = GetOrCreateBrush(pen.color);
+    if (!brush) return;
+    
+    // One path geometry for the whole line: a single draw call, with joins instead of overlapping caps
+    ComPtr<ID2D1PathGeometry> geometry;
+    if (FAILED(d2dFactory->CreatePathGeometry(geometry.GetAddressOf()))) return;
+    ComPtr<ID2D1GeometrySink> sink;
+    if (FAILED(geometry->Open(sink.GetAddressOf()))) return;
+    
+    FrameArena::Scope scratchScope(GetFrameArena());
+    D2D1_POINT_2F* d2dPoints = GetFrameArena().AllocateArray<D2D1_POINT_2F>(count);
+    for (size_t i = 0; i < count; ++i) {
+        d2dPoints[i] = PointToD2D(points[i]);
+    }
+    sink->BeginFigure(d2dPoints[0], D2D1_FIGURE_BEGIN_HOLLOW);
+    sink->AddLines(d2dPoints + 1, (UINT32)(count - 1));
+    sink->EndFigure(D2D1_FIGURE_END_OPEN);
+    if (FAILED(sink->Close())) return;
+    
+    renderTarget->DrawGeometry(geometry.Get(), brush.Get(), pen.width);
+}
+
 void D2DRenderer::DrawRoundedRectangle(const Rect& rect, float radiusX, float radiusY, const Pen& pen) {
     if (!renderTarget) return;
     
@@ -189,13 +229,14 @@ void D2DRenderer::FillEllipse(const Point& center, float radiusX, float radiusY,
     renderTarget->FillEllipse(ellipse, d2dBrush.Get());
 }
 
-void D2DRenderer::DrawText(const std::string& text, const Rect& rect, const Font& font, const Brush& brush, TextAlignment alignment) {
-    if (!renderTarget || !writeFactory) return;
+void D2DRenderer::DrawText(std::string_view text, const Rect& rect, const Font& font, const Brush& brush, TextAlignment alignment) {
+    if (!renderTarget || !writeFactory || text.empty()) return;
     
-    // Convert text to wide string
-    int textLen = MultiByteToWideChar(CP_UTF8, 0, text.c_str(), -1, nullptr, 0);
-    std::wstring wideText(textLen, 0);
-    MultiByteToWideChar(CP_UTF8, 0, text.c_str(), -1, &wideText[0], textLen);
+    // Convert text to a wide string in frame scratch memory
+    FrameArena::Scope scratchScope(GetFrameArena());
+    UINT32 wideLength = 0;
+    const wchar_t* wideText = StringToArenaWString(text, wideLength);
+    if (!wideText) return;
     
     // Get or create text format
     ComPtr<IDWriteTextFormat> textFormat = GetOrCreateTextFormat(font);
@@ -220,8 +261,8 @@ void D2DRenderer::DrawText(const std::string& text, const Rect& rect, const Font
     ComPtr<ID2D1SolidColorBrush> d2dBrush = GetOrCreateBrush(brush.color);
     if (d2dBrush) {
         renderTarget->DrawTextW(
-            wideText.c_str(),
-            (UINT32)wideText.length() - 1, // Exclude null terminator
+            wideText,
+            wideLength,
             textFormat.Get(),
             RectToD2D(rect),
             d2dBrush.Get()
@@ -229,13 +270,14 @@ void D2DRenderer::DrawText(const std::string& text, const Rect& rect, const Font
     }
 }
 
-Size D2DRenderer::MeasureText(const std::string& text, const Font& font, float maxWidth) {
+Size D2DRenderer::MeasureText(std::string_view text, const Font& font, float maxWidth) {
     if (!writeFactory) return Size(0, 0);
     
-    // Convert text to wide string
-    int textLen = MultiByteToWideChar(CP_UTF8, 0, text.c_str(), -1, nullptr, 0);
-    std::wstring wideText(textLen, 0);
-    MultiByteToWideChar(CP_UTF8, 0, text.c_str(), -1, &wideText[0], textLen);
+    // Convert text to a wide string in frame scratch memory
+    FrameArena::Scope scratchScope(GetFrameArena());
+    UINT32 wideLength = 0;
+    const wchar_t* wideText = StringToArenaWString(text, wideLength);
+    if (!wideText) wideText = L"";
     
     // Get or create text format
     ComPtr<IDWriteTextFormat> textFormat = GetOrCreateTextFormat(font);
@@ -244,8 +286,8 @@ Size D2DRenderer::MeasureText(const std::string& text, const Font& font, float m
     // Create text layout
     IDWriteTextLayout* textLayout = nullptr;
     HRESULT hr = writeFactory->CreateTextLayout(
-        wideText.c_str(),
-        (UINT32)wideText.length() - 1,
+        wideText,
+        wideLength,
         textFormat.Get(),
         maxWidth > 0 ? maxWidth : 10000.0f,
         10000.0f,
@@ -264,6 +306,77 @@ Size D2DRenderer::MeasureText(const std::string& text, const Font& font, float m
     return Size(metrics.width, metrics.height);
 }
 
+void D2DRenderer::MeasureCharacterAdvances(std::string_view text, const Font& font, float* advances) {
+    std::fill(advances, advances + text.size(), 0.0f);
+    if (!writeFactory || text.empty()) return;
+    
+    FrameArena& arena = GetFrameArena();
+    FrameArena::Scope scratchScope(arena);
+    UINT32 wideLength = 0;
+    const wchar_t* wideText = StringToArenaWString(text, wideLength);
+    if (!wideText) return;
+    
+    ComPtr<IDWriteTextFormat> textFormat = GetOrCreateTextFormat(font);
+    if (!textFormat) return;
+    
+    // One layout for the whole run, so kerning and shaping match what DrawText produces
+    ComPtr<IDWriteTextLayout> textLayout;
+    HRESULT hr = writeFactory->CreateTextLayout(wideText, wideLength, textFormat.Get(), 100000.0f, 10000.0f, &textLayout);
+    if (FAILED(hr) || !textLayout) return;
+    
+    UINT32 clusterCount = 0;
+    textLayout->GetClusterMetrics(nullptr, 0, &clusterCount);
+    if (clusterCount == 0) return;
+    DWRITE_CLUSTER_METRICS* clusters = arena.AllocateArray<DWRITE_CLUSTER_METRICS>(clusterCount);
+    hr = textLayout->GetClusterMetrics(clusters, clusterCount, &clusterCount);
+    if (FAILED(hr)) return;
+    
+    // Clusters are counted in UTF-16 code units; walk the UTF-8 text in step
+    // and put each cluster's width on the last byte it covers
+    size_t position = 0;
+    for (UINT32 i = 0; i < clusterCount && position < text.size(); ++i) {
+        UINT32 units = 0;
+        while (units < clusters[i].length && position < text.size()) {
+            const uint32_t codePoint = DecodeUtf8(text, position);
+            units += codePoint >= 0x10000 ? 2 : 1;
+        }
+        advances[position - 1] = clusters[i].width;
+    }
+}
+
+BitmapHandle D2DRenderer::CreateBitmap(int width, int height, bool opaque) {
+    if (!renderTarget || width <= 0 || height <= 0) return BitmapHandle();
+    
+    const D2D1_BITMAP_PROPERTIES properties = D2D1::BitmapProperties(
+        D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, opaque ? D2D1_ALPHA_MODE_IGNORE : D2D1_ALPHA_MODE_PREMULTIPLIED));
+    ID2D1Bitmap* bitmap = nullptr;
+    if (FAILED(renderTarget->CreateBitmap(D2D1::SizeU((UINT32)width, (UINT32)height), properties, &bitmap))) {
+        return BitmapHandle();
+    }
+    // The handle holds this reference; releasing it needs no render target
+    return BitmapHandle(bitmap, BitmapDeleter{ [](void* released) { static_cast<ID2D1Bitmap*>(released)->Release(); } });
+}
+
+void D2DRenderer::UpdateBitmap(void* bitmap, const PixelRect& region, const uint32_t* pixels, size_t stride) {
+    if (!bitmap || !pixels || region.IsEmpty()) return;
+    
+    // Only the region is sent to the GPU
+    const D2D1_RECT_U destination = D2D1::RectU((UINT32)region.x, (UINT32)region.y, (UINT32)region.Right(), (UINT32)region.Bottom());
+    const uint8_t* source = reinterpret_cast<const uint8_t*>(pixels) + (size_t)region.y * stride + (size_t)region.x * 4;
+    static_cast<ID2D1Bitmap*>(bitmap)->CopyFromMemory(&destination, source, (UINT32)stride);
+}
+
+void D2DRenderer::DrawBitmap(void* bitmap, const Rect& destination, bool smooth) {
+    if (!renderTarget || !bitmap) return;
+    
+    renderTarget->DrawBitmap(
+        static_cast<ID2D1Bitmap*>(bitmap),
+        RectToD2D(destination),
+        1.0f,
+        smooth ? D2D1_BITMAP_INTERPOLATION_MODE_LINEAR : D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR
+    );
+}
+
 void D2DRenderer::PushClipRect(const Rect& rect) {
     if (renderTarget) {
         clipStack.push(RectToD2D(rect));
@@ -279,44 +392,43 @@ void D2DRenderer::PopClipRect() {
 }
 
 void D2DRenderer::PushTransform() {
-    if (renderTarget) {
-        D2D1::Matrix3x2F currentTransform;
-        renderTarget->GetTransform(&currentTransform);
-        transformStack.push(currentTransform);
-    }
+    transformStack.push_back(currentTransform);
 }
 
 void D2DRenderer::PopTransform() {
-    if (renderTarget && !transformStack.empty()) {
-        renderTarget->SetTransform(transformStack.top());
-        transformStack.pop();
+    if (!transformStack.empty()) {
+        currentTransform = transformStack.back();
+        transformStack.pop_back();
+        ApplyTransform();
     }
 }
 
 void D2DRenderer::Translate(float x, float y) {
-    if (renderTarget) {
-        D2D1::Matrix3x2F currentTransform;
-        renderTarget->GetTransform(&currentTransform);
-        D2D1::Matrix3x2F translation = D2D1::Matrix3x2F::Translation(x, y);
-        renderTarget->SetTransform(currentTransform * translation);
-    }
+    currentTransform *= Matrix3x2::Translation(x, y);
+    ApplyTransform();
 }
 
 void D2DRenderer::Scale(float x, float y) {
-    if (renderTarget) {
-        D2D1::Matrix3x2F currentTransform;
-        renderTarget->GetTransform(&currentTransform);
-        D2D1::Matrix3x2F scale = D2D1::Matrix3x2F::Scale(x, y);
-        renderTarget->SetTransform(currentTransform * scale);
-    }
+    currentTransform *= Matrix3x2::Scale(x, y);
+    ApplyTransform();
 }
 
 void D2DRenderer::Rotate(float angle) {
+    currentTransform *= Matrix3x2::Rotation(angle);
+    ApplyTransform();
+}
+
+Matrix3x2 D2DRenderer::GetTransform() const {
+    return currentTransform;
+}
+
+void D2DRenderer::ApplyTransform() {
+    // The CPU copy is authoritative; the render target only ever receives it
     if (renderTarget) {
-        D2D1::Matrix3x2F currentTransform;
-        renderTarget->GetTransform(&currentTransform);
-        D2D1::Matrix3x2F rotation = D2D1::Matrix3x2F::Rotation(angle);
-        renderTarget->SetTransform(currentTransform * rotation);
+        renderTarget->SetTransform(D2D1::Matrix3x2F(
+            currentTransform.m11, currentTransform.m12,
+            currentTransform.m21, currentTransform.m22,
+            currentTransform.dx, currentTransform.dy));
     }
 }
 
@@ -402,12 +514,8 @@ ComPtr<ID2D1SolidColorBrush> D2DRenderer::GetOrCreateBrush(const Color& color) {
 ComPtr<IDWriteTextFormat> D2DRenderer::GetOrCreateTextFormat(const Font& font) {
     if (!writeFactory) return nullptr;
     
-    // Create a string key for the font
-    std::string fontKey = font.family + "_" + std::to_string(font.size) + "_" + 
-                         std::to_string(static_cast<int>(font.weight)) + "_" + 
-                         std::to_string(static_cast<int>(font.style));
-    
-    auto it = fontCache.find(fontKey);
+    // Looked up by the font itself; no key is built per lookup
+    auto it = fontCache.find(font);
     if (it != fontCache.end()) {
         return it->second;
     }
@@ -449,13 +557,34 @@ ComPtr<IDWriteTextFormat> D2DRenderer::GetOrCreateTextFormat(const Font& font) {
     );
     
     if (SUCCEEDED(hr)) {
-        fontCache[fontKey] = textFormat;
+        fontCache[font] = textFormat;
         return textFormat;
     }
     
     return nullptr;
 }
 
+const wchar_t* D2DRenderer::StringToArenaWString(std::string_view str, UINT32& length) {
+    length = 0;
+    if (str.empty()) return nullptr;
+    
+    int wideLength = MultiByteToWideChar(CP_UTF8, 0, str.data(), (int)str.size(), nullptr, 0);
+    if (wideLength <= 0) return nullptr;
+    
+    wchar_t* wideText = GetFrameArena().AllocateArray<wchar_t>(wideLength);
+    MultiByteToWideChar(CP_UTF8, 0, str.data(), (int)str.size(), wideText, wideLength);
+    length = (UINT32)wideLength;
+    return wideText;
+}
+
+size_t D2DRenderer::FontToHash(const Font& font) {
+    size_t hash = std::hash<std::string_view>{}(font.family);
+    hash ^= std::hash<float>{}(font.size) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<int>{}(static_cast<int>(font.weight)) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<int>{}(static_cast<int>(font.style)) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
 // Factory function implementation
 std::shared_ptr<Renderer> CreatePlatformRenderer() {
     return std::make_shared<D2DRenderer>();
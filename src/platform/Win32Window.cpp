@@ -28,6 +28,13 @@ namespace miko {
 static const wchar_t* WINDOW_CLASS_NAME = L"MikoWindow";
 static bool s_windowClassRegistered = false;
 
+// Key messages do not carry modifier state, so read it from the keyboard state
+static void ReadModifierKeys(KeyEvent& event) {
+    event.ctrlPressed = (GetKeyState(VK_CONTROL) & 0x8000) != 0;
+    event.shiftPressed = (GetKeyState(VK_SHIFT) & 0x8000) != 0;
+    event.altPressed = (GetKeyState(VK_MENU) & 0x8000) != 0;
+}
+
 Win32Window::Win32Window()
 : hwnd(nullptr)
 , renderer(nullptr)
@@ -272,6 +279,9 @@ std::shared_ptr<Renderer> Win32Window::GetRenderer() const {
 
 void Win32Window::Present() {
     if (renderer && rootWidget) {
+        // Everything invalidated since the last frame is laid out in one pass
+        UpdateLayout();
+        
         renderer->BeginDraw();
         
         // Clear background
@@ -285,12 +295,10 @@ void Win32Window::Present() {
 }
 
 void Win32Window::SetRootWidget(std::shared_ptr<Widget> widget) {
-    rootWidget = widget;
+    Window::SetRootWidget(widget);
     if (widget && hwnd) {
-        // Set widget size to match window client area
-        Size windowSize = GetSize();
-        widget->SetSize(windowSize);
-        widget->Arrange(Rect(0, 0, windowSize.width, windowSize.height));
+        // Laid out straight away so the widgets have their bounds before the first paint
+        UpdateLayout();
     }
 }
 
@@ -381,10 +389,8 @@ LRESULT Win32Window::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
                 renderer->Resize(width, height);
             }
             
-            if (rootWidget) {
-                rootWidget->SetSize(Size((float)width, (float)height));
-                rootWidget->Arrange(Rect(0, 0, (float)width, (float)height));
-            }
+            // The root is arranged at the new size before the next paint rather than per message
+            Invalidate();
             
             if (OnResize) {
                 WindowEvent event;
@@ -403,6 +409,7 @@ LRESULT Win32Window::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
             PAINTSTRUCT ps;
             BeginPaint(hwnd, &ps);
             if (renderer) {
+                UpdateLayout();
                 renderer->BeginDraw();
                 if (rootWidget) {
                     rootWidget->Render(renderer);
@@ -515,6 +522,32 @@ LRESULT Win32Window::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
             return 0;
         }
         
+        case WM_MOUSEWHEEL: {
+            // Wheel messages carry screen coordinates
+            POINT screenPoint = { GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam) };
+            ScreenToClient(hwnd, &screenPoint);
+            Point position((float)screenPoint.x, (float)screenPoint.y);
+            float wheelDelta = (float)GET_WHEEL_DELTA_WPARAM(wParam) / WHEEL_DELTA;
+
+            if (OnMouseEvent) {
+                MouseEvent mouseEvent;
+                mouseEvent.type = EventType::MouseScrolled;
+                mouseEvent.position = position;
+                mouseEvent.wheelDelta = wheelDelta;
+                OnMouseEvent(mouseEvent);
+            }
+
+            if (rootWidget) {
+                MouseEvent event;
+                event.type = EventType::MouseScrolled;
+                event.position = position;
+                event.wheelDelta = wheelDelta;
+                rootWidget->OnMouseEvent(event);
+            }
+
+            return 0;
+        }
+
         case WM_KEYDOWN:
         case WM_SYSKEYDOWN: {
             KeyCode key = static_cast<KeyCode>(wParam);
@@ -523,6 +556,7 @@ LRESULT Win32Window::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
                 KeyEvent keyEvent;
                 keyEvent.type = EventType::KeyPressed;
                 keyEvent.keyCode = key;
+                ReadModifierKeys(keyEvent);
                 OnKeyEvent(keyEvent);
             }
             
@@ -530,6 +564,7 @@ LRESULT Win32Window::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
                 KeyEvent event;
                 event.type = EventType::KeyPressed;
                 event.keyCode = key;
+                ReadModifierKeys(event);
                 rootWidget->OnKeyEvent(event);
             }
             
@@ -544,6 +579,7 @@ LRESULT Win32Window::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
                 KeyEvent keyEvent;
                 keyEvent.type = EventType::KeyReleased;
                 keyEvent.keyCode = key;
+                ReadModifierKeys(keyEvent);
                 OnKeyEvent(keyEvent);
             }
             
@@ -551,6 +587,7 @@ LRESULT Win32Window::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
                 KeyEvent event;
                 event.type = EventType::KeyReleased;
                 event.keyCode = key;
+                ReadModifierKeys(event);
                 rootWidget->OnKeyEvent(event);
             }
             
@@ -564,6 +601,7 @@ LRESULT Win32Window::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
                 KeyEvent event;
                 event.type = EventType::KeyTyped;
                 event.character = character;
+                ReadModifierKeys(event);
                 rootWidget->OnKeyEvent(event);
             }
             
@@ -0,0 +1,101 @@
+#include "miko/text/ChunkedLineIndex.h"
+#include "miko/utils/ThreadPool.h"
+#include <algorithm>
+#include <cstring>
+
+namespace miko {
+
+// Small enough that scanning one chunk for a line start is a few microseconds
+static const size_t LINE_INDEX_CHUNK_SIZE = 64 * 1024;
+// Pages are evicted in batches of this many chunks to keep system calls rare
+static const size_t LINE_INDEX_EVICT_CHUNKS = 16;
+
+void ChunkedLineIndex::Start(std::shared_ptr<const MappedFile> file) {
+    Stop();
+    if (!file) return;
+
+    state = std::make_shared<State>();
+    state->chunkCount = (file->GetSize() + LINE_INDEX_CHUNK_SIZE - 1) / LINE_INDEX_CHUNK_SIZE;
+    state->newlinesBefore.assign(state->chunkCount + 1, 0);
+    state->file = std::move(file);
+
+    ThreadPool::GetShared().Submit([state = state]() {
+        Run(state);
+    });
+}
+
+void ChunkedLineIndex::Stop() {
+    if (!state) return;
+
+    // The worker holds its own reference, so it can finish its chunk after this returns
+    state->cancelled = true;
+    state.reset();
+}
+
+bool ChunkedLineIndex::IsComplete() const {
+    return state && state->indexedChunks.load(std::memory_order_acquire) == state->chunkCount;
+}
+
+size_t ChunkedLineIndex::GetIndexedLength() const {
+    if (!state) return 0;
+    const size_t indexed = state->indexedChunks.load(std::memory_order_acquire);
+    return std::min(indexed * LINE_INDEX_CHUNK_SIZE, state->file->GetSize());
+}
+
+size_t ChunkedLineIndex::GetLineCount() const {
+    if (!state) return 0;
+    const size_t indexed = state->indexedChunks.load(std::memory_order_acquire);
+    return state->newlinesBefore[indexed] + 1;
+}
+
+size_t ChunkedLineIndex::GetLineStart(size_t line) const {
+    if (!state || line == 0) return 0;
+
+    // Line n starts after the n-th line break; find the chunk holding that break
+    const size_t indexed = state->indexedChunks.load(std::memory_order_acquire);
+    const auto begin = state->newlinesBefore.begin();
+    const auto chunkEnd = std::lower_bound(begin + 1, begin + indexed + 1, line);
+    if (chunkEnd == begin + indexed + 1) {
+        return state->file->GetSize();
+    }
+    const size_t chunk = (size_t)(chunkEnd - begin) - 1;
+
+    const char* data = state->file->GetData();
+    const size_t chunkStart = chunk * LINE_INDEX_CHUNK_SIZE;
+    const size_t chunkStop = std::min(chunkStart + LINE_INDEX_CHUNK_SIZE, state->file->GetSize());
+    size_t remaining = line - state->newlinesBefore[chunk];
+    size_t position = chunkStart;
+    while (position < chunkStop) {
+        const void* hit = std::memchr(data + position, '\n', chunkStop - position);
+        if (!hit) break;
+        position = (size_t)(static_cast<const char*>(hit) - data) + 1;
+        if (--remaining == 0) {
+            return position;
+        }
+    }
+    return chunkStop;
+}
+
+void ChunkedLineIndex::Run(const std::shared_ptr<State>& state) {
+    const MappedFile& file = *state->file;
+    const char* data = file.GetData();
+    const size_t size = file.GetSize();
+
+    size_t evictedUpTo = 0;
+    for (size_t chunk = 0; chunk < state->chunkCount; ++chunk) {
+        if (state->cancelled) return;
+
+        const size_t chunkStart = chunk * LINE_INDEX_CHUNK_SIZE;
+        const size_t chunkStop = std::min(chunkStart + LINE_INDEX_CHUNK_SIZE, size);
+        const size_t newlines = (size_t)std::count(data + chunkStart, data + chunkStop, '\n');
+        state->newlinesBefore[chunk + 1] = state->newlinesBefore[chunk] + newlines;
+        state->indexedChunks.store(chunk + 1, std::memory_order_release);
+
+        if ((chunk + 1) % LINE_INDEX_EVICT_CHUNKS == 0 || chunk + 1 == state->chunkCount) {
+            file.Evict(evictedUpTo, chunkStop - evictedUpTo);
+            evictedUpTo = chunkStop;
+        }
+    }
+}
+
+} // namespace miko
@@ -0,0 +1,134 @@
+#include "miko/text/GapBuffer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace miko {
+
+GapBuffer::GapBuffer(std::string_view text) {
+    Assign(text);
+}
+
+const std::string& GapBuffer::Str() const {
+    if (flattenedVersion != version) {
+        flattened.clear();
+        flattened.reserve(GetLength());
+        flattened.append(GetFirstSegment());
+        flattened.append(GetSecondSegment());
+        flattenedVersion = version;
+    }
+    return flattened;
+}
+
+std::string GapBuffer::Substr(size_t position, size_t count) const {
+    position = std::min(position, GetLength());
+    count = std::min(count, GetLength() - position);
+
+    std::string result(count, '\0');
+    CopyTo(position, count, result.data());
+    return result;
+}
+
+void GapBuffer::CopyTo(size_t position, size_t count, char* destination) const {
+    // Part before the gap
+    if (position < gapStart) {
+        const size_t firstCount = std::min(count, gapStart - position);
+        std::memcpy(destination, buffer.data() + position, firstCount);
+        destination += firstCount;
+        position += firstCount;
+        count -= firstCount;
+    }
+    // Part after the gap
+    if (count > 0) {
+        std::memcpy(destination, buffer.data() + position + GetGapLength(), count);
+    }
+}
+
+void GapBuffer::Insert(size_t position, std::string_view text) {
+    if (text.empty()) return;
+
+    position = std::min(position, GetLength());
+    MoveGap(position);
+    if (GetGapLength() < text.size()) {
+        // One growth step for the whole insert, however large it is
+        GrowGap(text.size());
+    }
+
+    std::memcpy(buffer.data() + gapStart, text.data(), text.size());
+    gapStart += text.size();
+    MarkChanged();
+}
+
+void GapBuffer::Erase(size_t position, size_t count) {
+    if (position >= GetLength() || count == 0) return;
+
+    count = std::min(count, GetLength() - position);
+    MoveGap(position);
+    // Deleting forward from the gap just widens it
+    gapEnd += count;
+    MarkChanged();
+}
+
+void GapBuffer::Replace(size_t position, size_t count, std::string_view text) {
+    Erase(position, count);
+    Insert(position, text);
+}
+
+void GapBuffer::Assign(std::string_view text) {
+    buffer.assign(text.size() + MinimumGap, '\0');
+    std::copy(text.begin(), text.end(), buffer.begin());
+    gapStart = text.size();
+    gapEnd = buffer.size();
+    MarkChanged();
+}
+
+void GapBuffer::Clear() {
+    // Keep the allocation; the whole buffer becomes gap
+    gapStart = 0;
+    gapEnd = buffer.size();
+    MarkChanged();
+}
+
+void GapBuffer::Reserve(size_t totalLength) {
+    if (totalLength > GetLength()) {
+        GrowGap(totalLength - GetLength());
+    }
+}
+
+void GapBuffer::MoveGap(size_t position) {
+    if (position == gapStart) return;
+
+    const size_t gapLength = GetGapLength();
+    if (position < gapStart) {
+        // Shift [position, gapStart) to the end of the gap
+        const size_t count = gapStart - position;
+        std::memmove(buffer.data() + gapEnd - count, buffer.data() + position, count);
+    } else {
+        // Shift [gapEnd, gapEnd + count) to the start of the gap
+        const size_t count = position - gapStart;
+        std::memmove(buffer.data() + gapStart, buffer.data() + gapEnd, count);
+    }
+    gapStart = position;
+    gapEnd = position + gapLength;
+}
+
+void GapBuffer::GrowGap(size_t minimumGap) {
+    if (GetGapLength() >= minimumGap) return;
+
+    // Grow geometrically so repeated inserts stay amortized O(1)
+    const size_t length = GetLength();
+    const size_t newCapacity = std::max(length + minimumGap + MinimumGap, buffer.size() * 2);
+    const size_t afterGap = buffer.size() - gapEnd;
+
+    std::vector<char> newBuffer(newCapacity);
+    std::copy(buffer.begin(), buffer.begin() + gapStart, newBuffer.begin());
+    std::copy(buffer.begin() + gapEnd, buffer.end(), newBuffer.end() - afterGap);
+
+    buffer.swap(newBuffer);
+    gapEnd = newCapacity - afterGap;
+}
+
+void GapBuffer::MarkChanged() {
+    ++version;
+}
+
+} // namespace miko
@@ -0,0 +1,104 @@
+#include "miko/text/GlyphAdvanceIndex.h"
+#include <algorithm>
+
+namespace miko {
+
+const std::vector<float>& GlyphAdvanceIndex::GetOffsets(size_t line, std::string_view lineText,
+                                                        const MeasureFunction& measure) {
+    auto it = lines.find(line);
+    if (it != lines.end() && it->second.size() == lineText.size() + 1) {
+        return it->second;
+    }
+
+    std::vector<float>& offsets = lines[line];
+    offsets.assign(lineText.size() + 1, 0.0f);
+    if (!lineText.empty()) {
+        // Measure into offsets[1..n] and turn the advances into running sums in place
+        measure(lineText, offsets.data() + 1);
+        for (size_t i = 1; i < offsets.size(); ++i) {
+            offsets[i] += offsets[i - 1];
+        }
+    }
+    return offsets;
+}
+
+const std::vector<float>* GlyphAdvanceIndex::FindOffsets(size_t line) const {
+    auto it = lines.find(line);
+    return it != lines.end() ? &it->second : nullptr;
+}
+
+void GlyphAdvanceIndex::SpliceLine(size_t line, size_t column, size_t removedLength, std::string_view inserted,
+                                   const MeasureFunction& measure) {
+    auto it = lines.find(line);
+    if (it == lines.end()) return;
+
+    std::vector<float>& offsets = it->second;
+    const size_t length = offsets.size() - 1;
+    if (column > length || column + removedLength > length) {
+        lines.erase(it);
+        return;
+    }
+
+    const float removedWidth = offsets[column + removedLength] - offsets[column];
+
+    scratch.assign(inserted.size(), 0.0f);
+    if (!inserted.empty()) {
+        measure(inserted, scratch.data());
+    }
+    float insertedWidth = 0.0f;
+    for (float& advance : scratch) {
+        insertedWidth += advance;
+        advance = insertedWidth;
+    }
+
+    // Everything after the edit moves by the width change
+    const float shift = insertedWidth - removedWidth;
+    for (size_t i = column + removedLength + 1; i < offsets.size(); ++i) {
+        offsets[i] += shift;
+    }
+
+    const float base = offsets[column];
+    offsets.erase(offsets.begin() + column + 1, offsets.begin() + column + 1 + removedLength);
+    offsets.insert(offsets.begin() + column + 1, scratch.begin(), scratch.end());
+    for (size_t i = 0; i < inserted.size(); ++i) {
+        offsets[column + 1 + i] += base;
+    }
+}
+
+void GlyphAdvanceIndex::ReplaceLines(size_t firstLine, size_t lastLine, ptrdiff_t lineDelta) {
+    std::unordered_map<size_t, std::vector<float>> renumbered;
+    renumbered.reserve(lines.size());
+    for (auto& entry : lines) {
+        if (entry.first < firstLine) {
+            renumbered.emplace(entry.first, std::move(entry.second));
+        } else if (entry.first > lastLine) {
+            renumbered.emplace(static_cast<size_t>(entry.first + lineDelta), std::move(entry.second));
+        }
+    }
+    lines.swap(renumbered);
+}
+
+void GlyphAdvanceIndex::Retain(size_t firstLine, size_t lastLine, size_t keepLine) {
+    for (auto it = lines.begin(); it != lines.end();) {
+        if ((it->first < firstLine || it->first >= lastLine) && it->first != keepLine) {
+            it = lines.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+size_t GlyphAdvanceIndex::HitTest(const std::vector<float>& offsets, float x) {
+    if (offsets.empty() || x <= offsets.front()) return 0;
+
+    // Last boundary at or before x, moved back to the first byte of its cluster
+    auto after = std::upper_bound(offsets.begin(), offsets.end(), x);
+    if (after == offsets.end()) return offsets.size() - 1;
+
+    auto before = std::lower_bound(offsets.begin(), after, *(after - 1));
+    // Snap to whichever side of the cluster is nearer
+    const size_t index = (x - *before <= *after - x) ? before - offsets.begin() : after - offsets.begin();
+    return index;
+}
+
+} // namespace miko
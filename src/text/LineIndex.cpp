@@ -0,0 +1,116 @@
+#include "miko/text/LineIndex.h"
+#include "miko/text/GapBuffer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace miko {
+
+LineIndex::LineIndex()
+    : starts(1 + MinimumGap, 0)
+    , gapStart(1)
+    , gapEnd(1 + MinimumGap)
+    , delta(0)
+    , textLength(0)
+{
+}
+
+void LineIndex::Rebuild(const GapBuffer& text) {
+    starts.clear();
+    starts.push_back(0);
+
+    size_t offset = 0;
+    for (std::string_view segment : { text.GetFirstSegment(), text.GetSecondSegment() }) {
+        const char* data = segment.data();
+        const char* end = data + segment.size();
+        for (const char* p = data; p < end; ++p) {
+            p = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            if (!p) break;
+            starts.push_back(offset + (p - data) + 1);
+        }
+        offset += segment.size();
+    }
+
+    // Leave the gap at the end, where appends land
+    gapStart = starts.size();
+    starts.resize(starts.size() + MinimumGap);
+    gapEnd = starts.size();
+    delta = 0;
+    textLength = text.GetLength();
+}
+
+void LineIndex::Replace(size_t position, size_t removedLength, std::string_view inserted) {
+    position = std::min(position, textLength);
+    removedLength = std::min(removedLength, textLength - position);
+
+    // Line starts in (position, position + removedLength] followed a removed '\n'
+    const size_t firstLine = FindLine(position);
+    const size_t removedEnd = position + removedLength;
+    const size_t lastRemoved = removedLength > 0 ? FindLine(removedEnd) : firstLine;
+
+    MoveGap(firstLine + 1);
+    gapEnd += lastRemoved - firstLine;
+
+    size_t newLines = 0;
+    for (const char c : inserted) {
+        newLines += (c == '\n') ? 1 : 0;
+    }
+    if (newLines > GetGapLength()) {
+        GrowGap(newLines);
+    }
+    for (size_t i = 0; i < inserted.size(); ++i) {
+        if (inserted[i] == '\n') {
+            starts[gapStart++] = position + i + 1;
+        }
+    }
+
+    // Everything after the gap starts after the edited range and moves by the size change
+    delta += static_cast<ptrdiff_t>(inserted.size()) - static_cast<ptrdiff_t>(removedLength);
+    textLength = textLength - removedLength + inserted.size();
+}
+
+size_t LineIndex::FindLine(size_t offset) const {
+    // Last line whose start is <= offset
+    size_t low = 0;
+    size_t high = GetLineCount();
+    while (high - low > 1) {
+        const size_t middle = low + (high - low) / 2;
+        if (GetLineStart(middle) <= offset) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+void LineIndex::MoveGap(size_t line) {
+    if (line < gapStart) {
+        // Entries [line, gapStart) move behind the gap and take on the delta
+        while (gapStart > line) {
+            --gapStart;
+            --gapEnd;
+            starts[gapEnd] = static_cast<size_t>(static_cast<ptrdiff_t>(starts[gapStart]) - delta);
+        }
+    } else {
+        // Entries after the gap move in front of it with the delta folded in
+        while (gapStart < line) {
+            starts[gapStart] = static_cast<size_t>(starts[gapEnd] + delta);
+            ++gapStart;
+            ++gapEnd;
+        }
+    }
+}
+
+void LineIndex::GrowGap(size_t minimumGap) {
+    const size_t afterGap = starts.size() - gapEnd;
+    const size_t newSize = std::max(starts.size() + minimumGap + MinimumGap, starts.size() * 2);
+
+    std::vector<size_t> newStarts(newSize);
+    std::copy(starts.begin(), starts.begin() + gapStart, newStarts.begin());
+    std::copy(starts.begin() + gapEnd, starts.end(), newStarts.end() - afterGap);
+
+    starts.swap(newStarts);
+    gapEnd = newSize - afterGap;
+}
+
+} // namespace miko
@@ -0,0 +1,84 @@
+#include "miko/text/LineTokenCache.h"
+#include <algorithm>
+
+namespace miko {
+
+void LineTokenCache::Reset() {
+    lines.clear();
+    staleLines.clear();
+    nextState = 0;
+}
+
+void LineTokenCache::ReplaceLines(size_t firstLine, size_t lastLine, ptrdiff_t lineDelta) {
+    // Nothing is cached for lines past the prefix
+    if (firstLine >= lines.size()) return;
+
+    // firstLine's start state does not depend on the edit, so it is kept
+    if (lastLine >= lines.size()) {
+        // The edit runs past the prefix; cut it back to the first touched line
+        lines.resize(firstLine + 1);
+        staleLines.erase(staleLines.upper_bound(firstLine), staleLines.end());
+        staleLines.insert(firstLine);
+        return;
+    }
+
+    std::vector<size_t> laterStale(staleLines.upper_bound(lastLine), staleLines.end());
+    staleLines.erase(staleLines.upper_bound(firstLine), staleLines.end());
+    const size_t newLastLine = (size_t)((ptrdiff_t)lastLine + lineDelta);
+    lines.erase(lines.begin() + firstLine + 1, lines.begin() + lastLine + 1);
+    lines.insert(lines.begin() + firstLine + 1, newLastLine - firstLine, Line());
+
+    for (size_t line = firstLine; line <= newLastLine; ++line) {
+        staleLines.insert(staleLines.end(), line);
+    }
+    for (size_t line : laterStale) {
+        staleLines.insert(staleLines.end(), (size_t)((ptrdiff_t)line + lineDelta));
+    }
+}
+
+void LineTokenCache::Update(Tokenizer& tokenizer, size_t endLine, size_t lineCount, const LineSource& lineText) {
+    if (lines.size() > lineCount) {
+        // The text shrank without telling us; the surviving prefix is still valid
+        lines.resize(lineCount);
+        staleLines.erase(staleLines.lower_bound(lineCount), staleLines.end());
+    }
+    endLine = std::min(endLine, lineCount);
+
+    // Re-tokenize stale lines in order, carrying a changed end state on to the
+    // next line; once the state converges the rest of the cache still holds
+    while (!staleLines.empty() && *staleLines.begin() < endLine) {
+        const size_t line = *staleLines.begin();
+        staleLines.erase(staleLines.begin());
+
+        const uint32_t endState = TokenizeLine(tokenizer, line, lineText);
+        if (line + 1 < lines.size()) {
+            if (lines[line + 1].startState != endState) {
+                lines[line + 1].startState = endState;
+                staleLines.insert(line + 1);
+            }
+        } else {
+            nextState = endState;
+        }
+    }
+
+    // Extend the prefix to cover lines seen for the first time
+    while (lines.size() < endLine) {
+        Line next;
+        next.startState = lines.empty() ? tokenizer.GetInitialState() : nextState;
+        lines.push_back(std::move(next));
+        nextState = TokenizeLine(tokenizer, lines.size() - 1, lineText);
+    }
+}
+
+const std::vector<TokenSpan>* LineTokenCache::FindSpans(size_t line) const {
+    if (line >= lines.size() || staleLines.count(line)) return nullptr;
+    return &lines[line].spans;
+}
+
+uint32_t LineTokenCache::TokenizeLine(Tokenizer& tokenizer, size_t line, const LineSource& lineText) {
+    Line& entry = lines[line];
+    entry.spans.clear();
+    return tokenizer.TokenizeLine(lineText(line), entry.startState, entry.spans);
+}
+
+} // namespace miko
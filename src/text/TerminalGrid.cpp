@@ -0,0 +1,758 @@
+#include "miko/text/TerminalGrid.h"
+#include "miko/text/Utf8.h"
+#include <algorithm>
+
+namespace miko {
+
+static const size_t TAB_WIDTH = 8;
+
+TerminalGrid::TerminalGrid(size_t columns, size_t rows, size_t scrollbackCapacity)
+    : parser(*this)
+    , columns(0)
+    , rows(0)
+    , screenOrigin(0)
+    , otherScreenOrigin(0)
+    , alternateActive(false)
+    , scrollbackCapacity(scrollbackCapacity)
+    , scrollbackStart(0)
+    , scrollbackCount(0)
+    , scrolledLineCount(0)
+    , cursorRow(0)
+    , cursorColumn(0)
+    , newLineMode(false)
+    , titleChanged(false)
+    , bellRang(false)
+{
+    ResetState();
+    Rebuild(columns, rows);
+}
+
+void TerminalGrid::Reset() {
+    parser.Reset();
+    ResetState();
+}
+
+void TerminalGrid::ResetState() {
+    if (alternateActive) {
+        SetAlternateScreen(false);
+    }
+    pen = Pen();
+    savedCursor = SavedCursor();
+    cursorRow = 0;
+    cursorColumn = 0;
+    pendingWrap = false;
+    scrollTop = 0;
+    scrollBottom = rows > 0 ? rows - 1 : 0;
+    autoWrap = true;
+    cursorVisible = true;
+    applicationCursorKeys = false;
+    for (size_t row = 0; row < rows; ++row) {
+        ClearCells(RowSlot(row), 0, columns);
+    }
+}
+
+void TerminalGrid::Resize(size_t newColumns, size_t newRows) {
+    newColumns = std::max<size_t>(newColumns, 1);
+    newRows = std::max<size_t>(newRows, 1);
+    if (newColumns == columns && newRows == rows) return;
+    Rebuild(newColumns, newRows);
+}
+
+void TerminalGrid::Rebuild(size_t newColumns, size_t newRows) {
+    newColumns = std::max<size_t>(newColumns, 1);
+    newRows = std::max<size_t>(newRows, 1);
+
+    // The main screen's lines in order, of which the first historyCount become scrollback
+    const std::vector<uint32_t>& mainScreen = alternateActive ? otherScreen : screen;
+    const size_t mainOrigin = alternateActive ? otherScreenOrigin : screenOrigin;
+    const size_t shift = (!alternateActive && cursorRow + 1 > newRows) ? cursorRow + 1 - newRows : 0;
+    std::vector<uint32_t> lines;
+    for (size_t i = 0; i < scrollbackCount; ++i) {
+        lines.push_back(scrollback[(scrollbackStart + i) % scrollbackCapacity]);
+    }
+    for (size_t row = 0; row < shift; ++row) {
+        lines.push_back(mainScreen[(mainOrigin + row) % rows]);
+    }
+    const size_t historyCount = std::min(lines.size(), scrollbackCapacity);
+    lines.erase(lines.begin(), lines.end() - historyCount);
+    for (size_t row = shift; row < rows && row < shift + newRows; ++row) {
+        lines.push_back(mainScreen[(mainOrigin + row) % rows]);
+    }
+
+    const size_t slotCount = historyCount + newRows + (alternateActive ? newRows : 0);
+    std::vector<uint32_t> newCodePoints(slotCount * newColumns, 0);
+    std::vector<uint32_t> newForeground(slotCount * newColumns, DEFAULT_COLOR);
+    std::vector<uint32_t> newBackground(slotCount * newColumns, DEFAULT_COLOR);
+    std::vector<uint8_t> newAttributes(slotCount * newColumns, 0);
+    std::vector<uint32_t> newLengths(slotCount, 0);
+
+    // Line i moves to slot i, cut or padded to the new width
+    for (size_t i = 0; i < lines.size(); ++i) {
+        const size_t from = lines[i] * columns;
+        const size_t to = i * newColumns;
+        const size_t copied = std::min<size_t>(lengths[lines[i]], newColumns);
+        std::copy_n(&codePoints[from], copied, &newCodePoints[to]);
+        std::copy_n(&foreground[from], copied, &newForeground[to]);
+        std::copy_n(&background[from], copied, &newBackground[to]);
+        std::copy_n(&attributes[from], copied, &newAttributes[to]);
+        newLengths[i] = static_cast<uint32_t>(copied);
+    }
+
+    codePoints.swap(newCodePoints);
+    foreground.swap(newForeground);
+    background.swap(newBackground);
+    attributes.swap(newAttributes);
+    lengths.swap(newLengths);
+    dirty.assign(slotCount, 1);
+    freeSlots.clear();
+    columns = newColumns;
+    rows = newRows;
+
+    scrollback.assign(scrollbackCapacity, 0);
+    for (size_t i = 0; i < historyCount; ++i) {
+        scrollback[i] = static_cast<uint32_t>(i);
+    }
+    scrollbackStart = 0;
+    scrollbackCount = historyCount;
+
+    screen.resize(newRows);
+    for (size_t row = 0; row < newRows; ++row) {
+        screen[row] = static_cast<uint32_t>(historyCount + row);
+    }
+    screenOrigin = 0;
+    otherScreen.clear();
+    otherScreenOrigin = 0;
+    if (alternateActive) {
+        // The main screen waits behind a blank alternate screen
+        otherScreen.swap(screen);
+        screen.resize(newRows);
+        for (size_t row = 0; row < newRows; ++row) {
+            screen[row] = static_cast<uint32_t>(historyCount + newRows + row);
+        }
+    }
+
+    cursorRow = std::min(cursorRow - std::min(cursorRow, shift), rows - 1);
+    cursorColumn = std::min(cursorColumn, columns - 1);
+    savedCursor.row = std::min(savedCursor.row, rows - 1);
+    savedCursor.column = std::min(savedCursor.column, columns - 1);
+    pendingWrap = false;
+    scrollTop = 0;
+    scrollBottom = rows - 1;
+}
+
+void TerminalGrid::SetScrollbackCapacity(size_t capacity) {
+    if (capacity == scrollbackCapacity) return;
+
+    // Only slot numbers move; dropped lines free their slots
+    std::vector<uint32_t> newScrollback(capacity, 0);
+    const size_t kept = std::min(scrollbackCount, capacity);
+    for (size_t i = 0; i < scrollbackCount; ++i) {
+        const uint32_t slot = scrollback[(scrollbackStart + i) % scrollbackCapacity];
+        if (i < scrollbackCount - kept) {
+            freeSlots.push_back(slot);
+        } else {
+            newScrollback[i - (scrollbackCount - kept)] = slot;
+        }
+    }
+    scrollback.swap(newScrollback);
+    scrollbackCapacity = capacity;
+    scrollbackStart = 0;
+    scrollbackCount = kept;
+}
+
+void TerminalGrid::ClearScrollback() {
+    for (size_t i = 0; i < scrollbackCount; ++i) {
+        freeSlots.push_back(scrollback[(scrollbackStart + i) % scrollbackCapacity]);
+    }
+    scrollbackStart = 0;
+    scrollbackCount = 0;
+}
+
+uint32_t TerminalGrid::GetLineSlot(size_t line) const {
+    if (line < scrollbackCount) {
+        return scrollback[(scrollbackStart + line) % scrollbackCapacity];
+    }
+    return GetRowSlot(line - scrollbackCount);
+}
+
+uint32_t TerminalGrid::AllocateSlot() {
+    if (!freeSlots.empty()) {
+        const uint32_t slot = freeSlots.back();
+        freeSlots.pop_back();
+        return slot;
+    }
+    const uint32_t slot = static_cast<uint32_t>(dirty.size());
+    codePoints.resize(codePoints.size() + columns, 0);
+    foreground.resize(foreground.size() + columns, DEFAULT_COLOR);
+    background.resize(background.size() + columns, DEFAULT_COLOR);
+    attributes.resize(attributes.size() + columns, 0);
+    lengths.push_back(0);
+    dirty.push_back(1);
+    return slot;
+}
+
+void TerminalGrid::ClearCells(uint32_t slot, size_t first, size_t last) {
+    if (first >= last) return;
+    dirty[slot] = 1;
+
+    uint32_t& length = lengths[slot];
+    if (pen.background == DEFAULT_COLOR && last >= length) {
+        // Erasing to the end of the used cells only shortens the line
+        length = static_cast<uint32_t>(std::min<size_t>(length, first));
+        return;
+    }
+
+    // Erased cells take the current background, as on a VT220 and later
+    const size_t rowStart = slot * columns;
+    if (first > length) {
+        FillBlank(rowStart + length, first - length);
+    }
+    const size_t count = last - first;
+    std::fill_n(&codePoints[rowStart + first], count, 0);
+    std::fill_n(&foreground[rowStart + first], count, DEFAULT_COLOR);
+    std::fill_n(&background[rowStart + first], count, pen.background);
+    std::fill_n(&attributes[rowStart + first], count, 0);
+    length = static_cast<uint32_t>(std::max<size_t>(length, last));
+}
+
+void TerminalGrid::FillBlank(size_t start, size_t count) {
+    std::fill_n(&codePoints[start], count, 0);
+    std::fill_n(&foreground[start], count, DEFAULT_COLOR);
+    std::fill_n(&background[start], count, DEFAULT_COLOR);
+    std::fill_n(&attributes[start], count, 0);
+}
+
+void TerminalGrid::ExtendToFullWidth(uint32_t slot) {
+    uint32_t& length = lengths[slot];
+    if (length < columns) {
+        FillBlank(slot * columns + length, columns - length);
+        length = static_cast<uint32_t>(columns);
+    }
+}
+
+void TerminalGrid::Print(std::string_view text) {
+    const size_t size = text.size();
+    size_t i = 0;
+    while (i < size) {
+        if (pendingWrap && autoWrap) {
+            cursorColumn = 0;
+            LineFeed();
+        }
+        pendingWrap = false;
+
+        // Fill the rest of the cursor's row, then write its colors in one go
+        const uint32_t slot = RowSlot(cursorRow);
+        const size_t rowStart = slot * columns;
+        const size_t first = rowStart + cursorColumn;
+        const size_t rowEnd = rowStart + columns;
+        uint32_t& length = lengths[slot];
+        if (cursorColumn > length) {
+            FillBlank(rowStart + length, cursorColumn - length);
+        }
+
+        uint32_t* cells = codePoints.data();
+        size_t cell = first;
+        while (i < size && cell < rowEnd) {
+            // Widen a run of ASCII in a loop simple enough to vectorize
+            const size_t ascii = GetAsciiPrefixLength(text.substr(i, std::min(size - i, rowEnd - cell)));
+            for (size_t k = 0; k < ascii; ++k) {
+                cells[cell + k] = static_cast<unsigned char>(text[i + k]);
+            }
+            i += ascii;
+            cell += ascii;
+            if (i == size || cell == rowEnd) break;
+
+            const uint32_t codePoint = DecodeUtf8(text, i);
+            if (!IsGraphemeExtender(codePoint)) {
+                cells[cell++] = codePoint;
+            }
+        }
+
+        const size_t written = cell - first;
+        std::fill_n(&foreground[first], written, pen.foreground);
+        std::fill_n(&background[first], written, pen.background);
+        std::fill_n(&attributes[first], written, pen.attributes);
+        length = static_cast<uint32_t>(std::max(static_cast<size_t>(length), cell - rowStart));
+        dirty[slot] = 1;
+
+        cursorColumn = cell - rowStart;
+        if (cursorColumn >= columns) {
+            cursorColumn = columns - 1;
+            pendingWrap = true;
+        }
+    }
+}
+
+void TerminalGrid::Execute(unsigned char control) {
+    switch (control) {
+        case 0x07:
+            bellRang = true;
+            break;
+        case 0x08:
+            if (cursorColumn > 0) {
+                --cursorColumn;
+            }
+            pendingWrap = false;
+            break;
+        case 0x09:
+            cursorColumn = std::min((cursorColumn / TAB_WIDTH + 1) * TAB_WIDTH, columns - 1);
+            pendingWrap = false;
+            break;
+        case 0x0A:
+        case 0x0B:
+        case 0x0C:
+            LineFeed();
+            if (newLineMode) {
+                cursorColumn = 0;
+            }
+            break;
+        case 0x0D:
+            cursorColumn = 0;
+            pendingWrap = false;
+            break;
+        default:
+            break;
+    }
+}
+
+void TerminalGrid::CsiDispatch(const VtParams& params, std::string_view intermediates, char final) {
+    if (!intermediates.empty()) {
+        if (intermediates == "?" && (final == 'h' || final == 'l')) {
+            for (size_t i = 0; i < params.count; ++i) {
+                SetPrivateMode(params.values[i], final == 'h');
+            }
+        }
+        return;
+    }
+
+    const int32_t count = params.Get(0, 1);
+    const ptrdiff_t row = static_cast<ptrdiff_t>(cursorRow);
+    const ptrdiff_t column = static_cast<ptrdiff_t>(cursorColumn);
+    switch (final) {
+        case 'A':
+            MoveCursor(row - count, column);
+            break;
+        case 'B':
+        case 'e':
+            MoveCursor(row + count, column);
+            break;
+        case 'C':
+        case 'a':
+            MoveCursor(row, column + count);
+            break;
+        case 'D':
+            MoveCursor(row, column - count);
+            break;
+        case 'E':
+            MoveCursor(row + count, 0);
+            break;
+        case 'F':
+            MoveCursor(row - count, 0);
+            break;
+        case 'G':
+        case '`':
+            MoveCursor(row, count - 1);
+            break;
+        case 'd':
+            MoveCursor(count - 1, column);
+            break;
+        case 'H':
+        case 'f':
+            MoveCursor(params.Get(0, 1) - 1, params.Get(1, 1) - 1);
+            break;
+        case 'J':
+            EraseInDisplay(params.Get(0, 0));
+            break;
+        case 'K':
+            EraseInLine(params.Get(0, 0));
+            break;
+        case 'L':
+            if (cursorRow >= scrollTop && cursorRow <= scrollBottom) {
+                ScrollDown(cursorRow, scrollBottom, count);
+                MoveCursor(row, 0);
+            }
+            break;
+        case 'M':
+            if (cursorRow >= scrollTop && cursorRow <= scrollBottom) {
+                ScrollUp(cursorRow, scrollBottom, count, false);
+                MoveCursor(row, 0);
+            }
+            break;
+        case '@':
+            InsertCharacters(count);
+            break;
+        case 'P':
+            DeleteCharacters(count);
+            break;
+        case 'X':
+            ClearCells(RowSlot(cursorRow), cursorColumn, std::min(columns, cursorColumn + count));
+            pendingWrap = false;
+            break;
+        case 'S':
+            ScrollUp(scrollTop, scrollBottom, count, true);
+            break;
+        case 'T':
+            ScrollDown(scrollTop, scrollBottom, count);
+            break;
+        case 'm':
+            SelectGraphicRendition(params);
+            break;
+        case 'r': {
+            const size_t top = params.Get(0, 1) - 1;
+            const size_t bottom = std::min<size_t>(params.Get(1, static_cast<int32_t>(rows)), rows) - 1;
+            if (top < bottom) {
+                scrollTop = top;
+                scrollBottom = bottom;
+                MoveCursor(0, 0);
+            }
+            break;
+        }
+        case 's':
+            SaveCursor();
+            break;
+        case 'u':
+            RestoreCursor();
+            break;
+        case 'h':
+        case 'l':
+            for (size_t i = 0; i < params.count; ++i) {
+                if (params.values[i] == 20) {
+                    newLineMode = final == 'h';
+                }
+            }
+            break;
+        case 'n':
+            if (params.Get(0, 0) == 5) {
+                responses += "\x1b[0n";
+            } else if (params.Get(0, 0) == 6) {
+                responses += "\x1b[" + std::to_string(cursorRow + 1) + ";" + std::to_string(cursorColumn + 1) + "R";
+            }
+            break;
+        case 'c':
+            if (params.Get(0, 0) == 0) {
+                // VT102
+                responses += "\x1b[?6c";
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void TerminalGrid::EscDispatch(std::string_view intermediates, char final) {
+    // Character set designations and the like are not supported
+    if (!intermediates.empty()) return;
+
+    switch (final) {
+        case '7':
+            SaveCursor();
+            break;
+        case '8':
+            RestoreCursor();
+            break;
+        case 'D':
+            LineFeed();
+            break;
+        case 'E':
+            LineFeed();
+            cursorColumn = 0;
+            break;
+        case 'M':
+            ReverseIndex();
+            break;
+        case 'c':
+            ResetState();
+            break;
+        default:
+            break;
+    }
+}
+
+void TerminalGrid::OscDispatch(std::string_view data) {
+    // "0;title" sets the icon name and title, "2;title" the title
+    const size_t separator = data.find(';');
+    if (separator == std::string_view::npos) return;
+    const std::string_view command = data.substr(0, separator);
+    if (command == "0" || command == "2") {
+        title.assign(data.substr(separator + 1));
+        titleChanged = true;
+    }
+}
+
+void TerminalGrid::LineFeed() {
+    if (cursorRow == scrollBottom) {
+        ScrollUp(scrollTop, scrollBottom, 1, true);
+    } else if (cursorRow + 1 < rows) {
+        ++cursorRow;
+    }
+    pendingWrap = false;
+}
+
+void TerminalGrid::ReverseIndex() {
+    if (cursorRow == scrollTop) {
+        ScrollDown(scrollTop, scrollBottom, 1);
+    } else if (cursorRow > 0) {
+        --cursorRow;
+    }
+    pendingWrap = false;
+}
+
+void TerminalGrid::ScrollUp(size_t top, size_t bottom, size_t count, bool toScrollback) {
+    count = std::min(count, bottom - top + 1);
+
+    if (top == 0 && bottom + 1 == rows) {
+        // The whole screen: advance the ring origin, recycling the top row's slot
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t& topRow = screen[screenOrigin];
+            uint32_t recycled = topRow;
+            if (toScrollback && !alternateActive && scrollbackCapacity > 0) {
+                if (scrollbackCount == scrollbackCapacity) {
+                    recycled = scrollback[scrollbackStart];
+                    scrollback[scrollbackStart] = topRow;
+                    scrollbackStart = (scrollbackStart + 1) % scrollbackCapacity;
+                } else {
+                    scrollback[(scrollbackStart + scrollbackCount) % scrollbackCapacity] = topRow;
+                    ++scrollbackCount;
+                    recycled = AllocateSlot();
+                }
+                ++scrolledLineCount;
+            }
+            topRow = recycled;
+            screenOrigin = (screenOrigin + 1) % rows;
+            ClearCells(recycled, 0, columns);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t recycled = RowSlot(top);
+        for (size_t row = top; row < bottom; ++row) {
+            RowSlot(row) = RowSlot(row + 1);
+        }
+        RowSlot(bottom) = recycled;
+        ClearCells(recycled, 0, columns);
+    }
+}
+
+void TerminalGrid::ScrollDown(size_t top, size_t bottom, size_t count) {
+    count = std::min(count, bottom - top + 1);
+
+    if (top == 0 && bottom + 1 == rows) {
+        for (size_t i = 0; i < count; ++i) {
+            screenOrigin = (screenOrigin + rows - 1) % rows;
+            ClearCells(RowSlot(0), 0, columns);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t recycled = RowSlot(bottom);
+        for (size_t row = bottom; row > top; --row) {
+            RowSlot(row) = RowSlot(row - 1);
+        }
+        RowSlot(top) = recycled;
+        ClearCells(recycled, 0, columns);
+    }
+}
+
+void TerminalGrid::MoveCursor(ptrdiff_t row, ptrdiff_t column) {
+    cursorRow = static_cast<size_t>(std::clamp<ptrdiff_t>(row, 0, static_cast<ptrdiff_t>(rows) - 1));
+    cursorColumn = static_cast<size_t>(std::clamp<ptrdiff_t>(column, 0, static_cast<ptrdiff_t>(columns) - 1));
+    pendingWrap = false;
+}
+
+void TerminalGrid::EraseInDisplay(int mode) {
+    switch (mode) {
+        case 0:
+            EraseInLine(0);
+            for (size_t row = cursorRow + 1; row < rows; ++row) {
+                ClearCells(RowSlot(row), 0, columns);
+            }
+            break;
+        case 1:
+            for (size_t row = 0; row < cursorRow; ++row) {
+                ClearCells(RowSlot(row), 0, columns);
+            }
+            EraseInLine(1);
+            break;
+        case 2:
+            for (size_t row = 0; row < rows; ++row) {
+                ClearCells(RowSlot(row), 0, columns);
+            }
+            break;
+        case 3:
+            ClearScrollback();
+            break;
+        default:
+            break;
+    }
+}
+
+void TerminalGrid::EraseInLine(int mode) {
+    const uint32_t slot = RowSlot(cursorRow);
+    switch (mode) {
+        case 0:
+            ClearCells(slot, cursorColumn, columns);
+            break;
+        case 1:
+            ClearCells(slot, 0, cursorColumn + 1);
+            break;
+        case 2:
+            ClearCells(slot, 0, columns);
+            break;
+        default:
+            break;
+    }
+    pendingWrap = false;
+}
+
+void TerminalGrid::InsertCharacters(size_t count) {
+    ExtendToFullWidth(RowSlot(cursorRow));
+    const size_t rowStart = RowSlot(cursorRow) * columns;
+    count = std::min(count, columns - cursorColumn);
+    const size_t first = rowStart + cursorColumn;
+    const size_t last = rowStart + columns;
+    std::copy_backward(&codePoints[first], &codePoints[last - count], &codePoints[last]);
+    std::copy_backward(&foreground[first], &foreground[last - count], &foreground[last]);
+    std::copy_backward(&background[first], &background[last - count], &background[last]);
+    std::copy_backward(&attributes[first], &attributes[last - count], &attributes[last]);
+    ClearCells(RowSlot(cursorRow), cursorColumn, cursorColumn + count);
+    pendingWrap = false;
+}
+
+void TerminalGrid::DeleteCharacters(size_t count) {
+    ExtendToFullWidth(RowSlot(cursorRow));
+    const size_t rowStart = RowSlot(cursorRow) * columns;
+    count = std::min(count, columns - cursorColumn);
+    const size_t first = rowStart + cursorColumn;
+    const size_t last = rowStart + columns;
+    std::copy(&codePoints[first + count], &codePoints[last], &codePoints[first]);
+    std::copy(&foreground[first + count], &foreground[last], &foreground[first]);
+    std::copy(&background[first + count], &background[last], &background[first]);
+    std::copy(&attributes[first + count], &attributes[last], &attributes[first]);
+    ClearCells(RowSlot(cursorRow), columns - count, columns);
+    pendingWrap = false;
+}
+
+void TerminalGrid::SelectGraphicRendition(const VtParams& params) {
+    if (params.count == 0) {
+        pen = Pen();
+        return;
+    }
+
+    for (size_t i = 0; i < params.count; ++i) {
+        const int32_t value = params.values[i];
+        if (value >= 30 && value <= 37) {
+            pen.foreground = PaletteColor(static_cast<uint8_t>(value - 30));
+        } else if (value >= 40 && value <= 47) {
+            pen.background = PaletteColor(static_cast<uint8_t>(value - 40));
+        } else if (value >= 90 && value <= 97) {
+            pen.foreground = PaletteColor(static_cast<uint8_t>(value - 90 + 8));
+        } else if (value >= 100 && value <= 107) {
+            pen.background = PaletteColor(static_cast<uint8_t>(value - 100 + 8));
+        } else if (value == 38 || value == 48) {
+            // 38;5;n and 38;2;r;g;b, likewise 48 for the background
+            uint32_t color = DEFAULT_COLOR;
+            if (i + 2 < params.count && params.values[i + 1] == 5) {
+                color = PaletteColor(static_cast<uint8_t>(params.values[i + 2]));
+                i += 2;
+            } else if (i + 4 < params.count && params.values[i + 1] == 2) {
+                color = RgbColor(static_cast<uint8_t>(params.values[i + 2]),
+                    static_cast<uint8_t>(params.values[i + 3]),
+                    static_cast<uint8_t>(params.values[i + 4]));
+                i += 4;
+            } else {
+                return;
+            }
+            (value == 38 ? pen.foreground : pen.background) = color;
+        } else {
+            switch (value) {
+                case 0: pen = Pen(); break;
+                case 1: pen.attributes |= Bold; break;
+                case 2: pen.attributes |= Faint; break;
+                case 3: pen.attributes |= Italic; break;
+                case 4: pen.attributes |= Underline; break;
+                case 5: pen.attributes |= Blink; break;
+                case 7: pen.attributes |= Inverse; break;
+                case 8: pen.attributes |= Hidden; break;
+                case 9: pen.attributes |= Strikethrough; break;
+                case 21: pen.attributes |= Underline; break;
+                case 22: pen.attributes &= ~(Bold | Faint); break;
+                case 23: pen.attributes &= ~Italic; break;
+                case 24: pen.attributes &= ~Underline; break;
+                case 25: pen.attributes &= ~Blink; break;
+                case 27: pen.attributes &= ~Inverse; break;
+                case 28: pen.attributes &= ~Hidden; break;
+                case 29: pen.attributes &= ~Strikethrough; break;
+                case 39: pen.foreground = DEFAULT_COLOR; break;
+                case 49: pen.background = DEFAULT_COLOR; break;
+                default: break;
+            }
+        }
+    }
+}
+
+void TerminalGrid::SetPrivateMode(int mode, bool enabled) {
+    switch (mode) {
+        case 1:
+            applicationCursorKeys = enabled;
+            break;
+        case 7:
+            autoWrap = enabled;
+            break;
+        case 25:
+            cursorVisible = enabled;
+            break;
+        case 47:
+        case 1047:
+            SetAlternateScreen(enabled);
+            break;
+        case 1049:
+            if (enabled) {
+                SaveCursor();
+                SetAlternateScreen(true);
+            } else {
+                SetAlternateScreen(false);
+                RestoreCursor();
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void TerminalGrid::SetAlternateScreen(bool enabled) {
+    if (enabled == alternateActive) return;
+
+    if (otherScreen.empty()) {
+        otherScreen.resize(rows);
+        for (size_t row = 0; row < rows; ++row) {
+            otherScreen[row] = AllocateSlot();
+        }
+        otherScreenOrigin = 0;
+    }
+    screen.swap(otherScreen);
+    std::swap(screenOrigin, otherScreenOrigin);
+    alternateActive = enabled;
+
+    if (enabled) {
+        // The alternate screen always starts blank
+        for (size_t row = 0; row < rows; ++row) {
+            ClearCells(RowSlot(row), 0, columns);
+        }
+    }
+    pendingWrap = false;
+}
+
+void TerminalGrid::SaveCursor() {
+    savedCursor.row = cursorRow;
+    savedCursor.column = cursorColumn;
+    savedCursor.pen = pen;
+}
+
+void TerminalGrid::RestoreCursor() {
+    pen = savedCursor.pen;
+    MoveCursor(static_cast<ptrdiff_t>(savedCursor.row), static_cast<ptrdiff_t>(savedCursor.column));
+}
+
+} // namespace miko
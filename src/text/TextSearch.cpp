@@ -0,0 +1,258 @@
+#include "miko/text/TextSearch.h"
+#include "miko/utils/ThreadPool.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__)
+#define MIKO_SEARCH_AVX2 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIKO_SEARCH_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define MIKO_SEARCH_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace miko {
+
+static const size_t NOT_FOUND = std::string_view::npos;
+// Bytes the background search reads per lock; small enough that Cancel() never stalls a frame
+static const size_t SEARCH_CHUNK_SIZE = 1024 * 1024;
+
+static unsigned CountTrailingZeros(uint64_t value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return (unsigned)index;
+#else
+    return (unsigned)__builtin_ctzll(value);
+#endif
+}
+
+// memchr for the first byte, then compare the rest; also finishes the vector loops
+static size_t FindScalar(const char* data, size_t size, std::string_view needle, size_t pos) {
+    const size_t length = needle.size();
+    while (pos + length <= size) {
+        const void* hit = std::memchr(data + pos, needle[0], size - length + 1 - pos);
+        if (!hit) return NOT_FOUND;
+        pos = (size_t)(static_cast<const char*>(hit) - data);
+        if (std::memcmp(data + pos + 1, needle.data() + 1, length - 1) == 0) {
+            return pos;
+        }
+        ++pos;
+    }
+    return NOT_FOUND;
+}
+
+#if defined(MIKO_SEARCH_AVX2)
+
+static size_t FindVector(const char* data, size_t size, std::string_view needle, size_t pos) {
+    const size_t length = needle.size();
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[length - 1]);
+    for (; pos + length - 1 + 32 <= size; pos += 32) {
+        const __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        const __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos + length - 1));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(first, blockFirst), _mm256_cmpeq_epi8(last, blockLast)));
+        while (mask) {
+            const size_t candidate = pos + CountTrailingZeros(mask);
+            if (std::memcmp(data + candidate + 1, needle.data() + 1, length - 2) == 0) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return FindScalar(data, size, needle, pos);
+}
+
+const char* GetTextSearchKernelName() {
+    return "AVX2";
+}
+
+#elif defined(MIKO_SEARCH_SSE2)
+
+static size_t FindVector(const char* data, size_t size, std::string_view needle, size_t pos) {
+    const size_t length = needle.size();
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[length - 1]);
+    for (; pos + length - 1 + 16 <= size; pos += 16) {
+        const __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        const __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + length - 1));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(first, blockFirst), _mm_cmpeq_epi8(last, blockLast)));
+        while (mask) {
+            const size_t candidate = pos + CountTrailingZeros(mask);
+            if (std::memcmp(data + candidate + 1, needle.data() + 1, length - 2) == 0) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return FindScalar(data, size, needle, pos);
+}
+
+const char* GetTextSearchKernelName() {
+    return "SSE2";
+}
+
+#elif defined(MIKO_SEARCH_NEON)
+
+static size_t FindVector(const char* data, size_t size, std::string_view needle, size_t pos) {
+    const size_t length = needle.size();
+    const uint8x16_t first = vdupq_n_u8((uint8_t)needle[0]);
+    const uint8x16_t last = vdupq_n_u8((uint8_t)needle[length - 1]);
+    for (; pos + length - 1 + 16 <= size; pos += 16) {
+        const uint8x16_t blockFirst = vld1q_u8(reinterpret_cast<const uint8_t*>(data + pos));
+        const uint8x16_t blockLast = vld1q_u8(reinterpret_cast<const uint8_t*>(data + pos + length - 1));
+        const uint8x16_t equal = vandq_u8(vceqq_u8(first, blockFirst), vceqq_u8(last, blockLast));
+        // Narrow to 4 bits per byte, the usual NEON stand-in for movemask
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(equal), 4)), 0);
+        while (mask) {
+            const unsigned bit = CountTrailingZeros(mask);
+            const size_t candidate = pos + bit / 4;
+            if (std::memcmp(data + candidate + 1, needle.data() + 1, length - 2) == 0) {
+                return candidate;
+            }
+            mask &= ~(0xFull << (bit & ~3u));
+        }
+    }
+    return FindScalar(data, size, needle, pos);
+}
+
+const char* GetTextSearchKernelName() {
+    return "NEON";
+}
+
+#else
+
+static size_t FindVector(const char* data, size_t size, std::string_view needle, size_t pos) {
+    return FindScalar(data, size, needle, pos);
+}
+
+const char* GetTextSearchKernelName() {
+    return "Scalar";
+}
+
+#endif
+
+size_t FindSubstring(std::string_view text, std::string_view needle, size_t from) {
+    if (needle.empty()) {
+        return from <= text.size() ? from : NOT_FOUND;
+    }
+    if (from >= text.size() || needle.size() > text.size() - from) {
+        return NOT_FOUND;
+    }
+    if (needle.size() == 1) {
+        // memchr is already vectorized by the C library
+        const void* hit = std::memchr(text.data() + from, needle[0], text.size() - from);
+        return hit ? (size_t)(static_cast<const char*>(hit) - text.data()) : NOT_FOUND;
+    }
+    return FindVector(text.data(), text.size(), needle, from);
+}
+
+void BackgroundSearch::Start(std::string_view first, std::string_view second, std::string_view needle,
+                             size_t from, size_t maxMatches) {
+    Cancel();
+    this->needle.assign(needle);
+    if (needle.empty() || maxMatches == 0) return;
+
+    state = std::make_shared<State>();
+    ThreadPool::GetShared().Submit([state = state, first, second, needle = this->needle, from, maxMatches]() {
+        Run(state, first, second, needle, from, maxMatches);
+        state->finished = true;
+    });
+}
+
+void BackgroundSearch::Cancel() {
+    if (!state) return;
+
+    state->cancelled = true;
+    // Wait out a chunk being read so the caller may change the text on return
+    std::lock_guard<std::mutex> lock(state->textMutex);
+    state.reset();
+}
+
+bool BackgroundSearch::TakeMatches(std::vector<size_t>& matches) {
+    if (!state) return false;
+
+    // Read the flag first: once it is set, the last matches have been published
+    const bool finished = state->finished;
+    {
+        std::lock_guard<std::mutex> lock(state->resultMutex);
+        matches.insert(matches.end(), state->found.begin(), state->found.end());
+        state->found.clear();
+    }
+    if (finished) {
+        state.reset();
+    }
+    return !finished;
+}
+
+void BackgroundSearch::Run(const std::shared_ptr<State>& state, std::string_view first, std::string_view second,
+                           const std::string& needle, size_t from, size_t maxMatches) {
+    const size_t total = first.size() + second.size();
+    const size_t length = needle.size();
+    if (length > total) return;
+    from = std::min(from, total);
+
+    std::string seam;
+    std::vector<size_t> chunkMatches;
+    size_t matchCount = 0;
+
+    // Views [begin, end) of the text, copying only a range that spans the two pieces
+    auto slice = [&](size_t begin, size_t end) -> std::string_view {
+        if (end <= first.size()) return first.substr(begin, end - begin);
+        if (begin >= first.size()) return second.substr(begin - first.size(), end - begin);
+        seam.assign(first.substr(begin));
+        seam.append(second.substr(0, end - first.size()));
+        return seam;
+    };
+
+    // Matches starting in [begin, end), one chunk per lock; false once stopped
+    auto searchRange = [&](size_t begin, size_t end) -> bool {
+        size_t next = begin;
+        for (size_t chunkStart = begin; chunkStart < end; chunkStart += SEARCH_CHUNK_SIZE) {
+            const size_t chunkEnd = std::min(end, chunkStart + SEARCH_CHUNK_SIZE);
+            // A match that ran into this chunk has already been taken
+            const size_t viewStart = std::max(chunkStart, next);
+            if (viewStart >= chunkEnd) continue;
+            const size_t viewEnd = std::min(total, chunkEnd + length - 1);
+
+            chunkMatches.clear();
+            {
+                std::lock_guard<std::mutex> lock(state->textMutex);
+                if (state->cancelled) return false;
+
+                const std::string_view view = slice(viewStart, viewEnd);
+                size_t position = 0;
+                while (matchCount < maxMatches) {
+                    position = FindSubstring(view, needle, position);
+                    if (position == NOT_FOUND || viewStart + position >= chunkEnd) break;
+                    chunkMatches.push_back(viewStart + position);
+                    next = viewStart + position + length;
+                    position += length;
+                    ++matchCount;
+                }
+            }
+
+            if (!chunkMatches.empty()) {
+                std::lock_guard<std::mutex> lock(state->resultMutex);
+                state->found.insert(state->found.end(), chunkMatches.begin(), chunkMatches.end());
+            }
+            if (matchCount >= maxMatches) return false;
+        }
+        return true;
+    };
+
+    if (searchRange(from, total) && from > 0) {
+        searchRange(0, from);
+    }
+}
+
+} // namespace miko
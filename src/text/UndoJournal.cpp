@@ -0,0 +1,228 @@
+#include "miko/text/UndoJournal.h"
+#include <algorithm>
+
+namespace miko {
+
+UndoJournal::UndoJournal(size_t byteLimit)
+    : current(0)
+    , sealed(true)
+    , ringHead(0)
+    , payloadUsed(0)
+    , byteLimit(byteLimit)
+{
+}
+
+void UndoJournal::SetByteLimit(size_t limit) {
+    byteLimit = limit;
+    while (!records.empty() && GetBytesUsed() > byteLimit) {
+        if (current == 0) {
+            // Only redo history is left; it cannot outlive the records before it
+            Clear();
+            return;
+        }
+        DropOldest();
+    }
+}
+
+void UndoJournal::Record(size_t offset, std::string_view removed, std::string_view inserted, EditKind kind) {
+    if (removed.empty() && inserted.empty()) return;
+
+    DropRedo();
+    if (TryCoalesce(offset, removed, inserted, kind)) {
+        return;
+    }
+
+    if (!MakeRoom(removed.size() + inserted.size() + sizeof(Entry))) {
+        Clear();
+        return;
+    }
+
+    Entry entry;
+    entry.offset = offset;
+    entry.payloadStart = ringHead;
+    entry.removedLength = static_cast<uint32_t>(removed.size());
+    entry.insertedLength = static_cast<uint32_t>(inserted.size());
+    entry.kind = kind;
+
+    // Backspace runs grow towards the start of the text, so their removed
+    // bytes are kept reversed and every further backspace is an append
+    if (kind == EditKind::Backspace) {
+        WritePayloadReversed(removed);
+    } else {
+        WritePayload(removed);
+    }
+    WritePayload(inserted);
+
+    records.push_back(entry);
+    current = records.size();
+    sealed = (kind == EditKind::Other);
+}
+
+bool UndoJournal::TryCoalesce(size_t offset, std::string_view removed, std::string_view inserted, EditKind kind) {
+    if (sealed || records.empty() || kind == EditKind::Other || records.back().kind != kind) {
+        return false;
+    }
+
+    Entry& last = records.back();
+    std::string_view appended;
+    switch (kind) {
+        case EditKind::Typing:
+        case EditKind::Paste:
+            if (!removed.empty() || offset != last.offset + last.insertedLength) return false;
+            appended = inserted;
+            break;
+        case EditKind::Backspace:
+            if (!inserted.empty() || offset + removed.size() != last.offset) return false;
+            appended = removed;
+            break;
+        case EditKind::ForwardDelete:
+            if (!inserted.empty() || offset != last.offset) return false;
+            appended = removed;
+            break;
+        default:
+            return false;
+    }
+
+    // The run's bytes sit at the head of the ring, so growing it is an append.
+    // A run that would no longer fit on its own starts a new record instead.
+    if (sizeof(Entry) + last.removedLength + last.insertedLength + appended.size() > byteLimit) {
+        return false;
+    }
+    if (!MakeRoom(appended.size())) {
+        return false;
+    }
+    Entry& run = records.back();
+
+    if (kind == EditKind::Backspace) {
+        WritePayloadReversed(appended);
+        run.removedLength += static_cast<uint32_t>(appended.size());
+        run.offset = offset;
+    } else if (kind == EditKind::ForwardDelete) {
+        WritePayload(appended);
+        run.removedLength += static_cast<uint32_t>(appended.size());
+    } else {
+        WritePayload(appended);
+        run.insertedLength += static_cast<uint32_t>(appended.size());
+    }
+    return true;
+}
+
+void UndoJournal::Clear() {
+    records.clear();
+    current = 0;
+    sealed = true;
+    ringHead = 0;
+    payloadUsed = 0;
+}
+
+bool UndoJournal::Undo(TextChange& change) {
+    if (!CanUndo()) return false;
+
+    const Entry& entry = records[--current];
+    change = TextChange(entry.offset, entry.insertedLength, ReadRemoved(entry));
+    sealed = true;
+    return true;
+}
+
+bool UndoJournal::Redo(TextChange& change) {
+    if (!CanRedo()) return false;
+
+    const Entry& entry = records[current++];
+    change = TextChange(entry.offset, entry.removedLength, ReadInserted(entry));
+    sealed = true;
+    return true;
+}
+
+bool UndoJournal::MakeRoom(size_t bytes) {
+    if (bytes > byteLimit) {
+        return false;
+    }
+    while (!records.empty() && GetBytesUsed() + bytes > byteLimit) {
+        DropOldest();
+    }
+    if (ring.size() - payloadUsed < bytes) {
+        GrowRing(bytes);
+    }
+    return true;
+}
+
+void UndoJournal::GrowRing(size_t minimumFree) {
+    const size_t capacity = ring.size();
+    const size_t newCapacity = std::min(byteLimit, std::max({ capacity * 2, payloadUsed + minimumFree, size_t(256) }));
+
+    // Unwrap the live bytes to the start of the new buffer
+    std::vector<char> newRing(newCapacity);
+    const size_t tail = capacity ? (ringHead + capacity - payloadUsed) % capacity : 0;
+    for (size_t i = 0; i < payloadUsed; ++i) {
+        newRing[i] = ring[(tail + i) % capacity];
+    }
+    for (Entry& entry : records) {
+        entry.payloadStart = (entry.payloadStart + capacity - tail) % capacity;
+    }
+
+    ring.swap(newRing);
+    ringHead = payloadUsed;
+}
+
+void UndoJournal::DropRedo() {
+    while (records.size() > current) {
+        const Entry& entry = records.back();
+        const size_t length = entry.removedLength + entry.insertedLength;
+        ringHead = (ringHead + ring.size() - length) % ring.size();
+        payloadUsed -= length;
+        records.pop_back();
+        sealed = true;
+    }
+}
+
+void UndoJournal::DropOldest() {
+    const Entry& entry = records.front();
+    payloadUsed -= entry.removedLength + entry.insertedLength;
+    records.pop_front();
+    if (current > 0) {
+        --current;
+    }
+}
+
+void UndoJournal::WritePayload(std::string_view bytes) {
+    // At most two copies: up to the end of the ring, then from its start
+    const size_t firstPart = std::min(bytes.size(), ring.size() - ringHead);
+    std::copy(bytes.begin(), bytes.begin() + firstPart, ring.begin() + ringHead);
+    std::copy(bytes.begin() + firstPart, bytes.end(), ring.begin());
+    ringHead = (ringHead + bytes.size()) % ring.size();
+    payloadUsed += bytes.size();
+}
+
+void UndoJournal::WritePayloadReversed(std::string_view bytes) {
+    for (auto it = bytes.rbegin(); it != bytes.rend(); ++it) {
+        ring[ringHead] = *it;
+        ringHead = (ringHead + 1) % ring.size();
+    }
+    payloadUsed += bytes.size();
+}
+
+void UndoJournal::ReadPayload(size_t start, size_t length, std::string& destination) const {
+    destination.resize(length);
+    const size_t capacity = ring.size();
+    const size_t firstPart = std::min(length, capacity - start);
+    std::copy(ring.begin() + start, ring.begin() + start + firstPart, destination.begin());
+    std::copy(ring.begin(), ring.begin() + (length - firstPart), destination.begin() + firstPart);
+}
+
+std::string UndoJournal::ReadRemoved(const Entry& entry) const {
+    std::string removed;
+    ReadPayload(entry.payloadStart, entry.removedLength, removed);
+    if (entry.kind == EditKind::Backspace) {
+        std::reverse(removed.begin(), removed.end());
+    }
+    return removed;
+}
+
+std::string UndoJournal::ReadInserted(const Entry& entry) const {
+    std::string inserted;
+    if (ring.empty()) return inserted;
+    ReadPayload((entry.payloadStart + entry.removedLength) % ring.size(), entry.insertedLength, inserted);
+    return inserted;
+}
+
+} // namespace miko
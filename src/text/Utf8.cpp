@@ -0,0 +1,203 @@
+#include "miko/text/Utf8.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIKO_UTF8_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define MIKO_UTF8_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace miko {
+
+static unsigned CountTrailingZeros(uint64_t value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return (unsigned)index;
+#else
+    return (unsigned)__builtin_ctzll(value);
+#endif
+}
+
+size_t GetAsciiPrefixLength(std::string_view text) {
+    const char* data = text.data();
+    const size_t size = text.size();
+    size_t i = 0;
+#if defined(MIKO_UTF8_SSE2)
+    // The high bit of each byte is exactly what movemask collects
+    for (; i + 16 <= size; i += 16) {
+        const int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+        if (mask != 0) {
+            return i + CountTrailingZeros((uint64_t)mask);
+        }
+    }
+#elif defined(MIKO_UTF8_NEON)
+    for (; i + 16 <= size; i += 16) {
+        const uint8x16_t high = vcgeq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(data + i)), vdupq_n_u8(0x80));
+        // Narrow to 4 bits per byte, the usual NEON stand-in for movemask
+        const uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(high), 4)), 0);
+        if (mask != 0) {
+            return i + CountTrailingZeros(mask) / 4;
+        }
+    }
+#endif
+    while (i < size && static_cast<unsigned char>(data[i]) < 0x80) {
+        ++i;
+    }
+    return i;
+}
+
+size_t GetUtf8SequenceLength(unsigned char lead) {
+    if (lead < 0x80) return 1;
+    if ((lead & 0xE0) == 0xC0) return 2;
+    if ((lead & 0xF0) == 0xE0) return 3;
+    if ((lead & 0xF8) == 0xF0) return 4;
+    return 1;
+}
+
+uint32_t DecodeUtf8(std::string_view text, size_t& position) {
+    const unsigned char lead = static_cast<unsigned char>(text[position]);
+    const size_t length = GetUtf8SequenceLength(lead);
+    if (length == 1) {
+        ++position;
+        return lead < 0x80 ? lead : 0xFFFD;
+    }
+    if (position + length > text.size()) {
+        ++position;
+        return 0xFFFD;
+    }
+
+    uint32_t codePoint = lead & (0x7F >> length);
+    for (size_t i = 1; i < length; ++i) {
+        const unsigned char byte = static_cast<unsigned char>(text[position + i]);
+        if (!IsUtf8Continuation(byte)) {
+            ++position;
+            return 0xFFFD;
+        }
+        codePoint = (codePoint << 6) | (byte & 0x3F);
+    }
+    position += length;
+    return codePoint;
+}
+
+size_t EncodeUtf8(uint32_t codePoint, char* out) {
+    if (codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+        codePoint = 0xFFFD;
+    }
+    if (codePoint < 0x80) {
+        out[0] = static_cast<char>(codePoint);
+        return 1;
+    }
+    if (codePoint < 0x800) {
+        out[0] = static_cast<char>(0xC0 | (codePoint >> 6));
+        out[1] = static_cast<char>(0x80 | (codePoint & 0x3F));
+        return 2;
+    }
+    if (codePoint < 0x10000) {
+        out[0] = static_cast<char>(0xE0 | (codePoint >> 12));
+        out[1] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out[2] = static_cast<char>(0x80 | (codePoint & 0x3F));
+        return 3;
+    }
+    out[0] = static_cast<char>(0xF0 | (codePoint >> 18));
+    out[1] = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+    out[2] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+    out[3] = static_cast<char>(0x80 | (codePoint & 0x3F));
+    return 4;
+}
+
+bool IsGraphemeExtender(uint32_t codePoint) {
+    return (codePoint >= 0x0300 && codePoint <= 0x036F) ||   // Combining diacritical marks
+           (codePoint >= 0x0483 && codePoint <= 0x0489) ||
+           (codePoint >= 0x0591 && codePoint <= 0x05BD) ||   // Hebrew points
+           (codePoint >= 0x0610 && codePoint <= 0x061A) ||   // Arabic marks
+           (codePoint >= 0x064B && codePoint <= 0x065F) ||
+           (codePoint >= 0x0900 && codePoint <= 0x0903) ||   // Devanagari signs
+           (codePoint >= 0x093A && codePoint <= 0x094F) ||
+           (codePoint >= 0x1AB0 && codePoint <= 0x1AFF) ||
+           (codePoint >= 0x1DC0 && codePoint <= 0x1DFF) ||
+           (codePoint >= 0x200C && codePoint <= 0x200D) ||   // ZWNJ, ZWJ
+           (codePoint >= 0x20D0 && codePoint <= 0x20FF) ||
+           (codePoint >= 0xFE00 && codePoint <= 0xFE0F) ||   // Variation selectors
+           (codePoint >= 0xFE20 && codePoint <= 0xFE2F) ||
+           (codePoint >= 0x1F3FB && codePoint <= 0x1F3FF) || // Emoji skin tone modifiers
+           (codePoint >= 0xE0020 && codePoint <= 0xE007F) || // Tag characters
+           (codePoint >= 0xE0100 && codePoint <= 0xE01EF);
+}
+
+size_t GetGraphemeLength(std::string_view text, size_t position) {
+    if (position >= text.size()) return 0;
+
+    size_t end = position;
+    uint32_t previous = DecodeUtf8(text, end);
+    if (previous == '\r' && end < text.size() && text[end] == '\n') {
+        return end + 1 - position;
+    }
+
+    while (end < text.size()) {
+        size_t next = end;
+        const uint32_t codePoint = DecodeUtf8(text, next);
+        // A zero width joiner glues the following character to the cluster
+        if (!IsGraphemeExtender(codePoint) && previous != 0x200D) {
+            break;
+        }
+        previous = codePoint;
+        end = next;
+    }
+    return end - position;
+}
+
+size_t GetPreviousGraphemeStart(std::string_view text, size_t position) {
+    if (position == 0) return 0;
+
+    // Walk back over extenders to the code point that starts the cluster
+    size_t start = position;
+    while (start > 0) {
+        size_t codePointStart = start - 1;
+        while (codePointStart > 0 && IsUtf8Continuation(static_cast<unsigned char>(text[codePointStart]))) {
+            --codePointStart;
+        }
+
+        size_t cursor = codePointStart;
+        const uint32_t codePoint = DecodeUtf8(text, cursor);
+        start = codePointStart;
+        if (codePoint == '\n' && start > 0 && text[start - 1] == '\r') {
+            return start - 1;
+        }
+        if (!IsGraphemeExtender(codePoint)) {
+            // Keep going through a ZWJ that joins this character to the previous one
+            if (start > 0) {
+                size_t joinerStart = start - 1;
+                while (joinerStart > 0 && IsUtf8Continuation(static_cast<unsigned char>(text[joinerStart]))) {
+                    --joinerStart;
+                }
+                size_t joinerCursor = joinerStart;
+                if (DecodeUtf8(text, joinerCursor) == 0x200D) {
+                    start = joinerStart;
+                    continue;
+                }
+            }
+            break;
+        }
+    }
+    return start;
+}
+
+std::string_view GetFirstLine(std::string_view text, size_t maxLength) {
+    text = text.substr(0, text.find_first_of("\r\n"));
+    if (text.size() > maxLength) {
+        size_t end = maxLength;
+        while (end > 0 && IsUtf8Continuation(static_cast<unsigned char>(text[end]))) {
+            --end;
+        }
+        text = text.substr(0, end);
+    }
+    return text;
+}
+
+} // namespace miko
@@ -0,0 +1,310 @@
+#include "miko/text/VtParser.h"
+#include "miko/text/Utf8.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIKO_VT_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define MIKO_VT_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace miko {
+
+namespace {
+
+enum Action : uint8_t {
+    ActionNone,
+    ActionPrint,
+    ActionExecute,
+    ActionIgnore,
+    ActionCollect,
+    ActionParam,
+    ActionEscDispatch,
+    ActionCsiDispatch,
+    ActionOscPut,
+    ActionOscEnd
+};
+
+const size_t STATE_COUNT = static_cast<size_t>(VtParser::State::Count);
+
+// entries[state][byte] holds the action in the high nibble and the next state in the low one
+struct TransitionTable {
+    uint8_t entries[STATE_COUNT][256];
+
+    TransitionTable() {
+        using S = VtParser::State;
+
+        for (size_t state = 0; state < STATE_COUNT; ++state) {
+            Set(S(state), 0x00, 0xFF, ActionIgnore, S(state));
+        }
+
+        // C0 controls execute without leaving a sequence, except inside strings
+        for (S state : { S::Ground, S::Escape, S::EscapeIntermediate, S::CsiEntry, S::CsiParam, S::CsiIntermediate, S::CsiIgnore }) {
+            Set(state, 0x00, 0x17, ActionExecute, state);
+            Set(state, 0x19, 0x19, ActionExecute, state);
+            Set(state, 0x1C, 0x1F, ActionExecute, state);
+        }
+
+        Set(S::Ground, 0x20, 0x7E, ActionPrint, S::Ground);
+        Set(S::Ground, 0x80, 0xFF, ActionPrint, S::Ground);
+
+        Set(S::Escape, 0x20, 0x2F, ActionCollect, S::EscapeIntermediate);
+        Set(S::Escape, 0x30, 0x7E, ActionEscDispatch, S::Ground);
+        Set(S::Escape, 'P', 'P', ActionNone, S::StringIgnore);
+        Set(S::Escape, 'X', 'X', ActionNone, S::StringIgnore);
+        Set(S::Escape, '^', '_', ActionNone, S::StringIgnore);
+        Set(S::Escape, '[', '[', ActionNone, S::CsiEntry);
+        Set(S::Escape, ']', ']', ActionNone, S::OscString);
+
+        Set(S::EscapeIntermediate, 0x20, 0x2F, ActionCollect, S::EscapeIntermediate);
+        Set(S::EscapeIntermediate, 0x30, 0x7E, ActionEscDispatch, S::Ground);
+
+        // ':' sub-parameters are read as plain separators
+        Set(S::CsiEntry, 0x20, 0x2F, ActionCollect, S::CsiIntermediate);
+        Set(S::CsiEntry, 0x30, 0x3B, ActionParam, S::CsiParam);
+        Set(S::CsiEntry, 0x3C, 0x3F, ActionCollect, S::CsiParam);
+        Set(S::CsiEntry, 0x40, 0x7E, ActionCsiDispatch, S::Ground);
+
+        Set(S::CsiParam, 0x20, 0x2F, ActionCollect, S::CsiIntermediate);
+        Set(S::CsiParam, 0x30, 0x3B, ActionParam, S::CsiParam);
+        Set(S::CsiParam, 0x3C, 0x3F, ActionIgnore, S::CsiIgnore);
+        Set(S::CsiParam, 0x40, 0x7E, ActionCsiDispatch, S::Ground);
+
+        Set(S::CsiIntermediate, 0x20, 0x2F, ActionCollect, S::CsiIntermediate);
+        Set(S::CsiIntermediate, 0x30, 0x3F, ActionIgnore, S::CsiIgnore);
+        Set(S::CsiIntermediate, 0x40, 0x7E, ActionCsiDispatch, S::Ground);
+
+        Set(S::CsiIgnore, 0x40, 0x7E, ActionNone, S::Ground);
+
+        Set(S::OscString, 0x20, 0xFF, ActionOscPut, S::OscString);
+        Set(S::OscString, 0x07, 0x07, ActionOscEnd, S::Ground);
+
+        // CAN and SUB abort any sequence; ESC starts a new one (and ends a string, as part of ST)
+        for (size_t state = 0; state < STATE_COUNT; ++state) {
+            Set(S(state), 0x18, 0x18, ActionExecute, S::Ground);
+            Set(S(state), 0x1A, 0x1A, ActionExecute, S::Ground);
+            Set(S(state), 0x1B, 0x1B, ActionNone, S::Escape);
+        }
+        Set(S::OscString, 0x1B, 0x1B, ActionOscEnd, S::Escape);
+    }
+
+    void Set(VtParser::State state, unsigned first, unsigned last, Action action, VtParser::State next) {
+        for (unsigned byte = first; byte <= last; ++byte) {
+            entries[static_cast<size_t>(state)][byte] = static_cast<uint8_t>((action << 4) | static_cast<uint8_t>(next));
+        }
+    }
+};
+
+const TransitionTable& GetTransitionTable() {
+    static const TransitionTable table;
+    return table;
+}
+
+inline bool IsPrintable(unsigned char byte) {
+    return byte >= 0x20 && byte != 0x7F;
+}
+
+unsigned CountTrailingZeros(uint64_t value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return (unsigned)index;
+#else
+    return (unsigned)__builtin_ctzll(value);
+#endif
+}
+
+// Position of the first C0 control or DEL at or after pos, or size if there is none
+size_t FindControlByte(const char* data, size_t pos, size_t size) {
+#if defined(MIKO_VT_SSE2)
+    const __m128i lastControl = _mm_set1_epi8(0x1F);
+    const __m128i del = _mm_set1_epi8(0x7F);
+    for (; pos + 16 <= size; pos += 16) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        // Unsigned byte <= 0x1F is max(byte, 0x1F) == 0x1F
+        const __m128i control = _mm_or_si128(
+            _mm_cmpeq_epi8(_mm_max_epu8(block, lastControl), lastControl),
+            _mm_cmpeq_epi8(block, del));
+        const int mask = _mm_movemask_epi8(control);
+        if (mask != 0) {
+            return pos + CountTrailingZeros((uint64_t)mask);
+        }
+    }
+#elif defined(MIKO_VT_NEON)
+    const uint8x16_t firstPrintable = vdupq_n_u8(0x20);
+    const uint8x16_t del = vdupq_n_u8(0x7F);
+    for (; pos + 16 <= size; pos += 16) {
+        const uint8x16_t block = vld1q_u8(reinterpret_cast<const uint8_t*>(data + pos));
+        const uint8x16_t control = vorrq_u8(vcltq_u8(block, firstPrintable), vceqq_u8(block, del));
+        // Narrow to 4 bits per byte, the usual NEON stand-in for movemask
+        const uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(control), 4)), 0);
+        if (mask != 0) {
+            return pos + CountTrailingZeros(mask) / 4;
+        }
+    }
+#endif
+    while (pos < size && IsPrintable(static_cast<unsigned char>(data[pos]))) {
+        ++pos;
+    }
+    return pos;
+}
+
+} // namespace
+
+VtParser::VtParser(VtHandler& handler)
+    : handler(handler)
+    , state(State::Ground)
+    , intermediateCount(0)
+    , utf8CarryLength(0)
+{
+    Clear();
+}
+
+void VtParser::Reset() {
+    state = State::Ground;
+    Clear();
+    osc.clear();
+    utf8CarryLength = 0;
+}
+
+void VtParser::Feed(std::string_view bytes) {
+    const TransitionTable& table = GetTransitionTable();
+    const size_t size = bytes.size();
+    size_t i = utf8CarryLength > 0 ? CompleteCarriedCharacter(bytes) : 0;
+
+    while (i < size) {
+        if (state == State::Ground) {
+            // Text goes to the handler a run at a time rather than through the table
+            const size_t start = i;
+            i = FindControlByte(bytes.data(), i, size);
+            if (i > start) {
+                PrintRun(bytes.substr(start, i - start), i == size);
+                if (i == size) break;
+            }
+        }
+
+        const unsigned char byte = static_cast<unsigned char>(bytes[i++]);
+        const uint8_t entry = table.entries[static_cast<size_t>(state)][byte];
+        PerformAction(entry >> 4, byte);
+
+        const State next = static_cast<State>(entry & 0x0F);
+        if (next != state) {
+            state = next;
+            if (next == State::Escape || next == State::CsiEntry) {
+                Clear();
+            } else if (next == State::OscString) {
+                osc.clear();
+            }
+        }
+    }
+}
+
+size_t VtParser::CompleteCarriedCharacter(std::string_view bytes) {
+    const size_t length = GetUtf8SequenceLength(static_cast<unsigned char>(utf8Carry[0]));
+    size_t i = 0;
+    while (utf8CarryLength < length && i < bytes.size() && IsUtf8Continuation(static_cast<unsigned char>(bytes[i]))) {
+        utf8Carry[utf8CarryLength++] = bytes[i++];
+    }
+    if (utf8CarryLength < length && i == bytes.size()) {
+        // Still incomplete; wait for more
+        return i;
+    }
+
+    // Complete, or cut short by another byte, in which case it prints as U+FFFD
+    handler.Print(std::string_view(utf8Carry, utf8CarryLength));
+    utf8CarryLength = 0;
+    return i;
+}
+
+void VtParser::PrintRun(std::string_view run, bool atEnd) {
+    if (atEnd) {
+        // Hold back a character whose remaining bytes are in the next Feed
+        size_t lead = run.size();
+        while (lead > 0 && run.size() - lead < 3 && IsUtf8Continuation(static_cast<unsigned char>(run[lead - 1]))) {
+            --lead;
+        }
+        if (lead > 0) {
+            --lead;
+            const size_t available = run.size() - lead;
+            if (GetUtf8SequenceLength(static_cast<unsigned char>(run[lead])) > available) {
+                run.copy(utf8Carry, available, lead);
+                utf8CarryLength = available;
+                run = run.substr(0, lead);
+            }
+        }
+    }
+    if (!run.empty()) {
+        handler.Print(run);
+    }
+}
+
+void VtParser::Clear() {
+    params.count = 0;
+    intermediateCount = 0;
+}
+
+void VtParser::Collect(char byte) {
+    if (intermediateCount < MAX_INTERMEDIATES) {
+        intermediates[intermediateCount++] = byte;
+    }
+}
+
+void VtParser::Param(char byte) {
+    if (params.count == 0) {
+        params.values[0] = 0;
+        params.count = 1;
+    }
+    if (byte == ';' || byte == ':') {
+        if (params.count < VtParams::MAX_COUNT) {
+            params.values[params.count++] = 0;
+        }
+        return;
+    }
+
+    int32_t& value = params.values[params.count - 1];
+    if (value < 100000) {
+        value = value * 10 + (byte - '0');
+    }
+}
+
+void VtParser::PerformAction(uint8_t action, unsigned char byte) {
+    switch (action) {
+        case ActionPrint:
+            // Reached only for a lone byte the ground state run scan did not take
+            handler.Print(std::string_view(reinterpret_cast<const char*>(&byte), 1));
+            break;
+        case ActionExecute:
+            handler.Execute(byte);
+            break;
+        case ActionCollect:
+            Collect(static_cast<char>(byte));
+            break;
+        case ActionParam:
+            Param(static_cast<char>(byte));
+            break;
+        case ActionEscDispatch:
+            handler.EscDispatch(std::string_view(intermediates, intermediateCount), static_cast<char>(byte));
+            break;
+        case ActionCsiDispatch:
+            handler.CsiDispatch(params, std::string_view(intermediates, intermediateCount), static_cast<char>(byte));
+            break;
+        case ActionOscPut:
+            if (osc.size() < MAX_OSC_LENGTH) {
+                osc.push_back(static_cast<char>(byte));
+            }
+            break;
+        case ActionOscEnd:
+            handler.OscDispatch(osc);
+            osc.clear();
+            break;
+        default:
+            break;
+    }
+}
+
+} // namespace miko
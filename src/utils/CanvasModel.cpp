@@ -0,0 +1,180 @@
+#include "miko/utils/CanvasModel.h"
+#include <algorithm>
+#include <cmath>
+
+namespace miko {
+
+namespace {
+
+const Rect INITIAL_BOUNDS(0.0f, 0.0f, 1024.0f, 1024.0f);
+// Items outside the index it puts up with before being rebuilt, at least, or as a share of all items
+const size_t MIN_OUTSIDE_ITEMS = 64;
+const size_t OUTSIDE_SHARE = 8;
+
+Rect Inflate(const Rect& rect, float amount) {
+    return Rect(rect.x - amount, rect.y - amount, rect.width + 2 * amount, rect.height + 2 * amount);
+}
+
+float DistanceToSegment(const Point& point, const Point& start, const Point& end) {
+    const float dx = end.x - start.x;
+    const float dy = end.y - start.y;
+    const float lengthSquared = dx * dx + dy * dy;
+    float t = 0.0f;
+    if (lengthSquared > 0.0f) {
+        t = std::clamp(((point.x - start.x) * dx + (point.y - start.y) * dy) / lengthSquared, 0.0f, 1.0f);
+    }
+    const float nearestX = start.x + t * dx;
+    const float nearestY = start.y + t * dy;
+    return std::hypot(point.x - nearestX, point.y - nearestY);
+}
+
+} // namespace
+
+CanvasItem CanvasItem::MakeRectangle(const Rect& bounds, const Color& fill, const Color& stroke, float strokeWidth) {
+    CanvasItem item;
+    item.shape = CanvasShape::Rectangle;
+    item.bounds = bounds;
+    item.fillColor = fill;
+    item.strokeColor = stroke;
+    item.strokeWidth = strokeWidth;
+    return item;
+}
+
+CanvasItem CanvasItem::MakeEllipse(const Rect& bounds, const Color& fill, const Color& stroke, float strokeWidth) {
+    CanvasItem item = MakeRectangle(bounds, fill, stroke, strokeWidth);
+    item.shape = CanvasShape::Ellipse;
+    return item;
+}
+
+CanvasItem CanvasItem::MakeLine(const Point& start, const Point& end, const Color& color, float width) {
+    CanvasItem item;
+    item.shape = CanvasShape::Line;
+    item.start = start;
+    item.end = end;
+    item.strokeColor = color;
+    item.strokeWidth = width;
+    return item;
+}
+
+CanvasItem CanvasItem::MakeText(const Rect& bounds, const std::string& text, float fontSize, const Color& color) {
+    CanvasItem item;
+    item.shape = CanvasShape::Text;
+    item.bounds = bounds;
+    item.text = text;
+    item.fontSize = fontSize;
+    item.strokeColor = color;
+    item.strokeWidth = 0.0f;
+    return item;
+}
+
+CanvasModel::CanvasModel()
+    : liveCount(0)
+    , tree(INITIAL_BOUNDS)
+{
+}
+
+CanvasModel::ItemId CanvasModel::AddItem(const CanvasItem& item) {
+    const ItemId id = (ItemId)items.size();
+    items.push_back(item);
+    itemBounds.push_back(ComputeBounds(item));
+    alive.push_back(true);
+    ++liveCount;
+    tree.Insert(id, itemBounds[id]);
+    RebuildIfOutgrown();
+    return id;
+}
+
+bool CanvasModel::UpdateItem(ItemId id, const CanvasItem& item) {
+    if (!IsValid(id)) return false;
+
+    tree.Remove(id, itemBounds[id]);
+    items[id] = item;
+    itemBounds[id] = ComputeBounds(item);
+    tree.Insert(id, itemBounds[id]);
+    RebuildIfOutgrown();
+    return true;
+}
+
+bool CanvasModel::RemoveItem(ItemId id) {
+    if (!IsValid(id)) return false;
+
+    tree.Remove(id, itemBounds[id]);
+    items[id] = CanvasItem();
+    alive[id] = false;
+    --liveCount;
+    return true;
+}
+
+void CanvasModel::Clear() {
+    items.clear();
+    itemBounds.clear();
+    alive.clear();
+    liveCount = 0;
+    tree.Reset(INITIAL_BOUNDS);
+}
+
+void CanvasModel::Reserve(size_t itemCount) {
+    items.reserve(itemCount);
+    itemBounds.reserve(itemCount);
+    alive.reserve(itemCount);
+}
+
+CanvasModel::ItemId CanvasModel::HitTest(const Point& point, float tolerance) const {
+    std::vector<ItemId> candidates;
+    tree.Query(Rect(point.x - tolerance, point.y - tolerance, 2 * tolerance, 2 * tolerance), candidates);
+
+    // The highest number is drawn last, so it is on top
+    ItemId hit = NO_ITEM;
+    for (ItemId id : candidates) {
+        if ((hit == NO_ITEM || id > hit) && HitsShape(items[id], point, tolerance)) {
+            hit = id;
+        }
+    }
+    return hit;
+}
+
+Rect CanvasModel::ComputeBounds(const CanvasItem& item) {
+    const float halfStroke = std::max(0.0f, item.strokeWidth) / 2;
+    if (item.shape == CanvasShape::Line) {
+        const float left = std::min(item.start.x, item.end.x);
+        const float top = std::min(item.start.y, item.end.y);
+        const Rect box(left, top, std::max(item.start.x, item.end.x) - left, std::max(item.start.y, item.end.y) - top);
+        return Inflate(box, halfStroke);
+    }
+    return Inflate(item.bounds, halfStroke);
+}
+
+void CanvasModel::RebuildIfOutgrown() {
+    if (tree.GetOutsideCount() <= std::max(MIN_OUTSIDE_ITEMS, liveCount / OUTSIDE_SHARE)) return;
+
+    // Twice the extent of the items, centred on them, so growing on in the same direction takes a while to outgrow it
+    const Rect extent = tree.GetItemBounds();
+    const float side = std::max(extent.width, extent.height) * 2;
+    const Point center = extent.Center();
+    tree.Reset(Rect(center.x - side / 2, center.y - side / 2, side, side));
+    for (ItemId id = 0; id < items.size(); ++id) {
+        if (alive[id]) {
+            tree.Insert(id, itemBounds[id]);
+        }
+    }
+}
+
+bool CanvasModel::HitsShape(const CanvasItem& item, const Point& point, float tolerance) {
+    const float reach = tolerance + std::max(0.0f, item.strokeWidth) / 2;
+    switch (item.shape) {
+        case CanvasShape::Line:
+            return DistanceToSegment(point, item.start, item.end) <= reach;
+        case CanvasShape::Ellipse: {
+            const float radiusX = item.bounds.width / 2 + reach;
+            const float radiusY = item.bounds.height / 2 + reach;
+            const Point center = item.bounds.Center();
+            const float x = (point.x - center.x) / radiusX;
+            const float y = (point.y - center.y) / radiusY;
+            return x * x + y * y <= 1.0f;
+        }
+        default:
+            return Inflate(item.bounds, reach).Contains(point);
+    }
+}
+
+} // namespace miko
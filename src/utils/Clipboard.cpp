@@ -0,0 +1,158 @@
+#include "miko/utils/Clipboard.h"
+#include <algorithm>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <cwchar>
+#else
+#include <string>
+#endif
+
+namespace miko {
+
+// UTF-16 units, or bytes without a system clipboard, converted per piece handed out
+static const size_t CLIPBOARD_CHUNK_LENGTH = 64 * 1024;
+
+#ifdef _WIN32
+
+bool SetClipboardText(std::string_view text) {
+    const int wideLength = text.empty() ? 0 : MultiByteToWideChar(CP_UTF8, 0, text.data(), (int)text.size(), nullptr, 0);
+    if (!text.empty() && wideLength <= 0) return false;
+
+    // Windows expects CRLF line breaks
+    size_t addedReturns = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '\n' && (i == 0 || text[i - 1] != '\r')) ++addedReturns;
+    }
+    const size_t finalLength = (size_t)wideLength + addedReturns;
+
+    HGLOBAL memory = GlobalAlloc(GMEM_MOVEABLE, (finalLength + 1) * sizeof(wchar_t));
+    if (!memory) return false;
+    wchar_t* wide = static_cast<wchar_t*>(GlobalLock(memory));
+    if (!wide) {
+        GlobalFree(memory);
+        return false;
+    }
+
+    // Converted into the tail of the block, then spread out in place to make
+    // room for the returns; the write position never passes the read one
+    if (wideLength > 0) {
+        MultiByteToWideChar(CP_UTF8, 0, text.data(), (int)text.size(), wide + addedReturns, wideLength);
+    }
+    size_t write = 0;
+    wchar_t previous = 0;
+    for (size_t read = addedReturns; read < finalLength; ++read) {
+        const wchar_t c = wide[read];
+        if (c == L'\n' && previous != L'\r') {
+            wide[write++] = L'\r';
+        }
+        wide[write++] = c;
+        previous = c;
+    }
+    wide[write] = 0;
+    GlobalUnlock(memory);
+
+    if (!OpenClipboard(nullptr)) {
+        GlobalFree(memory);
+        return false;
+    }
+    EmptyClipboard();
+    // The clipboard owns the memory once it accepts it
+    const bool accepted = SetClipboardData(CF_UNICODETEXT, memory) != nullptr;
+    CloseClipboard();
+    if (!accepted) {
+        GlobalFree(memory);
+    }
+    return accepted;
+}
+
+bool ReadClipboardText(const std::function<void(std::string_view chunk, size_t totalLength)>& onChunk) {
+    if (!IsClipboardFormatAvailable(CF_UNICODETEXT) || !OpenClipboard(nullptr)) return false;
+
+    HANDLE memory = GetClipboardData(CF_UNICODETEXT);
+    const wchar_t* wide = memory ? static_cast<const wchar_t*>(GlobalLock(memory)) : nullptr;
+    if (!wide) {
+        CloseClipboard();
+        return false;
+    }
+    const size_t length = wcsnlen(wide, GlobalSize(memory) / sizeof(wchar_t));
+
+    // Pieces never split a surrogate pair
+    auto pieceLength = [&](size_t position) {
+        size_t count = std::min(CLIPBOARD_CHUNK_LENGTH, length - position);
+        if (position + count < length && IS_HIGH_SURROGATE(wide[position + count - 1])) --count;
+        return count;
+    };
+
+    // The UTF-8 length, less the returns of CRLF pairs, without converting anything
+    size_t totalLength = 0;
+    for (size_t position = 0; position < length;) {
+        const size_t count = pieceLength(position);
+        totalLength += WideCharToMultiByte(CP_UTF8, 0, wide + position, (int)count, nullptr, 0, nullptr, nullptr);
+        position += count;
+    }
+    for (size_t i = 0; i + 1 < length; ++i) {
+        if (wide[i] == L'\r' && wide[i + 1] == L'\n') --totalLength;
+    }
+
+    // A UTF-16 unit takes at most three bytes of UTF-8
+    std::vector<char> chunk(CLIPBOARD_CHUNK_LENGTH * 3);
+    for (size_t position = 0; position < length;) {
+        const size_t count = pieceLength(position);
+        const int bytes = WideCharToMultiByte(CP_UTF8, 0, wide + position, (int)count, chunk.data(), (int)chunk.size(), nullptr, nullptr);
+
+        // Drop the return of each CRLF, looking past the piece for its last byte
+        size_t kept = 0;
+        for (int i = 0; i < bytes; ++i) {
+            const bool last = i + 1 == bytes;
+            const bool lineFeedNext = last ? position + count < length && wide[position + count] == L'\n' : chunk[i + 1] == '\n';
+            if (chunk[i] == '\r' && lineFeedNext) continue;
+            chunk[kept++] = chunk[i];
+        }
+        position += count;
+        if (kept > 0) {
+            onChunk(std::string_view(chunk.data(), kept), totalLength);
+        }
+    }
+
+    GlobalUnlock(memory);
+    CloseClipboard();
+    return true;
+}
+
+#else
+
+// Without a system clipboard the text is kept for this process only
+static std::string& GetLocalClipboard() {
+    static std::string text;
+    return text;
+}
+
+bool SetClipboardText(std::string_view text) {
+    GetLocalClipboard().assign(text);
+    return true;
+}
+
+bool ReadClipboardText(const std::function<void(std::string_view chunk, size_t totalLength)>& onChunk) {
+    const std::string& text = GetLocalClipboard();
+    if (text.empty()) return false;
+
+    for (size_t position = 0; position < text.size();) {
+        size_t count = std::min(CLIPBOARD_CHUNK_LENGTH, text.size() - position);
+        // End on a character boundary rather than inside a UTF-8 sequence
+        while (position + count < text.size() && count > 1 && (static_cast<unsigned char>(text[position + count]) & 0xC0) == 0x80) {
+            --count;
+        }
+        onChunk(std::string_view(text).substr(position, count), text.size());
+        position += count;
+    }
+    return true;
+}
+
+#endif
+
+} // namespace miko
@@ -0,0 +1,299 @@
+#include "miko/utils/DataTable.h"
+#include "miko/utils/ThreadPool.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace miko {
+
+namespace {
+
+// Rows tested per filter task
+const size_t FILTER_BLOCK_SIZE = 64 * 1024;
+// Sorting is split into runs of at least this many rows, one per pool thread
+const size_t MIN_SORT_RUN = 16 * 1024;
+// Text sorting compares keys of 8 bytes up to this far into the text, then the texts themselves
+const size_t MAX_TEXT_KEY_OFFSET = 64;
+
+// Sort keys compare as integers; text keys hold the first 8 bytes of the text
+struct SortKey {
+    uint64_t key;
+    uint32_t row;
+};
+
+// Maps a double to an integer with the same order; NaN, a missing value, sorts last
+uint64_t NumberKey(double value, bool ascending) {
+    if (std::isnan(value)) return UINT64_MAX;
+    if (value == 0.0) value = 0.0; // -0 and 0 are equal
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    bits = (bits >> 63) ? ~bits : bits | (1ull << 63);
+    // Infinities map well inside the range, so neither order reaches the NaN key
+    return ascending ? bits : ~bits;
+}
+
+uint64_t TextKey(std::string_view text, bool ascending) {
+    uint64_t key = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        key = (key << 8) | (i < text.size() ? static_cast<unsigned char>(text[i]) : 0);
+    }
+    return ascending ? key : ~key;
+}
+
+/**
+ * Text keys only hold 8 bytes, so rows whose keys tie are put in order
+ * afterwards: each run of equal keys is keyed again on the next 8 bytes
+ * and sorted, down to MAX_TEXT_KEY_OFFSET, where the full texts are
+ * compared. This reads each tied text once per level rather than once
+ * per comparison. The keys of [first, last) hold the bytes at offset.
+ */
+void SortTextTies(const DataTable& table, size_t column, bool ascending, SortKey* first, SortKey* last, size_t offset) {
+    for (SortKey* start = first; start < last;) {
+        SortKey* end = start + 1;
+        while (end < last && end->key == start->key) {
+            ++end;
+        }
+        if (end - start > 1) {
+            const size_t next = offset + 8;
+            bool longer = false;
+            if (next < MAX_TEXT_KEY_OFFSET) {
+                for (SortKey* key = start; key < end; ++key) {
+                    const std::string_view text = table.GetText(key->row, column);
+                    key->key = TextKey(text.substr(std::min(next, text.size())), ascending);
+                    longer = longer || text.size() > next;
+                }
+            }
+            if (longer) {
+                std::sort(start, end, [](const SortKey& a, const SortKey& b) {
+                    return a.key != b.key ? a.key < b.key : a.row < b.row;
+                });
+                SortTextTies(table, column, ascending, start, end, next);
+            } else {
+                // Texts this short that still tie are almost always equal
+                std::sort(start, end, [&](const SortKey& a, const SortKey& b) {
+                    const int order = table.CompareRows(column, a.row, b.row);
+                    if (order != 0) return ascending ? order < 0 : order > 0;
+                    return a.row < b.row;
+                });
+            }
+        }
+        start = end;
+    }
+}
+
+template<typename Less>
+void ParallelSort(ThreadPool& pool, std::vector<SortKey>& keys, const Less& less) {
+    const size_t runCount = std::clamp<size_t>(keys.size() / MIN_SORT_RUN, 1, pool.GetThreadCount() + 1);
+    std::vector<size_t> bounds(runCount + 1);
+    for (size_t i = 0; i <= runCount; ++i) {
+        bounds[i] = keys.size() * i / runCount;
+    }
+    pool.ParallelFor(runCount, [&](size_t run) {
+        std::sort(keys.begin() + bounds[run], keys.begin() + bounds[run + 1], less);
+    });
+
+    // Merge neighbouring runs pairwise until one is left
+    std::vector<SortKey> merged(keys.size());
+    while (bounds.size() > 2) {
+        const size_t runs = bounds.size() - 1;
+        pool.ParallelFor((runs + 1) / 2, [&](size_t pair) {
+            const size_t first = bounds[pair * 2];
+            const size_t middle = bounds[pair * 2 + 1];
+            const size_t last = bounds[std::min(pair * 2 + 2, runs)];
+            std::merge(keys.begin() + first, keys.begin() + middle, keys.begin() + middle, keys.begin() + last,
+                       merged.begin() + first, less);
+        });
+        std::vector<size_t> mergedBounds;
+        for (size_t i = 0; i < runs; i += 2) {
+            mergedBounds.push_back(bounds[i]);
+        }
+        mergedBounds.push_back(bounds[runs]);
+        bounds.swap(mergedBounds);
+        keys.swap(merged);
+    }
+}
+
+void SortRows(ThreadPool& pool, const DataTable& table, size_t column, bool ascending, std::vector<uint32_t>& rows) {
+    std::vector<SortKey> keys(rows.size());
+    const bool text = table.GetColumnType(column) == DataTable::ColumnType::Text;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        keys[i].row = rows[i];
+        keys[i].key = text ? TextKey(table.GetText(rows[i], column), ascending)
+                           : NumberKey(table.GetNumber(rows[i], column), ascending);
+    }
+
+    // Ties fall back to the row number, which keeps equal values in table order
+    ParallelSort(pool, keys, [](const SortKey& a, const SortKey& b) {
+        return a.key != b.key ? a.key < b.key : a.row < b.row;
+    });
+
+    if (text) {
+        SortTextTies(table, column, ascending, keys.data(), keys.data() + keys.size(), 0);
+    }
+
+    for (size_t i = 0; i < rows.size(); ++i) {
+        rows[i] = keys[i].row;
+    }
+}
+
+} // namespace
+
+bool DataTable::AcceptRowCount(size_t count) {
+    if (columns.empty()) {
+        rowCount = count;
+        return true;
+    }
+    return count == rowCount;
+}
+
+size_t DataTable::AddNumberColumn(std::string name, std::vector<double> values, int decimals) {
+    if (!AcceptRowCount(values.size())) return SIZE_MAX;
+
+    Column column;
+    column.name = std::move(name);
+    column.type = ColumnType::Number;
+    column.decimals = std::clamp(decimals, 0, 17);
+    column.numbers = std::move(values);
+    columns.push_back(std::move(column));
+    return columns.size() - 1;
+}
+
+size_t DataTable::AddTextColumn(std::string name, const std::vector<std::string>& values) {
+    if (!AcceptRowCount(values.size())) return SIZE_MAX;
+
+    Column column;
+    column.name = std::move(name);
+    column.type = ColumnType::Text;
+    column.decimals = 0;
+    size_t totalLength = 0;
+    for (const std::string& value : values) {
+        totalLength += value.size();
+    }
+    column.text.reserve(totalLength);
+    column.textOffsets.reserve(values.size() + 1);
+    column.textOffsets.push_back(0);
+    for (const std::string& value : values) {
+        column.text.append(value);
+        column.textOffsets.push_back(column.text.size());
+    }
+    columns.push_back(std::move(column));
+    return columns.size() - 1;
+}
+
+std::string_view DataTable::GetText(size_t row, size_t column) const {
+    const Column& data = columns[column];
+    const size_t start = data.textOffsets[row];
+    return std::string_view(data.text.data() + start, data.textOffsets[row + 1] - start);
+}
+
+std::string_view DataTable::FormatCell(size_t row, size_t column, std::string& scratch) const {
+    const Column& data = columns[column];
+    if (data.type == ColumnType::Text) {
+        return GetText(row, column);
+    }
+
+    // NaN is a missing value and shows as an empty cell
+    const double value = data.numbers[row];
+    if (std::isnan(value)) return std::string_view();
+
+    char buffer[64];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed, data.decimals);
+    if (result.ec != std::errc()) {
+        // Too long in fixed notation
+        result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general, data.decimals);
+    }
+    scratch.assign(buffer, result.ptr);
+    return scratch;
+}
+
+int DataTable::CompareRows(size_t column, size_t a, size_t b) const {
+    const Column& data = columns[column];
+    if (data.type == ColumnType::Text) {
+        return GetText(a, column).compare(GetText(b, column));
+    }
+
+    const double first = data.numbers[a];
+    const double second = data.numbers[b];
+    if (std::isnan(first) || std::isnan(second)) {
+        return (int)std::isnan(first) - (int)std::isnan(second);
+    }
+    return first < second ? -1 : (second < first ? 1 : 0);
+}
+
+void BackgroundRowOrder::Start(std::shared_ptr<const DataTable> table, RowFilter filter,
+                               size_t sortColumn, bool ascending) {
+    Cancel();
+    if (!table) return;
+
+    state = std::make_shared<State>();
+    ThreadPool::GetShared().Submit([state = state, table = std::move(table), filter = std::move(filter), sortColumn, ascending]() {
+        Run(state, *table, filter, sortColumn, ascending);
+        state->finished = true;
+    });
+}
+
+void BackgroundRowOrder::Cancel() {
+    if (!state) return;
+
+    // The job holds its own reference to the table, so there is nothing to wait for
+    state->cancelled = true;
+    state.reset();
+}
+
+bool BackgroundRowOrder::TakeResult(std::shared_ptr<const RowIndex>& rows) {
+    if (!state || !state->finished) return false;
+
+    {
+        std::lock_guard<std::mutex> lock(state->resultMutex);
+        rows = std::move(state->result);
+    }
+    state.reset();
+    return true;
+}
+
+void BackgroundRowOrder::Run(const std::shared_ptr<State>& state, const DataTable& table, const RowFilter& filter,
+                             size_t sortColumn, bool ascending) {
+    ThreadPool& pool = ThreadPool::GetShared();
+    const size_t rowCount = std::min<size_t>(table.GetRowCount(), UINT32_MAX);
+    auto rows = std::make_shared<RowIndex>();
+
+    if (filter) {
+        // Blocks are filtered in parallel and joined in table order
+        const size_t blockCount = (rowCount + FILTER_BLOCK_SIZE - 1) / FILTER_BLOCK_SIZE;
+        std::vector<RowIndex> kept(blockCount);
+        pool.ParallelFor(blockCount, [&](size_t block) {
+            if (state->cancelled) return;
+            const size_t end = std::min(rowCount, (block + 1) * FILTER_BLOCK_SIZE);
+            for (size_t row = block * FILTER_BLOCK_SIZE; row < end; ++row) {
+                if (filter(table, row)) {
+                    kept[block].push_back((uint32_t)row);
+                }
+            }
+        });
+        if (state->cancelled) return;
+
+        size_t keptCount = 0;
+        for (const RowIndex& block : kept) {
+            keptCount += block.size();
+        }
+        rows->reserve(keptCount);
+        for (const RowIndex& block : kept) {
+            rows->insert(rows->end(), block.begin(), block.end());
+        }
+    } else {
+        rows->resize(rowCount);
+        std::iota(rows->begin(), rows->end(), 0u);
+    }
+
+    if (sortColumn < table.GetColumnCount() && !state->cancelled) {
+        SortRows(pool, table, sortColumn, ascending, *rows);
+    }
+    if (state->cancelled) return;
+
+    std::lock_guard<std::mutex> lock(state->resultMutex);
+    state->result = std::move(rows);
+}
+
+} // namespace miko
@@ -0,0 +1,125 @@
+#include "miko/utils/FrameArena.h"
+#include <algorithm>
+
+namespace miko {
+
+FrameArena::FrameArena(size_t initialCapacity)
+    : currentBlock(0)
+    , currentOffset(0)
+    , peakBytesUsed(0)
+{
+    blocks.reserve(8);
+    AddBlock(std::max<size_t>(initialCapacity, 256));
+    currentBlock = 0;
+}
+
+FrameArena::~FrameArena() {
+    ReleaseBlocks();
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment) {
+    if (size == 0) size = 1;
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        alignment = alignof(std::max_align_t);
+    }
+
+    while (true) {
+        Block& block = blocks[currentBlock];
+        const uintptr_t base = reinterpret_cast<uintptr_t>(block.data);
+        const uintptr_t aligned = (base + currentOffset + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+        const size_t newOffset = static_cast<size_t>(aligned - base) + size;
+
+        if (newOffset <= block.size) {
+            currentOffset = newOffset;
+            peakBytesUsed = std::max(peakBytesUsed, GetBytesUsed());
+            return reinterpret_cast<void*>(aligned);
+        }
+
+        // Move on to the next retained block if it is large enough, otherwise grow
+        if (currentBlock + 1 < blocks.size() && blocks[currentBlock + 1].size >= size + alignment) {
+            ++currentBlock;
+            currentOffset = 0;
+            continue;
+        }
+
+        AddBlock(size + alignment);
+        currentOffset = 0;
+    }
+}
+
+std::string_view FrameArena::CopyString(std::string_view text) {
+    if (text.empty()) return std::string_view();
+
+    char* data = AllocateArray<char>(text.size());
+    std::memcpy(data, text.data(), text.size());
+    return std::string_view(data, text.size());
+}
+
+void FrameArena::Rewind(const Marker& marker) {
+    if (marker.block < blocks.size()) {
+        currentBlock = marker.block;
+        currentOffset = marker.offset;
+    }
+}
+
+void FrameArena::Reset() {
+    // Coalesce into a single block sized for the whole frame so the next
+    // frame never has to spill into a new block
+    if (blocks.size() > 1) {
+        size_t totalSize = 0;
+        for (const auto& block : blocks) {
+            totalSize += block.size;
+        }
+        ReleaseBlocks();
+        blocks.push_back(Block{ new char[totalSize], totalSize });
+    }
+
+    currentBlock = 0;
+    currentOffset = 0;
+}
+
+size_t FrameArena::GetBytesUsed() const {
+    size_t used = currentOffset;
+    for (size_t i = 0; i < currentBlock; ++i) {
+        used += blocks[i].size;
+    }
+    return used;
+}
+
+size_t FrameArena::GetCapacity() const {
+    size_t capacity = 0;
+    for (const auto& block : blocks) {
+        capacity += block.size;
+    }
+    return capacity;
+}
+
+void FrameArena::AddBlock(size_t minimumSize) {
+    // Grow geometrically so a frame with a new peak spills only a few times
+    size_t size = minimumSize;
+    if (!blocks.empty()) {
+        size = std::max(size, blocks[currentBlock].size * 2);
+    }
+
+    Block block{ new char[size], size };
+    if (blocks.empty()) {
+        blocks.push_back(block);
+    } else {
+        blocks.insert(blocks.begin() + currentBlock + 1, block);
+        ++currentBlock;
+    }
+}
+
+void FrameArena::ReleaseBlocks() {
+    for (auto& block : blocks) {
+        delete[] block.data;
+    }
+    blocks.clear();
+}
+
+FrameArena& GetFrameArena() {
+    static thread_local FrameArena arena;
+    return arena;
+}
+
+} // namespace miko
@@ -0,0 +1,501 @@
+#include "miko/utils/Geometry.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__)
+#define MIKO_GEOMETRY_AVX2 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIKO_GEOMETRY_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define MIKO_GEOMETRY_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace miko {
+
+Matrix3x2 Matrix3x2::Rotation(float degrees, const Point& center) {
+    const float radians = degrees * (3.14159265359f / 180.0f);
+    const float c = std::cos(radians);
+    const float s = std::sin(radians);
+    return Matrix3x2::Translation(-center.x, -center.y) *
+           Matrix3x2(c, s, -s, c, 0.0f, 0.0f) *
+           Matrix3x2::Translation(center.x, center.y);
+}
+
+// Scalar kernels, also used for the tails of the vector loops
+
+static void IntersectsScalar(const RectArrayView& rects, const Rect& query, uint8_t* result, size_t begin) {
+    const float queryRight = query.x + query.width;
+    const float queryBottom = query.y + query.height;
+    for (size_t i = begin; i < rects.count; ++i) {
+        result[i] = (query.x <= rects.x[i] + rects.width[i] && queryRight >= rects.x[i] &&
+                     query.y <= rects.y[i] + rects.height[i] && queryBottom >= rects.y[i]) ? 1 : 0;
+    }
+}
+
+static void ContainsScalar(const RectArrayView& rects, const Point& point, uint8_t* result, size_t begin) {
+    for (size_t i = begin; i < rects.count; ++i) {
+        result[i] = (point.x >= rects.x[i] && point.x <= rects.x[i] + rects.width[i] &&
+                     point.y >= rects.y[i] && point.y <= rects.y[i] + rects.height[i]) ? 1 : 0;
+    }
+}
+
+static void IntersectScalar(const RectArrayView& rects, const Rect& clip, const RectArrayOutput& output, size_t begin) {
+    const float clipRight = clip.x + clip.width;
+    const float clipBottom = clip.y + clip.height;
+    for (size_t i = begin; i < rects.count; ++i) {
+        const float left = std::max(rects.x[i], clip.x);
+        const float top = std::max(rects.y[i], clip.y);
+        const float right = std::min(rects.x[i] + rects.width[i], clipRight);
+        const float bottom = std::min(rects.y[i] + rects.height[i], clipBottom);
+        output.x[i] = left;
+        output.y[i] = top;
+        output.width[i] = std::max(0.0f, right - left);
+        output.height[i] = std::max(0.0f, bottom - top);
+    }
+}
+
+static void TransformPointsScalar(const Matrix3x2& m, const float* xs, const float* ys,
+                                  float* outXs, float* outYs, size_t begin, size_t count) {
+    for (size_t i = begin; i < count; ++i) {
+        const float x = xs[i];
+        const float y = ys[i];
+        outXs[i] = x * m.m11 + y * m.m21 + m.dx;
+        outYs[i] = x * m.m12 + y * m.m22 + m.dy;
+    }
+}
+
+#if MIKO_GEOMETRY_AVX2
+
+static inline void StoreMask8(int mask, uint8_t* result) {
+    for (int lane = 0; lane < 8; ++lane) {
+        result[lane] = static_cast<uint8_t>((mask >> lane) & 1);
+    }
+}
+
+void BatchIntersects(const RectArrayView& rects, const Rect& query, uint8_t* result) {
+    const __m256 qLeft = _mm256_set1_ps(query.x);
+    const __m256 qTop = _mm256_set1_ps(query.y);
+    const __m256 qRight = _mm256_set1_ps(query.x + query.width);
+    const __m256 qBottom = _mm256_set1_ps(query.y + query.height);
+    size_t i = 0;
+    for (; i + 8 <= rects.count; i += 8) {
+        const __m256 x = _mm256_loadu_ps(rects.x + i);
+        const __m256 y = _mm256_loadu_ps(rects.y + i);
+        const __m256 right = _mm256_add_ps(x, _mm256_loadu_ps(rects.width + i));
+        const __m256 bottom = _mm256_add_ps(y, _mm256_loadu_ps(rects.height + i));
+        __m256 hit = _mm256_and_ps(_mm256_cmp_ps(qLeft, right, _CMP_LE_OQ), _mm256_cmp_ps(qRight, x, _CMP_GE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(qTop, bottom, _CMP_LE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(qBottom, y, _CMP_GE_OQ));
+        StoreMask8(_mm256_movemask_ps(hit), result + i);
+    }
+    IntersectsScalar(rects, query, result, i);
+}
+
+void BatchContains(const RectArrayView& rects, const Point& point, uint8_t* result) {
+    const __m256 px = _mm256_set1_ps(point.x);
+    const __m256 py = _mm256_set1_ps(point.y);
+    size_t i = 0;
+    for (; i + 8 <= rects.count; i += 8) {
+        const __m256 x = _mm256_loadu_ps(rects.x + i);
+        const __m256 y = _mm256_loadu_ps(rects.y + i);
+        const __m256 right = _mm256_add_ps(x, _mm256_loadu_ps(rects.width + i));
+        const __m256 bottom = _mm256_add_ps(y, _mm256_loadu_ps(rects.height + i));
+        __m256 hit = _mm256_and_ps(_mm256_cmp_ps(px, x, _CMP_GE_OQ), _mm256_cmp_ps(px, right, _CMP_LE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(py, y, _CMP_GE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(py, bottom, _CMP_LE_OQ));
+        StoreMask8(_mm256_movemask_ps(hit), result + i);
+    }
+    ContainsScalar(rects, point, result, i);
+}
+
+void BatchIntersect(const RectArrayView& rects, const Rect& clip, const RectArrayOutput& output) {
+    const __m256 cLeft = _mm256_set1_ps(clip.x);
+    const __m256 cTop = _mm256_set1_ps(clip.y);
+    const __m256 cRight = _mm256_set1_ps(clip.x + clip.width);
+    const __m256 cBottom = _mm256_set1_ps(clip.y + clip.height);
+    const __m256 zero = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= rects.count; i += 8) {
+        const __m256 x = _mm256_loadu_ps(rects.x + i);
+        const __m256 y = _mm256_loadu_ps(rects.y + i);
+        const __m256 right = _mm256_min_ps(_mm256_add_ps(x, _mm256_loadu_ps(rects.width + i)), cRight);
+        const __m256 bottom = _mm256_min_ps(_mm256_add_ps(y, _mm256_loadu_ps(rects.height + i)), cBottom);
+        const __m256 left = _mm256_max_ps(x, cLeft);
+        const __m256 top = _mm256_max_ps(y, cTop);
+        _mm256_storeu_ps(output.x + i, left);
+        _mm256_storeu_ps(output.y + i, top);
+        _mm256_storeu_ps(output.width + i, _mm256_max_ps(zero, _mm256_sub_ps(right, left)));
+        _mm256_storeu_ps(output.height + i, _mm256_max_ps(zero, _mm256_sub_ps(bottom, top)));
+    }
+    IntersectScalar(rects, clip, output, i);
+}
+
+Rect BatchUnion(const RectArrayView& rects) {
+    if (rects.count == 0) return Rect();
+
+    float left = rects.x[0];
+    float top = rects.y[0];
+    float right = rects.x[0] + rects.width[0];
+    float bottom = rects.y[0] + rects.height[0];
+    size_t i = 0;
+    if (rects.count >= 8) {
+        __m256 minX = _mm256_loadu_ps(rects.x);
+        __m256 minY = _mm256_loadu_ps(rects.y);
+        __m256 maxR = _mm256_add_ps(minX, _mm256_loadu_ps(rects.width));
+        __m256 maxB = _mm256_add_ps(minY, _mm256_loadu_ps(rects.height));
+        for (i = 8; i + 8 <= rects.count; i += 8) {
+            const __m256 x = _mm256_loadu_ps(rects.x + i);
+            const __m256 y = _mm256_loadu_ps(rects.y + i);
+            minX = _mm256_min_ps(minX, x);
+            minY = _mm256_min_ps(minY, y);
+            maxR = _mm256_max_ps(maxR, _mm256_add_ps(x, _mm256_loadu_ps(rects.width + i)));
+            maxB = _mm256_max_ps(maxB, _mm256_add_ps(y, _mm256_loadu_ps(rects.height + i)));
+        }
+        alignas(32) float lanes[4][8];
+        _mm256_store_ps(lanes[0], minX);
+        _mm256_store_ps(lanes[1], minY);
+        _mm256_store_ps(lanes[2], maxR);
+        _mm256_store_ps(lanes[3], maxB);
+        for (int lane = 0; lane < 8; ++lane) {
+            left = std::min(left, lanes[0][lane]);
+            top = std::min(top, lanes[1][lane]);
+            right = std::max(right, lanes[2][lane]);
+            bottom = std::max(bottom, lanes[3][lane]);
+        }
+    }
+    for (; i < rects.count; ++i) {
+        left = std::min(left, rects.x[i]);
+        top = std::min(top, rects.y[i]);
+        right = std::max(right, rects.x[i] + rects.width[i]);
+        bottom = std::max(bottom, rects.y[i] + rects.height[i]);
+    }
+    return Rect(left, top, right - left, bottom - top);
+}
+
+void TransformPoints(const Matrix3x2& matrix, const float* xs, const float* ys,
+                     float* outXs, float* outYs, size_t count) {
+    const __m256 m11 = _mm256_set1_ps(matrix.m11);
+    const __m256 m12 = _mm256_set1_ps(matrix.m12);
+    const __m256 m21 = _mm256_set1_ps(matrix.m21);
+    const __m256 m22 = _mm256_set1_ps(matrix.m22);
+    const __m256 dx = _mm256_set1_ps(matrix.dx);
+    const __m256 dy = _mm256_set1_ps(matrix.dy);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 x = _mm256_loadu_ps(xs + i);
+        const __m256 y = _mm256_loadu_ps(ys + i);
+        const __m256 ox = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, m11), _mm256_mul_ps(y, m21)), dx);
+        const __m256 oy = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, m12), _mm256_mul_ps(y, m22)), dy);
+        _mm256_storeu_ps(outXs + i, ox);
+        _mm256_storeu_ps(outYs + i, oy);
+    }
+    TransformPointsScalar(matrix, xs, ys, outXs, outYs, i, count);
+}
+
+const char* GetGeometryKernelName() {
+    return "AVX2";
+}
+
+#elif MIKO_GEOMETRY_SSE2
+
+static inline void StoreMask4(int mask, uint8_t* result) {
+    result[0] = static_cast<uint8_t>(mask & 1);
+    result[1] = static_cast<uint8_t>((mask >> 1) & 1);
+    result[2] = static_cast<uint8_t>((mask >> 2) & 1);
+    result[3] = static_cast<uint8_t>((mask >> 3) & 1);
+}
+
+void BatchIntersects(const RectArrayView& rects, const Rect& query, uint8_t* result) {
+    const __m128 qLeft = _mm_set1_ps(query.x);
+    const __m128 qTop = _mm_set1_ps(query.y);
+    const __m128 qRight = _mm_set1_ps(query.x + query.width);
+    const __m128 qBottom = _mm_set1_ps(query.y + query.height);
+    size_t i = 0;
+    for (; i + 4 <= rects.count; i += 4) {
+        const __m128 x = _mm_loadu_ps(rects.x + i);
+        const __m128 y = _mm_loadu_ps(rects.y + i);
+        const __m128 right = _mm_add_ps(x, _mm_loadu_ps(rects.width + i));
+        const __m128 bottom = _mm_add_ps(y, _mm_loadu_ps(rects.height + i));
+        __m128 hit = _mm_and_ps(_mm_cmple_ps(qLeft, right), _mm_cmpge_ps(qRight, x));
+        hit = _mm_and_ps(hit, _mm_cmple_ps(qTop, bottom));
+        hit = _mm_and_ps(hit, _mm_cmpge_ps(qBottom, y));
+        StoreMask4(_mm_movemask_ps(hit), result + i);
+    }
+    IntersectsScalar(rects, query, result, i);
+}
+
+void BatchContains(const RectArrayView& rects, const Point& point, uint8_t* result) {
+    const __m128 px = _mm_set1_ps(point.x);
+    const __m128 py = _mm_set1_ps(point.y);
+    size_t i = 0;
+    for (; i + 4 <= rects.count; i += 4) {
+        const __m128 x = _mm_loadu_ps(rects.x + i);
+        const __m128 y = _mm_loadu_ps(rects.y + i);
+        const __m128 right = _mm_add_ps(x, _mm_loadu_ps(rects.width + i));
+        const __m128 bottom = _mm_add_ps(y, _mm_loadu_ps(rects.height + i));
+        __m128 hit = _mm_and_ps(_mm_cmpge_ps(px, x), _mm_cmple_ps(px, right));
+        hit = _mm_and_ps(hit, _mm_cmpge_ps(py, y));
+        hit = _mm_and_ps(hit, _mm_cmple_ps(py, bottom));
+        StoreMask4(_mm_movemask_ps(hit), result + i);
+    }
+    ContainsScalar(rects, point, result, i);
+}
+
+void BatchIntersect(const RectArrayView& rects, const Rect& clip, const RectArrayOutput& output) {
+    const __m128 cLeft = _mm_set1_ps(clip.x);
+    const __m128 cTop = _mm_set1_ps(clip.y);
+    const __m128 cRight = _mm_set1_ps(clip.x + clip.width);
+    const __m128 cBottom = _mm_set1_ps(clip.y + clip.height);
+    const __m128 zero = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 4 <= rects.count; i += 4) {
+        const __m128 x = _mm_loadu_ps(rects.x + i);
+        const __m128 y = _mm_loadu_ps(rects.y + i);
+        const __m128 right = _mm_min_ps(_mm_add_ps(x, _mm_loadu_ps(rects.width + i)), cRight);
+        const __m128 bottom = _mm_min_ps(_mm_add_ps(y, _mm_loadu_ps(rects.height + i)), cBottom);
+        const __m128 left = _mm_max_ps(x, cLeft);
+        const __m128 top = _mm_max_ps(y, cTop);
+        _mm_storeu_ps(output.x + i, left);
+        _mm_storeu_ps(output.y + i, top);
+        _mm_storeu_ps(output.width + i, _mm_max_ps(zero, _mm_sub_ps(right, left)));
+        _mm_storeu_ps(output.height + i, _mm_max_ps(zero, _mm_sub_ps(bottom, top)));
+    }
+    IntersectScalar(rects, clip, output, i);
+}
+
+Rect BatchUnion(const RectArrayView& rects) {
+    if (rects.count == 0) return Rect();
+
+    float left = rects.x[0];
+    float top = rects.y[0];
+    float right = rects.x[0] + rects.width[0];
+    float bottom = rects.y[0] + rects.height[0];
+    size_t i = 0;
+    if (rects.count >= 4) {
+        __m128 minX = _mm_loadu_ps(rects.x);
+        __m128 minY = _mm_loadu_ps(rects.y);
+        __m128 maxR = _mm_add_ps(minX, _mm_loadu_ps(rects.width));
+        __m128 maxB = _mm_add_ps(minY, _mm_loadu_ps(rects.height));
+        for (i = 4; i + 4 <= rects.count; i += 4) {
+            const __m128 x = _mm_loadu_ps(rects.x + i);
+            const __m128 y = _mm_loadu_ps(rects.y + i);
+            minX = _mm_min_ps(minX, x);
+            minY = _mm_min_ps(minY, y);
+            maxR = _mm_max_ps(maxR, _mm_add_ps(x, _mm_loadu_ps(rects.width + i)));
+            maxB = _mm_max_ps(maxB, _mm_add_ps(y, _mm_loadu_ps(rects.height + i)));
+        }
+        alignas(16) float lanes[4][4];
+        _mm_store_ps(lanes[0], minX);
+        _mm_store_ps(lanes[1], minY);
+        _mm_store_ps(lanes[2], maxR);
+        _mm_store_ps(lanes[3], maxB);
+        for (int lane = 0; lane < 4; ++lane) {
+            left = std::min(left, lanes[0][lane]);
+            top = std::min(top, lanes[1][lane]);
+            right = std::max(right, lanes[2][lane]);
+            bottom = std::max(bottom, lanes[3][lane]);
+        }
+    }
+    for (; i < rects.count; ++i) {
+        left = std::min(left, rects.x[i]);
+        top = std::min(top, rects.y[i]);
+        right = std::max(right, rects.x[i] + rects.width[i]);
+        bottom = std::max(bottom, rects.y[i] + rects.height[i]);
+    }
+    return Rect(left, top, right - left, bottom - top);
+}
+
+void TransformPoints(const Matrix3x2& matrix, const float* xs, const float* ys,
+                     float* outXs, float* outYs, size_t count) {
+    const __m128 m11 = _mm_set1_ps(matrix.m11);
+    const __m128 m12 = _mm_set1_ps(matrix.m12);
+    const __m128 m21 = _mm_set1_ps(matrix.m21);
+    const __m128 m22 = _mm_set1_ps(matrix.m22);
+    const __m128 dx = _mm_set1_ps(matrix.dx);
+    const __m128 dy = _mm_set1_ps(matrix.dy);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 x = _mm_loadu_ps(xs + i);
+        const __m128 y = _mm_loadu_ps(ys + i);
+        const __m128 ox = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m11), _mm_mul_ps(y, m21)), dx);
+        const __m128 oy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m12), _mm_mul_ps(y, m22)), dy);
+        _mm_storeu_ps(outXs + i, ox);
+        _mm_storeu_ps(outYs + i, oy);
+    }
+    TransformPointsScalar(matrix, xs, ys, outXs, outYs, i, count);
+}
+
+const char* GetGeometryKernelName() {
+    return "SSE2";
+}
+
+#elif MIKO_GEOMETRY_NEON
+
+static inline void StoreMask4(uint32x4_t mask, uint8_t* result) {
+    result[0] = static_cast<uint8_t>(vgetq_lane_u32(mask, 0) & 1);
+    result[1] = static_cast<uint8_t>(vgetq_lane_u32(mask, 1) & 1);
+    result[2] = static_cast<uint8_t>(vgetq_lane_u32(mask, 2) & 1);
+    result[3] = static_cast<uint8_t>(vgetq_lane_u32(mask, 3) & 1);
+}
+
+void BatchIntersects(const RectArrayView& rects, const Rect& query, uint8_t* result) {
+    const float32x4_t qLeft = vdupq_n_f32(query.x);
+    const float32x4_t qTop = vdupq_n_f32(query.y);
+    const float32x4_t qRight = vdupq_n_f32(query.x + query.width);
+    const float32x4_t qBottom = vdupq_n_f32(query.y + query.height);
+    size_t i = 0;
+    for (; i + 4 <= rects.count; i += 4) {
+        const float32x4_t x = vld1q_f32(rects.x + i);
+        const float32x4_t y = vld1q_f32(rects.y + i);
+        const float32x4_t right = vaddq_f32(x, vld1q_f32(rects.width + i));
+        const float32x4_t bottom = vaddq_f32(y, vld1q_f32(rects.height + i));
+        uint32x4_t hit = vandq_u32(vcleq_f32(qLeft, right), vcgeq_f32(qRight, x));
+        hit = vandq_u32(hit, vcleq_f32(qTop, bottom));
+        hit = vandq_u32(hit, vcgeq_f32(qBottom, y));
+        StoreMask4(hit, result + i);
+    }
+    IntersectsScalar(rects, query, result, i);
+}
+
+void BatchContains(const RectArrayView& rects, const Point& point, uint8_t* result) {
+    const float32x4_t px = vdupq_n_f32(point.x);
+    const float32x4_t py = vdupq_n_f32(point.y);
+    size_t i = 0;
+    for (; i + 4 <= rects.count; i += 4) {
+        const float32x4_t x = vld1q_f32(rects.x + i);
+        const float32x4_t y = vld1q_f32(rects.y + i);
+        const float32x4_t right = vaddq_f32(x, vld1q_f32(rects.width + i));
+        const float32x4_t bottom = vaddq_f32(y, vld1q_f32(rects.height + i));
+        uint32x4_t hit = vandq_u32(vcgeq_f32(px, x), vcleq_f32(px, right));
+        hit = vandq_u32(hit, vcgeq_f32(py, y));
+        hit = vandq_u32(hit, vcleq_f32(py, bottom));
+        StoreMask4(hit, result + i);
+    }
+    ContainsScalar(rects, point, result, i);
+}
+
+void BatchIntersect(const RectArrayView& rects, const Rect& clip, const RectArrayOutput& output) {
+    const float32x4_t cLeft = vdupq_n_f32(clip.x);
+    const float32x4_t cTop = vdupq_n_f32(clip.y);
+    const float32x4_t cRight = vdupq_n_f32(clip.x + clip.width);
+    const float32x4_t cBottom = vdupq_n_f32(clip.y + clip.height);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 4 <= rects.count; i += 4) {
+        const float32x4_t x = vld1q_f32(rects.x + i);
+        const float32x4_t y = vld1q_f32(rects.y + i);
+        const float32x4_t right = vminq_f32(vaddq_f32(x, vld1q_f32(rects.width + i)), cRight);
+        const float32x4_t bottom = vminq_f32(vaddq_f32(y, vld1q_f32(rects.height + i)), cBottom);
+        const float32x4_t left = vmaxq_f32(x, cLeft);
+        const float32x4_t top = vmaxq_f32(y, cTop);
+        vst1q_f32(output.x + i, left);
+        vst1q_f32(output.y + i, top);
+        vst1q_f32(output.width + i, vmaxq_f32(zero, vsubq_f32(right, left)));
+        vst1q_f32(output.height + i, vmaxq_f32(zero, vsubq_f32(bottom, top)));
+    }
+    IntersectScalar(rects, clip, output, i);
+}
+
+Rect BatchUnion(const RectArrayView& rects) {
+    if (rects.count == 0) return Rect();
+
+    float left = rects.x[0];
+    float top = rects.y[0];
+    float right = rects.x[0] + rects.width[0];
+    float bottom = rects.y[0] + rects.height[0];
+    size_t i = 0;
+    if (rects.count >= 4) {
+        float32x4_t minX = vld1q_f32(rects.x);
+        float32x4_t minY = vld1q_f32(rects.y);
+        float32x4_t maxR = vaddq_f32(minX, vld1q_f32(rects.width));
+        float32x4_t maxB = vaddq_f32(minY, vld1q_f32(rects.height));
+        for (i = 4; i + 4 <= rects.count; i += 4) {
+            const float32x4_t x = vld1q_f32(rects.x + i);
+            const float32x4_t y = vld1q_f32(rects.y + i);
+            minX = vminq_f32(minX, x);
+            minY = vminq_f32(minY, y);
+            maxR = vmaxq_f32(maxR, vaddq_f32(x, vld1q_f32(rects.width + i)));
+            maxB = vmaxq_f32(maxB, vaddq_f32(y, vld1q_f32(rects.height + i)));
+        }
+        float lanes[4][4];
+        vst1q_f32(lanes[0], minX);
+        vst1q_f32(lanes[1], minY);
+        vst1q_f32(lanes[2], maxR);
+        vst1q_f32(lanes[3], maxB);
+        for (int lane = 0; lane < 4; ++lane) {
+            left = std::min(left, lanes[0][lane]);
+            top = std::min(top, lanes[1][lane]);
+            right = std::max(right, lanes[2][lane]);
+            bottom = std::max(bottom, lanes[3][lane]);
+        }
+    }
+    for (; i < rects.count; ++i) {
+        left = std::min(left, rects.x[i]);
+        top = std::min(top, rects.y[i]);
+        right = std::max(right, rects.x[i] + rects.width[i]);
+        bottom = std::max(bottom, rects.y[i] + rects.height[i]);
+    }
+    return Rect(left, top, right - left, bottom - top);
+}
+
+void TransformPoints(const Matrix3x2& matrix, const float* xs, const float* ys,
+                     float* outXs, float* outYs, size_t count) {
+    const float32x4_t dx = vdupq_n_f32(matrix.dx);
+    const float32x4_t dy = vdupq_n_f32(matrix.dy);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float32x4_t x = vld1q_f32(xs + i);
+        const float32x4_t y = vld1q_f32(ys + i);
+        float32x4_t ox = vmlaq_n_f32(dx, x, matrix.m11);
+        ox = vmlaq_n_f32(ox, y, matrix.m21);
+        float32x4_t oy = vmlaq_n_f32(dy, x, matrix.m12);
+        oy = vmlaq_n_f32(oy, y, matrix.m22);
+        vst1q_f32(outXs + i, ox);
+        vst1q_f32(outYs + i, oy);
+    }
+    TransformPointsScalar(matrix, xs, ys, outXs, outYs, i, count);
+}
+
+const char* GetGeometryKernelName() {
+    return "NEON";
+}
+
+#else
+
+void BatchIntersects(const RectArrayView& rects, const Rect& query, uint8_t* result) {
+    IntersectsScalar(rects, query, result, 0);
+}
+
+void BatchContains(const RectArrayView& rects, const Point& point, uint8_t* result) {
+    ContainsScalar(rects, point, result, 0);
+}
+
+void BatchIntersect(const RectArrayView& rects, const Rect& clip, const RectArrayOutput& output) {
+    IntersectScalar(rects, clip, output, 0);
+}
+
+Rect BatchUnion(const RectArrayView& rects) {
+    if (rects.count == 0) return Rect();
+
+    Rect result(rects.x[0], rects.y[0], rects.width[0], rects.height[0]);
+    for (size_t i = 1; i < rects.count; ++i) {
+        result = result.Union(Rect(rects.x[i], rects.y[i], rects.width[i], rects.height[i]));
+    }
+    return result;
+}
+
+void TransformPoints(const Matrix3x2& matrix, const float* xs, const float* ys,
+                     float* outXs, float* outYs, size_t count) {
+    TransformPointsScalar(matrix, xs, ys, outXs, outYs, 0, count);
+}
+
+const char* GetGeometryKernelName() {
+    return "Scalar";
+}
+
+#endif
+
+} // namespace miko
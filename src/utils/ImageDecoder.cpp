@@ -0,0 +1,394 @@
+#include "miko/utils/ImageDecoder.h"
+#include <algorithm>
+#include <cstring>
+
+namespace miko {
+
+namespace {
+
+uint16_t ReadLe16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+uint32_t ReadLe32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+uint32_t ReadBe32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+uint32_t PackPixel(uint32_t r, uint32_t g, uint32_t b, uint32_t a) {
+    return (a << 24) | (r << 16) | (g << 8) | b;
+}
+
+// Checked before the data length, so the length checks cannot overflow
+bool IsValidSize(int64_t width, int64_t height) {
+    return width > 0 && height > 0 && (uint64_t)width * (uint64_t)height <= MAX_IMAGE_PIXELS;
+}
+
+// Called only once the data is known to hold every pixel, so a short file cannot force a large allocation
+bool AllocateSurface(int64_t width, int64_t height, ImageSurface& surface) {
+    if (!IsValidSize(width, height)) return false;
+    surface.width = (int)width;
+    surface.height = (int)height;
+    surface.pixels.assign((size_t)width * (size_t)height, 0);
+    return true;
+}
+
+// Decoders write straight alpha; this converts to premultiplied and sets opaque
+void Premultiply(ImageSurface& surface) {
+    bool opaque = true;
+    for (uint32_t& pixel : surface.pixels) {
+        const uint32_t a = pixel >> 24;
+        if (a == 255) continue;
+        opaque = false;
+        const uint32_t r = (((pixel >> 16) & 0xFF) * a + 127) / 255;
+        const uint32_t g = (((pixel >> 8) & 0xFF) * a + 127) / 255;
+        const uint32_t b = ((pixel & 0xFF) * a + 127) / 255;
+        pixel = PackPixel(r, g, b, a);
+    }
+    surface.opaque = opaque;
+}
+
+// One channel of a bit-field pixel, scaled to 0-255; an empty mask reads as missing
+struct BitField {
+    uint32_t mask = 0;
+    unsigned shift = 0;
+    uint32_t maximum = 0;
+
+    explicit BitField(uint32_t mask) : mask(mask) {
+        if (mask == 0) return;
+        while (((mask >> shift) & 1) == 0) {
+            ++shift;
+        }
+        maximum = mask >> shift;
+    }
+
+    uint32_t Read(uint32_t value, uint32_t missing) const {
+        if (maximum == 0) return missing;
+        return (uint32_t)(((uint64_t)((value & mask) >> shift) * 255 + maximum / 2) / maximum);
+    }
+};
+
+} // namespace
+
+bool DecodeImage(const uint8_t* data, size_t size, ImageSurface& surface) {
+    if (size >= 2 && data[0] == 'B' && data[1] == 'M') return DecodeBmp(data, size, surface);
+    if (size >= 4 && std::memcmp(data, "qoif", 4) == 0) return DecodeQoi(data, size, surface);
+    if (size >= 2 && data[0] == 'P' && data[1] >= '2' && data[1] <= '6' && data[1] != '4') return DecodePpm(data, size, surface);
+    return false;
+}
+
+bool DecodeBmp(const uint8_t* data, size_t size, ImageSurface& surface) {
+    if (size < 26 || data[0] != 'B' || data[1] != 'M') return false;
+
+    const uint32_t pixelOffset = ReadLe32(data + 10);
+    const uint32_t headerSize = ReadLe32(data + 14);
+    if (headerSize < 12 || 14 + (uint64_t)headerSize > size) return false;
+
+    int64_t width;
+    int64_t height;
+    unsigned bitCount;
+    uint32_t compression = 0;
+    uint32_t paletteSize = 0;
+    size_t paletteEntryBytes = 4;
+    size_t paletteOffset = 14 + headerSize;
+    if (headerSize == 12) {
+        // OS/2 core header: 16-bit sizes and 3-byte palette entries
+        width = ReadLe16(data + 18);
+        height = (int16_t)ReadLe16(data + 20);
+        bitCount = ReadLe16(data + 24);
+        paletteEntryBytes = 3;
+    } else {
+        if (headerSize < 40) return false;
+        width = (int32_t)ReadLe32(data + 18);
+        height = (int32_t)ReadLe32(data + 22);
+        bitCount = ReadLe16(data + 28);
+        compression = ReadLe32(data + 30);
+        paletteSize = ReadLe32(data + 46);
+    }
+
+    // Rows are stored bottom-up unless the height is negative
+    const bool topDown = height < 0;
+    height = topDown ? -height : height;
+
+    // Bit fields for 16 and 32 bits; without them 16 bits is 5-5-5 and 32 bits is 8-8-8 with an unreliable alpha byte
+    uint32_t masks[4] = { 0, 0, 0, 0 };
+    bool alphaFromBits = false;
+    if (bitCount == 16) {
+        masks[0] = 0x7C00;
+        masks[1] = 0x03E0;
+        masks[2] = 0x001F;
+    } else if (bitCount == 32) {
+        masks[0] = 0x00FF0000;
+        masks[1] = 0x0000FF00;
+        masks[2] = 0x000000FF;
+        masks[3] = 0xFF000000;
+        alphaFromBits = true;
+    }
+    const bool bitFields = compression == 3 || compression == 6;
+    if (bitFields) {
+        // Masks are in the header from version 2 on, and right after a 40-byte header otherwise
+        const size_t maskCount = compression == 6 || headerSize >= 56 ? 4 : 3;
+        const size_t maskOffset = 14 + 40;
+        if (maskOffset + maskCount * 4 > size) return false;
+        for (size_t i = 0; i < 4; ++i) {
+            masks[i] = i < maskCount ? ReadLe32(data + maskOffset + i * 4) : 0;
+        }
+        alphaFromBits = masks[3] != 0;
+        if (headerSize == 40) {
+            paletteOffset += maskCount * 4;
+        }
+    } else if (compression != 0) {
+        // Run-length and embedded JPEG/PNG data are not supported
+        return false;
+    }
+
+    // Indices past the end of a short palette read as opaque black
+    uint32_t palette[256];
+    std::fill(palette, palette + 256, PackPixel(0, 0, 0, 255));
+    if (bitCount <= 8) {
+        if (bitCount != 1 && bitCount != 4 && bitCount != 8) return false;
+        const uint32_t entries = paletteSize == 0 ? (1u << bitCount) : std::min<uint32_t>(paletteSize, 1u << bitCount);
+        if (paletteOffset + (uint64_t)entries * paletteEntryBytes > size) return false;
+        for (uint32_t i = 0; i < entries; ++i) {
+            const uint8_t* entry = data + paletteOffset + i * paletteEntryBytes;
+            palette[i] = PackPixel(entry[2], entry[1], entry[0], 255);
+        }
+    } else if (bitCount != 16 && bitCount != 24 && bitCount != 32) {
+        return false;
+    }
+
+    if (!IsValidSize(width, height)) return false;
+    const size_t rowBytes = (((size_t)width * bitCount + 31) / 32) * 4;
+    if (pixelOffset > size || rowBytes * (size_t)height > size - pixelOffset) return false;
+    if (!AllocateSurface(width, height, surface)) return false;
+
+    const BitField red(masks[0]);
+    const BitField green(masks[1]);
+    const BitField blue(masks[2]);
+    const BitField alpha(masks[3]);
+    bool anyAlpha = false;
+    for (int64_t y = 0; y < height; ++y) {
+        const uint8_t* row = data + pixelOffset + rowBytes * (size_t)(topDown ? y : height - 1 - y);
+        uint32_t* out = surface.pixels.data() + (size_t)y * (size_t)width;
+        for (int64_t x = 0; x < width; ++x) {
+            switch (bitCount) {
+                case 1:
+                    out[x] = palette[(row[x >> 3] >> (7 - (x & 7))) & 1];
+                    break;
+                case 4:
+                    out[x] = palette[(row[x >> 1] >> ((x & 1) ? 0 : 4)) & 0xF];
+                    break;
+                case 8:
+                    out[x] = palette[row[x]];
+                    break;
+                case 24:
+                    out[x] = PackPixel(row[x * 3 + 2], row[x * 3 + 1], row[x * 3], 255);
+                    break;
+                default: {
+                    const uint32_t value = bitCount == 16 ? ReadLe16(row + x * 2) : ReadLe32(row + x * 4);
+                    const uint32_t a = alpha.Read(value, 255);
+                    anyAlpha |= a != 0;
+                    out[x] = PackPixel(red.Read(value, 0), green.Read(value, 0), blue.Read(value, 0), a);
+                    break;
+                }
+            }
+        }
+    }
+
+    // Many writers leave the alpha byte of 32-bit pixels at zero; all-zero alpha means opaque
+    if (alphaFromBits && !anyAlpha) {
+        for (uint32_t& pixel : surface.pixels) {
+            pixel |= 0xFF000000;
+        }
+    }
+    Premultiply(surface);
+    return true;
+}
+
+bool DecodePpm(const uint8_t* data, size_t size, ImageSurface& surface) {
+    if (size < 3 || data[0] != 'P') return false;
+    const char kind = (char)data[1];
+    const bool binary = kind == '5' || kind == '6';
+    const bool gray = kind == '2' || kind == '5';
+    if (kind != '2' && kind != '3' && kind != '5' && kind != '6') return false;
+
+    size_t position = 2;
+    // Reads a decimal header field or ASCII sample, skipping whitespace and comments
+    auto readNumber = [&](uint32_t& value) {
+        while (position < size) {
+            const uint8_t c = data[position];
+            if (c == '#') {
+                while (position < size && data[position] != '\n' && data[position] != '\r') {
+                    ++position;
+                }
+            } else if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f') {
+                ++position;
+            } else {
+                break;
+            }
+        }
+        if (position >= size || data[position] < '0' || data[position] > '9') return false;
+        uint64_t number = 0;
+        while (position < size && data[position] >= '0' && data[position] <= '9') {
+            number = number * 10 + (data[position++] - '0');
+            if (number > UINT32_MAX) return false;
+        }
+        value = (uint32_t)number;
+        return true;
+    };
+
+    uint32_t width;
+    uint32_t height;
+    uint32_t maximum;
+    if (!readNumber(width) || !readNumber(height) || !readNumber(maximum)) return false;
+    if (maximum == 0 || maximum > 65535) return false;
+    if (!IsValidSize(width, height)) return false;
+
+    const size_t channels = gray ? 1 : 3;
+    const size_t sampleBytes = maximum > 255 ? 2 : 1;
+    const size_t sampleCount = (size_t)width * height * channels;
+    if (binary) {
+        // Exactly one whitespace byte separates the header from the samples
+        ++position;
+        if (position > size || sampleCount * sampleBytes > size - position) return false;
+    } else if (sampleCount > (size - position) / 2) {
+        // Each ASCII sample is at least a separator and a digit
+        return false;
+    }
+    if (!AllocateSurface(width, height, surface)) return false;
+
+    uint32_t sample[3];
+    for (size_t i = 0; i < surface.pixels.size(); ++i) {
+        for (size_t c = 0; c < channels; ++c) {
+            uint32_t value;
+            if (!binary) {
+                if (!readNumber(value)) return false;
+            } else if (sampleBytes == 2) {
+                value = ((uint32_t)data[position] << 8) | data[position + 1];
+                position += 2;
+            } else {
+                value = data[position++];
+            }
+            sample[c] = (std::min(value, maximum) * 255 + maximum / 2) / maximum;
+        }
+        surface.pixels[i] = gray ? PackPixel(sample[0], sample[0], sample[0], 255)
+                                 : PackPixel(sample[0], sample[1], sample[2], 255);
+    }
+    surface.opaque = true;
+    return true;
+}
+
+bool DecodeQoi(const uint8_t* data, size_t size, ImageSurface& surface) {
+    // 14-byte header and an 8-byte end marker
+    if (size < 22 || std::memcmp(data, "qoif", 4) != 0) return false;
+    const uint32_t width = ReadBe32(data + 4);
+    const uint32_t height = ReadBe32(data + 8);
+    const uint8_t channels = data[12];
+    if (channels != 3 && channels != 4) return false;
+    // The longest run byte covers 62 pixels, which bounds what the data can hold
+    if (!IsValidSize(width, height) || (uint64_t)width * height > (uint64_t)(size - 22) * 62) return false;
+    if (!AllocateSurface(width, height, surface)) return false;
+
+    // Colours are kept as straight RGBA bytes while decoding, as the format hashes them
+    uint8_t seen[64][4] = {};
+    uint8_t r = 0;
+    uint8_t g = 0;
+    uint8_t b = 0;
+    uint8_t a = 255;
+    size_t position = 14;
+    const size_t end = size - 8;
+    size_t run = 0;
+    for (uint32_t& pixel : surface.pixels) {
+        if (run > 0) {
+            --run;
+        } else {
+            if (position >= end) return false;
+            const uint8_t op = data[position++];
+            if (op == 0xFE) {
+                if (position + 3 > end) return false;
+                r = data[position];
+                g = data[position + 1];
+                b = data[position + 2];
+                position += 3;
+            } else if (op == 0xFF) {
+                if (position + 4 > end) return false;
+                r = data[position];
+                g = data[position + 1];
+                b = data[position + 2];
+                a = data[position + 3];
+                position += 4;
+            } else {
+                switch (op >> 6) {
+                    case 0: {
+                        const uint8_t* color = seen[op & 0x3F];
+                        r = color[0];
+                        g = color[1];
+                        b = color[2];
+                        a = color[3];
+                        break;
+                    }
+                    case 1:
+                        r += ((op >> 4) & 3) - 2;
+                        g += ((op >> 2) & 3) - 2;
+                        b += (op & 3) - 2;
+                        break;
+                    case 2: {
+                        if (position >= end) return false;
+                        const int greenDelta = (op & 0x3F) - 32;
+                        const uint8_t next = data[position++];
+                        r += greenDelta - 8 + (next >> 4);
+                        g += greenDelta;
+                        b += greenDelta - 8 + (next & 0xF);
+                        break;
+                    }
+                    default:
+                        run = op & 0x3F;
+                        break;
+                }
+            }
+            uint8_t* slot = seen[(r * 3 + g * 5 + b * 7 + a * 11) % 64];
+            slot[0] = r;
+            slot[1] = g;
+            slot[2] = b;
+            slot[3] = a;
+        }
+        pixel = PackPixel(r, g, b, a);
+    }
+
+    Premultiply(surface);
+    return true;
+}
+
+void DownscaleHalf(const ImageSurface& source, ImageSurface& result) {
+    const int width = (source.width + 1) / 2;
+    const int height = (source.height + 1) / 2;
+    result.width = width;
+    result.height = height;
+    result.opaque = source.opaque;
+    result.pixels.resize((size_t)width * height);
+
+    for (int y = 0; y < height; ++y) {
+        // An odd last row or column is averaged with itself
+        const uint32_t* top = source.pixels.data() + (size_t)(2 * y) * source.width;
+        const uint32_t* bottom = source.pixels.data() + (size_t)std::min(2 * y + 1, source.height - 1) * source.width;
+        uint32_t* out = result.pixels.data() + (size_t)y * width;
+        for (int x = 0; x < width; ++x) {
+            const int left = 2 * x;
+            const int right = std::min(2 * x + 1, source.width - 1);
+            const uint32_t p0 = top[left];
+            const uint32_t p1 = top[right];
+            const uint32_t p2 = bottom[left];
+            const uint32_t p3 = bottom[right];
+            // Two channels at a time: 0x00FF00FF lanes have room for the sum of four bytes
+            const uint32_t evens = ((p0 & 0x00FF00FF) + (p1 & 0x00FF00FF) + (p2 & 0x00FF00FF) + (p3 & 0x00FF00FF) + 0x00020002) >> 2;
+            const uint32_t odds = (((p0 >> 8) & 0x00FF00FF) + ((p1 >> 8) & 0x00FF00FF) + ((p2 >> 8) & 0x00FF00FF) +
+                                   ((p3 >> 8) & 0x00FF00FF) + 0x00020002) >> 2;
+            out[x] = (evens & 0x00FF00FF) | ((odds & 0x00FF00FF) << 8);
+        }
+    }
+}
+
+} // namespace miko
@@ -0,0 +1,205 @@
+#include "miko/utils/ImplicitTreap.h"
+#include <algorithm>
+
+namespace miko {
+
+namespace {
+
+uint32_t Priority(uint32_t item) {
+    // Integer hash finalizer; spreads consecutive item numbers over the whole range
+    uint32_t x = item * 0x9E3779B1u;
+    x ^= x >> 16;
+    x *= 0x85EBCA6Bu;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35u;
+    x ^= x >> 16;
+    return x;
+}
+
+} // namespace
+
+bool ImplicitTreap::IsHigher(uint32_t a, uint32_t b) {
+    // Ties are broken by item number so the heap order is strict
+    const uint32_t priorityA = Priority(a);
+    const uint32_t priorityB = Priority(b);
+    return priorityA != priorityB ? priorityA > priorityB : a > b;
+}
+
+void ImplicitTreap::Reset(size_t itemCount) {
+    nodes.assign(itemCount, Node{ NIL, NIL, NIL, 0, 0, 0 });
+}
+
+void ImplicitTreap::Update(uint32_t node) {
+    Node& n = nodes[node];
+    n.size = 1;
+    n.minKey = n.key;
+    if (n.left != NIL) {
+        n.size += nodes[n.left].size;
+        n.minKey = std::min(n.minKey, nodes[n.left].minKey);
+        nodes[n.left].parent = node;
+    }
+    if (n.right != NIL) {
+        n.size += nodes[n.right].size;
+        n.minKey = std::min(n.minKey, nodes[n.right].minKey);
+        nodes[n.right].parent = node;
+    }
+}
+
+uint32_t ImplicitTreap::Build(const uint32_t* items, const uint32_t* keys, size_t count) {
+    // Cartesian tree construction: the stack holds the right spine. A node
+    // popped off it has its subtree complete, so its size is final then
+    buildStack.clear();
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t item = items[i];
+        nodes[item] = Node{ NIL, NIL, NIL, 1, keys[i], keys[i] };
+
+        uint32_t last = NIL;
+        while (!buildStack.empty() && IsHigher(item, buildStack.back())) {
+            last = buildStack.back();
+            buildStack.pop_back();
+            Update(last);
+        }
+        nodes[item].left = last;
+        if (!buildStack.empty()) {
+            nodes[buildStack.back()].right = item;
+        }
+        buildStack.push_back(item);
+    }
+
+    // The bottom of the spine is the root
+    const uint32_t root = buildStack.empty() ? NIL : buildStack.front();
+    while (!buildStack.empty()) {
+        Update(buildStack.back());
+        buildStack.pop_back();
+    }
+    return root;
+}
+
+uint32_t ImplicitTreap::Merge(uint32_t first, uint32_t second) {
+    const uint32_t root = MergeNodes(first, second);
+    if (root != NIL) {
+        nodes[root].parent = NIL;
+    }
+    return root;
+}
+
+uint32_t ImplicitTreap::MergeNodes(uint32_t first, uint32_t second) {
+    if (first == NIL) return second;
+    if (second == NIL) return first;
+
+    if (IsHigher(first, second)) {
+        const uint32_t right = MergeNodes(nodes[first].right, second);
+        nodes[first].right = right;
+        Update(first);
+        return first;
+    }
+    const uint32_t left = MergeNodes(first, nodes[second].left);
+    nodes[second].left = left;
+    Update(second);
+    return second;
+}
+
+void ImplicitTreap::Split(uint32_t root, size_t count, uint32_t& first, uint32_t& second) {
+    SplitNodes(root, count, first, second);
+    if (first != NIL) nodes[first].parent = NIL;
+    if (second != NIL) nodes[second].parent = NIL;
+}
+
+void ImplicitTreap::SplitNodes(uint32_t root, size_t count, uint32_t& first, uint32_t& second) {
+    if (root == NIL) {
+        first = second = NIL;
+        return;
+    }
+
+    const size_t leftSize = GetSize(nodes[root].left);
+    if (count <= leftSize) {
+        uint32_t rest;
+        SplitNodes(nodes[root].left, count, first, rest);
+        nodes[root].left = rest;
+        Update(root);
+        second = root;
+    } else {
+        uint32_t rest;
+        SplitNodes(nodes[root].right, count - leftSize - 1, rest, second);
+        nodes[root].right = rest;
+        Update(root);
+        first = root;
+    }
+}
+
+uint32_t ImplicitTreap::GetItem(uint32_t root, size_t index) const {
+    uint32_t node = root;
+    while (node != NIL) {
+        const size_t leftSize = GetSize(nodes[node].left);
+        if (index < leftSize) {
+            node = nodes[node].left;
+        } else if (index == leftSize) {
+            return node;
+        } else {
+            index -= leftSize + 1;
+            node = nodes[node].right;
+        }
+    }
+    return NIL;
+}
+
+size_t ImplicitTreap::GetIndex(uint32_t item) const {
+    size_t index = GetSize(nodes[item].left);
+    for (uint32_t node = item; nodes[node].parent != NIL; node = nodes[node].parent) {
+        const uint32_t parent = nodes[node].parent;
+        if (nodes[parent].right == node) {
+            index += GetSize(nodes[parent].left) + 1;
+        }
+    }
+    return index;
+}
+
+uint32_t ImplicitTreap::GetRoot(uint32_t item) const {
+    while (nodes[item].parent != NIL) {
+        item = nodes[item].parent;
+    }
+    return item;
+}
+
+uint32_t ImplicitTreap::GetNext(uint32_t item) const {
+    if (nodes[item].right != NIL) {
+        item = nodes[item].right;
+        while (nodes[item].left != NIL) {
+            item = nodes[item].left;
+        }
+        return item;
+    }
+    while (nodes[item].parent != NIL) {
+        const uint32_t parent = nodes[item].parent;
+        if (nodes[parent].left == item) return parent;
+        item = parent;
+    }
+    return NIL;
+}
+
+size_t ImplicitTreap::FindFirstAtMost(uint32_t root, size_t from, uint32_t limit) const {
+    const size_t found = FindNodes(root, 0, from, limit);
+    return found != SIZE_MAX ? found : GetSize(root);
+}
+
+size_t ImplicitTreap::FindNodes(uint32_t root, size_t offset, size_t from, uint32_t limit) const {
+    // offset is the position of the subtree's first item. Only the path
+    // along from is partly searched; the first whole subtree right of it
+    // with a small enough key is sure to hold the answer
+    if (root == NIL || nodes[root].minKey > limit || offset + nodes[root].size <= from) {
+        return SIZE_MAX;
+    }
+
+    const Node& node = nodes[root];
+    const size_t position = offset + GetSize(node.left);
+    if (from < position) {
+        const size_t found = FindNodes(node.left, offset, from, limit);
+        if (found != SIZE_MAX) return found;
+    }
+    if (position >= from && node.key <= limit) {
+        return position;
+    }
+    return FindNodes(node.right, position + 1, from, limit);
+}
+
+} // namespace miko
@@ -0,0 +1,160 @@
+#include "miko/utils/MappedFile.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace miko {
+
+MappedFile::MappedFile()
+    : data(nullptr)
+    , size(0)
+    , isOpen(false)
+#ifdef _WIN32
+    , fileHandle(INVALID_HANDLE_VALUE)
+    , mappingHandle(nullptr)
+#else
+    , fileDescriptor(-1)
+#endif
+{
+}
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& path) {
+    Close();
+
+    int pathLen = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+    std::wstring widePath(pathLen, 0);
+    MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &widePath[0], pathLen);
+
+    HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    size = (size_t)fileSize.QuadPart;
+    isOpen = true;
+
+    // Empty files cannot be mapped; they open as an empty view
+    if (size == 0) {
+        return true;
+    }
+
+    mappingHandle = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle) {
+        data = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    }
+    if (!data) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data) {
+        UnmapViewOfFile(data);
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(fileHandle);
+    }
+    data = nullptr;
+    size = 0;
+    isOpen = false;
+    mappingHandle = nullptr;
+    fileHandle = INVALID_HANDLE_VALUE;
+}
+
+void MappedFile::Evict(size_t offset, size_t length) const {
+    if (!data || offset >= size) return;
+    length = std::min(length, size - offset);
+    // Unlocking pages that were never locked removes them from the working set
+    VirtualUnlock(const_cast<char*>(data) + offset, length);
+}
+
+#else
+
+bool MappedFile::Open(const std::string& path) {
+    Close();
+
+    const int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(file, &info) != 0) {
+        close(file);
+        return false;
+    }
+    fileDescriptor = file;
+    size = (size_t)info.st_size;
+    isOpen = true;
+
+    // Empty files cannot be mapped; they open as an empty view
+    if (size == 0) {
+        return true;
+    }
+
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+    if (mapping == MAP_FAILED) {
+        Close();
+        return false;
+    }
+    data = static_cast<const char*>(mapping);
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data) {
+        munmap(const_cast<char*>(data), size);
+    }
+    if (fileDescriptor >= 0) {
+        close(fileDescriptor);
+    }
+    data = nullptr;
+    size = 0;
+    isOpen = false;
+    fileDescriptor = -1;
+}
+
+void MappedFile::Evict(size_t offset, size_t length) const {
+    if (!data || offset >= size) return;
+
+    // madvise works on whole pages; only drop pages that lie entirely in the range
+    const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    const size_t end = offset + std::min(length, size - offset);
+    const size_t first = (offset + pageSize - 1) / pageSize * pageSize;
+    const size_t last = end == size ? end : end / pageSize * pageSize;
+    if (last > first) {
+        madvise(const_cast<char*>(data) + first, last - first, MADV_DONTNEED);
+    }
+}
+
+#endif
+
+} // namespace miko
@@ -0,0 +1,158 @@
+#include "miko/utils/MinMaxPyramid.h"
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIKO_PYRAMID_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define MIKO_PYRAMID_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace miko {
+
+namespace {
+
+static_assert(MinMaxPyramid::FAN_IN == 4, "the vector kernels reduce groups of four");
+
+// Reduces groups of FAN_IN inputs to one output, for outputs [begin, count)
+void ReduceScalar(const float* mins, const float* maxs, size_t begin, size_t count, float* outMins, float* outMaxs) {
+    for (size_t i = begin; i < count; ++i) {
+        const float* groupMins = mins + i * MinMaxPyramid::FAN_IN;
+        const float* groupMaxs = maxs + i * MinMaxPyramid::FAN_IN;
+        float low = groupMins[0];
+        float high = groupMaxs[0];
+        for (size_t j = 1; j < MinMaxPyramid::FAN_IN; ++j) {
+            low = std::min(low, groupMins[j]);
+            high = std::max(high, groupMaxs[j]);
+        }
+        outMins[i] = low;
+        outMaxs[i] = high;
+    }
+}
+
+// Four groups per step: transposing the 4x4 block puts each group's values
+// in the same lane of four registers, so three vertical ops reduce them
+void Reduce(const float* mins, const float* maxs, size_t count, float* outMins, float* outMaxs) {
+    size_t i = 0;
+#if MIKO_PYRAMID_SSE2
+    for (; i + 4 <= count; i += 4) {
+        __m128 a = _mm_loadu_ps(mins + i * 4);
+        __m128 b = _mm_loadu_ps(mins + i * 4 + 4);
+        __m128 c = _mm_loadu_ps(mins + i * 4 + 8);
+        __m128 d = _mm_loadu_ps(mins + i * 4 + 12);
+        _MM_TRANSPOSE4_PS(a, b, c, d);
+        _mm_storeu_ps(outMins + i, _mm_min_ps(_mm_min_ps(a, b), _mm_min_ps(c, d)));
+
+        a = _mm_loadu_ps(maxs + i * 4);
+        b = _mm_loadu_ps(maxs + i * 4 + 4);
+        c = _mm_loadu_ps(maxs + i * 4 + 8);
+        d = _mm_loadu_ps(maxs + i * 4 + 12);
+        _MM_TRANSPOSE4_PS(a, b, c, d);
+        _mm_storeu_ps(outMaxs + i, _mm_max_ps(_mm_max_ps(a, b), _mm_max_ps(c, d)));
+    }
+#elif MIKO_PYRAMID_NEON
+    // vld4q deinterleaves, which is the same transpose
+    for (; i + 4 <= count; i += 4) {
+        const float32x4x4_t low = vld4q_f32(mins + i * 4);
+        vst1q_f32(outMins + i, vminq_f32(vminq_f32(low.val[0], low.val[1]), vminq_f32(low.val[2], low.val[3])));
+        const float32x4x4_t high = vld4q_f32(maxs + i * 4);
+        vst1q_f32(outMaxs + i, vmaxq_f32(vmaxq_f32(high.val[0], high.val[1]), vmaxq_f32(high.val[2], high.val[3])));
+    }
+#endif
+    ReduceScalar(mins, maxs, i, count, outMins, outMaxs);
+}
+
+} // namespace
+
+void MinMaxPyramid::Clear() {
+    samples.clear();
+    levels.clear();
+}
+
+void MinMaxPyramid::Append(const float* values, size_t count) {
+    if (count == 0) return;
+
+    size_t changedFrom = samples.size();
+    samples.insert(samples.end(), values, values + count);
+
+    // Each level is recomputed from the bucket holding its first changed input;
+    // the last bucket may be partial and is redone by later appends
+    size_t sourceCount = samples.size();
+    for (size_t k = 0; sourceCount > 1; ++k) {
+        if (k == levels.size()) {
+            levels.emplace_back();
+        }
+        const float* sourceMins = k == 0 ? samples.data() : levels[k - 1].mins.data();
+        const float* sourceMaxs = k == 0 ? samples.data() : levels[k - 1].maxs.data();
+        Level& level = levels[k];
+        const size_t bucketCount = (sourceCount + FAN_IN - 1) / FAN_IN;
+        const size_t fullCount = sourceCount / FAN_IN;
+        const size_t first = changedFrom / FAN_IN;
+        level.mins.resize(bucketCount);
+        level.maxs.resize(bucketCount);
+
+        if (first < fullCount) {
+            Reduce(sourceMins + first * FAN_IN, sourceMaxs + first * FAN_IN, fullCount - first,
+                   level.mins.data() + first, level.maxs.data() + first);
+        }
+        if (fullCount < bucketCount) {
+            float low = sourceMins[fullCount * FAN_IN];
+            float high = sourceMaxs[fullCount * FAN_IN];
+            for (size_t i = fullCount * FAN_IN + 1; i < sourceCount; ++i) {
+                low = std::min(low, sourceMins[i]);
+                high = std::max(high, sourceMaxs[i]);
+            }
+            level.mins[fullCount] = low;
+            level.maxs[fullCount] = high;
+        }
+
+        changedFrom = first;
+        sourceCount = bucketCount;
+    }
+}
+
+size_t MinMaxPyramid::GetBucketSize(size_t level) {
+    size_t size = 1;
+    for (size_t i = 0; i < level; ++i) {
+        size *= FAN_IN;
+    }
+    return size;
+}
+
+size_t MinMaxPyramid::PickLevel(double maxBucketSize) const {
+    size_t level = 0;
+    size_t nextSize = FAN_IN;
+    while (level + 1 < GetLevelCount() && (double)nextSize <= maxBucketSize) {
+        ++level;
+        nextSize *= FAN_IN;
+    }
+    return level;
+}
+
+bool MinMaxPyramid::GetRange(size_t level, size_t begin, size_t end, float& min, float& max) const {
+    end = std::min(end, samples.size());
+    if (begin >= end || level >= GetLevelCount()) return false;
+
+    const float* mins = samples.data();
+    const float* maxs = samples.data();
+    if (level > 0) {
+        const size_t bucketSize = GetBucketSize(level);
+        mins = levels[level - 1].mins.data();
+        maxs = levels[level - 1].maxs.data();
+        begin /= bucketSize;
+        end = (end - 1) / bucketSize + 1;
+    }
+
+    float low = mins[begin];
+    float high = maxs[begin];
+    for (size_t i = begin + 1; i < end; ++i) {
+        low = std::min(low, mins[i]);
+        high = std::max(high, maxs[i]);
+    }
+    min = low;
+    max = high;
+    return true;
+}
+
+} // namespace miko
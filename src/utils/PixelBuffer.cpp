@@ -0,0 +1,125 @@
+#include "miko/utils/PixelBuffer.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace miko {
+
+namespace {
+
+// Adds a rect to a dirty list, merging the list into its bounding box once it is too long
+void AddDirtyRect(std::vector<PixelRect>& list, const PixelRect& rect) {
+    // The same rect marked frame after frame is kept once
+    for (const PixelRect& existing : list) {
+        if (existing.Contains(rect)) return;
+    }
+    list.push_back(rect);
+    if (list.size() > PixelBuffer::MAX_DIRTY_RECTS) {
+        PixelRect bounds = list[0];
+        for (const PixelRect& other : list) {
+            bounds = bounds.Union(other);
+        }
+        list.assign(1, bounds);
+    }
+}
+
+} // namespace
+
+PixelBuffer::PixelBuffer(int width, int height, bool opaque)
+    : width(std::max(width, 0))
+    , height(std::max(height, 0))
+    , opaque(opaque)
+    , backSlot(0)
+    , readySlot(1)
+    , frontSlot(2)
+    , readyIsNew(false)
+    , latestSlot(2)
+{
+    for (Slot& slot : slots) {
+        slot.owned.assign((size_t)this->width * this->height, 0);
+        slot.pixels = slot.owned.data();
+    }
+}
+
+PixelBuffer::PixelBuffer(int width, int height, uint32_t* const buffers[3], bool opaque)
+    : width(std::max(width, 0))
+    , height(std::max(height, 0))
+    , opaque(opaque)
+    , backSlot(0)
+    , readySlot(1)
+    , frontSlot(2)
+    , readyIsNew(false)
+    , latestSlot(2)
+{
+    // Catching up copies only dirty rects, so all three must start out alike
+    const size_t pixelCount = (size_t)this->width * this->height;
+    for (int slot = 0; slot < 3; ++slot) {
+        slots[slot].pixels = buffers[slot];
+        if (slot > 0 && pixelCount > 0) {
+            std::memcpy(buffers[slot], buffers[0], pixelCount * 4);
+        }
+    }
+}
+
+uint32_t* PixelBuffer::BeginFrame() {
+    frameDirty.clear();
+    int source;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        catchUp.swap(slots[backSlot].stale);
+        slots[backSlot].stale.clear();
+        source = latestSlot;
+    }
+
+    // The source slot is only read, by either thread, until the writer publishes again
+    uint32_t* target = slots[backSlot].pixels;
+    const uint32_t* newest = slots[source].pixels;
+    for (const PixelRect& rect : catchUp) {
+        for (int y = rect.y; y < rect.Bottom(); ++y) {
+            const size_t offset = (size_t)y * width + rect.x;
+            std::memcpy(target + offset, newest + offset, (size_t)rect.width * 4);
+        }
+    }
+    catchUp.clear();
+    return target;
+}
+
+void PixelBuffer::MarkDirty(const PixelRect& rect) {
+    const PixelRect clipped = rect.Intersection(PixelRect(0, 0, width, height));
+    if (clipped.IsEmpty()) return;
+    AddDirtyRect(frameDirty, clipped);
+}
+
+void PixelBuffer::EndFrame() {
+    std::lock_guard<std::mutex> lock(mutex);
+    // The other two pictures now lack this frame's changes
+    for (const PixelRect& rect : frameDirty) {
+        for (int slot = 0; slot < 3; ++slot) {
+            if (slot != backSlot) {
+                AddDirtyRect(slots[slot].stale, rect);
+            }
+        }
+        AddDirtyRect(unread, rect);
+    }
+    std::swap(backSlot, readySlot);
+    latestSlot = readySlot;
+    readyIsNew = true;
+}
+
+bool PixelBuffer::AcquireFrame(const uint32_t*& pixels, std::vector<PixelRect>& dirty) {
+    dirty.clear();
+    bool acquired = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (readyIsNew) {
+            std::swap(frontSlot, readySlot);
+            readyIsNew = false;
+            dirty.swap(unread);
+            acquired = true;
+        }
+    }
+    pixels = slots[frontSlot].pixels;
+    return acquired;
+}
+
+} // namespace miko
@@ -0,0 +1,149 @@
+#include "miko/utils/QuadTree.h"
+#include <algorithm>
+
+namespace miko {
+
+namespace {
+
+const uint32_t NO_NODE = UINT32_MAX;
+
+} // namespace
+
+QuadTree::QuadTree(const Rect& bounds)
+    : outsideCount(0)
+{
+    Reset(bounds);
+}
+
+void QuadTree::Reset(const Rect& newBounds) {
+    const float side = std::max(std::max(newBounds.width, newBounds.height), 1.0f);
+    bounds = Rect(newBounds.x, newBounds.y, side, side);
+    nodes.assign(1, Node());
+    outsideCount = 0;
+}
+
+void QuadTree::Insert(ItemId id, const Rect& rect) {
+    const uint32_t node = Descend(rect, true, 1);
+    nodes[node].entries.push_back(Entry{id, rect});
+    if (IsOutside(rect)) {
+        ++outsideCount;
+    }
+}
+
+bool QuadTree::Remove(ItemId id, const Rect& rect) {
+    const uint32_t node = Descend(rect, false, 0);
+    if (node == NO_NODE) return false;
+
+    std::vector<Entry>& entries = nodes[node].entries;
+    auto found = std::find_if(entries.begin(), entries.end(), [id](const Entry& entry) { return entry.id == id; });
+    if (found == entries.end()) return false;
+
+    *found = entries.back();
+    entries.pop_back();
+    Descend(rect, false, -1);
+    if (IsOutside(rect)) {
+        --outsideCount;
+    }
+    return true;
+}
+
+void QuadTree::Query(const Rect& area, std::vector<ItemId>& ids) const {
+    QueryNode(0, bounds.width, area, 0.0f, ids, nullptr);
+}
+
+void QuadTree::QueryClustered(const Rect& area, float minSize, std::vector<ItemId>& ids, std::vector<Cluster>& clusters) const {
+    QueryNode(0, bounds.width, area, minSize, ids, &clusters);
+}
+
+uint32_t QuadTree::Descend(const Rect& rect, bool create, int countChange) {
+    uint32_t node = 0;
+    AdjustNode(node, rect, countChange);
+    if (IsOutside(rect)) return node;
+
+    // Down while the item fits in the child cell holding its centre
+    const float size = std::max(rect.width, rect.height);
+    const float centerX = rect.x + rect.width / 2;
+    const float centerY = rect.y + rect.height / 2;
+    float cellX = bounds.x;
+    float cellY = bounds.y;
+    float cell = bounds.width;
+    for (int depth = 0; depth < MAX_DEPTH && size <= cell / 2; ++depth) {
+        const float half = cell / 2;
+        int quadrant = 0;
+        if (centerX >= cellX + half) {
+            quadrant |= 1;
+            cellX += half;
+        }
+        if (centerY >= cellY + half) {
+            quadrant |= 2;
+            cellY += half;
+        }
+        cell = half;
+
+        uint32_t child = nodes[node].children[quadrant];
+        if (child == 0) {
+            if (!create) return NO_NODE;
+            child = (uint32_t)nodes.size();
+            nodes.emplace_back();
+            nodes[node].children[quadrant] = child;
+        }
+        node = child;
+        AdjustNode(node, rect, countChange);
+    }
+    return node;
+}
+
+void QuadTree::AdjustNode(uint32_t node, const Rect& rect, int countChange) {
+    Node& target = nodes[node];
+    if (countChange > 0) {
+        target.itemBounds = target.count == 0 ? rect : target.itemBounds.Union(rect);
+    }
+    target.count += countChange;
+}
+
+bool QuadTree::IsOutside(const Rect& rect) const {
+    // Written so that NaN coordinates count as outside
+    const float centerX = rect.x + rect.width / 2;
+    const float centerY = rect.y + rect.height / 2;
+    return !(centerX >= bounds.x && centerX < bounds.Right() &&
+             centerY >= bounds.y && centerY < bounds.Bottom() &&
+             std::max(rect.width, rect.height) <= bounds.width);
+}
+
+void QuadTree::QueryNode(uint32_t node, float cell, const Rect& area, float minSize, std::vector<ItemId>& ids, std::vector<Cluster>* clusters) const {
+    const Node& current = nodes[node];
+    if (current.count == 0 || !current.itemBounds.Intersects(area)) return;
+
+    // A branch's items lie within twice its cell, so a small cell is a small branch even if its items are spread out
+    const bool small = 2 * cell < minSize || (current.itemBounds.width < minSize && current.itemBounds.height < minSize);
+    if (clusters && current.count > 1 && small) {
+        clusters->push_back(Cluster{current.itemBounds, current.count, FindRepresentative(node)});
+        return;
+    }
+
+    for (const Entry& entry : current.entries) {
+        if (entry.rect.Intersects(area)) {
+            ids.push_back(entry.id);
+        }
+    }
+    for (uint32_t child : current.children) {
+        if (child != 0) {
+            QueryNode(child, cell / 2, area, minSize, ids, clusters);
+        }
+    }
+}
+
+QuadTree::ItemId QuadTree::FindRepresentative(uint32_t node) const {
+    // Any branch with items leads to one
+    while (nodes[node].entries.empty()) {
+        for (uint32_t child : nodes[node].children) {
+            if (child != 0 && nodes[child].count > 0) {
+                node = child;
+                break;
+            }
+        }
+    }
+    return nodes[node].entries.front().id;
+}
+
+} // namespace miko
@@ -0,0 +1,98 @@
+#include "miko/utils/ThreadPool.h"
+#include <algorithm>
+
+namespace miko {
+
+ThreadPool::ThreadPool(size_t threadCount)
+    : stopping(false)
+{
+    if (threadCount == 0) {
+        const size_t cores = std::thread::hardware_concurrency();
+        threadCount = std::max<size_t>(1, cores > 1 ? cores - 1 : 1);
+    }
+    workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers.emplace_back([this]() { WorkerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    wake.notify_one();
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t index)>& body) {
+    if (count == 0) return;
+
+    struct Progress {
+        std::atomic<size_t> next{ 0 };
+        size_t completed = 0;
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+    auto progress = std::make_shared<Progress>();
+
+    // Whoever runs this claims indices until none are left. A helper that
+    // only starts after the loop has returned finds nothing to claim and
+    // never touches body.
+    auto work = [progress, count, &body]() {
+        size_t finished = 0;
+        for (size_t index = progress->next++; index < count; index = progress->next++) {
+            body(index);
+            ++finished;
+        }
+        if (finished > 0) {
+            std::lock_guard<std::mutex> lock(progress->mutex);
+            progress->completed += finished;
+            if (progress->completed == count) {
+                progress->done.notify_all();
+            }
+        }
+    };
+
+    const size_t helpers = std::min(workers.size(), count - 1);
+    for (size_t i = 0; i < helpers; ++i) {
+        Submit(work);
+    }
+    work();
+
+    std::unique_lock<std::mutex> lock(progress->mutex);
+    progress->done.wait(lock, [&]() { return progress->completed == count; });
+}
+
+ThreadPool& ThreadPool::GetShared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::WorkerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+} // namespace miko
@@ -0,0 +1,127 @@
+#include "miko/utils/TiledImage.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+namespace miko {
+
+namespace {
+
+uint32_t ReadLe32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+uint64_t ReadLe64(const uint8_t* p) {
+    return (uint64_t)ReadLe32(p) | ((uint64_t)ReadLe32(p + 4) << 32);
+}
+
+// Size of a level along one side: the full size over 2^level, rounded up
+int ScaleDown(int size, int level) {
+    return (int)(((int64_t)size + ((int64_t)1 << level) - 1) >> level);
+}
+
+} // namespace
+
+TiledImage::TiledImage()
+    : width(0)
+    , height(0)
+    , tileSize(0)
+    , levelCount(0)
+{
+}
+
+bool TiledImage::Open(const std::string& path) {
+    Close();
+    if (!file.Open(path)) return false;
+
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(file.GetData());
+    const size_t size = file.GetSize();
+    if (size < HEADER_SIZE || std::memcmp(data, "MKTI", 4) != 0 || ReadLe32(data + 4) != VERSION) {
+        Close();
+        return false;
+    }
+    const uint32_t fileWidth = ReadLe32(data + 8);
+    const uint32_t fileHeight = ReadLe32(data + 12);
+    const uint32_t fileTileSize = ReadLe32(data + 16);
+    const uint32_t fileLevelCount = ReadLe32(data + 20);
+    if (fileWidth == 0 || fileHeight == 0 || fileWidth > INT_MAX || fileHeight > INT_MAX ||
+        fileTileSize < MIN_TILE_SIZE || fileTileSize > MAX_TILE_SIZE ||
+        fileLevelCount == 0 || fileLevelCount > MAX_LEVELS) {
+        Close();
+        return false;
+    }
+    width = (int)fileWidth;
+    height = (int)fileHeight;
+    tileSize = (int)fileTileSize;
+    levelCount = (int)fileLevelCount;
+
+    // The index must fit in the file; the entries themselves are checked as tiles are read
+    uint64_t entries = 0;
+    levelStart.resize(levelCount);
+    for (int level = 0; level < levelCount; ++level) {
+        levelStart[level] = entries;
+        entries += (uint64_t)GetColumns(level) * (uint64_t)GetRows(level);
+    }
+    if (entries > (size - HEADER_SIZE) / INDEX_ENTRY_SIZE) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void TiledImage::Close() {
+    file.Close();
+    width = 0;
+    height = 0;
+    tileSize = 0;
+    levelCount = 0;
+    levelStart.clear();
+}
+
+int TiledImage::GetLevelWidth(int level) const {
+    return ScaleDown(width, level);
+}
+
+int TiledImage::GetLevelHeight(int level) const {
+    return ScaleDown(height, level);
+}
+
+int TiledImage::GetColumns(int level) const {
+    return tileSize > 0 ? (GetLevelWidth(level) + tileSize - 1) / tileSize : 0;
+}
+
+int TiledImage::GetRows(int level) const {
+    return tileSize > 0 ? (GetLevelHeight(level) + tileSize - 1) / tileSize : 0;
+}
+
+bool TiledImage::GetTileData(int level, int column, int row, const uint8_t*& data, size_t& size) const {
+    if (level < 0 || level >= levelCount) return false;
+    const int columns = GetColumns(level);
+    if (column < 0 || column >= columns || row < 0 || row >= GetRows(level)) return false;
+
+    const uint8_t* base = reinterpret_cast<const uint8_t*>(file.GetData());
+    const uint64_t entry = levelStart[level] + (uint64_t)row * (uint64_t)columns + (uint64_t)column;
+    const uint8_t* entryData = base + HEADER_SIZE + entry * INDEX_ENTRY_SIZE;
+    const uint64_t offset = ReadLe64(entryData);
+    const uint32_t length = ReadLe32(entryData + 8);
+    if (length == 0 || offset > file.GetSize() || length > file.GetSize() - offset) return false;
+
+    data = base + offset;
+    size = length;
+    return true;
+}
+
+bool TiledImage::DecodeTile(int level, int column, int row, ImageSurface& surface) const {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    if (!GetTileData(level, column, row, data, size) || !DecodeImage(data, size, surface)) {
+        return false;
+    }
+
+    // Tiles are placed by the grid, so one of another size would not line up
+    const int expectedWidth = std::min(tileSize, GetLevelWidth(level) - column * tileSize);
+    const int expectedHeight = std::min(tileSize, GetLevelHeight(level) - row * tileSize);
+    return surface.width == expectedWidth && surface.height == expectedHeight;
+}
+
+} // namespace miko
@@ -0,0 +1,56 @@
+#include "miko/utils/TreeModel.h"
+
+namespace miko {
+
+TreeModel::TreeModel()
+    : parents(1, NO_NODE)
+    , firstChildren(1, NO_NODE)
+    , lastChildren(1, NO_NODE)
+    , nextSiblings(1, NO_NODE)
+    , childCounts(1, 0)
+    , depths(1, 0)
+    , textOffsets(2, 0)
+{
+}
+
+TreeModel::NodeId TreeModel::AddNode(NodeId parent, std::string_view label) {
+    // NO_NODE stays out of range
+    if (!IsValid(parent) || parents.size() >= NO_NODE) return NO_NODE;
+
+    const NodeId node = (NodeId)parents.size();
+    parents.push_back(parent);
+    firstChildren.push_back(NO_NODE);
+    lastChildren.push_back(NO_NODE);
+    nextSiblings.push_back(NO_NODE);
+    childCounts.push_back(0);
+    depths.push_back(depths[parent] + 1);
+    text.append(label);
+    textOffsets.push_back(text.size());
+
+    if (lastChildren[parent] == NO_NODE) {
+        firstChildren[parent] = node;
+    } else {
+        nextSiblings[lastChildren[parent]] = node;
+    }
+    lastChildren[parent] = node;
+    ++childCounts[parent];
+    return node;
+}
+
+void TreeModel::Reserve(size_t nodeCount, size_t textLength) {
+    parents.reserve(nodeCount);
+    firstChildren.reserve(nodeCount);
+    lastChildren.reserve(nodeCount);
+    nextSiblings.reserve(nodeCount);
+    childCounts.reserve(nodeCount);
+    depths.reserve(nodeCount);
+    textOffsets.reserve(nodeCount + 1);
+    text.reserve(textLength);
+}
+
+std::string_view TreeModel::GetText(NodeId node) const {
+    const size_t start = textOffsets[node];
+    return std::string_view(text.data() + start, textOffsets[node + 1] - start);
+}
+
+} // namespace miko
@@ -18,7 +18,13 @@ Button::Button(const std::string& text)
     SetSize(Size(100, 30));
 }
 
-
+void Button::SetText(const std::string& text) {
+    if (this->text != text) {
+        this->text = text;
+        Invalidate();
+        InvalidateMeasure();
+    }
+}
 
 Size Button::MeasureDesiredSize(const Size& availableSize) {
     // Measure text size if we have a renderer context
@@ -0,0 +1,385 @@
+#include "miko/widgets/CanvasView.h"
+#include "miko/core/Renderer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace miko {
+
+static const float MIN_ZOOM = 1e-6f;
+static const float MAX_ZOOM = 1e4f;
+// Zoom change per wheel notch or Page Up/Page Down
+static const float ZOOM_STEP = 1.25f;
+// Part of the view moved by the arrow keys
+static const float PAN_FRACTION = 0.125f;
+// A press moving less than this before release is a click rather than a drag
+static const float DRAG_THRESHOLD = 4.0f;
+// Distance in DIPs at which a click still picks a shape
+static const float HIT_TOLERANCE = 3.0f;
+static const float SELECTION_WIDTH = 2.0f;
+// Zoomed text sizes snap to this many steps per doubling, so the renderer
+// caches a bounded set of text formats however the zoom changes
+static const float TEXT_SIZE_STEPS_PER_DOUBLING = 8.0f;
+
+CanvasView::CanvasView()
+    : m_zoom(1.0f)
+    , m_fitPending(false)
+    , m_selectedItem(CanvasModel::NO_ITEM)
+    , m_selectionColor(Color::AccentColor)
+    , m_minTextSize(5.0f)
+    , m_clusterSize(8.0f)
+    , m_dragging(false)
+    , m_dragMoved(false)
+    , m_drawnItems(0)
+    , m_drawnClusters(0)
+{
+    SetSize(Size(400, 300));
+    SetBackgroundColor(Color::White);
+    SetBorderColor(Color::FromRGBA(128, 128, 128, 255));
+    SetBorderWidth(1.0f);
+}
+
+void CanvasView::SetModel(std::shared_ptr<CanvasModel> model) {
+    m_model = std::move(model);
+    m_selectedItem = CanvasModel::NO_ITEM;
+    m_fitPending = true;
+    Invalidate();
+}
+
+void CanvasView::SetZoom(float zoom, const Point& anchor) {
+    // The world point under the anchor stays there
+    const Rect area = GetDrawingArea();
+    const Point world = ViewToWorld(anchor);
+    m_zoom = std::clamp(zoom, MIN_ZOOM, MAX_ZOOM);
+    m_pan = Point(anchor.x - area.x - world.x * m_zoom, anchor.y - area.y - world.y * m_zoom);
+    m_fitPending = false;
+    Invalidate();
+    NotifyViewChanged();
+}
+
+void CanvasView::Zoom(float factor, const Point& anchor) {
+    SetZoom(m_zoom * factor, anchor);
+}
+
+void CanvasView::PanBy(float dx, float dy) {
+    m_pan = Point(m_pan.x + dx, m_pan.y + dy);
+    m_fitPending = false;
+    Invalidate();
+    NotifyViewChanged();
+}
+
+void CanvasView::ZoomToFit() {
+    if (!m_model) return;
+    
+    if (GetDrawingArea().IsEmpty()) {
+        // Done on the first frame with a size
+        m_fitPending = true;
+        return;
+    }
+    if (m_model->GetItemCount() == 0) {
+        m_zoom = 1.0f;
+        m_pan = Point();
+        m_fitPending = false;
+        Invalidate();
+        NotifyViewChanged();
+        return;
+    }
+    ZoomToRect(m_model->GetBounds());
+}
+
+void CanvasView::ZoomToRect(const Rect& worldArea) {
+    const Rect area = GetDrawingArea();
+    if (area.IsEmpty()) return;
+    
+    // A zero-sized area, such as a single point, is shown at the largest zoom
+    const float zoomX = worldArea.width > 0 ? area.width / worldArea.width : MAX_ZOOM;
+    const float zoomY = worldArea.height > 0 ? area.height / worldArea.height : MAX_ZOOM;
+    m_zoom = std::clamp(std::min(zoomX, zoomY), MIN_ZOOM, MAX_ZOOM);
+    const Point center = worldArea.Center();
+    m_pan = Point(area.width / 2 - center.x * m_zoom, area.height / 2 - center.y * m_zoom);
+    m_fitPending = false;
+    Invalidate();
+    NotifyViewChanged();
+}
+
+Matrix3x2 CanvasView::GetViewTransform() const {
+    const Rect area = GetDrawingArea();
+    return Matrix3x2(m_zoom, 0.0f, 0.0f, m_zoom, area.x + m_pan.x, area.y + m_pan.y);
+}
+
+Point CanvasView::ViewToWorld(const Point& viewPoint) const {
+    const Rect area = GetDrawingArea();
+    return Point((viewPoint.x - area.x - m_pan.x) / m_zoom, (viewPoint.y - area.y - m_pan.y) / m_zoom);
+}
+
+Point CanvasView::WorldToView(const Point& worldPoint) const {
+    return GetViewTransform().TransformPoint(worldPoint);
+}
+
+CanvasView::ItemId CanvasView::HitTestItem(const Point& viewPoint) const {
+    if (!m_model || !GetDrawingArea().Contains(viewPoint)) return CanvasModel::NO_ITEM;
+    return m_model->HitTest(ViewToWorld(viewPoint), HIT_TOLERANCE / m_zoom);
+}
+
+void CanvasView::SetSelectedItem(ItemId item) {
+    if (item == m_selectedItem) return;
+    
+    m_selectedItem = item;
+    Invalidate();
+    if (OnSelectionChanged) {
+        OnSelectionChanged(item);
+    }
+}
+
+bool CanvasView::OnMouseEvent(const MouseEvent& event) {
+    if (!IsEnabled()) return false;
+    
+    if (m_dragging) {
+        if (event.type == EventType::MouseMoved) {
+            // Small movements are kept back until it is clear this is a drag and not a click
+            if (!m_dragMoved && std::hypot(event.position.x - m_dragStart.x, event.position.y - m_dragStart.y) >= DRAG_THRESHOLD) {
+                m_dragMoved = true;
+            }
+            if (m_dragMoved) {
+                PanBy(event.position.x - m_dragLast.x, event.position.y - m_dragLast.y);
+                m_dragLast = event.position;
+            }
+            return true;
+        }
+        if (event.type == EventType::MouseButtonReleased) {
+            m_dragging = false;
+            if (!m_dragMoved) {
+                const ItemId item = HitTestItem(m_dragStart);
+                SetSelectedItem(item);
+                if (item != CanvasModel::NO_ITEM && OnItemClicked) {
+                    OnItemClicked(item);
+                }
+            }
+            return true;
+        }
+    }
+    
+    if (event.type == EventType::MouseButtonPressed && event.button == MouseButton::Left && HitTest(event.position)) {
+        SetFocused(true);
+        m_dragging = true;
+        m_dragMoved = false;
+        m_dragStart = event.position;
+        m_dragLast = event.position;
+        return true;
+    }
+    
+    if (event.type == EventType::MouseScrolled && HitTest(event.position)) {
+        // Zooms around the point under the pointer; rolling forward zooms in
+        Zoom(std::pow(ZOOM_STEP, event.wheelDelta), event.position);
+        return true;
+    }
+    
+    return false;
+}
+
+bool CanvasView::OnKeyEvent(const KeyEvent& event) {
+    if (!IsEnabled() || event.type != EventType::KeyPressed) {
+        return false;
+    }
+    
+    const Rect area = GetDrawingArea();
+    switch (event.keyCode) {
+        case KeyCode::Left:
+            PanBy(area.width * PAN_FRACTION, 0.0f);
+            return true;
+        case KeyCode::Right:
+            PanBy(-area.width * PAN_FRACTION, 0.0f);
+            return true;
+        case KeyCode::Up:
+            PanBy(0.0f, area.height * PAN_FRACTION);
+            return true;
+        case KeyCode::Down:
+            PanBy(0.0f, -area.height * PAN_FRACTION);
+            return true;
+        case KeyCode::PageUp:
+            Zoom(ZOOM_STEP, area.Center());
+            return true;
+        case KeyCode::PageDown:
+            Zoom(1.0f / ZOOM_STEP, area.Center());
+            return true;
+        case KeyCode::Home:
+            ZoomToFit();
+            return true;
+        case KeyCode::Escape:
+            SetSelectedItem(CanvasModel::NO_ITEM);
+            return true;
+        default:
+            return false;
+    }
+}
+
+Size CanvasView::MeasureDesiredSize(const Size& availableSize) {
+    return Size(
+        Clamp(400.0f, GetMinSize().width, GetMaxSize().width),
+        Clamp(300.0f, GetMinSize().height, GetMaxSize().height)
+    );
+}
+
+void CanvasView::OnRender(std::shared_ptr<Renderer> renderer) {
+    if (!IsVisible() || !renderer) return;
+    
+    Brush backgroundBrush(GetBackgroundColor());
+    renderer->FillRectangle(GetBounds(), backgroundBrush);
+    
+    m_drawnItems = 0;
+    m_drawnClusters = 0;
+    const Rect area = GetDrawingArea();
+    if (m_model && !area.IsEmpty()) {
+        if (m_fitPending) {
+            ZoomToFit();
+        }
+        renderer->PushClipRect(area);
+    
+        // Only what is in view, with small branches collapsed
+        const Matrix3x2 toView = GetViewTransform();
+        Matrix3x2 toWorld;
+        toView.Invert(toWorld);
+        const Rect visible = toWorld.TransformRect(area);
+        m_visibleItems.clear();
+        m_clusters.clear();
+        if (m_clusterSize > 0) {
+            m_model->QueryClustered(visible, m_clusterSize / m_zoom, m_visibleItems, m_clusters);
+        } else {
+            m_model->Query(visible, m_visibleItems);
+        }
+    
+        const float dpiScale = renderer->GetDpiScale();
+        DrawClusters(*renderer, toView, dpiScale);
+    
+        // Numbers are the drawing order
+        std::sort(m_visibleItems.begin(), m_visibleItems.end());
+        m_textFont = m_font;
+        for (ItemId item : m_visibleItems) {
+            DrawItem(*renderer, m_model->GetItem(item), toView, dpiScale);
+        }
+        m_drawnItems = m_visibleItems.size();
+        m_drawnClusters = m_clusters.size();
+    
+        if (m_model->IsValid(m_selectedItem)) {
+            const Rect selected = toView.TransformRect(m_model->GetItemBounds(m_selectedItem));
+            if (selected.Intersects(area)) {
+                renderer->DrawRectangle(
+                    Rect(selected.x - SELECTION_WIDTH, selected.y - SELECTION_WIDTH,
+                         selected.width + 2 * SELECTION_WIDTH, selected.height + 2 * SELECTION_WIDTH),
+                    Pen(m_selectionColor, SELECTION_WIDTH));
+            }
+        }
+    
+        renderer->PopClipRect();
+    }
+    
+    if (GetBorderWidth() > 0) {
+        renderer->DrawRectangle(GetBounds(), Pen(GetBorderColor(), GetBorderWidth()));
+    }
+    
+    for (auto& child : GetChildren()) {
+        if (child && child->IsVisible()) {
+            child->Render(renderer);
+        }
+    }
+}
+
+void CanvasView::DrawItem(Renderer& renderer, const CanvasItem& item, const Matrix3x2& toView, float dpiScale) {
+    const bool filled = item.fillColor.a > 0.0f;
+    const bool stroked = item.strokeColor.a > 0.0f && item.strokeWidth > 0.0f;
+    // Strokes keep to at least a device pixel, so zoomed-out outlines stay visible
+    const float strokeWidth = std::max(item.strokeWidth * m_zoom, 1.0f / dpiScale);
+    
+    switch (item.shape) {
+        case CanvasShape::Rectangle: {
+            const Rect rect = toView.TransformRect(item.bounds);
+            if (filled) {
+                renderer.FillRectangle(rect, Brush(item.fillColor));
+            }
+            if (stroked) {
+                renderer.DrawRectangle(rect, Pen(item.strokeColor, strokeWidth));
+            }
+            break;
+        }
+        case CanvasShape::Ellipse: {
+            const Rect rect = toView.TransformRect(item.bounds);
+            if (filled) {
+                renderer.FillEllipse(rect.Center(), rect.width / 2, rect.height / 2, Brush(item.fillColor));
+            }
+            if (stroked) {
+                renderer.DrawEllipse(rect.Center(), rect.width / 2, rect.height / 2, Pen(item.strokeColor, strokeWidth));
+            }
+            break;
+        }
+        case CanvasShape::Line:
+            if (stroked) {
+                renderer.DrawLine(toView.TransformPoint(item.start), toView.TransformPoint(item.end), Pen(item.strokeColor, strokeWidth));
+            }
+            break;
+        case CanvasShape::Text: {
+            const Rect rect = toView.TransformRect(item.bounds);
+            if (filled) {
+                renderer.FillRectangle(rect, Brush(item.fillColor));
+            }
+            // Text too small to read is left out, and text of no size is never drawn, whatever the minimum
+            const float textSize = item.fontSize * m_zoom;
+            if (!item.text.empty() && item.strokeColor.a > 0.0f && textSize > 0.0f && textSize * dpiScale >= m_minTextSize) {
+                const float steps = std::round(std::log2(textSize) * TEXT_SIZE_STEPS_PER_DOUBLING);
+                m_textFont.size = std::exp2(steps / TEXT_SIZE_STEPS_PER_DOUBLING);
+                renderer.DrawText(item.text, rect, m_textFont, Brush(item.strokeColor), TextAlignment::Center);
+            }
+            break;
+        }
+    }
+}
+
+void CanvasView::DrawClusters(Renderer& renderer, const Matrix3x2& toView, float dpiScale) {
+    if (m_clusters.empty()) return;
+    
+    // Each cluster is a block at least a device pixel across in the colour of one of its items, batched by colour
+    const float minSize = 1.0f / dpiScale;
+    m_clusterFills.clear();
+    for (const QuadTree::Cluster& cluster : m_clusters) {
+        const CanvasItem& item = m_model->GetItem(cluster.representative);
+        const Color& color = item.fillColor.a > 0.0f ? item.fillColor : item.strokeColor;
+        Rect rect = toView.TransformRect(cluster.bounds);
+        rect.width = std::max(rect.width, minSize);
+        rect.height = std::max(rect.height, minSize);
+        m_clusterFills.emplace_back(color.ToARGB(), rect);
+    }
+    std::sort(m_clusterFills.begin(), m_clusterFills.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    
+    size_t start = 0;
+    while (start < m_clusterFills.size()) {
+        const uint32_t argb = m_clusterFills[start].first;
+        m_clusterRects.clear();
+        size_t end = start;
+        while (end < m_clusterFills.size() && m_clusterFills[end].first == argb) {
+            m_clusterRects.push_back(m_clusterFills[end].second);
+            ++end;
+        }
+        if (argb >> 24) {
+            const Color color = Color::FromRGBA((argb >> 16) & 0xFF, (argb >> 8) & 0xFF, argb & 0xFF, argb >> 24);
+            renderer.FillRectangles(m_clusterRects.data(), m_clusterRects.size(), Brush(color));
+        }
+        start = end;
+    }
+}
+
+void CanvasView::NotifyViewChanged() {
+    if (OnViewChanged) {
+        OnViewChanged();
+    }
+}
+
+Rect CanvasView::GetDrawingArea() const {
+    const Rect bounds = GetBounds();
+    const Spacing padding = GetPadding();
+    return Rect(
+        bounds.x + padding.left,
+        bounds.y + padding.top,
+        std::max(0.0f, bounds.width - padding.Horizontal()),
+        std::max(0.0f, bounds.height - padding.Vertical())
+    );
+}
+
+} // namespace miko
@@ -0,0 +1,319 @@
+#include "miko/widgets/ChartView.h"
+#include "miko/core/Renderer.h"
+#include "miko/utils/FrameArena.h"
+#include <algorithm>
+#include <cmath>
+
+namespace miko {
+
+// Zooming in stops at this many samples across the view
+static const double MIN_VISIBLE_SAMPLES = 8.0;
+// View length change per wheel notch or Up/Down key
+static const double ZOOM_STEP = 1.25;
+// Part of the view moved by Left/Right
+static const double PAN_FRACTION = 0.125;
+// Horizontal grid lines split the plot into this many bands
+static const int GRID_BANDS = 4;
+// Automatic y scaling leaves this fraction of the range free above and below
+static const float Y_MARGIN = 0.05f;
+
+ChartView::ChartView()
+    : m_sampleCount(0)
+    , m_viewStart(0.0)
+    , m_viewLength(1000.0)
+    , m_followLatest(true)
+    , m_autoScaleY(true)
+    , m_yMin(0.0f)
+    , m_yMax(1.0f)
+    , m_lineWidth(1.0f)
+    , m_gridColor(Color::FromRGBA(225, 225, 225))
+    , m_dragging(false)
+    , m_dragStartX(0.0f)
+    , m_dragStartView(0.0)
+{
+    SetSize(Size(400, 300));
+    SetBackgroundColor(Color::White);
+    SetBorderColor(Color::FromRGBA(128, 128, 128, 255));
+    SetBorderWidth(1.0f);
+    SetPadding(Spacing(4, 4, 4, 4));
+}
+
+size_t ChartView::AddSeries(const std::string& name, const Color& color) {
+    m_series.push_back(Series{ name, color, MinMaxPyramid() });
+    Invalidate();
+    return m_series.size() - 1;
+}
+
+void ChartView::Append(size_t series, const float* values, size_t count) {
+    if (count == 0) return;
+    m_pending.Push(PendingSamples{ series, std::vector<float>(values, values + count) });
+}
+
+void ChartView::FlushAppends() {
+    const size_t taken = m_pending.Drain([this](PendingSamples&& pending) {
+        // Samples for a series that was never added are dropped
+        if (pending.series >= m_series.size()) return;
+        MinMaxPyramid& samples = m_series[pending.series].samples;
+        samples.Append(pending.values.data(), pending.values.size());
+        m_sampleCount = std::max(m_sampleCount, samples.GetSampleCount());
+    });
+    if (taken == 0) return;
+    
+    if (m_followLatest) {
+        m_viewStart = GetMaxViewStart();
+    }
+    Invalidate();
+}
+
+void ChartView::ClearSamples() {
+    m_pending.Drain([](PendingSamples&&) {}, 0);
+    for (Series& series : m_series) {
+        series.samples.Clear();
+    }
+    m_sampleCount = 0;
+    m_viewStart = 0.0;
+    Invalidate();
+}
+
+void ChartView::SetVisibleRange(double start, double length) {
+    if (!std::isfinite(start) || !std::isfinite(length)) return;
+    
+    m_viewLength = std::max(length, MIN_VISIBLE_SAMPLES);
+    const double maxStart = GetMaxViewStart();
+    m_viewStart = std::clamp(start, 0.0, maxStart);
+    // Scrolling back to the newest samples resumes following them, as in LogView
+    m_followLatest = m_viewStart >= maxStart;
+    Invalidate();
+    
+    if (OnVisibleRangeChanged) {
+        OnVisibleRangeChanged(m_viewStart, m_viewLength);
+    }
+}
+
+void ChartView::ZoomToFit() {
+    SetVisibleRange(0.0, (double)m_sampleCount);
+}
+
+void ChartView::Zoom(double factor, double anchor) {
+    if (!(factor > 0.0)) return;
+    
+    // The anchor stays at the same place on screen
+    const double length = std::max(m_viewLength * factor, MIN_VISIBLE_SAMPLES);
+    const double scale = length / m_viewLength;
+    SetVisibleRange(anchor - (anchor - m_viewStart) * scale, length);
+}
+
+void ChartView::SetFollowLatest(bool follow) {
+    m_followLatest = follow;
+    if (follow) {
+        SetVisibleRange(GetMaxViewStart(), m_viewLength);
+    }
+}
+
+void ChartView::SetYRange(float min, float max) {
+    m_autoScaleY = false;
+    m_yMin = std::min(min, max);
+    m_yMax = std::max(min, max);
+    Invalidate();
+}
+
+bool ChartView::OnMouseEvent(const MouseEvent& event) {
+    if (!IsEnabled()) return false;
+    
+    const Rect plot = GetPlotRect();
+    if (m_dragging) {
+        if (event.type == EventType::MouseMoved) {
+            // Dragging moves the samples with the pointer
+            const double samplesPerDip = plot.width > 0 ? m_viewLength / plot.width : 0.0;
+            SetVisibleRange(m_dragStartView - (event.position.x - m_dragStartX) * samplesPerDip, m_viewLength);
+            return true;
+        }
+        if (event.type == EventType::MouseButtonReleased) {
+            m_dragging = false;
+            return true;
+        }
+    }
+    
+    if (event.type == EventType::MouseButtonPressed && event.button == MouseButton::Left && HitTest(event.position)) {
+        SetFocused(true);
+        m_dragging = true;
+        m_dragStartX = event.position.x;
+        m_dragStartView = m_viewStart;
+        return true;
+    }
+    
+    if (event.type == EventType::MouseScrolled && HitTest(event.position)) {
+        // Zooms around the sample under the pointer; rolling forward zooms in
+        const double offset = plot.width > 0 ? std::clamp((event.position.x - plot.x) / plot.width, 0.0f, 1.0f) : 0.0;
+        Zoom(std::pow(ZOOM_STEP, -event.wheelDelta), m_viewStart + offset * m_viewLength);
+        return true;
+    }
+    
+    return false;
+}
+
+bool ChartView::OnKeyEvent(const KeyEvent& event) {
+    if (!IsEnabled() || event.type != EventType::KeyPressed) {
+        return false;
+    }
+    
+    const double center = m_viewStart + m_viewLength / 2;
+    switch (event.keyCode) {
+        case KeyCode::Left:
+            SetVisibleRange(m_viewStart - m_viewLength * PAN_FRACTION, m_viewLength);
+            return true;
+        case KeyCode::Right:
+            SetVisibleRange(m_viewStart + m_viewLength * PAN_FRACTION, m_viewLength);
+            return true;
+        case KeyCode::Up:
+            Zoom(1.0 / ZOOM_STEP, center);
+            return true;
+        case KeyCode::Down:
+            Zoom(ZOOM_STEP, center);
+            return true;
+        case KeyCode::Home:
+            ZoomToFit();
+            return true;
+        case KeyCode::End:
+            SetFollowLatest(true);
+            return true;
+        default:
+            return false;
+    }
+}
+
+Size ChartView::MeasureDesiredSize(const Size& availableSize) {
+    return Size(
+        Clamp(400.0f, GetMinSize().width, GetMaxSize().width),
+        Clamp(300.0f, GetMinSize().height, GetMaxSize().height)
+    );
+}
+
+void ChartView::OnRender(std::shared_ptr<Renderer> renderer) {
+    // Appends are applied once per frame, before drawing
+    FlushAppends();
+    
+    if (!IsVisible() || !renderer) return;
+    
+    Brush backgroundBrush(GetBackgroundColor());
+    renderer->FillRectangle(GetBounds(), backgroundBrush);
+    if (GetBorderWidth() > 0) {
+        Color borderColor = IsFocused() ? Color::FromRGBA(0, 120, 215, 255) : GetBorderColor();
+        renderer->DrawRectangle(GetBounds(), Pen(borderColor, GetBorderWidth()));
+    }
+    
+    const Rect plot = GetPlotRect();
+    if (plot.width > 0 && plot.height > 0) {
+        renderer->PushClipRect(plot);
+    
+        Rect gridLines[GRID_BANDS - 1];
+        for (int i = 1; i < GRID_BANDS; ++i) {
+            gridLines[i - 1] = Rect(plot.x, plot.y + plot.height * i / GRID_BANDS, plot.width, 1.0f);
+        }
+        renderer->FillRectangles(gridLines, GRID_BANDS - 1, Brush(m_gridColor));
+    
+        // One column per physical pixel
+        const size_t columns = (size_t)std::max(1.0f, std::ceil(plot.width * renderer->GetDpiScale()));
+        FrameArena& arena = GetFrameArena();
+        FrameArena::Scope scratchScope(arena);
+        Point** points = arena.AllocateArray<Point*>(m_series.size());
+        size_t* pointCounts = arena.AllocateArray<size_t>(m_series.size());
+    
+        // Every series is reduced first, since automatic scaling needs all their ranges
+        float low = INFINITY;
+        float high = -INFINITY;
+        for (size_t s = 0; s < m_series.size(); ++s) {
+            points[s] = arena.AllocateArray<Point>(2 * columns + 4);
+            pointCounts[s] = DecimateSeries(m_series[s].samples, plot, columns, points[s]);
+            for (size_t i = 0; i < pointCounts[s]; ++i) {
+                low = std::min(low, points[s][i].y);
+                high = std::max(high, points[s][i].y);
+            }
+        }
+        if (m_autoScaleY && low <= high) {
+            if (low == high) {
+                low -= 1.0f;
+                high += 1.0f;
+            }
+            const float margin = (high - low) * Y_MARGIN;
+            m_yMin = low - margin;
+            m_yMax = high + margin;
+        }
+    
+        const float yScale = m_yMax > m_yMin ? plot.height / (m_yMax - m_yMin) : 0.0f;
+        const float bottom = plot.y + plot.height;
+        for (size_t s = 0; s < m_series.size(); ++s) {
+            if (pointCounts[s] < 2) continue;
+            for (size_t i = 0; i < pointCounts[s]; ++i) {
+                points[s][i].y = bottom - (points[s][i].y - m_yMin) * yScale;
+            }
+            renderer->DrawPolyline(points[s], pointCounts[s], Pen(m_series[s].color, m_lineWidth));
+        }
+    
+        renderer->PopClipRect();
+    }
+    
+    for (auto& child : GetChildren()) {
+        if (child && child->IsVisible()) {
+            child->Render(renderer);
+        }
+    }
+}
+
+size_t ChartView::DecimateSeries(const MinMaxPyramid& samples, const Rect& plot, size_t columns, Point* points) const {
+    const size_t sampleCount = samples.GetSampleCount();
+    const double viewEnd = m_viewStart + m_viewLength;
+    if (sampleCount == 0 || m_viewStart >= (double)sampleCount) return 0;
+    
+    const double dipsPerSample = plot.width / m_viewLength;
+    const double samplesPerColumn = m_viewLength / (double)columns;
+    size_t count = 0;
+    
+    if (samplesPerColumn <= 2.0) {
+        // Few enough to draw every sample, plus one past each edge so the line reaches it
+        const size_t first = (size_t)m_viewStart;
+        const size_t end = std::min(sampleCount, (size_t)std::ceil(viewEnd) + 1);
+        const float* values = samples.GetSamples();
+        for (size_t i = first; i < end; ++i) {
+            points[count++] = Point(plot.x + (float)((i - m_viewStart) * dipsPerSample), values[i]);
+        }
+        return count;
+    }
+    
+    // Each column shows the lowest and highest value under it, in the order that
+    // keeps the segment joining it to the previous column short
+    const size_t level = samples.PickLevel(samplesPerColumn);
+    const float columnWidth = plot.width / (float)columns;
+    float previous = 0.0f;
+    for (size_t column = 0; column < columns; ++column) {
+        const double begin = m_viewStart + column * samplesPerColumn;
+        const double end = std::min(std::ceil(begin + samplesPerColumn), (double)sampleCount);
+        float low;
+        float high;
+        if (!samples.GetRange(level, (size_t)begin, (size_t)end, low, high)) break;
+    
+        const float x = plot.x + (column + 0.5f) * columnWidth;
+        const bool lowFirst = count == 0 || std::abs(previous - low) <= std::abs(previous - high);
+        points[count++] = Point(x, lowFirst ? low : high);
+        points[count++] = Point(x, lowFirst ? high : low);
+        previous = lowFirst ? high : low;
+    }
+    return count;
+}
+
+double ChartView::GetMaxViewStart() const {
+    return std::max(0.0, (double)m_sampleCount - m_viewLength);
+}
+
+Rect ChartView::GetPlotRect() const {
+    const Rect bounds = GetBounds();
+    const Spacing padding = GetPadding();
+    return Rect(
+        bounds.x + padding.left,
+        bounds.y + padding.top,
+        std::max(0.0f, bounds.width - padding.left - padding.right),
+        std::max(0.0f, bounds.height - padding.top - padding.bottom)
+    );
+}
+
+} // namespace miko
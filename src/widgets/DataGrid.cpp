@@ -0,0 +1,542 @@
+#include "miko/widgets/DataGrid.h"
+#include "miko/core/Renderer.h"
+#include "miko/text/Utf8.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace miko {
+
+static const float DEFAULT_COLUMN_WIDTH = 100.0f;
+static const float MIN_COLUMN_WIDTH = 16.0f;
+static const float CELL_PADDING = 4.0f;
+// How close to a header cell's right edge a press must be to start resizing the column
+static const float RESIZE_GRIP_WIDTH = 4.0f;
+static const float HORIZONTAL_SCROLL_STEP = 40.0f;
+// Longer cell text is cut for display
+static const size_t MAX_CELL_TEXT_LENGTH = 256;
+
+// Sort direction marks appended to the header of the sorted column
+static const char* const SORT_ASCENDING_MARK = " \xE2\x96\xB2";
+static const char* const SORT_DESCENDING_MARK = " \xE2\x96\xBC";
+
+DataGrid::DataGrid()
+    : m_sortColumn(NO_COLUMN)
+    , m_sortAscending(true)
+    , m_frozenRows(0)
+    , m_frozenColumns(0)
+    , m_firstRow(0)
+    , m_scrollX(0.0f)
+    , m_selectedRow(NO_ROW)
+    , m_selectedPosition(NO_ROW)
+    , m_resizingColumn(NO_COLUMN)
+    , m_resizeStartX(0.0f)
+    , m_resizeStartWidth(0.0f)
+    , m_font("Segoe UI", 12.0f, FontWeight::Normal, FontStyle::Normal)
+    , m_headerFont("Segoe UI", 12.0f, FontWeight::Bold, FontStyle::Normal)
+    , m_textColor(Color::TextColor)
+    , m_headerColor(Color::WindowBackground)
+    , m_alternateRowColor(Color::FromRGBA(246, 246, 246, 255))
+    , m_selectionColor(Color::PressedColor)
+    , m_gridLineColor(Color::FromRGBA(218, 218, 218, 255))
+{
+    SetSize(Size(600, 400));
+    SetBackgroundColor(Color::White);
+    SetBorderColor(Color::FromRGBA(128, 128, 128, 255));
+    SetBorderWidth(1.0f);
+    SetPadding(Spacing(1, 1, 1, 1));
+    UpdateColumnOffsets();
+}
+
+void DataGrid::SetTable(std::shared_ptr<const DataTable> table) {
+    m_orderJob.Cancel();
+    m_table = std::move(table);
+    m_order.reset();
+    
+    const size_t columnCount = m_table ? m_table->GetColumnCount() : 0;
+    m_columnWidths.assign(columnCount, DEFAULT_COLUMN_WIDTH);
+    UpdateColumnOffsets();
+    if (m_sortColumn >= columnCount) {
+        m_sortColumn = NO_COLUMN;
+    }
+    
+    m_firstRow = 0;
+    m_scrollX = 0.0f;
+    m_selectedRow = NO_ROW;
+    m_selectedPosition = NO_ROW;
+    m_resizingColumn = NO_COLUMN;
+    
+    // Rows show in table order until the sort and filter job finishes
+    StartOrderJob();
+    Invalidate();
+}
+
+size_t DataGrid::GetRowCount() const {
+    if (m_order) return m_order->size();
+    return m_table ? m_table->GetRowCount() : 0;
+}
+
+void DataGrid::SortByColumn(size_t column, bool ascending) {
+    if (!m_table || column >= m_table->GetColumnCount()) return;
+    
+    m_sortColumn = column;
+    m_sortAscending = ascending;
+    StartOrderJob();
+    Invalidate();
+}
+
+void DataGrid::ClearSort() {
+    m_sortColumn = NO_COLUMN;
+    m_sortAscending = true;
+    StartOrderJob();
+    Invalidate();
+}
+
+void DataGrid::SetFilter(RowFilter filter) {
+    m_filter = std::move(filter);
+    StartOrderJob();
+    Invalidate();
+}
+
+void DataGrid::SetColumnWidth(size_t column, float width) {
+    if (column >= m_columnWidths.size()) return;
+    
+    m_columnWidths[column] = std::max(width, MIN_COLUMN_WIDTH);
+    UpdateColumnOffsets();
+    ClampScroll();
+    Invalidate();
+}
+
+void DataGrid::SetFrozenRowCount(size_t count) {
+    m_frozenRows = count;
+    ClampScroll();
+    Invalidate();
+}
+
+void DataGrid::SetFrozenColumnCount(size_t count) {
+    m_frozenColumns = count;
+    ClampScroll();
+    Invalidate();
+}
+
+void DataGrid::SetSelectedRow(size_t tableRow) {
+    if (!m_table || tableRow >= m_table->GetRowCount()) {
+        tableRow = NO_ROW;
+    }
+    if (tableRow == m_selectedRow) return;
+    
+    m_selectedRow = tableRow;
+    UpdateSelectedPosition();
+    if (OnSelectionChanged) {
+        OnSelectionChanged(m_selectedRow);
+    }
+    Invalidate();
+}
+
+void DataGrid::ScrollToRow(size_t row) {
+    const size_t firstRow = m_firstRow;
+    m_firstRow = row;
+    ClampScroll();
+    if (m_firstRow != firstRow) {
+        Invalidate();
+    }
+}
+
+void DataGrid::SetHorizontalOffset(float offset) {
+    const float scrollX = m_scrollX;
+    m_scrollX = offset;
+    ClampScroll();
+    if (m_scrollX != scrollX) {
+        Invalidate();
+    }
+}
+
+void DataGrid::SetFont(const Font& font) {
+    m_font = font;
+    m_headerFont = font;
+    m_headerFont.weight = FontWeight::Bold;
+    ClampScroll();
+    Invalidate();
+}
+
+bool DataGrid::OnMouseEvent(const MouseEvent& event) {
+    if (!IsEnabled()) return false;
+    
+    const Rect grid = GetGridRect();
+    if (m_resizingColumn != NO_COLUMN) {
+        if (event.type == EventType::MouseMoved) {
+            SetColumnWidth(m_resizingColumn, m_resizeStartWidth + event.position.x - m_resizeStartX);
+            return true;
+        }
+        if (event.type == EventType::MouseButtonReleased) {
+            m_resizingColumn = NO_COLUMN;
+            return true;
+        }
+    }
+    
+    if (event.type == EventType::MouseButtonPressed && event.button == MouseButton::Left && HitTest(event.position)) {
+        SetFocused(true);
+        if (!m_table) return true;
+    
+        if (event.position.y < grid.y + GetRowHeight()) {
+            // A press on the edge between two header cells resizes the left one; elsewhere it sorts
+            const size_t edgeColumn = HitTestColumn(event.position.x - RESIZE_GRIP_WIDTH, grid);
+            if (edgeColumn != NO_COLUMN &&
+                GetColumnX(edgeColumn, grid) + m_columnWidths[edgeColumn] <= event.position.x + RESIZE_GRIP_WIDTH) {
+                m_resizingColumn = edgeColumn;
+                m_resizeStartX = event.position.x;
+                m_resizeStartWidth = m_columnWidths[edgeColumn];
+                return true;
+            }
+    
+            const size_t column = HitTestColumn(event.position.x, grid);
+            if (column != NO_COLUMN) {
+                SortByColumn(column, column != m_sortColumn || !m_sortAscending);
+            }
+            return true;
+        }
+    
+        const size_t row = HitTestRow(event.position.y, grid);
+        if (row != NO_ROW) {
+            MoveSelection(row);
+        }
+        return true;
+    }
+    
+    if (event.type == EventType::MouseScrolled && HitTest(event.position)) {
+        if (event.shiftPressed) {
+            SetHorizontalOffset(m_scrollX - event.wheelDelta * HORIZONTAL_SCROLL_STEP);
+        } else {
+            const ptrdiff_t delta = (ptrdiff_t)(-event.wheelDelta * 3.0f);
+            ScrollToRow((size_t)std::max<ptrdiff_t>(0, (ptrdiff_t)m_firstRow + delta));
+        }
+        return true;
+    }
+    
+    return false;
+}
+
+bool DataGrid::OnKeyEvent(const KeyEvent& event) {
+    if (!IsEnabled() || event.type != EventType::KeyPressed) {
+        return false;
+    }
+    
+    const size_t rowCount = GetRowCount();
+    const size_t page = GetScrollingRowCapacity();
+    // With no selection in view, moving starts from the first scrolling row
+    const size_t position = m_selectedPosition != NO_ROW ? m_selectedPosition : m_firstRow;
+    const bool hasSelection = m_selectedPosition != NO_ROW;
+    switch (event.keyCode) {
+        case KeyCode::Up:
+            MoveSelection(hasSelection && position > 0 ? position - 1 : position);
+            return true;
+        case KeyCode::Down:
+            MoveSelection(hasSelection ? position + 1 : position);
+            return true;
+        case KeyCode::PageUp:
+            MoveSelection(position > page ? position - page : 0);
+            return true;
+        case KeyCode::PageDown:
+            MoveSelection(position + page);
+            return true;
+        case KeyCode::Home:
+            // The first rows may be frozen, which would not scroll by themselves
+            ScrollToRow(0);
+            MoveSelection(0);
+            return true;
+        case KeyCode::End:
+            MoveSelection(rowCount > 0 ? rowCount - 1 : 0);
+            return true;
+        case KeyCode::Left:
+            SetHorizontalOffset(m_scrollX - HORIZONTAL_SCROLL_STEP);
+            return true;
+        case KeyCode::Right:
+            SetHorizontalOffset(m_scrollX + HORIZONTAL_SCROLL_STEP);
+            return true;
+        default:
+            return false;
+    }
+}
+
+Size DataGrid::MeasureDesiredSize(const Size& availableSize) {
+    return Size(
+        Clamp(600.0f, GetMinSize().width, GetMaxSize().width),
+        Clamp(400.0f, GetMinSize().height, GetMaxSize().height)
+    );
+}
+
+void DataGrid::OnRender(std::shared_ptr<Renderer> renderer) {
+    if (!IsVisible() || !renderer) return;
+    
+    UpdateOrder();
+    // The widget may have been resized since the last frame
+    ClampScroll();
+    
+    Brush backgroundBrush(GetBackgroundColor());
+    renderer->FillRectangle(GetBounds(), backgroundBrush);
+    if (GetBorderWidth() > 0) {
+        Color borderColor = IsFocused() ? Color::FromRGBA(0, 120, 215, 255) : GetBorderColor();
+        renderer->DrawRectangle(GetBounds(), Pen(borderColor, GetBorderWidth()));
+    }
+    
+    if (m_table && !m_columnWidths.empty()) {
+        const Rect grid = GetGridRect();
+        const float gridRight = grid.x + grid.width;
+        const float gridBottom = grid.y + grid.height;
+        const float rowHeight = GetRowHeight();
+        const size_t rowCount = GetRowCount();
+        const size_t columnCount = m_columnWidths.size();
+        const size_t frozenRows = GetShownFrozenRowCount();
+        const size_t frozenColumns = std::min(m_frozenColumns, columnCount);
+        const float frozenRight = grid.x + GetFrozenWidth();
+        renderer->PushClipRect(grid);
+    
+        // Rows on screen: the frozen ones, then the scrolling ones from m_firstRow down to the bottom edge
+        m_visibleRows.clear();
+        for (size_t band = 0; grid.y + (band + 1) * rowHeight < gridBottom; ++band) {
+            const size_t row = band < frozenRows ? band : m_firstRow + (band - frozenRows);
+            if (row >= rowCount) break;
+            m_visibleRows.push_back(row);
+        }
+    
+        // Columns on screen: the frozen ones, then the scrolling ones from the horizontal offset to the right edge
+        m_visibleColumns.clear();
+        for (size_t column = 0; column < frozenColumns && GetColumnX(column, grid) < gridRight; ++column) {
+            m_visibleColumns.push_back(column);
+        }
+        const size_t firstScrolling = std::max(frozenColumns, (size_t)(std::upper_bound(
+            m_columnOffsets.begin(), m_columnOffsets.end(), m_columnOffsets[frozenColumns] + m_scrollX) - m_columnOffsets.begin()) - 1);
+        for (size_t column = firstScrolling; column < columnCount && GetColumnX(column, grid) < gridRight; ++column) {
+            m_visibleColumns.push_back(column);
+        }
+        const float rowsBottom = grid.y + (m_visibleRows.size() + 1) * rowHeight;
+    
+        // Backgrounds: header, alternate rows, then the selection
+        renderer->FillRectangle(Rect(grid.x, grid.y, grid.width, rowHeight), Brush(m_headerColor));
+        m_fillRects.clear();
+        for (size_t band = 0; band < m_visibleRows.size(); ++band) {
+            const size_t row = m_visibleRows[band];
+            if (row % 2 == 1 && row != m_selectedPosition) {
+                m_fillRects.push_back(Rect(grid.x, grid.y + (band + 1) * rowHeight, grid.width, rowHeight));
+            }
+        }
+        renderer->FillRectangles(m_fillRects.data(), m_fillRects.size(), Brush(m_alternateRowColor));
+        for (size_t band = 0; band < m_visibleRows.size(); ++band) {
+            if (m_visibleRows[band] == m_selectedPosition) {
+                renderer->FillRectangle(Rect(grid.x, grid.y + (band + 1) * rowHeight, grid.width, rowHeight), Brush(m_selectionColor));
+            }
+        }
+    
+        // Grid lines, all in one batch; the edges of the frozen area are drawn twice as thick
+        m_fillRects.clear();
+        for (size_t band = 0; band <= m_visibleRows.size(); ++band) {
+            const float thickness = (band == 0 || band == frozenRows) ? 2.0f : 1.0f;
+            m_fillRects.push_back(Rect(grid.x, grid.y + (band + 1) * rowHeight - thickness, grid.width, thickness));
+        }
+        for (size_t column : m_visibleColumns) {
+            const float right = GetColumnX(column, grid) + m_columnWidths[column];
+            if (column >= frozenColumns && right <= frozenRight) continue;
+            const float thickness = column + 1 == frozenColumns ? 2.0f : 1.0f;
+            m_fillRects.push_back(Rect(right - thickness, grid.y, thickness, rowsBottom - grid.y));
+        }
+        renderer->FillRectangles(m_fillRects.data(), m_fillRects.size(), Brush(m_gridLineColor));
+    
+        // Text, one column at a time under a clip for that column. Text cells are
+        // laid out wider than the column so long values are cut off rather than wrapped
+        const Brush textBrush(m_textColor);
+        const float textHeight = rowHeight - CELL_PADDING;
+        for (size_t column : m_visibleColumns) {
+            const float x = GetColumnX(column, grid);
+            const float width = m_columnWidths[column];
+            const float clipLeft = column < frozenColumns ? x : std::max(x, frozenRight);
+            const float clipRight = std::min(x + width, gridRight);
+            if (clipRight <= clipLeft) continue;
+            renderer->PushClipRect(Rect(clipLeft, grid.y, clipRight - clipLeft, rowsBottom - grid.y));
+    
+            const bool number = m_table->GetColumnType(column) == DataTable::ColumnType::Number;
+            const TextAlignment alignment = number ? TextAlignment::Right : TextAlignment::Left;
+            const float textWidth = number ? width - 2 * CELL_PADDING : MAX_CELL_TEXT_LENGTH * m_font.size;
+    
+            m_cellText = m_table->GetColumnName(column);
+            if (column == m_sortColumn) {
+                m_cellText += m_sortAscending ? SORT_ASCENDING_MARK : SORT_DESCENDING_MARK;
+            }
+            renderer->DrawText(GetFirstLine(m_cellText, MAX_CELL_TEXT_LENGTH), Rect(x + CELL_PADDING, grid.y + CELL_PADDING / 2, textWidth, textHeight),
+                               m_headerFont, textBrush, alignment);
+    
+            for (size_t band = 0; band < m_visibleRows.size(); ++band) {
+                const std::string_view text = m_table->FormatCell(GetTableRow(m_visibleRows[band]), column, m_cellText);
+                if (text.empty()) continue;
+                const float y = grid.y + (band + 1) * rowHeight + CELL_PADDING / 2;
+                renderer->DrawText(GetFirstLine(text, MAX_CELL_TEXT_LENGTH), Rect(x + CELL_PADDING, y, textWidth, textHeight),
+                                   m_font, textBrush, alignment);
+            }
+    
+            renderer->PopClipRect();
+        }
+    
+        renderer->PopClipRect();
+    }
+    
+    for (auto& child : GetChildren()) {
+        if (child && child->IsVisible()) {
+            child->Render(renderer);
+        }
+    }
+}
+
+void DataGrid::StartOrderJob() {
+    if (!m_table) {
+        m_orderJob.Cancel();
+        return;
+    }
+    
+    if (!m_filter && m_sortColumn == NO_COLUMN) {
+        // Table order needs no index
+        m_orderJob.Cancel();
+        if (m_order) {
+            ApplyOrder(nullptr);
+        }
+        return;
+    }
+    m_orderJob.Start(m_table, m_filter, m_sortColumn, m_sortAscending);
+}
+
+void DataGrid::UpdateOrder() {
+    if (!m_orderJob.IsRunning()) return;
+    
+    std::shared_ptr<const BackgroundRowOrder::RowIndex> order;
+    if (m_orderJob.TakeResult(order)) {
+        ApplyOrder(std::move(order));
+    } else {
+        // Keep frames coming until the job is done
+        Invalidate();
+    }
+}
+
+void DataGrid::ApplyOrder(std::shared_ptr<const BackgroundRowOrder::RowIndex> order) {
+    m_order = std::move(order);
+    UpdateSelectedPosition();
+    ClampScroll();
+    if (OnOrderChanged) {
+        OnOrderChanged(GetRowCount());
+    }
+    Invalidate();
+}
+
+void DataGrid::UpdateColumnOffsets() {
+    m_columnOffsets.resize(m_columnWidths.size() + 1);
+    m_columnOffsets[0] = 0.0f;
+    for (size_t column = 0; column < m_columnWidths.size(); ++column) {
+        m_columnOffsets[column + 1] = m_columnOffsets[column] + m_columnWidths[column];
+    }
+}
+
+void DataGrid::UpdateSelectedPosition() {
+    m_selectedPosition = NO_ROW;
+    if (m_selectedRow == NO_ROW) return;
+    
+    if (!m_order) {
+        m_selectedPosition = m_selectedRow < GetRowCount() ? m_selectedRow : NO_ROW;
+        return;
+    }
+    // Once per new order, so a linear scan is fine even for millions of rows
+    auto found = std::find(m_order->begin(), m_order->end(), (uint32_t)m_selectedRow);
+    if (found != m_order->end()) {
+        m_selectedPosition = (size_t)(found - m_order->begin());
+    }
+}
+
+void DataGrid::MoveSelection(size_t position) {
+    const size_t rowCount = GetRowCount();
+    if (rowCount == 0) return;
+    
+    position = std::min(position, rowCount - 1);
+    const size_t tableRow = GetTableRow(position);
+    m_selectedPosition = position;
+    if (tableRow != m_selectedRow) {
+        m_selectedRow = tableRow;
+        if (OnSelectionChanged) {
+            OnSelectionChanged(m_selectedRow);
+        }
+    }
+    
+    // Frozen rows are always in view
+    const size_t capacity = GetScrollingRowCapacity();
+    if (position >= GetShownFrozenRowCount()) {
+        if (position < m_firstRow) {
+            ScrollToRow(position);
+        } else if (position >= m_firstRow + capacity) {
+            ScrollToRow(position - capacity + 1);
+        }
+    }
+    Invalidate();
+}
+
+void DataGrid::ClampScroll() {
+    const size_t rowCount = GetRowCount();
+    const size_t frozenRows = GetShownFrozenRowCount();
+    const size_t capacity = GetScrollingRowCapacity();
+    const size_t maxFirstRow = std::max(frozenRows, rowCount > capacity ? rowCount - capacity : 0);
+    m_firstRow = std::clamp(m_firstRow, frozenRows, maxFirstRow);
+    
+    const float maxScrollX = std::max(0.0f, m_columnOffsets.back() - GetGridRect().width);
+    m_scrollX = std::clamp(m_scrollX, 0.0f, maxScrollX);
+}
+
+float DataGrid::GetRowHeight() const {
+    return m_font.size * 1.2f + CELL_PADDING;
+}
+
+Rect DataGrid::GetGridRect() const {
+    const Rect bounds = GetBounds();
+    const Spacing padding = GetPadding();
+    return Rect(
+        bounds.x + padding.left,
+        bounds.y + padding.top,
+        std::max(0.0f, bounds.width - padding.left - padding.right),
+        std::max(0.0f, bounds.height - padding.top - padding.bottom)
+    );
+}
+
+size_t DataGrid::GetScrollingRowCapacity() const {
+    const float rowHeight = GetRowHeight();
+    const float height = GetGridRect().height - (1 + GetShownFrozenRowCount()) * rowHeight;
+    return (size_t)std::max(1.0f, height / rowHeight);
+}
+
+size_t DataGrid::GetShownFrozenRowCount() const {
+    return std::min(m_frozenRows, GetRowCount());
+}
+
+float DataGrid::GetFrozenWidth() const {
+    return m_columnOffsets[std::min(m_frozenColumns, m_columnWidths.size())];
+}
+
+float DataGrid::GetColumnX(size_t column, const Rect& grid) const {
+    const float x = grid.x + m_columnOffsets[column];
+    return column < m_frozenColumns ? x : x - m_scrollX;
+}
+
+size_t DataGrid::HitTestColumn(float x, const Rect& grid) const {
+    const float local = x - grid.x;
+    if (local < 0.0f) return NO_COLUMN;
+    
+    // Past the frozen columns, x is over the scrolled ones
+    const float offset = local < GetFrozenWidth() ? local : local + m_scrollX;
+    auto next = std::upper_bound(m_columnOffsets.begin(), m_columnOffsets.end(), offset);
+    if (next == m_columnOffsets.end()) return NO_COLUMN;
+    return (size_t)(next - m_columnOffsets.begin()) - 1;
+}
+
+size_t DataGrid::HitTestRow(float y, const Rect& grid) const {
+    const float rowHeight = GetRowHeight();
+    const float local = y - grid.y - rowHeight;
+    if (local < 0.0f || y >= grid.y + grid.height) return NO_ROW;
+    
+    const size_t band = (size_t)(local / rowHeight);
+    const size_t frozenRows = GetShownFrozenRowCount();
+    const size_t row = band < frozenRows ? band : m_firstRow + (band - frozenRows);
+    return row < GetRowCount() ? row : NO_ROW;
+}
+
+} // namespace miko
@@ -0,0 +1,211 @@
+#include "miko/widgets/FileView.h"
+#include "miko/core/Renderer.h"
+#include "miko/text/Utf8.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace miko {
+
+// Longer lines are cut for display; minified or binary files can have lines of many megabytes
+static const size_t MAX_DISPLAYED_LINE_LENGTH = 4096;
+
+FileView::FileView()
+    : m_font("Consolas", 12.0f, FontWeight::Normal, FontStyle::Normal)
+    , m_textColor(Color::TextColor)
+    , m_firstLine(0)
+    , m_indexingReported(false)
+{
+    SetSize(Size(400, 300));
+    SetBackgroundColor(Color::White);
+    SetBorderColor(Color::FromRGBA(128, 128, 128, 255));
+    SetBorderWidth(1.0f);
+    SetPadding(Spacing(4, 2, 4, 2));
+}
+
+bool FileView::Open(const std::string& path) {
+    Close();
+    
+    auto file = std::make_shared<MappedFile>();
+    if (!file->Open(path)) {
+        return false;
+    }
+    
+    m_file = file;
+    m_path = path;
+    m_lineIndex.Start(file);
+    Invalidate();
+    return true;
+}
+
+void FileView::Close() {
+    m_lineIndex.Stop();
+    m_file.reset();
+    m_path.clear();
+    m_firstLine = 0;
+    m_indexingReported = false;
+    Invalidate();
+}
+
+float FileView::GetIndexProgress() const {
+    if (!m_file || m_file->GetSize() == 0) return 1.0f;
+    return (float)((double)m_lineIndex.GetIndexedLength() / (double)m_file->GetSize());
+}
+
+void FileView::ScrollToLine(size_t line) {
+    const size_t lineCount = GetLineCount();
+    const size_t visible = GetVisibleLineCount();
+    const size_t maxFirstLine = lineCount > visible ? lineCount - visible : 0;
+    line = std::min(line, maxFirstLine);
+    if (line != m_firstLine) {
+        m_firstLine = line;
+        Invalidate();
+    }
+}
+
+size_t FileView::GetVisibleLineCount() const {
+    return (size_t)std::max(1.0f, GetTextRect().height / GetLineHeight());
+}
+
+bool FileView::OnMouseEvent(const MouseEvent& event) {
+    if (!IsEnabled()) return false;
+    
+    if (event.type == EventType::MouseButtonPressed && HitTest(event.position)) {
+        SetFocused(true);
+        return true;
+    }
+    
+    if (event.type == EventType::MouseScrolled && HitTest(event.position)) {
+        const ptrdiff_t delta = (ptrdiff_t)(-event.wheelDelta * 3.0f);
+        ScrollToLine((size_t)std::max<ptrdiff_t>(0, (ptrdiff_t)m_firstLine + delta));
+        return true;
+    }
+    
+    return false;
+}
+
+bool FileView::OnKeyEvent(const KeyEvent& event) {
+    if (!IsEnabled() || event.type != EventType::KeyPressed) {
+        return false;
+    }
+    
+    const size_t page = GetVisibleLineCount();
+    switch (event.keyCode) {
+        case KeyCode::Up:
+            ScrollToLine(m_firstLine > 0 ? m_firstLine - 1 : 0);
+            return true;
+        case KeyCode::Down:
+            ScrollToLine(m_firstLine + 1);
+            return true;
+        case KeyCode::PageUp:
+            ScrollToLine(m_firstLine > page ? m_firstLine - page : 0);
+            return true;
+        case KeyCode::PageDown:
+            ScrollToLine(m_firstLine + page);
+            return true;
+        case KeyCode::Home:
+            ScrollToLine(0);
+            return true;
+        case KeyCode::End:
+            ScrollToLine(SIZE_MAX);
+            return true;
+        default:
+            return false;
+    }
+}
+
+Size FileView::MeasureDesiredSize(const Size& availableSize) {
+    return Size(
+        Clamp(400.0f, GetMinSize().width, GetMaxSize().width),
+        Clamp(300.0f, GetMinSize().height, GetMaxSize().height)
+    );
+}
+
+void FileView::OnRender(std::shared_ptr<Renderer> renderer) {
+    if (!IsVisible() || !renderer) return;
+    
+    if (m_file && !m_indexingReported && m_lineIndex.IsComplete()) {
+        m_indexingReported = true;
+        if (OnIndexingCompleted) {
+            OnIndexingCompleted(GetLineCount());
+        }
+    }
+    
+    Brush backgroundBrush(GetBackgroundColor());
+    renderer->FillRectangle(GetBounds(), backgroundBrush);
+    if (GetBorderWidth() > 0) {
+        Color borderColor = IsFocused() ? Color::FromRGBA(0, 120, 215, 255) : GetBorderColor();
+        renderer->DrawRectangle(GetBounds(), Pen(borderColor, GetBorderWidth()));
+    }
+    
+    if (m_file && m_file->GetSize() > 0) {
+        const Rect textRect = GetTextRect();
+        renderer->PushClipRect(textRect);
+        
+        // Only the visible lines are read from the mapping; lines after the
+        // first are found by scanning forward from the one before
+        const float lineHeight = GetLineHeight();
+        const size_t lineCount = GetLineCount();
+        const size_t endLine = std::min(lineCount, m_firstLine + GetVisibleLineCount() + 1);
+        const Brush textBrush(m_textColor);
+        size_t start = m_lineIndex.GetLineStart(std::min(m_firstLine, lineCount - 1));
+        for (size_t line = m_firstLine; line < endLine; ++line) {
+            size_t nextStart;
+            const std::string_view text = ReadLine(line, start, nextStart);
+            if (!text.empty()) {
+                Rect lineRect(textRect.x, textRect.y + (line - m_firstLine) * lineHeight, textRect.width, lineHeight);
+                renderer->DrawText(text, lineRect, m_font, textBrush, TextAlignment::Left);
+            }
+            start = nextStart;
+        }
+        
+        renderer->PopClipRect();
+    }
+    
+    for (auto& child : GetChildren()) {
+        if (child && child->IsVisible()) {
+            child->Render(renderer);
+        }
+    }
+}
+
+std::string_view FileView::ReadLine(size_t line, size_t start, size_t& nextStart) const {
+    const char* data = m_file->GetData();
+    const size_t size = m_file->GetSize();
+    start = std::min(start, size);
+    
+    const size_t limit = std::min(size, start + MAX_DISPLAYED_LINE_LENGTH);
+    const void* lineBreak = std::memchr(data + start, '\n', limit - start);
+    size_t end = lineBreak ? (size_t)(static_cast<const char*>(lineBreak) - data) : limit;
+    if (lineBreak) {
+        nextStart = end + 1;
+    } else {
+        // The line was cut short; ask the index where the next one starts rather than scanning the rest
+        nextStart = line + 1 < GetLineCount() ? m_lineIndex.GetLineStart(line + 1) : size;
+        // Do not cut a character in half
+        while (end > start && end < size && IsUtf8Continuation((unsigned char)data[end])) {
+            --end;
+        }
+    }
+    if (end > start && data[end - 1] == '\r') {
+        --end;
+    }
+    return std::string_view(data + start, end - start);
+}
+
+float FileView::GetLineHeight() const {
+    return m_font.size * 1.2f;
+}
+
+Rect FileView::GetTextRect() const {
+    const Rect bounds = GetBounds();
+    const Spacing padding = GetPadding();
+    return Rect(
+        bounds.x + padding.left,
+        bounds.y + padding.top,
+        bounds.width - padding.left - padding.right,
+        bounds.height - padding.top - padding.bottom
+    );
+}
+
+} // namespace miko
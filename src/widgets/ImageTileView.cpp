@@ -0,0 +1,511 @@
+#include "miko/widgets/ImageTileView.h"
+#include "miko/core/Renderer.h"
+#include "miko/utils/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+
+namespace miko {
+
+// Zooming in stops at this many DIPs per picture pixel
+static const double MAX_ZOOM = 64.0;
+// Zoom change per wheel notch or Page Up/Page Down
+static const double ZOOM_STEP = 1.25;
+// Part of the view moved by the arrow keys
+static const double PAN_FRACTION = 0.125;
+
+// Tile keys: level in the top byte, then 28 bits each of row and column
+static const int KEY_BITS = 28;
+static const uint64_t KEY_MASK = ((uint64_t)1 << KEY_BITS) - 1;
+
+static uint64_t MakeTileKey(int level, int column, int row) {
+    return ((uint64_t)level << (2 * KEY_BITS)) | ((uint64_t)row << KEY_BITS) | (uint64_t)column;
+}
+
+static int GetKeyLevel(uint64_t key) { return (int)(key >> (2 * KEY_BITS)); }
+static int GetKeyRow(uint64_t key) { return (int)((key >> KEY_BITS) & KEY_MASK); }
+static int GetKeyColumn(uint64_t key) { return (int)(key & KEY_MASK); }
+
+ImageTileView::ImageTileView()
+    : m_tileCapacity(DEFAULT_TILE_CAPACITY)
+    , m_frame(0)
+    , m_zoom(1.0)
+    , m_centerX(0.0)
+    , m_centerY(0.0)
+    , m_fitPending(false)
+    , m_hasRequests(false)
+    , m_dragging(false)
+{
+    SetSize(Size(400, 300));
+    SetBackgroundColor(Color::FromRGBA(64, 64, 64));
+}
+
+ImageTileView::~ImageTileView() {
+    CloseLoader();
+    ReleaseTiles();
+}
+
+bool ImageTileView::Open(const std::string& path) {
+    auto image = std::make_shared<TiledImage>();
+    if (!image->Open(path)) {
+        SetImage(nullptr);
+        return false;
+    }
+    SetImage(std::move(image));
+    return true;
+}
+
+void ImageTileView::SetImage(std::shared_ptr<const TiledImage> image) {
+    if (image == m_image) return;
+    
+    CloseLoader();
+    ReleaseTiles();
+    m_image = std::move(image);
+    if (m_image) {
+        m_loader = std::make_shared<Loader>();
+        m_loader->image = m_image;
+    }
+    m_fitPending = true;
+    Invalidate();
+    InvalidateLayout();
+}
+
+void ImageTileView::SetZoom(double zoom, const Point& anchor) {
+    if (!m_image) return;
+    
+    // The picture point under the anchor stays there
+    const Rect area = GetPictureArea();
+    const double offsetX = anchor.x - (area.x + area.width / 2);
+    const double offsetY = anchor.y - (area.y + area.height / 2);
+    const double pointX = m_centerX + offsetX / m_zoom;
+    const double pointY = m_centerY + offsetY / m_zoom;
+    m_zoom = std::clamp(zoom, GetMinZoom(), MAX_ZOOM);
+    m_centerX = pointX - offsetX / m_zoom;
+    m_centerY = pointY - offsetY / m_zoom;
+    m_fitPending = false;
+    ClampView();
+    Invalidate();
+    NotifyViewChanged();
+}
+
+void ImageTileView::Zoom(double factor, const Point& anchor) {
+    SetZoom(m_zoom * factor, anchor);
+}
+
+void ImageTileView::ZoomToFit() {
+    if (!m_image) return;
+    
+    const Rect area = GetPictureArea();
+    if (area.IsEmpty()) {
+        // Done on the first frame with a size
+        m_fitPending = true;
+        return;
+    }
+    m_zoom = std::min((double)area.width / m_image->GetWidth(), (double)area.height / m_image->GetHeight());
+    m_centerX = m_image->GetWidth() / 2.0;
+    m_centerY = m_image->GetHeight() / 2.0;
+    m_fitPending = false;
+    Invalidate();
+    NotifyViewChanged();
+}
+
+void ImageTileView::PanBy(float dx, float dy) {
+    if (!m_image) return;
+    
+    m_centerX -= dx / m_zoom;
+    m_centerY -= dy / m_zoom;
+    m_fitPending = false;
+    ClampView();
+    Invalidate();
+    NotifyViewChanged();
+}
+
+void ImageTileView::SetCenter(double x, double y) {
+    if (!m_image) return;
+    
+    m_centerX = x;
+    m_centerY = y;
+    m_fitPending = false;
+    ClampView();
+    Invalidate();
+    NotifyViewChanged();
+}
+
+void ImageTileView::SetTileCapacity(size_t tiles) {
+    m_tileCapacity = tiles;
+    EvictTiles();
+}
+
+bool ImageTileView::OnMouseEvent(const MouseEvent& event) {
+    if (!IsEnabled()) return false;
+    
+    if (m_dragging) {
+        if (event.type == EventType::MouseMoved) {
+            // Dragging moves the picture with the pointer
+            PanBy(event.position.x - m_dragLast.x, event.position.y - m_dragLast.y);
+            m_dragLast = event.position;
+            return true;
+        }
+        if (event.type == EventType::MouseButtonReleased) {
+            m_dragging = false;
+            return true;
+        }
+    }
+    
+    if (event.type == EventType::MouseButtonPressed && event.button == MouseButton::Left && HitTest(event.position)) {
+        SetFocused(true);
+        m_dragging = true;
+        m_dragLast = event.position;
+        return true;
+    }
+    
+    if (event.type == EventType::MouseScrolled && HitTest(event.position)) {
+        // Zooms around the point under the pointer; rolling forward zooms in
+        Zoom(std::pow(ZOOM_STEP, event.wheelDelta), event.position);
+        return true;
+    }
+    
+    return false;
+}
+
+bool ImageTileView::OnKeyEvent(const KeyEvent& event) {
+    if (!IsEnabled() || event.type != EventType::KeyPressed) {
+        return false;
+    }
+    
+    const Rect area = GetPictureArea();
+    const float panX = (float)(area.width * PAN_FRACTION);
+    const float panY = (float)(area.height * PAN_FRACTION);
+    switch (event.keyCode) {
+        case KeyCode::Left:
+            PanBy(panX, 0.0f);
+            return true;
+        case KeyCode::Right:
+            PanBy(-panX, 0.0f);
+            return true;
+        case KeyCode::Up:
+            PanBy(0.0f, panY);
+            return true;
+        case KeyCode::Down:
+            PanBy(0.0f, -panY);
+            return true;
+        case KeyCode::PageUp:
+            Zoom(ZOOM_STEP, area.Center());
+            return true;
+        case KeyCode::PageDown:
+            Zoom(1.0 / ZOOM_STEP, area.Center());
+            return true;
+        case KeyCode::Home:
+            ZoomToFit();
+            return true;
+        default:
+            return false;
+    }
+}
+
+Size ImageTileView::MeasureDesiredSize(const Size& availableSize) {
+    return Size(
+        Clamp(400.0f, GetMinSize().width, GetMaxSize().width),
+        Clamp(300.0f, GetMinSize().height, GetMaxSize().height)
+    );
+}
+
+void ImageTileView::OnRender(std::shared_ptr<Renderer> renderer) {
+    if (!IsVisible() || !renderer) return;
+    
+    Brush backgroundBrush(GetBackgroundColor());
+    renderer->FillRectangle(GetBounds(), backgroundBrush);
+    
+    const Rect area = GetPictureArea();
+    if (m_image && !area.IsEmpty()) {
+        if (m_fitPending) {
+            ZoomToFit();
+        }
+        // Bitmaps belong to the renderer that made them
+        if (m_bitmapRenderer.lock() != renderer) {
+            ReleaseTiles();
+            m_bitmapRenderer = renderer;
+        }
+        CollectFinished();
+        ++m_frame;
+    
+        const float dpiScale = renderer->GetDpiScale();
+        const int level = PickLevel(dpiScale);
+        const int levelCount = m_image->GetLevelCount();
+        const int columns = m_image->GetColumns(level);
+        const int rows = m_image->GetRows(level);
+        const double tileExtent = std::ldexp(m_zoom, level) * m_image->GetTileSize();
+        const double originX = area.x + area.width / 2 - m_centerX * m_zoom;
+        const double originY = area.y + area.height / 2 - m_centerY * m_zoom;
+    
+        // Only the tiles in view; the centre is kept on the picture, so these are never far out of range
+        const int firstColumn = (int)std::clamp(std::floor((area.x - originX) / tileExtent), 0.0, columns - 1.0);
+        const int lastColumn = (int)std::clamp(std::floor((area.Right() - originX) / tileExtent), 0.0, columns - 1.0);
+        const int firstRow = (int)std::clamp(std::floor((area.y - originY) / tileExtent), 0.0, rows - 1.0);
+        const int lastRow = (int)std::clamp(std::floor((area.Bottom() - originY) / tileExtent), 0.0, rows - 1.0);
+    
+        // Missing tiles are wanted, and the nearest coarser tile already decoded stands in for each
+        m_wanted.clear();
+        m_fallbacks.clear();
+        m_coarsest.clear();
+        for (int row = firstRow; row <= lastRow; ++row) {
+            for (int column = firstColumn; column <= lastColumn; ++column) {
+                const uint64_t key = MakeTileKey(level, column, row);
+                if (m_tiles.count(key)) continue;
+    
+                m_wanted.push_back(key);
+                bool covered = false;
+                for (int coarser = level + 1; coarser < levelCount && !covered; ++coarser) {
+                    const int shift = coarser - level;
+                    const uint64_t coarseKey = MakeTileKey(coarser, column >> shift, row >> shift);
+                    auto found = m_tiles.find(coarseKey);
+                    if (found != m_tiles.end()) {
+                        if (!found->second.blank) {
+                            m_fallbacks.push_back(coarseKey);
+                        }
+                        covered = true;
+                    }
+                }
+                if (!covered && level + 1 < levelCount) {
+                    // Nothing coarser yet: the last level is a tile or two and loads before anything else
+                    const int shift = levelCount - 1 - level;
+                    m_coarsest.push_back(MakeTileKey(levelCount - 1, column >> shift, row >> shift));
+                }
+            }
+        }
+    
+        // Clipped to the picture too, as edge tiles of coarse levels reach up to a level pixel past it
+        const float clipLeft = std::max(area.x, (float)originX);
+        const float clipTop = std::max(area.y, (float)originY);
+        const float clipRight = std::min(area.Right(), (float)(originX + m_image->GetWidth() * m_zoom));
+        const float clipBottom = std::min(area.Bottom(), (float)(originY + m_image->GetHeight() * m_zoom));
+        renderer->PushClipRect(Rect(clipLeft, clipTop, std::max(0.0f, clipRight - clipLeft), std::max(0.0f, clipBottom - clipTop)));
+    
+        // Stand-ins first, coarsest at the bottom, so finer tiles drawn after cover them
+        std::sort(m_fallbacks.begin(), m_fallbacks.end(), std::greater<uint64_t>());
+        m_fallbacks.erase(std::unique(m_fallbacks.begin(), m_fallbacks.end()), m_fallbacks.end());
+        for (uint64_t key : m_fallbacks) {
+            DrawTile(renderer, key, m_tiles[key], originX, originY, dpiScale);
+        }
+        for (int row = firstRow; row <= lastRow; ++row) {
+            for (int column = firstColumn; column <= lastColumn; ++column) {
+                const uint64_t key = MakeTileKey(level, column, row);
+                auto found = m_tiles.find(key);
+                if (found != m_tiles.end()) {
+                    DrawTile(renderer, key, found->second, originX, originY, dpiScale);
+                }
+            }
+        }
+    
+        renderer->PopClipRect();
+    
+        // Most wanted last: the tiles furthest from the middle of the view are decoded last
+        const double middleColumn = (firstColumn + lastColumn) / 2.0;
+        const double middleRow = (firstRow + lastRow) / 2.0;
+        std::sort(m_wanted.begin(), m_wanted.end(), [middleColumn, middleRow](uint64_t a, uint64_t b) {
+            const double aColumn = GetKeyColumn(a) - middleColumn;
+            const double aRow = GetKeyRow(a) - middleRow;
+            const double bColumn = GetKeyColumn(b) - middleColumn;
+            const double bRow = GetKeyRow(b) - middleRow;
+            return aColumn * aColumn + aRow * aRow > bColumn * bColumn + bRow * bRow;
+        });
+        std::sort(m_coarsest.begin(), m_coarsest.end());
+        m_coarsest.erase(std::unique(m_coarsest.begin(), m_coarsest.end()), m_coarsest.end());
+        m_wanted.insert(m_wanted.end(), m_coarsest.begin(), m_coarsest.end());
+        if (!m_wanted.empty() || m_hasRequests) {
+            RequestTiles();
+        }
+    
+        EvictTiles();
+    }
+    
+    if (GetBorderWidth() > 0) {
+        renderer->DrawRectangle(GetBounds(), Pen(GetBorderColor(), GetBorderWidth()));
+    }
+    
+    for (auto& child : GetChildren()) {
+        if (child && child->IsVisible()) {
+            child->Render(renderer);
+        }
+    }
+}
+
+void ImageTileView::CollectFinished() {
+    std::vector<DecodedTile> finished;
+    {
+        std::lock_guard<std::mutex> lock(m_loader->mutex);
+        if (m_loader->finished.empty()) return;
+        finished.swap(m_loader->finished);
+    }
+    
+    for (DecodedTile& decoded : finished) {
+        if (m_tiles.count(decoded.key)) continue;
+    
+        Tile& tile = m_tiles[decoded.key];
+        tile.blank = !decoded.decoded;
+        if (decoded.decoded) {
+            tile.pixels = std::move(decoded.pixels);
+        }
+        m_lru.push_front(decoded.key);
+        tile.lruPosition = m_lru.begin();
+    }
+}
+
+void ImageTileView::RequestTiles() {
+    // The queue is rebuilt from this frame's wants, so tiles no longer in view are never decoded
+    size_t newWorkers = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_loader->mutex);
+        m_loader->queue.clear();
+        for (uint64_t key : m_wanted) {
+            if (!m_loader->decoding.count(key)) {
+                m_loader->queue.push_back(key);
+            }
+        }
+        const size_t maxWorkers = std::max<size_t>(1, ThreadPool::GetShared().GetThreadCount());
+        if (m_loader->workers < maxWorkers) {
+            newWorkers = std::min(m_loader->queue.size(), maxWorkers - m_loader->workers);
+            m_loader->workers += newWorkers;
+        }
+    }
+    m_hasRequests = !m_wanted.empty();
+    
+    for (size_t i = 0; i < newWorkers; ++i) {
+        ThreadPool::GetShared().Submit([loader = m_loader]() {
+            DecodeTiles(loader);
+        });
+    }
+}
+
+void ImageTileView::DrawTile(const std::shared_ptr<Renderer>& renderer, uint64_t key, Tile& tile,
+                             double originX, double originY, float dpiScale) {
+    tile.lastDrawnFrame = m_frame;
+    m_lru.splice(m_lru.begin(), m_lru, tile.lruPosition);
+    if (tile.blank) return;
+    
+    if (!tile.bitmap && !tile.pixels.pixels.empty()) {
+        tile.bitmap = renderer->CreateBitmap(tile.pixels.width, tile.pixels.height, tile.pixels.opaque);
+        if (tile.bitmap) {
+            renderer->UpdateBitmap(tile.bitmap.get(), PixelRect(0, 0, tile.pixels.width, tile.pixels.height),
+                                   tile.pixels.pixels.data(), (size_t)tile.pixels.width * 4);
+            // The size is still needed for placing the tile
+            std::vector<uint32_t>().swap(tile.pixels.pixels);
+        }
+    }
+    if (!tile.bitmap) return;
+    
+    // Edges snapped to device pixels, so neighbouring tiles meet without a seam
+    const double levelScale = std::ldexp(m_zoom, GetKeyLevel(key));
+    const double tileSize = m_image->GetTileSize();
+    auto snap = [dpiScale](double value) {
+        return (float)(std::round(value * dpiScale) / dpiScale);
+    };
+    const float left = snap(originX + GetKeyColumn(key) * tileSize * levelScale);
+    const float top = snap(originY + GetKeyRow(key) * tileSize * levelScale);
+    const float right = snap(originX + (GetKeyColumn(key) * tileSize + tile.pixels.width) * levelScale);
+    const float bottom = snap(originY + (GetKeyRow(key) * tileSize + tile.pixels.height) * levelScale);
+    renderer->DrawBitmap(tile.bitmap.get(), Rect(left, top, right - left, bottom - top), true);
+}
+
+void ImageTileView::EvictTiles() {
+    while (m_tiles.size() > m_tileCapacity && !m_lru.empty()) {
+        auto found = m_tiles.find(m_lru.back());
+        // Everything older has gone; what is left is in view
+        if (found->second.lastDrawnFrame == m_frame && m_frame != 0) break;
+    
+        // Erasing the tile frees its bitmap
+        m_tiles.erase(found);
+        m_lru.pop_back();
+    }
+}
+
+void ImageTileView::ReleaseTiles() {
+    // Bitmap handles free themselves, whether or not the renderer is still around
+    m_tiles.clear();
+    m_lru.clear();
+    m_bitmapRenderer.reset();
+}
+
+void ImageTileView::CloseLoader() {
+    if (!m_loader) return;
+    
+    {
+        // A tile being decoded finishes on its worker and is dropped
+        std::lock_guard<std::mutex> lock(m_loader->mutex);
+        m_loader->closed = true;
+        m_loader->queue.clear();
+        m_loader->finished.clear();
+    }
+    m_loader.reset();
+    m_hasRequests = false;
+}
+
+int ImageTileView::PickLevel(float dpiScale) const {
+    // The coarsest level whose pixels are no larger than a device pixel
+    const double devicePixels = m_zoom * dpiScale;
+    int level = 0;
+    while (level + 1 < m_image->GetLevelCount() && std::ldexp(devicePixels, level + 1) <= 1.0 + 1e-9) {
+        ++level;
+    }
+    return level;
+}
+
+double ImageTileView::GetMinZoom() const {
+    // Half the fitting zoom, or of 1:1 for a picture smaller than the view
+    const Rect area = GetPictureArea();
+    if (area.IsEmpty()) {
+        // Small enough for the whole picture to fit in one DIP
+        return 1.0 / std::max(m_image->GetWidth(), m_image->GetHeight());
+    }
+    const double fit = std::min((double)area.width / m_image->GetWidth(), (double)area.height / m_image->GetHeight());
+    return std::min(fit, 1.0) / 2;
+}
+
+void ImageTileView::ClampView() {
+    // Some of the picture always stays in the middle of the view
+    m_centerX = std::clamp(m_centerX, 0.0, (double)m_image->GetWidth());
+    m_centerY = std::clamp(m_centerY, 0.0, (double)m_image->GetHeight());
+}
+
+void ImageTileView::NotifyViewChanged() {
+    if (OnViewChanged) {
+        OnViewChanged();
+    }
+}
+
+Rect ImageTileView::GetPictureArea() const {
+    const Rect bounds = GetBounds();
+    const Spacing padding = GetPadding();
+    return Rect(
+        bounds.x + padding.left,
+        bounds.y + padding.top,
+        std::max(0.0f, bounds.width - padding.Horizontal()),
+        std::max(0.0f, bounds.height - padding.Vertical())
+    );
+}
+
+void ImageTileView::DecodeTiles(const std::shared_ptr<Loader>& loader) {
+    // Each worker keeps taking the most wanted tile until none are left
+    for (;;) {
+        DecodedTile tile;
+        {
+            std::lock_guard<std::mutex> lock(loader->mutex);
+            if (loader->closed || loader->queue.empty()) {
+                --loader->workers;
+                return;
+            }
+            tile.key = loader->queue.back();
+            loader->queue.pop_back();
+            loader->decoding.insert(tile.key);
+        }
+    
+        tile.decoded = loader->image->DecodeTile(GetKeyLevel(tile.key), GetKeyColumn(tile.key), GetKeyRow(tile.key), tile.pixels);
+    
+        std::lock_guard<std::mutex> lock(loader->mutex);
+        loader->decoding.erase(tile.key);
+        if (!loader->closed) {
+            loader->finished.push_back(std::move(tile));
+        }
+    }
+}
+
+} // namespace miko
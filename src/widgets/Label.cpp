@@ -18,7 +18,16 @@ void Label::SetText(const std::string& text) {
     if (this->text != text) {
         this->text = text;
         Invalidate();
+        InvalidateTextSize();
+    }
+}
+
+void Label::InvalidateTextSize() {
+    // A wrapped label's height depends on the width, which may differ between its parent's passes
+    if (wordWrap) {
         InvalidateLayout();
+    } else {
+        InvalidateMeasure();
     }
 }
 
@@ -0,0 +1,249 @@
+#include "miko/widgets/LogView.h"
+#include "miko/core/Renderer.h"
+#include "miko/text/Utf8.h"
+#include <algorithm>
+
+namespace miko {
+
+// Longer lines are cut so one runaway line cannot grow a ring slot without bound
+static const size_t MAX_LOG_LINE_LENGTH = 4096;
+
+LogView::LogView(size_t capacity)
+    : m_pendingCount(0)
+    , m_dropThreshold(2 * std::max<size_t>(capacity, 1))
+    , m_droppedLines(0)
+    , m_capacity(std::max<size_t>(capacity, 1))
+    , m_firstSlot(0)
+    , m_lineCount(0)
+    , m_font("Consolas", 12.0f, FontWeight::Normal, FontStyle::Normal)
+    , m_textColor(Color::TextColor)
+    , m_firstLine(0)
+    , m_stickToBottom(true)
+{
+    SetSize(Size(400, 300));
+    SetBackgroundColor(Color::White);
+    SetBorderColor(Color::FromRGBA(128, 128, 128, 255));
+    SetBorderWidth(1.0f);
+    SetPadding(Spacing(4, 2, 4, 2));
+}
+
+void LogView::Append(std::string_view line) {
+    // Producers may outrun a stalled UI thread; past twice the capacity
+    // the waiting lines could never all be shown, so drop instead of queueing
+    if (m_pendingCount.fetch_add(1, std::memory_order_relaxed) >= m_dropThreshold.load(std::memory_order_relaxed)) {
+        m_pendingCount.fetch_sub(1, std::memory_order_relaxed);
+        m_droppedLines.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    
+    while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) {
+        line.remove_suffix(1);
+    }
+    if (line.size() > MAX_LOG_LINE_LENGTH) {
+        size_t length = MAX_LOG_LINE_LENGTH;
+        while (length > 0 && IsUtf8Continuation((unsigned char)line[length])) {
+            --length;
+        }
+        line = line.substr(0, length);
+    }
+    m_pending.Push(std::string(line));
+}
+
+void LogView::Clear() {
+    // Queued lines are dropped too
+    const size_t taken = m_pending.Drain([](std::string&&) {}, 0);
+    m_pendingCount.fetch_sub(taken, std::memory_order_relaxed);
+    m_firstSlot = 0;
+    m_lineCount = 0;
+    m_firstLine = 0;
+    Invalidate();
+}
+
+void LogView::SetCapacity(size_t capacity) {
+    capacity = std::max<size_t>(capacity, 1);
+    if (capacity == m_capacity) return;
+    
+    // Unroll the ring, keeping the newest lines
+    std::vector<std::string> lines;
+    const size_t kept = std::min(m_lineCount, capacity);
+    lines.reserve(kept);
+    for (size_t i = m_lineCount - kept; i < m_lineCount; ++i) {
+        lines.push_back(std::move(m_lines[(m_firstSlot + i) % m_capacity]));
+    }
+    m_firstLine -= std::min(m_firstLine, m_lineCount - kept);
+    m_lines.swap(lines);
+    m_capacity = capacity;
+    m_dropThreshold.store(2 * capacity, std::memory_order_relaxed);
+    m_firstSlot = 0;
+    m_lineCount = kept;
+    Invalidate();
+}
+
+const std::string& LogView::GetLine(size_t index) const {
+    return m_lines[(m_firstSlot + index) % m_capacity];
+}
+
+void LogView::FlushAppends() {
+    size_t evicted = 0;
+    // Only the newest capacity lines of a burst can survive, so the rest are never copied
+    const size_t taken = m_pending.Drain([this, &evicted](std::string&& line) {
+        const size_t slot = (m_firstSlot + m_lineCount) % m_capacity;
+        if (m_lineCount < m_capacity) {
+            ++m_lineCount;
+        } else {
+            m_firstSlot = (m_firstSlot + 1) % m_capacity;
+            ++evicted;
+        }
+        // The queued string is moved in; copying it into the slot's old buffer would free just as much
+        if (slot == m_lines.size()) {
+            m_lines.push_back(std::move(line));
+        } else {
+            m_lines[slot] = std::move(line);
+        }
+    }, m_capacity);
+    if (taken == 0) return;
+    
+    m_pendingCount.fetch_sub(taken, std::memory_order_relaxed);
+    evicted += taken - std::min(taken, m_capacity);
+    
+    if (m_stickToBottom) {
+        m_firstLine = GetMaxFirstLine();
+    } else {
+        // Keep the same lines in view while older ones are dropped
+        m_firstLine -= std::min(m_firstLine, evicted);
+    }
+    Invalidate();
+}
+
+void LogView::SetStickToBottom(bool stick) {
+    m_stickToBottom = stick;
+    if (stick) {
+        ScrollToLine(GetMaxFirstLine());
+    }
+}
+
+void LogView::ScrollToLine(size_t line) {
+    const size_t maxFirstLine = GetMaxFirstLine();
+    line = std::min(line, maxFirstLine);
+    // Scrolling back to the bottom resumes following new lines
+    m_stickToBottom = line == maxFirstLine;
+    if (line != m_firstLine) {
+        m_firstLine = line;
+        Invalidate();
+    }
+}
+
+size_t LogView::GetVisibleLineCount() const {
+    return (size_t)std::max(1.0f, GetTextRect().height / GetLineHeight());
+}
+
+bool LogView::OnMouseEvent(const MouseEvent& event) {
+    if (!IsEnabled()) return false;
+    
+    if (event.type == EventType::MouseButtonPressed && HitTest(event.position)) {
+        SetFocused(true);
+        return true;
+    }
+    
+    if (event.type == EventType::MouseScrolled && HitTest(event.position)) {
+        const ptrdiff_t delta = (ptrdiff_t)(-event.wheelDelta * 3.0f);
+        ScrollToLine((size_t)std::max<ptrdiff_t>(0, (ptrdiff_t)m_firstLine + delta));
+        return true;
+    }
+    
+    return false;
+}
+
+bool LogView::OnKeyEvent(const KeyEvent& event) {
+    if (!IsEnabled() || event.type != EventType::KeyPressed) {
+        return false;
+    }
+    
+    const size_t page = GetVisibleLineCount();
+    switch (event.keyCode) {
+        case KeyCode::Up:
+            ScrollToLine(m_firstLine > 0 ? m_firstLine - 1 : 0);
+            return true;
+        case KeyCode::Down:
+            ScrollToLine(m_firstLine + 1);
+            return true;
+        case KeyCode::PageUp:
+            ScrollToLine(m_firstLine > page ? m_firstLine - page : 0);
+            return true;
+        case KeyCode::PageDown:
+            ScrollToLine(m_firstLine + page);
+            return true;
+        case KeyCode::Home:
+            ScrollToLine(0);
+            return true;
+        case KeyCode::End:
+            ScrollToLine(GetMaxFirstLine());
+            return true;
+        default:
+            return false;
+    }
+}
+
+Size LogView::MeasureDesiredSize(const Size& availableSize) {
+    return Size(
+        Clamp(400.0f, GetMinSize().width, GetMaxSize().width),
+        Clamp(300.0f, GetMinSize().height, GetMaxSize().height)
+    );
+}
+
+void LogView::OnRender(std::shared_ptr<Renderer> renderer) {
+    // Appends are applied once per frame, before drawing
+    FlushAppends();
+    
+    if (!IsVisible() || !renderer) return;
+    
+    Brush backgroundBrush(GetBackgroundColor());
+    renderer->FillRectangle(GetBounds(), backgroundBrush);
+    if (GetBorderWidth() > 0) {
+        Color borderColor = IsFocused() ? Color::FromRGBA(0, 120, 215, 255) : GetBorderColor();
+        renderer->DrawRectangle(GetBounds(), Pen(borderColor, GetBorderWidth()));
+    }
+    
+    const Rect textRect = GetTextRect();
+    renderer->PushClipRect(textRect);
+    
+    const float lineHeight = GetLineHeight();
+    const size_t endLine = std::min(m_lineCount, m_firstLine + GetVisibleLineCount() + 1);
+    const Brush textBrush(m_textColor);
+    for (size_t line = m_firstLine; line < endLine; ++line) {
+        const std::string& text = GetLine(line);
+        if (text.empty()) continue;
+        Rect lineRect(textRect.x, textRect.y + (line - m_firstLine) * lineHeight, textRect.width, lineHeight);
+        renderer->DrawText(text, lineRect, m_font, textBrush, TextAlignment::Left);
+    }
+    
+    renderer->PopClipRect();
+    
+    for (auto& child : GetChildren()) {
+        if (child && child->IsVisible()) {
+            child->Render(renderer);
+        }
+    }
+}
+
+size_t LogView::GetMaxFirstLine() const {
+    const size_t visible = GetVisibleLineCount();
+    return m_lineCount > visible ? m_lineCount - visible : 0;
+}
+
+float LogView::GetLineHeight() const {
+    return m_font.size * 1.2f;
+}
+
+Rect LogView::GetTextRect() const {
+    const Rect bounds = GetBounds();
+    const Spacing padding = GetPadding();
+    return Rect(
+        bounds.x + padding.left,
+        bounds.y + padding.top,
+        bounds.width - padding.left - padding.right,
+        bounds.height - padding.top - padding.bottom
+    );
+}
+
+} // namespace miko
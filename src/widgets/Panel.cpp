@@ -39,7 +39,7 @@ Size Panel::MeasureDesiredSize(const Size& availableSize) {
     
     for (auto& child : GetChildren()) {
         if (child && child->IsVisible()) {
-            Size childDesiredSize = child->MeasureDesiredSize(availableSize);
+            Size childDesiredSize = child->Measure(availableSize);
             
             // For panels without layout, we assume children are positioned manually
             // So we need to account for their position + size
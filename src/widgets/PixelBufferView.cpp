@@ -0,0 +1,98 @@
+#include "miko/widgets/PixelBufferView.h"
+#include "miko/core/Renderer.h"
+#include <algorithm>
+
+namespace miko {
+
+PixelBufferView::PixelBufferView()
+    : m_preserveAspectRatio(true)
+    , m_smoothScaling(true)
+{
+    SetSize(Size(320, 240));
+    SetBackgroundColor(Color::Black);
+}
+
+void PixelBufferView::SetPixelBuffer(std::shared_ptr<PixelBuffer> buffer) {
+    if (buffer == m_buffer) return;
+    
+    // The bitmap matches the old buffer's size, and has none of the new one's pixels
+    m_bitmap.reset();
+    m_buffer = std::move(buffer);
+    Invalidate();
+    InvalidateLayout();
+}
+
+Size PixelBufferView::MeasureDesiredSize(const Size& availableSize) {
+    const Spacing padding = GetPadding();
+    const float width = m_buffer ? (float)m_buffer->GetWidth() : 0.0f;
+    const float height = m_buffer ? (float)m_buffer->GetHeight() : 0.0f;
+    return Size(
+        Clamp(width + padding.Horizontal(), GetMinSize().width, GetMaxSize().width),
+        Clamp(height + padding.Vertical(), GetMinSize().height, GetMaxSize().height)
+    );
+}
+
+void PixelBufferView::OnRender(std::shared_ptr<Renderer> renderer) {
+    if (!IsVisible() || !renderer) return;
+    
+    Brush backgroundBrush(GetBackgroundColor());
+    renderer->FillRectangle(GetBounds(), backgroundBrush);
+    
+    if (m_buffer) {
+        // The newest published frame, with the rects changed since the one before
+        const uint32_t* pixels = nullptr;
+        const bool changed = m_buffer->AcquireFrame(pixels, m_dirty);
+    
+        // Bitmaps are only drawn by the renderer that made them
+        if (m_bitmap && m_bitmapRenderer.lock() != renderer) {
+            m_bitmap.reset();
+        }
+        if (!m_bitmap) {
+            m_bitmap = renderer->CreateBitmap(m_buffer->GetWidth(), m_buffer->GetHeight(), m_buffer->IsOpaque());
+            m_bitmapRenderer = renderer;
+            if (m_bitmap) {
+                renderer->UpdateBitmap(m_bitmap.get(), PixelRect(0, 0, m_buffer->GetWidth(), m_buffer->GetHeight()),
+                                       pixels, m_buffer->GetStride());
+            }
+        } else if (changed) {
+            for (const PixelRect& rect : m_dirty) {
+                renderer->UpdateBitmap(m_bitmap.get(), rect, pixels, m_buffer->GetStride());
+            }
+        }
+    
+        if (m_bitmap) {
+            renderer->DrawBitmap(m_bitmap.get(), GetPictureRect(), m_smoothScaling);
+        }
+    }
+    
+    if (GetBorderWidth() > 0) {
+        renderer->DrawRectangle(GetBounds(), Pen(GetBorderColor(), GetBorderWidth()));
+    }
+    
+    for (auto& child : GetChildren()) {
+        if (child && child->IsVisible()) {
+            child->Render(renderer);
+        }
+    }
+}
+
+Rect PixelBufferView::GetPictureRect() const {
+    const Rect bounds = GetBounds();
+    const Spacing padding = GetPadding();
+    Rect area(
+        bounds.x + padding.left,
+        bounds.y + padding.top,
+        std::max(0.0f, bounds.width - padding.Horizontal()),
+        std::max(0.0f, bounds.height - padding.Vertical())
+    );
+    if (!m_preserveAspectRatio || !m_buffer || m_buffer->GetWidth() == 0 || m_buffer->GetHeight() == 0) {
+        return area;
+    }
+    
+    const float scale = std::min(area.width / m_buffer->GetWidth(), area.height / m_buffer->GetHeight());
+    const float width = m_buffer->GetWidth() * scale;
+    const float height = m_buffer->GetHeight() * scale;
+    return Rect(area.x + (area.width - width) / 2, area.y + (area.height - height) / 2, width, height);
+}
+
+} // namespace miko
@@ -0,0 +1,460 @@
+#include "miko/widgets/TerminalView.h"
+#include "miko/core/Renderer.h"
+#include "miko/text/Utf8.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace miko {
+
+// Color key of the default foreground; key 0 (TerminalGrid::DEFAULT_COLOR) is the default background
+static const uint32_t FOREGROUND_KEY = 0x03000000u;
+// Output is parsed in slices of this size, checking the time budget between them
+static const size_t PARSE_SLICE_SIZE = 64 * 1024;
+// Parsing time per frame; the rest of the frame is left for drawing and input
+static const std::chrono::milliseconds PARSE_BUDGET(10);
+// Unparsed output taken from writers, both queued and carried over between frames
+static const size_t MAX_BACKLOG_BYTES = 16 * 1024 * 1024;
+
+// Campbell, the Windows Terminal default scheme
+static const uint8_t ANSI_COLORS[16][3] = {
+    { 12, 12, 12 }, { 197, 15, 31 }, { 19, 161, 14 }, { 193, 156, 0 },
+    { 0, 55, 218 }, { 136, 23, 152 }, { 58, 150, 221 }, { 204, 204, 204 },
+    { 118, 118, 118 }, { 231, 72, 86 }, { 22, 198, 12 }, { 249, 241, 165 },
+    { 59, 120, 255 }, { 180, 0, 158 }, { 97, 214, 214 }, { 242, 242, 242 }
+};
+
+TerminalView::TerminalView(size_t scrollbackCapacity)
+    : m_grid(80, 24, scrollbackCapacity)
+    , m_pendingBytes(0)
+    , m_backlogOffset(0)
+    , m_cellSizeValid(false)
+    , m_textColor(Color::FromRGBA(204, 204, 204))
+    , m_cursorColor(Color::FromRGBA(204, 204, 204))
+    , m_scrollOffset(0)
+    , m_scrolledLineCount(0)
+{
+    SetSize(Size(640, 400));
+    SetBackgroundColor(Color::FromRGBA(12, 12, 12));
+    SetBorderColor(Color::FromRGBA(128, 128, 128, 255));
+    SetBorderWidth(1.0f);
+    SetPadding(Spacing(4, 2, 4, 2));
+    SetFont(Font("Consolas", 12.0f, FontWeight::Normal, FontStyle::Normal));
+    
+    // Output written directly, rather than through a pseudo console, usually ends lines with a bare LF
+    m_grid.SetNewLineMode(true);
+    
+    for (size_t i = 0; i < 16; ++i) {
+        m_palette[i] = Color::FromRGBA(ANSI_COLORS[i][0], ANSI_COLORS[i][1], ANSI_COLORS[i][2]);
+    }
+    static const uint8_t CUBE_LEVELS[6] = { 0, 95, 135, 175, 215, 255 };
+    for (size_t i = 0; i < 216; ++i) {
+        m_palette[16 + i] = Color::FromRGBA(CUBE_LEVELS[i / 36], CUBE_LEVELS[(i / 6) % 6], CUBE_LEVELS[i % 6]);
+    }
+    for (size_t i = 0; i < 24; ++i) {
+        const uint8_t level = static_cast<uint8_t>(8 + 10 * i);
+        m_palette[232 + i] = Color::FromRGBA(level, level, level);
+    }
+}
+
+size_t TerminalView::Write(std::string_view bytes) {
+    if (bytes.empty()) return 0;
+    
+    // Take what fits under the limit; the writer holds on to the rest
+    size_t pending = m_pendingBytes.load(std::memory_order_relaxed);
+    size_t taken = 0;
+    do {
+        if (pending >= MAX_BACKLOG_BYTES) return 0;
+        taken = std::min(bytes.size(), MAX_BACKLOG_BYTES - pending);
+    } while (!m_pendingBytes.compare_exchange_weak(pending, pending + taken, std::memory_order_relaxed));
+    
+    m_pending.Push(std::string(bytes.substr(0, taken)));
+    return taken;
+}
+
+bool TerminalView::CanWrite() const {
+    return m_pendingBytes.load(std::memory_order_relaxed) < MAX_BACKLOG_BYTES;
+}
+
+void TerminalView::FlushWrites() {
+    m_pending.Drain([this](std::string&& bytes) {
+        m_backlog.push_back(std::move(bytes));
+    });
+    if (m_backlog.empty()) return;
+    
+    const auto deadline = std::chrono::steady_clock::now() + PARSE_BUDGET;
+    while (!m_backlog.empty()) {
+        const std::string& bytes = m_backlog.front();
+        const size_t length = std::min(PARSE_SLICE_SIZE, bytes.size() - m_backlogOffset);
+        m_grid.Write(std::string_view(bytes).substr(m_backlogOffset, length));
+        m_backlogOffset += length;
+        // Room for writers opens up only as output is parsed
+        m_pendingBytes.fetch_sub(length, std::memory_order_relaxed);
+        if (m_backlogOffset == bytes.size()) {
+            m_backlog.pop_front();
+            m_backlogOffset = 0;
+        }
+        if (std::chrono::steady_clock::now() >= deadline) break;
+    }
+    
+    const std::string responses = m_grid.TakeResponses();
+    if (!responses.empty() && OnInput) {
+        OnInput(responses);
+    }
+    if (m_grid.TakeTitleChanged() && OnTitleChanged) {
+        OnTitleChanged(m_grid.GetTitle());
+    }
+    if (m_grid.TakeBell() && OnBell) {
+        OnBell();
+    }
+    
+    // While scrolled back, keep the same lines in view as new ones push in below
+    const uint64_t scrolled = m_grid.GetScrolledLineCount();
+    if (m_scrollOffset > 0) {
+        m_scrollOffset = (size_t)std::min<uint64_t>(m_scrollOffset + (scrolled - m_scrolledLineCount), m_grid.GetScrollbackLineCount());
+    }
+    m_scrolledLineCount = scrolled;
+    Invalidate();
+}
+
+void TerminalView::Reset() {
+    size_t discarded = 0;
+    m_pending.Drain([&discarded](std::string&& bytes) {
+        discarded += bytes.size();
+    });
+    for (const std::string& bytes : m_backlog) {
+        discarded += bytes.size();
+    }
+    discarded -= m_backlogOffset;
+    m_pendingBytes.fetch_sub(discarded, std::memory_order_relaxed);
+    m_backlog.clear();
+    m_backlogOffset = 0;
+    m_grid.Reset();
+    m_grid.ClearScrollback();
+    m_scrollOffset = 0;
+    m_scrolledLineCount = m_grid.GetScrolledLineCount();
+    Invalidate();
+}
+
+void TerminalView::SetScrollOffset(size_t lines) {
+    lines = std::min(lines, m_grid.GetScrollbackLineCount());
+    if (lines != m_scrollOffset) {
+        m_scrollOffset = lines;
+        Invalidate();
+    }
+}
+
+void TerminalView::SetFont(const Font& font) {
+    m_fonts[0] = font;
+    m_fonts[1] = Font(font.family, font.size, FontWeight::Bold, font.style);
+    m_fonts[2] = Font(font.family, font.size, font.weight, FontStyle::Italic);
+    m_fonts[3] = Font(font.family, font.size, FontWeight::Bold, FontStyle::Italic);
+    m_cellSizeValid = false;
+    Invalidate();
+}
+
+bool TerminalView::OnMouseEvent(const MouseEvent& event) {
+    if (!IsEnabled()) return false;
+    
+    if (event.type == EventType::MouseButtonPressed && HitTest(event.position)) {
+        SetFocused(true);
+        return true;
+    }
+    
+    if (event.type == EventType::MouseScrolled && HitTest(event.position)) {
+        const ptrdiff_t delta = (ptrdiff_t)(event.wheelDelta * 3.0f);
+        SetScrollOffset((size_t)std::max<ptrdiff_t>(0, (ptrdiff_t)m_scrollOffset + delta));
+        return true;
+    }
+    
+    return false;
+}
+
+bool TerminalView::OnKeyEvent(const KeyEvent& event) {
+    if (!IsEnabled()) {
+        return false;
+    }
+    
+    if (event.type == EventType::KeyTyped) {
+        // Control characters, including Ctrl+letter combinations, are sent as they are;
+        // Backspace sends DEL like other terminals
+        const char c = event.character;
+        SendInput(c == '\b' ? std::string("\x7f") : std::string(1, c));
+        return true;
+    }
+    
+    if (event.type != EventType::KeyPressed) {
+        return false;
+    }
+    
+    // Shift+PageUp/PageDown page through the scrollback instead of reaching the program
+    if (event.shiftPressed && (event.keyCode == KeyCode::PageUp || event.keyCode == KeyCode::PageDown)) {
+        const size_t page = m_grid.GetRows();
+        SetScrollOffset(event.keyCode == KeyCode::PageUp ? m_scrollOffset + page : m_scrollOffset - std::min(m_scrollOffset, page));
+        return true;
+    }
+    
+    // Cursor keys use SS3 instead of CSI in application cursor mode
+    const char* cursorPrefix = m_grid.IsApplicationCursorKeys() ? "\x1bO" : "\x1b[";
+    switch (event.keyCode) {
+        case KeyCode::Up: SendInput(std::string(cursorPrefix) + "A"); return true;
+        case KeyCode::Down: SendInput(std::string(cursorPrefix) + "B"); return true;
+        case KeyCode::Right: SendInput(std::string(cursorPrefix) + "C"); return true;
+        case KeyCode::Left: SendInput(std::string(cursorPrefix) + "D"); return true;
+        case KeyCode::Home: SendInput(std::string(cursorPrefix) + "H"); return true;
+        case KeyCode::End: SendInput(std::string(cursorPrefix) + "F"); return true;
+        case KeyCode::PageUp: SendInput("\x1b[5~"); return true;
+        case KeyCode::PageDown: SendInput("\x1b[6~"); return true;
+        case KeyCode::Delete: SendInput("\x1b[3~"); return true;
+        case KeyCode::F1: SendInput("\x1bOP"); return true;
+        case KeyCode::F2: SendInput("\x1bOQ"); return true;
+        case KeyCode::F3: SendInput("\x1bOR"); return true;
+        case KeyCode::F4: SendInput("\x1bOS"); return true;
+        case KeyCode::F5: SendInput("\x1b[15~"); return true;
+        case KeyCode::F6: SendInput("\x1b[17~"); return true;
+        case KeyCode::F7: SendInput("\x1b[18~"); return true;
+        case KeyCode::F8: SendInput("\x1b[19~"); return true;
+        case KeyCode::F9: SendInput("\x1b[20~"); return true;
+        case KeyCode::F10: SendInput("\x1b[21~"); return true;
+        case KeyCode::F11: SendInput("\x1b[23~"); return true;
+        case KeyCode::F12: SendInput("\x1b[24~"); return true;
+        default:
+            // Everything else arrives as a typed character
+            return false;
+    }
+}
+
+Size TerminalView::MeasureDesiredSize(const Size& availableSize) {
+    return Size(
+        Clamp(640.0f, GetMinSize().width, GetMaxSize().width),
+        Clamp(400.0f, GetMinSize().height, GetMaxSize().height)
+    );
+}
+
+void TerminalView::OnRender(std::shared_ptr<Renderer> renderer) {
+    if (renderer) {
+        UpdateGridSize(*renderer);
+    }
+    // Output is applied once per frame, before drawing
+    FlushWrites();
+    
+    if (!IsVisible() || !renderer) return;
+    
+    Brush backgroundBrush(GetBackgroundColor());
+    renderer->FillRectangle(GetBounds(), backgroundBrush);
+    if (GetBorderWidth() > 0) {
+        Color borderColor = IsFocused() ? Color::FromRGBA(0, 120, 215, 255) : GetBorderColor();
+        renderer->DrawRectangle(GetBounds(), Pen(borderColor, GetBorderWidth()));
+    }
+    
+    const Rect textRect = GetTextRect();
+    renderer->PushClipRect(textRect);
+    
+    const float cellWidth = m_cellSize.width;
+    const float cellHeight = m_cellSize.height;
+    const size_t rows = m_grid.GetRows();
+    const size_t firstLine = m_grid.GetLineCount() - rows - m_scrollOffset;
+    if (m_slotRuns.size() < m_grid.GetSlotCount()) {
+        m_slotRuns.resize(m_grid.GetSlotCount());
+    }
+    
+    // Bring the visible lines' runs up to date and collect their backgrounds,
+    // merging neighbouring runs that differ only in foreground
+    m_fills.clear();
+    for (size_t row = 0; row < rows; ++row) {
+        const uint32_t slot = m_grid.GetLineSlot(firstLine + row);
+        if (m_grid.IsSlotDirty(slot)) {
+            BuildRuns(slot);
+            m_grid.ClearSlotDirty(slot);
+        }
+    
+        const float y = textRect.y + row * cellHeight;
+        for (const Run& run : m_slotRuns[slot].runs) {
+            const uint32_t background = (run.attributes & TerminalGrid::Inverse)
+                ? (run.foreground == TerminalGrid::DEFAULT_COLOR ? FOREGROUND_KEY : run.foreground)
+                : run.background;
+            if (background == TerminalGrid::DEFAULT_COLOR) continue;
+    
+            const Rect rect(textRect.x + run.column * cellWidth, y, run.cellCount * cellWidth, cellHeight);
+            if (!m_fills.empty() && m_fills.back().first == background && m_fills.back().second.y == y &&
+                std::fabs(m_fills.back().second.x + m_fills.back().second.width - rect.x) < 0.5f) {
+                m_fills.back().second.width += rect.width;
+            } else {
+                m_fills.emplace_back(background, rect);
+            }
+        }
+    }
+    
+    FillCollectedRects(*renderer);
+    
+    // One DrawText per run; underlines and strikethroughs are batched like the backgrounds
+    const float textRight = textRect.x + textRect.width;
+    for (size_t row = 0; row < rows; ++row) {
+        const SlotRuns& slotRuns = m_slotRuns[m_grid.GetLineSlot(firstLine + row)];
+        const float y = textRect.y + row * cellHeight;
+        for (const Run& run : slotRuns.runs) {
+            if (run.attributes & TerminalGrid::Hidden) continue;
+    
+            uint32_t foreground = run.foreground == TerminalGrid::DEFAULT_COLOR ? FOREGROUND_KEY : run.foreground;
+            uint32_t background = run.background;
+            if (run.attributes & TerminalGrid::Inverse) {
+                std::swap(foreground, background);
+            }
+            const float x = textRect.x + run.column * cellWidth;
+    
+            if (run.textLength > 0) {
+                Color color = ResolveColor(foreground);
+                if (run.attributes & TerminalGrid::Faint) {
+                    color = color.Blend(ResolveColor(background), 0.5f);
+                }
+                const Font& font = m_fonts[((run.attributes & TerminalGrid::Bold) ? 1 : 0) | ((run.attributes & TerminalGrid::Italic) ? 2 : 0)];
+                // The rectangle runs to the right edge so rounding in the advances never wraps a run
+                renderer->DrawText(std::string_view(slotRuns.text).substr(run.textStart, run.textLength),
+                    Rect(x, y, textRight - x + cellWidth, cellHeight), font, Brush(color), TextAlignment::Left);
+            }
+            if (run.attributes & TerminalGrid::Underline) {
+                m_fills.emplace_back(foreground, Rect(x, y + cellHeight - 1.0f, run.cellCount * cellWidth, 1.0f));
+            }
+            if (run.attributes & TerminalGrid::Strikethrough) {
+                m_fills.emplace_back(foreground, Rect(x, y + cellHeight * 0.5f, run.cellCount * cellWidth, 1.0f));
+            }
+        }
+    }
+    FillCollectedRects(*renderer);
+    
+    if (m_scrollOffset == 0 && m_grid.IsCursorVisible()) {
+        const Rect cursorRect(textRect.x + m_grid.GetCursorColumn() * cellWidth,
+            textRect.y + m_grid.GetCursorRow() * cellHeight, cellWidth, cellHeight);
+        if (IsFocused()) {
+            Color cursorColor = m_cursorColor;
+            cursorColor.a *= 0.6f;
+            renderer->FillRectangle(cursorRect, Brush(cursorColor));
+        } else {
+            renderer->DrawRectangle(cursorRect, Pen(m_cursorColor, 1.0f));
+        }
+    }
+    
+    renderer->PopClipRect();
+    
+    for (auto& child : GetChildren()) {
+        if (child && child->IsVisible()) {
+            child->Render(renderer);
+        }
+    }
+}
+
+void TerminalView::FillCollectedRects(Renderer& renderer) {
+    // One FillRectangles call per color
+    std::stable_sort(m_fills.begin(), m_fills.end(),
+        [](const std::pair<uint32_t, Rect>& a, const std::pair<uint32_t, Rect>& b) { return a.first < b.first; });
+    for (size_t start = 0; start < m_fills.size();) {
+        size_t end = start;
+        m_fillRects.clear();
+        while (end < m_fills.size() && m_fills[end].first == m_fills[start].first) {
+            m_fillRects.push_back(m_fills[end++].second);
+        }
+        renderer.FillRectangles(m_fillRects.data(), m_fillRects.size(), Brush(ResolveColor(m_fills[start].first)));
+        start = end;
+    }
+    m_fills.clear();
+}
+
+void TerminalView::SendInput(const std::string& bytes) {
+    SetScrollOffset(0);
+    if (OnInput) {
+        OnInput(bytes);
+    }
+}
+
+void TerminalView::UpdateGridSize(Renderer& renderer) {
+    if (!m_cellSizeValid) {
+        // Averaged over several cells so the advance keeps its fractional part
+        const Size measured = renderer.MeasureText("MMMMMMMMMMMMMMMM", m_fonts[0]);
+        m_cellSize = Size(
+            std::max(1.0f, measured.width / 16.0f),
+            measured.height > 0 ? measured.height : m_fonts[0].size * 1.2f
+        );
+        m_cellSizeValid = true;
+    }
+    
+    const Rect textRect = GetTextRect();
+    const size_t columns = std::max<size_t>(1, (size_t)std::max(0.0f, textRect.width / m_cellSize.width));
+    const size_t rows = std::max<size_t>(1, (size_t)std::max(0.0f, textRect.height / m_cellSize.height));
+    if (columns == m_grid.GetColumns() && rows == m_grid.GetRows()) return;
+    
+    // Resizing renumbers every slot, so no cached run survives it
+    m_grid.Resize(columns, rows);
+    m_slotRuns.clear();
+    m_scrollOffset = std::min(m_scrollOffset, m_grid.GetScrollbackLineCount());
+    m_scrolledLineCount = m_grid.GetScrolledLineCount();
+    if (OnResized) {
+        OnResized(columns, rows);
+    }
+}
+
+void TerminalView::BuildRuns(uint32_t slot) {
+    SlotRuns& slotRuns = m_slotRuns[slot];
+    slotRuns.text.clear();
+    slotRuns.runs.clear();
+    
+    const size_t length = m_grid.GetLength(slot);
+    const uint32_t* codePoints = m_grid.GetCodePoints(slot);
+    const uint32_t* foreground = m_grid.GetForeground(slot);
+    const uint32_t* background = m_grid.GetBackground(slot);
+    const uint8_t* attributes = m_grid.GetAttributes(slot);
+    
+    size_t column = 0;
+    while (column < length) {
+        Run run;
+        run.textStart = (uint32_t)slotRuns.text.size();
+        run.column = (uint32_t)column;
+        run.foreground = foreground[column];
+        run.background = background[column];
+        run.attributes = attributes[column];
+    
+        // Text up to the last non-blank cell, so blank runs draw no text
+        size_t textEnd = slotRuns.text.size();
+        while (column < length && foreground[column] == run.foreground &&
+               background[column] == run.background && attributes[column] == run.attributes) {
+            const uint32_t codePoint = codePoints[column];
+            if (codePoint == 0 || codePoint == ' ') {
+                slotRuns.text.push_back(' ');
+            } else {
+                char encoded[4];
+                slotRuns.text.append(encoded, EncodeUtf8(codePoint, encoded));
+                textEnd = slotRuns.text.size();
+            }
+            ++column;
+        }
+        slotRuns.text.resize(textEnd);
+        run.textLength = (uint32_t)(textEnd - run.textStart);
+        run.cellCount = (uint32_t)(column - run.column);
+        slotRuns.runs.push_back(run);
+    }
+}
+
+Color TerminalView::ResolveColor(uint32_t key) const {
+    if (key == TerminalGrid::DEFAULT_COLOR) {
+        return GetBackgroundColor();
+    }
+    if (key == FOREGROUND_KEY) {
+        return m_textColor;
+    }
+    if (TerminalGrid::IsPaletteColor(key)) {
+        return m_palette[key & 0xFF];
+    }
+    return Color::FromRGBA((key >> 16) & 0xFF, (key >> 8) & 0xFF, key & 0xFF);
+}
+
+Rect TerminalView::GetTextRect() const {
+    const Rect bounds = GetBounds();
+    const Spacing padding = GetPadding();
+    return Rect(
+        bounds.x + padding.left,
+        bounds.y + padding.top,
+        bounds.width - padding.left - padding.right,
+        bounds.height - padding.top - padding.bottom
+    );
+}
+
+} // namespace miko
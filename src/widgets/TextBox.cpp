@@ -1,27 +1,39 @@
 #include "miko/widgets/TextBox.h"
 #include "miko/core/Renderer.h"
+#include "miko/utils/FrameArena.h"
+#include "miko/text/Utf8.h"
+#include "miko/utils/Clipboard.h"
 #include <algorithm>
+#include <cstdlib>
 
 namespace miko {
 
+// FindAll stops collecting past this many matches to bound its memory
+static const size_t MAX_FIND_MATCHES = 1 << 20;
+
 TextBox::TextBox()
     : m_text()
+    , m_applyingHistory(false)
+    , m_deferTextNotification(false)
     , m_placeholderText()
     , m_font("Segoe UI", 12.0f, FontWeight::Normal, FontStyle::Normal)
     , m_textColor(Color::TextColor)
     , m_placeholderColor(Color(128, 128, 128, 255))
     , m_selectionColor(Color(0, 120, 215, 100))
     , m_caretColor(Color::TextColor)
+    , m_findHighlightColor(Color::FromRGBA(255, 200, 0, 110))
     , m_isReadOnly(false)
+    , m_multiline(false)
     , m_passwordMode(false)
     , m_passwordChar('*')
     , m_maxLength(0)
     , m_caretPosition(0)
     , m_selectionStart(0)
     , m_selectionEnd(0)
-    , m_scrollOffset(0.0f)
     , m_caretVisible(true)
     , m_lastCaretBlink(std::chrono::steady_clock::now())
+    , m_scrollOffset(0.0f)
+    , m_verticalScrollOffset(0.0f)
 {
     SetSize(Size(150, 25));
     SetBackgroundColor(Color::White);
@@ -37,20 +49,15 @@ TextBox::TextBox(const std::string& text) : TextBox() {
 
 
 void TextBox::SetText(const std::string& text) {
-    if (m_text != text) {
-        std::string newText = text;
-        if (m_maxLength > 0 && newText.length() > m_maxLength) {
-            newText = newText.substr(0, m_maxLength);
-        }
-        
-        m_text = newText;
-        m_caretPosition = std::min(m_caretPosition, (int)m_text.length());
+    if (m_text.GetLength() != text.length() || m_text.Str() != text) {
+        const int caretPosition = m_caretPosition;
+        ReplaceRange(0, (int)m_text.GetLength(), text);
+        m_caretPosition = std::min(caretPosition, (int)m_text.GetLength());
         ClearSelection();
-        
-        if (OnTextChanged) {
-            OnTextChanged(m_text);
-        }
+        EnsureCaretVisible();
     }
+    // Text set from code is a new document rather than an edit
+    m_undo.Clear();
 }
 
 void TextBox::SetPlaceholderText(const std::string& placeholderText) {
@@ -66,28 +73,38 @@ void TextBox::SetPlaceholderText(const std::string& placeholderText) {
 
 void TextBox::SetPasswordChar(char passwordChar) {
     m_passwordChar = passwordChar;
+    m_advances.Clear();
 }
 
 char TextBox::GetPasswordChar() const {
     return m_passwordChar;
 }
 
+void TextBox::SetTokenizer(std::shared_ptr<Tokenizer> tokenizer) {
+    m_tokenizer = std::move(tokenizer);
+    m_tokens.Reset();
+    Invalidate();
+}
+
 void TextBox::SetCaretPosition(int position) {
-    m_caretPosition = Clamp(position, 0, (int)m_text.length());
+    m_caretPosition = std::clamp<int>(position, 0, (int)m_text.GetLength());
     ClearSelection();
+    m_undo.Seal();
     EnsureCaretVisible();
 }
 
 void TextBox::SelectAll() {
     m_selectionStart = 0;
-    m_selectionEnd = (int)m_text.length();
+    m_selectionEnd = (int)m_text.GetLength();
     m_caretPosition = m_selectionEnd;
+    m_undo.Seal();
 }
 
 void TextBox::SetSelection(int start, int end) {
-    m_selectionStart = std::max(0, std::min(start, (int)m_text.length()));
-    m_selectionEnd = std::max(0, std::min(end, (int)m_text.length()));
+    m_selectionStart = std::max(0, std::min(start, (int)m_text.GetLength()));
+    m_selectionEnd = std::max(0, std::min(end, (int)m_text.GetLength()));
     m_caretPosition = m_selectionEnd;
+    m_undo.Seal();
 }
 
 void TextBox::GetSelection(int& start, int& end) const {
@@ -104,47 +121,248 @@ std::string TextBox::GetSelectedText() const {
     
     int start = std::min(m_selectionStart, m_selectionEnd);
     int end = std::max(m_selectionStart, m_selectionEnd);
-    return m_text.substr(start, end - start);
+    return m_text.Substr(start, end - start);
 }
 
-void TextBox::DeleteSelection() {
-    if (!HasSelection() || m_isReadOnly) return;
-    
-    int start = std::min(m_selectionStart, m_selectionEnd);
-    int end = std::max(m_selectionStart, m_selectionEnd);
-    
-    m_text.erase(start, end - start);
-    m_caretPosition = start;
+void TextBox::ReplaceRange(int start, int removeLength, std::string_view text, UndoJournal::EditKind kind) {
+    const int length = (int)m_text.GetLength();
+    start = std::clamp<int>(start, 0, length);
+    removeLength = std::clamp<int>(removeLength, 0, length - start);
+
+    // Undo and redo restore text that was already within the limit
+    if (m_maxLength > 0 && !m_applyingHistory) {
+        const int allowedLength = std::max(0, m_maxLength - (length - removeLength));
+        if ((int)text.length() > allowedLength) {
+            text = text.substr(0, allowedLength);
+        }
+    }
+    if (removeLength == 0 && text.empty()) return;
+
+    if (!m_applyingHistory) {
+        // Only the replaced bytes are journaled, never the whole text
+        FrameArena::Scope scratchScope(GetFrameArena());
+        m_undo.Record(start, GetTextRange(start, removeLength), text, kind);
+    }
+
+    // Cached advances and tokens are spliced against the line layout from before the edit
+    UpdateLineCachesForEdit(start, removeLength, text);
+    // Workers may be reading the buffer, so stop them before it changes
+    const bool findAllWasRunning = m_findAllSearch.IsRunning();
+    StopSearchesForEdit();
+    m_text.Replace(start, removeLength, text);
+    m_lines.Replace(start, removeLength, text);
+    if (findAllWasRunning) {
+        // Matches found so far may be stale; search the new text from the top
+        m_findMatches.clear();
+        m_findAllSearch.Start(m_text.GetFirstSegment(), m_text.GetSecondSegment(), m_findText, 0, MAX_FIND_MATCHES);
+    } else {
+        UpdateFindMatchesForEdit(start, removeLength, text.length());
+    }
+
+    // Keep the caret on the same character: after the edit if it was past it,
+    // at the edit point if it was inside the removed range
+    if (m_caretPosition >= start + removeLength) {
+        m_caretPosition += (int)text.length() - removeLength;
+    } else if (m_caretPosition > start) {
+        m_caretPosition = start;
+    }
     ClearSelection();
+
+    if (!m_deferTextNotification) {
+        NotifyTextChanged(start, removeLength, text);
+    }
+    EnsureCaretVisible();
+}
+
+void TextBox::NotifyTextChanged(size_t offset, size_t removedLength, std::string_view insertedText) {
+    Invalidate();
+    
+    if (OnTextChange || OnTextChangesBatched) {
+        TextChange change(offset, removedLength, std::string(insertedText));
+        if (OnTextChange) {
+            OnTextChange(change);
+        }
+        if (OnTextChangesBatched) {
+            // Consecutive keystrokes collapse into one change per frame
+            if (m_pendingChanges.empty() || !m_pendingChanges.back().TryMerge(change)) {
+                m_pendingChanges.push_back(std::move(change));
+            } else if (m_pendingChanges.back().removedLength == 0 && m_pendingChanges.back().insertedText.empty()) {
+                m_pendingChanges.pop_back();
+            }
+            // No frame will come for a box that is not drawn, so its edits are delivered as they happen
+            if (!IsRendered()) {
+                FlushTextChanges();
+            }
+        }
+    }
     
+    // The callback takes the whole string, so only flatten the buffer when someone listens
     if (OnTextChanged) {
-        OnTextChanged(m_text);
+        OnTextChanged(m_text.Str());
     }
 }
 
-void TextBox::InsertText(const std::string& text) {
-    if (m_isReadOnly) return;
+bool TextBox::IsRendered() const {
+    // Drawn each frame only if it and every ancestor are visible, under a window's root
+    if (!IsVisible()) return false;
+    std::shared_ptr<Widget> root;
+    for (auto ancestor = GetParent(); ancestor; ancestor = ancestor->GetParent()) {
+        if (!ancestor->IsVisible()) return false;
+        root = ancestor;
+    }
+    return (root ? root->GetLayoutScheduler() : GetLayoutScheduler()) != nullptr;
+}
+
+void TextBox::FlushTextChanges() {
+    if (m_pendingChanges.empty()) return;
     
-    DeleteSelection();
+    // Swap out first so a handler that edits the box queues into a fresh batch
+    std::vector<TextChange> changes;
+    changes.swap(m_pendingChanges);
+    if (OnTextChangesBatched) {
+        OnTextChangesBatched(changes);
+    }
+}
+
+void TextBox::Find(const std::string& text) {
+    m_findSearch.Cancel();
+    if (text.empty()) return;
     
-    std::string newText = m_text;
-    newText.insert(m_caretPosition, text);
+    // Start after the current selection so repeated calls step through the matches
+    const size_t from = (size_t)std::max(m_selectionStart, m_selectionEnd);
+    m_findSearch.Start(m_text.GetFirstSegment(), m_text.GetSecondSegment(), text, from, 1);
+}
+
+void TextBox::FindAll(const std::string& text) {
+    m_findAllSearch.Cancel();
+    m_findMatches.clear();
+    m_findText = text;
+    if (!text.empty()) {
+        m_findAllSearch.Start(m_text.GetFirstSegment(), m_text.GetSecondSegment(), text, 0, MAX_FIND_MATCHES);
+    }
+    Invalidate();
+}
+
+void TextBox::ClearFind() {
+    m_findSearch.Cancel();
+    m_findAllSearch.Cancel();
+    m_findMatches.clear();
+    m_findText.clear();
+    Invalidate();
+}
+
+void TextBox::PollFindResults() {
+    if (m_findSearch.IsRunning()) {
+        std::vector<size_t> found;
+        const bool running = m_findSearch.TakeMatches(found);
+        if (!found.empty()) {
+            // The search stops after one match, so this is the last poll for it
+            m_findSearch.Cancel();
+            SetSelection((int)found.front(), (int)(found.front() + m_findSearch.GetNeedle().size()));
+        }
+        if (!running || !found.empty()) {
+            EnsureCaretVisible();
+            if (OnFindCompleted) {
+                OnFindCompleted(!found.empty());
+            }
+        }
+    }
     
-    if (m_maxLength > 0 && newText.length() > m_maxLength) {
-        int allowedLength = m_maxLength - m_text.length();
-        if (allowedLength <= 0) return;
-        newText = m_text;
-        newText.insert(m_caretPosition, text.substr(0, allowedLength));
+    if (m_findAllSearch.IsRunning()) {
+        // Chunks are searched in order, so new matches extend the sorted list
+        if (!m_findAllSearch.TakeMatches(m_findMatches) && OnFindAllCompleted) {
+            OnFindAllCompleted(m_findMatches.size());
+        }
+        Invalidate();
     }
+}
+
+void TextBox::StopSearchesForEdit() {
+    // A Find that has not reported yet is dropped; it would point into the old text
+    m_findSearch.Cancel();
+    m_findAllSearch.Cancel();
+}
+
+void TextBox::UpdateFindMatchesForEdit(size_t start, size_t removeLength, size_t insertLength) {
+    if (m_findText.empty()) return;
     
-    m_text = newText;
-    m_caretPosition += text.length();
+    // Drop matches touching the edit and shift the ones after it
+    const size_t needleLength = m_findText.size();
+    const size_t windowStart = start >= needleLength - 1 ? start - (needleLength - 1) : 0;
+    const auto first = std::lower_bound(m_findMatches.begin(), m_findMatches.end(), windowStart);
+    const auto last = std::lower_bound(first, m_findMatches.end(), start + removeLength);
+    const auto kept = m_findMatches.erase(first, last);
+    const ptrdiff_t delta = (ptrdiff_t)insertLength - (ptrdiff_t)removeLength;
+    for (auto it = kept; it != m_findMatches.end(); ++it) {
+        *it = (size_t)((ptrdiff_t)*it + delta);
+    }
     
-    if (OnTextChanged) {
-        OnTextChanged(m_text);
+    // Only the bytes around the edit can hold new matches
+    FrameArena::Scope scratchScope(GetFrameArena());
+    const size_t windowEnd = std::min(m_text.GetLength(), start + insertLength + needleLength - 1);
+    const std::string_view window = GetTextRange(windowStart, windowEnd - windowStart);
+    size_t position = FindSubstring(window, m_findText);
+    while (position != std::string_view::npos && m_findMatches.size() < MAX_FIND_MATCHES) {
+        const size_t match = windowStart + position;
+        // Keep matches non-overlapping with their neighbours
+        const auto next = std::lower_bound(m_findMatches.begin(), m_findMatches.end(), match);
+        const bool clearOfPrevious = next == m_findMatches.begin() || *(next - 1) + needleLength <= match;
+        const bool clearOfNext = next == m_findMatches.end() || match + needleLength <= *next;
+        if (clearOfPrevious && clearOfNext) {
+            m_findMatches.insert(next, match);
+            position += needleLength;
+        } else {
+            ++position;
+        }
+        position = FindSubstring(window, m_findText, position);
+    }
+}
+
+void TextBox::DeleteSelection() {
+    if (!HasSelection() || m_isReadOnly) return;
+    
+    int start = std::min(m_selectionStart, m_selectionEnd);
+    int end = std::max(m_selectionStart, m_selectionEnd);
+    
+    ReplaceRange(start, end - start, std::string_view());
+}
+
+void TextBox::InsertText(std::string_view text, UndoJournal::EditKind kind) {
+    if (m_isReadOnly) return;
+    
+    if (HasSelection()) {
+        // Typing over a selection replaces it in a single edit, leaving the caret after the new text
+        int start = std::min(m_selectionStart, m_selectionEnd);
+        int end = std::max(m_selectionStart, m_selectionEnd);
+        m_caretPosition = end;
+        ReplaceRange(start, end - start, text);
+    } else {
+        ReplaceRange(m_caretPosition, 0, text, kind);
     }
+}
+
+bool TextBox::Undo() {
+    TextChange change;
+    if (m_isReadOnly || !m_undo.Undo(change)) return false;
+    return ApplyHistoryChange(change);
+}
+
+bool TextBox::Redo() {
+    TextChange change;
+    if (m_isReadOnly || !m_undo.Redo(change)) return false;
+    return ApplyHistoryChange(change);
+}
+
+bool TextBox::ApplyHistoryChange(const TextChange& change) {
+    m_applyingHistory = true;
+    ReplaceRange((int)change.offset, (int)change.removedLength, change.insertedText);
+    m_applyingHistory = false;
     
+    // Leave the caret after the restored text, as if it had just been typed
+    m_caretPosition = (int)change.GetInsertedEnd();
+    ClearSelection();
     EnsureCaretVisible();
+    return true;
 }
 
 void TextBox::Insert(const std::string& text) {
@@ -152,32 +370,16 @@ void TextBox::Insert(const std::string& text) {
 }
 
 void TextBox::Delete(int start, int count) {
-    if (start < 0 || start >= m_text.length() || count <= 0) return;
-    
-    int end = std::min(start + count, (int)m_text.length());
-    m_text.erase(start, end - start);
-    
-    if (m_caretPosition > start) {
-        m_caretPosition = std::max(start, m_caretPosition - (end - start));
-    }
-    
-    if (OnTextChanged) {
-        OnTextChanged(m_text);
-    }
+    if (start < 0 || start >= (int)m_text.GetLength() || count <= 0) return;
     
-    EnsureCaretVisible();
+    ReplaceRange(start, count, std::string_view());
 }
 
 void TextBox::Clear() {
-    m_text.clear();
     m_caretPosition = 0;
+    ReplaceRange(0, (int)m_text.GetLength(), std::string_view());
     m_selectionStart = 0;
     m_selectionEnd = 0;
-    
-    if (OnTextChanged) {
-        OnTextChanged(m_text);
-    }
-    
     EnsureCaretVisible();
 }
 
@@ -196,8 +398,19 @@ Size TextBox::MeasureDesiredSize(const Size& availableSize) {
 }
 
 void TextBox::OnRender(std::shared_ptr<Renderer> renderer) {
+    // Batched edits and search results are delivered once per frame, before drawing
+    FlushTextChanges();
+    PollFindResults();
+    
     if (!IsVisible() || !renderer) return;
     
+    FrameArena::Scope scratchScope(GetFrameArena());
+    // Advances cached so far came from the estimate or another renderer's fonts
+    if (m_renderer.lock() != renderer) {
+        m_advances.Clear();
+        m_renderer = renderer;
+    }
+    
     // Draw background
     Color bgColor = GetBackgroundColor();
     if (!IsEnabled()) {
@@ -227,33 +440,71 @@ void TextBox::OnRender(std::shared_ptr<Renderer> renderer) {
     }
     
     // Calculate text area
-        const Spacing& padding = GetPadding();
-    Rect textRect(
-        GetBounds().x + padding.left,
-        GetBounds().y + padding.top,
-        GetBounds().width - padding.left - padding.right,
-        GetBounds().height - padding.top - padding.bottom
-    );
+    Rect textRect = GetTextRect();
     
     // Set clipping to text area
     renderer->PushClipRect(textRect);
     
+    if (!m_findMatches.empty()) {
+        DrawFindMatches(renderer, textRect);
+    }
+    
     // Draw selection background
     if (HasSelection() && IsFocused()) {
         DrawSelection(renderer, textRect);
     }
     
     // Draw text or placeholder
-    std::string displayText = GetDisplayText();
-    if (!displayText.empty()) {
+    if (!m_text.IsEmpty()) {
         Color textColor = IsEnabled() ? m_textColor : Color(128, 128, 128, 255);
         Brush textBrush(textColor);
         
-        // Apply scroll offset
-        Rect scrolledTextRect = textRect;
-        scrolledTextRect.x -= m_scrollOffset;
-        
-        renderer->DrawText(displayText, scrolledTextRect, m_font, textBrush, TextAlignment::Left);
+        if (m_multiline) {
+            // Only the lines that intersect the text area are drawn
+            size_t firstLine, lastLine;
+            GetVisibleLines(textRect, firstLine, lastLine);
+            if (m_tokenizer && !m_passwordMode && IsEnabled()) {
+                // Tokenizing stops at the last visible line; stale lines further down wait until shown
+                FrameArena::Scope scratchScope(GetFrameArena());
+                m_tokens.Update(*m_tokenizer, lastLine, m_lines.GetLineCount(), [this](size_t line) {
+                    size_t start, length;
+                    GetLineRange(line, start, length);
+                    if (length > 0 && m_text.At(start + length - 1) == '\r') {
+                        --length;
+                    }
+                    return GetTextRange(start, length);
+                });
+            }
+            const float lineHeight = GetLineHeight();
+            for (size_t line = firstLine; line < lastLine; ++line) {
+                size_t start = m_lines.GetLineStart(line);
+                size_t length = m_lines.GetLineLength(line);
+                if (length > 0 && m_text.At(start + length - 1) == '\r') {
+                    --length;
+                }
+                if (length == 0) continue;
+                
+                Rect lineRect(
+                    textRect.x - m_scrollOffset,
+                    textRect.y + line * lineHeight - m_verticalScrollOffset,
+                    textRect.width + m_scrollOffset,
+                    lineHeight
+                );
+                DrawLineText(renderer, line, start, length, lineRect, textBrush);
+            }
+        } else {
+            // Apply scroll offset
+            Rect scrolledTextRect = textRect;
+            scrolledTextRect.x -= m_scrollOffset;
+            
+            if (m_tokenizer && !m_passwordMode && IsEnabled()) {
+                FrameArena::Scope scratchScope(GetFrameArena());
+                m_tokens.Update(*m_tokenizer, 1, 1, [this](size_t) {
+                    return GetTextRange(0, m_text.GetLength());
+                });
+            }
+            DrawLineText(renderer, 0, 0, m_text.GetLength(), scrolledTextRect, textBrush);
+        }
     } else if (!m_placeholderText.empty() && !IsFocused()) {
         Brush placeholderBrush(m_placeholderColor);
         renderer->DrawText(m_placeholderText, textRect, m_font, placeholderBrush, TextAlignment::Left);
@@ -266,6 +517,13 @@ void TextBox::OnRender(std::shared_ptr<Renderer> renderer) {
     
     renderer->PopClipRect();
     
+    // Only keep measurements for what is on screen and the caret line
+    if (m_multiline) {
+        size_t firstLine, lastLine;
+        GetVisibleLines(textRect, firstLine, lastLine);
+        m_advances.Retain(firstLine, lastLine, GetLineOf(m_caretPosition));
+    }
+    
     // Render children
     for (auto& child : GetChildren()) {
         if (child && child->IsVisible()) {
@@ -293,10 +551,16 @@ bool TextBox::OnMouseEvent(const MouseEvent& event) {
             m_selectionStart = m_selectionEnd = newCaretPos;
         }
         
+        m_undo.Seal();
         EnsureCaretVisible();
         return true;
     }
     
+    if (event.type == EventType::MouseScrolled && m_multiline && HitTest(event.position)) {
+        SetVerticalScrollOffset(m_verticalScrollOffset - event.wheelDelta * GetLineHeight() * 3.0f);
+        return true;
+    }
+    
     return false;
 }
 
@@ -305,6 +569,11 @@ bool TextBox::OnKeyEvent(const KeyEvent& event) {
         return false;
     }
     
+    if (event.type == EventType::KeyTyped) {
+        HandleCharacterInput(event.character);
+        return true;
+    }
+    
     if (event.type != EventType::KeyPressed) {
         return false;
     }
@@ -315,43 +584,54 @@ bool TextBox::OnKeyEvent(const KeyEvent& event) {
         case KeyCode::Left:
             if (event.shiftPressed) {
                 if (m_caretPosition > 0) {
-                    m_caretPosition--;
+                    m_caretPosition = GetPreviousCaretStop(m_caretPosition);
                     m_selectionEnd = m_caretPosition;
                 }
             } else {
                 if (m_caretPosition > 0) {
-                    m_caretPosition--;
+                    m_caretPosition = GetPreviousCaretStop(m_caretPosition);
                 }
                 m_selectionStart = m_selectionEnd = m_caretPosition;
             }
+            m_undo.Seal();
+            EnsureCaretVisible();
             handled = true;
             break;
             
         case KeyCode::Right:
             if (event.shiftPressed) {
-                if (m_caretPosition < (int)m_text.length()) {
-                    m_caretPosition++;
+                if (m_caretPosition < (int)m_text.GetLength()) {
+                    m_caretPosition = GetNextCaretStop(m_caretPosition);
                     m_selectionEnd = m_caretPosition;
                 }
             } else {
-                if (m_caretPosition < (int)m_text.length()) {
-                    m_caretPosition++;
+                if (m_caretPosition < (int)m_text.GetLength()) {
+                    m_caretPosition = GetNextCaretStop(m_caretPosition);
                 }
                 m_selectionStart = m_selectionEnd = m_caretPosition;
             }
+            m_undo.Seal();
+            EnsureCaretVisible();
             handled = true;
             break;
             
+        case KeyCode::Up:
+        case KeyCode::Down:
+            if (m_multiline) {
+                MoveCaretToLine(event.keyCode == KeyCode::Up ? -1 : 1, event.shiftPressed);
+            } else {
+                handled = false;
+            }
+            break;
+            
         case KeyCode::Backspace:
             if (!m_isReadOnly) {
                 if (HasSelection()) {
                     DeleteSelection();
                 } else if (m_caretPosition > 0) {
-                    m_text.erase(m_caretPosition - 1, 1);
-                    m_caretPosition--;
-                    if (OnTextChanged) {
-                        OnTextChanged(m_text);
-                    }
+                    const int previous = GetPreviousCaretStop(m_caretPosition);
+                    ReplaceRange(previous, m_caretPosition - previous, std::string_view(),
+                                 UndoJournal::EditKind::Backspace);
                 }
                 EnsureCaretVisible();
             }
@@ -361,11 +641,9 @@ bool TextBox::OnKeyEvent(const KeyEvent& event) {
             if (!m_isReadOnly) {
                 if (HasSelection()) {
                     DeleteSelection();
-                } else if (m_caretPosition < (int)m_text.length()) {
-                    m_text.erase(m_caretPosition, 1);
-                    if (OnTextChanged) {
-                        OnTextChanged(m_text);
-                    }
+                } else if (m_caretPosition < (int)m_text.GetLength()) {
+                    ReplaceRange(m_caretPosition, GetNextCaretStop(m_caretPosition) - m_caretPosition, std::string_view(),
+                                 UndoJournal::EditKind::ForwardDelete);
                 }
                 EnsureCaretVisible();
             }
@@ -379,6 +657,50 @@ bool TextBox::OnKeyEvent(const KeyEvent& event) {
             }
             break;
             
+        case KeyCode::C:
+            if (event.ctrlPressed) {
+                Copy();
+            } else {
+                handled = false;
+            }
+            break;
+            
+        case KeyCode::X:
+            if (event.ctrlPressed) {
+                Cut();
+            } else {
+                handled = false;
+            }
+            break;
+            
+        case KeyCode::V:
+            if (event.ctrlPressed) {
+                Paste();
+            } else {
+                handled = false;
+            }
+            break;
+            
+        case KeyCode::Z:
+            if (event.ctrlPressed) {
+                if (event.shiftPressed) {
+                    Redo();
+                } else {
+                    Undo();
+                }
+            } else {
+                handled = false;
+            }
+            break;
+            
+        case KeyCode::Y:
+            if (event.ctrlPressed) {
+                Redo();
+            } else {
+                handled = false;
+            }
+            break;
+            
         default:
             handled = false;
             break;
@@ -389,6 +711,24 @@ bool TextBox::OnKeyEvent(const KeyEvent& event) {
 
 
 
+void TextBox::HandleCharacterInput(char c) {
+    if (c == '\r' || c == '\n') {
+        if (m_multiline) {
+            InsertText("\n", UndoJournal::EditKind::Typing);
+        } else if (OnEnterPressed) {
+            OnEnterPressed();
+        }
+        return;
+    }
+    
+    // Backspace, tab and other control characters arrive as key presses
+    if (static_cast<unsigned char>(c) < 32 || c == 127) {
+        return;
+    }
+    
+    InsertText(std::string_view(&c, 1), UndoJournal::EditKind::Typing);
+}
+
 void TextBox::OnFocusGained() {
     m_caretVisible = true;
 }
@@ -398,15 +738,180 @@ void TextBox::OnFocusLost() {
     m_caretVisible = false;
 }
 
-std::string TextBox::GetDisplayText() const {
-    if (m_passwordMode && !m_text.empty()) {
-        return std::string(m_text.length(), m_passwordChar);
+std::string_view TextBox::GetDisplayText(size_t start, size_t count) const {
+    // Anything that has to be assembled only lives for the current frame, so build it in the frame arena
+    if (m_passwordMode) {
+        return MaskText(count);
+    }
+    return GetTextRange(start, count);
+}
+
+std::string_view TextBox::GetTextRange(size_t start, size_t count) const {
+    // Ranges on one side of the gap are read in place; only a range spanning it is copied
+    const std::string_view first = m_text.GetFirstSegment();
+    if (start + count <= first.size()) {
+        return first.substr(start, count);
+    }
+    if (start >= first.size()) {
+        return m_text.GetSecondSegment().substr(start - first.size(), count);
+    }
+    char* copy = GetFrameArena().AllocateArray<char>(count);
+    m_text.CopyTo(start, count, copy);
+    return std::string_view(copy, count);
+}
+
+std::string_view TextBox::MaskText(size_t count) const {
+    if (count == 0) return std::string_view();
+    
+    char* masked = GetFrameArena().AllocateArray<char>(count);
+    std::fill(masked, masked + count, m_passwordChar);
+    return std::string_view(masked, count);
+}
+
+void TextBox::GetLineRange(size_t line, size_t& start, size_t& length) const {
+    // A single-line box treats its whole text as line 0
+    if (!m_multiline) {
+        start = 0;
+        length = m_text.GetLength();
+        return;
+    }
+    start = m_lines.GetLineStart(line);
+    length = m_lines.GetLineLength(line);
+}
+
+size_t TextBox::GetLineOf(int position) const {
+    return m_multiline ? m_lines.FindLine(position) : 0;
+}
+
+const std::vector<float>& TextBox::GetLineOffsets(size_t line) const {
+    FrameArena::Scope scratchScope(GetFrameArena());
+    size_t start, length;
+    GetLineRange(line, start, length);
+    return m_advances.GetOffsets(line, GetDisplayText(start, length), GetMeasureFunction());
+}
+
+GlyphAdvanceIndex::MeasureFunction TextBox::GetMeasureFunction() const {
+    // Use the renderer from the last frame; before the first frame fall back to an estimate
+    return [this](std::string_view text, float* advances) {
+        if (auto renderer = m_renderer.lock()) {
+            renderer->MeasureCharacterAdvances(text, m_font, advances);
+            return;
+        }
+        const float estimate = m_font.size * 0.6f;
+        size_t position = 0;
+        while (position < text.size()) {
+            const size_t length = GetGraphemeLength(text, position);
+            std::fill(advances + position, advances + position + length - 1, 0.0f);
+            advances[position + length - 1] = estimate;
+            position += length;
+        }
+    };
+}
+
+float TextBox::GetCharacterX(int position) const {
+    const size_t line = GetLineOf(position);
+    size_t start, length;
+    GetLineRange(line, start, length);
+    const std::vector<float>& offsets = GetLineOffsets(line);
+    return offsets[std::min((size_t)position - start, offsets.size() - 1)];
+}
+
+void TextBox::UpdateLineCachesForEdit(int start, int removeLength, std::string_view text) {
+    FrameArena::Scope scratchScope(GetFrameArena());
+    const std::string_view displayText = m_passwordMode ? MaskText(text.length()) : text;
+    
+    const size_t firstLine = GetLineOf(start);
+    const size_t lastLine = GetLineOf(start + removeLength);
+    const size_t insertedBreaks = m_multiline ? (size_t)std::count(text.begin(), text.end(), '\n') : 0;
+    if (firstLine == lastLine && insertedBreaks == 0) {
+        size_t lineStart, lineLength;
+        GetLineRange(firstLine, lineStart, lineLength);
+        m_advances.SpliceLine(firstLine, start - lineStart, removeLength, displayText, GetMeasureFunction());
+    } else {
+        m_advances.ReplaceLines(firstLine, lastLine, (ptrdiff_t)insertedBreaks - (ptrdiff_t)(lastLine - firstLine));
+    }
+    m_tokens.ReplaceLines(firstLine, lastLine, (ptrdiff_t)insertedBreaks - (ptrdiff_t)(lastLine - firstLine));
+}
+
+int TextBox::GetNextCaretStop(int position) const {
+    // Clusters are short, so a small window after the caret is enough to find the next one
+    FrameArena::Scope scratchScope(GetFrameArena());
+    const size_t count = std::min<size_t>(64, m_text.GetLength() - position);
+    const size_t length = GetGraphemeLength(GetTextRange(position, count), 0);
+    return position + (int)std::max<size_t>(length, 1);
+}
+
+int TextBox::GetPreviousCaretStop(int position) const {
+    FrameArena::Scope scratchScope(GetFrameArena());
+    size_t windowStart = position > 64 ? position - 64 : 0;
+    while (windowStart > 0 && IsUtf8Continuation((unsigned char)m_text.At(windowStart))) {
+        --windowStart;
+    }
+    const std::string_view window = GetTextRange(windowStart, position - windowStart);
+    return (int)(windowStart + GetPreviousGraphemeStart(window, window.size()));
+}
+
+float TextBox::GetLineHeight() const {
+    return m_font.size * 1.2f;
+}
+
+Rect TextBox::GetTextRect() const {
+    const Rect bounds = GetBounds();
+    const Spacing padding = GetPadding();
+    return Rect(
+        bounds.x + padding.left,
+        bounds.y + padding.top,
+        bounds.width - padding.left - padding.right,
+        bounds.height - padding.top - padding.bottom
+    );
+}
+
+void TextBox::GetVisibleLines(const Rect& textRect, size_t& firstLine, size_t& lastLine) const {
+    const float lineHeight = GetLineHeight();
+    const size_t lineCount = m_lines.GetLineCount();
+    firstLine = std::min(lineCount - 1, (size_t)(std::max(0.0f, m_verticalScrollOffset) / lineHeight));
+    lastLine = std::min(lineCount, (size_t)((m_verticalScrollOffset + textRect.height) / lineHeight) + 1);
+}
+
+int TextBox::GetLineCount() const {
+    return m_multiline ? (int)m_lines.GetLineCount() : 1;
+}
+
+void TextBox::SetVerticalScrollOffset(float offset) {
+    const float contentHeight = m_lines.GetLineCount() * GetLineHeight();
+    const float maxOffset = std::max(0.0f, contentHeight - GetTextRect().height);
+    offset = Clamp(offset, 0.0f, maxOffset);
+    if (offset != m_verticalScrollOffset) {
+        m_verticalScrollOffset = offset;
+        Invalidate();
     }
-    return m_text;
+}
+
+void TextBox::MoveCaretToLine(int lineDelta, bool extendSelection) {
+    // Keep the caret's x position, snapped to the nearest cluster on the target line
+    const int line = (int)m_lines.FindLine(m_caretPosition);
+    const float caretX = GetCharacterX(m_caretPosition);
+    const int targetLine = std::clamp<int>(line + lineDelta, 0, (int)m_lines.GetLineCount() - 1);
+    const size_t targetColumn = std::min(GlyphAdvanceIndex::HitTest(GetLineOffsets(targetLine), caretX),
+                                         m_lines.GetLineLength(targetLine));
+    const int newPos = (int)(m_lines.GetLineStart(targetLine) + targetColumn);
+    
+    if (extendSelection) {
+        if (!HasSelection()) {
+            m_selectionStart = m_caretPosition;
+        }
+        m_selectionEnd = newPos;
+    } else {
+        m_selectionStart = m_selectionEnd = newPos;
+    }
+    
+    m_caretPosition = newPos;
+    m_undo.Seal();
+    EnsureCaretVisible();
 }
 
 void TextBox::MoveCaret(int delta, bool extendSelection) {
-    int newPos = Clamp(m_caretPosition + delta, 0, (int)m_text.length());
+    int newPos = std::clamp<int>(m_caretPosition + delta, 0, (int)m_text.GetLength());
     
     if (extendSelection) {
         m_selectionEnd = newPos;
@@ -415,34 +920,71 @@ void TextBox::MoveCaret(int delta, bool extendSelection) {
     }
     
     m_caretPosition = newPos;
+    m_undo.Seal();
     EnsureCaretVisible();
 }
 
 int TextBox::GetCaretPositionFromPoint(const Point& point) {
-    // Simplified implementation - in a real implementation, this would
-    // use the renderer to measure text accurately
-    const Spacing& padding = GetPadding();
-    float textX = point.x - GetBounds().x - padding.left + m_scrollOffset;
-    if (textX <= 0) return 0;
-    float charWidth = m_font.size * 0.6f; // Approximate character width
-    int position = (int)(textX / charWidth);
-    return Clamp(position, 0, (int)m_text.length());
+    return GetCharacterIndexAt(point);
 }
 
 void TextBox::EnsureCaretVisible() {
     // Simplified scrolling implementation
-    const Spacing& padding = GetPadding();
-    float textAreaWidth = GetBounds().width - padding.left - padding.right;
-    float charWidth = m_font.size * 0.6f;
-    float caretX = m_caretPosition * charWidth;
+    const Rect textRect = GetTextRect();
+    const size_t line = GetLineOf(m_caretPosition);
+    float caretX = GetCharacterX(m_caretPosition);
     if (caretX < m_scrollOffset) {
         m_scrollOffset = caretX;
-    } else if (caretX > m_scrollOffset + textAreaWidth) {
-        m_scrollOffset = caretX - textAreaWidth;
+    } else if (caretX > m_scrollOffset + textRect.width) {
+        m_scrollOffset = caretX - textRect.width;
     }
     if (m_scrollOffset < 0) {
         m_scrollOffset = 0;
     }
+    
+    if (m_multiline) {
+        const float lineHeight = GetLineHeight();
+        const float caretTop = line * lineHeight;
+        if (caretTop < m_verticalScrollOffset) {
+            m_verticalScrollOffset = caretTop;
+        } else if (caretTop + lineHeight > m_verticalScrollOffset + textRect.height) {
+            m_verticalScrollOffset = caretTop + lineHeight - textRect.height;
+        }
+        m_verticalScrollOffset = std::max(0.0f, m_verticalScrollOffset);
+    }
+}
+
+void TextBox::DrawLineText(std::shared_ptr<Renderer> renderer, size_t line, size_t start, size_t length,
+                           const Rect& lineRect, const Brush& textBrush) {
+    const std::vector<TokenSpan>* spans = nullptr;
+    if (m_tokenizer && !m_passwordMode && IsEnabled()) {
+        spans = m_tokens.FindSpans(line);
+    }
+    if (!spans || spans->empty()) {
+        renderer->DrawText(GetDisplayText(start, length), lineRect, m_font, textBrush, TextAlignment::Left);
+        return;
+    }
+    
+    // Draw the line as runs, placed with the cached advances so they line up with the caret
+    const std::vector<float>& offsets = GetLineOffsets(line);
+    auto drawRun = [&](size_t runStart, size_t runEnd, const Brush& brush) {
+        if (runEnd <= runStart) return;
+        const float x = offsets[runStart];
+        Rect runRect(lineRect.x + x, lineRect.y, lineRect.width - x, lineRect.height);
+        renderer->DrawText(GetTextRange(start + runStart, runEnd - runStart), runRect, m_font, brush, TextAlignment::Left);
+    };
+    
+    FrameArena::Scope scratchScope(GetFrameArena());
+    size_t drawn = 0;
+    for (const TokenSpan& span : *spans) {
+        const size_t spanStart = std::max<size_t>(span.start, drawn);
+        const size_t spanEnd = std::min<size_t>((size_t)span.start + span.length, length);
+        if (spanStart >= spanEnd) continue;
+        drawRun(drawn, spanStart, textBrush);
+        drawRun(spanStart, spanEnd, Brush(span.color));
+        drawn = spanEnd;
+    }
+    drawRun(drawn, length, textBrush);
 }
 
 void TextBox::DrawSelection(std::shared_ptr<Renderer> renderer, const Rect& textRect) {
@@ -451,86 +993,195 @@ void TextBox::DrawSelection(std::shared_ptr<Renderer> renderer, const Rect& text
     int start = std::min(m_selectionStart, m_selectionEnd);
     int end = std::max(m_selectionStart, m_selectionEnd);
     
-    float charWidth = m_font.size * 0.6f;
-    float startX = start * charWidth - m_scrollOffset;
-    float endX = end * charWidth - m_scrollOffset;
+    FillTextRange(renderer, textRect, start, end, Brush(m_selectionColor));
+}
+
+void TextBox::DrawFindMatches(std::shared_ptr<Renderer> renderer, const Rect& textRect) {
+    // Only matches that can reach the visible lines are drawn
+    size_t visibleStart = 0;
+    size_t visibleEnd = m_text.GetLength();
+    if (m_multiline) {
+        size_t firstLine, lastLine;
+        GetVisibleLines(textRect, firstLine, lastLine);
+        if (firstLine >= lastLine) return;
+        visibleStart = m_lines.GetLineStart(firstLine);
+        visibleEnd = m_lines.GetLineEnd(lastLine - 1);
+    }
     
-    Rect selectionRect(
-        textRect.x + startX,
-        textRect.y,
-        endX - startX,
-        textRect.height
-    );
+    const size_t needleLength = m_findText.size();
+    const Brush highlightBrush(m_findHighlightColor);
+    auto it = std::lower_bound(m_findMatches.begin(), m_findMatches.end(),
+                               visibleStart >= needleLength ? visibleStart - needleLength + 1 : 0);
+    for (; it != m_findMatches.end() && *it < visibleEnd; ++it) {
+        FillTextRange(renderer, textRect, (int)*it, (int)(*it + needleLength), highlightBrush);
+    }
+}
+
+void TextBox::FillTextRange(std::shared_ptr<Renderer> renderer, const Rect& textRect, int start, int end, const Brush& brush) {
+    if (!m_multiline) {
+        const std::vector<float>& offsets = GetLineOffsets(0);
+        float startX = offsets[start] - m_scrollOffset;
+        float endX = offsets[end] - m_scrollOffset;
+        
+        Rect rangeRect(
+            textRect.x + startX,
+            textRect.y,
+            endX - startX,
+            textRect.height
+        );
+        
+        // Clip to text area
+        rangeRect.x = std::max(rangeRect.x, textRect.x);
+        float rightEdge = std::min(rangeRect.x + rangeRect.width, textRect.x + textRect.width);
+        rangeRect.width = rightEdge - rangeRect.x;
+        
+        if (rangeRect.width > 0) {
+            renderer->FillRectangle(rangeRect, brush);
+        }
+        return;
+    }
     
-    // Clip selection to text area
-    selectionRect.x = std::max(selectionRect.x, textRect.x);
-    float rightEdge = std::min(selectionRect.x + selectionRect.width, textRect.x + textRect.width);
-    selectionRect.width = rightEdge - selectionRect.x;
+    // One rectangle per visible line of the range
+    size_t firstLine, lastLine;
+    GetVisibleLines(textRect, firstLine, lastLine);
+    const size_t startLine = std::max(firstLine, m_lines.FindLine(start));
+    const size_t endLine = std::min(lastLine, m_lines.FindLine(end) + 1);
+    const float lineHeight = GetLineHeight();
+    // Width shown for a selected line break
+    const float breakWidth = m_font.size * 0.3f;
     
-    if (selectionRect.width > 0) {
-        Brush selectionBrush(m_selectionColor);
-        renderer->FillRectangle(selectionRect, selectionBrush);
+    for (size_t line = startLine; line < endLine; ++line) {
+        const int lineStart = (int)m_lines.GetLineStart(line);
+        const int lineEnd = (int)m_lines.GetLineEnd(line);
+        const std::vector<float>& offsets = GetLineOffsets(line);
+        
+        const float lineStartX = offsets[std::max(start, lineStart) - lineStart];
+        // Ranges running past the end of a line include its line break
+        const float lineEndX = end > lineEnd ? offsets.back() + breakWidth : offsets[end - lineStart];
+        
+        float startX = std::max(textRect.x, textRect.x + lineStartX - m_scrollOffset);
+        float endX = std::min(textRect.Right(), textRect.x + lineEndX - m_scrollOffset);
+        if (endX > startX) {
+            Rect rangeRect(startX, textRect.y + line * lineHeight - m_verticalScrollOffset, endX - startX, lineHeight);
+            renderer->FillRectangle(rangeRect, brush);
+        }
     }
 }
 
 void TextBox::DrawCaret(std::shared_ptr<Renderer> renderer, const Rect& textRect) {
-    float charWidth = m_font.size * 0.6f;
-    float caretX = m_caretPosition * charWidth - m_scrollOffset;
+    const size_t line = GetLineOf(m_caretPosition);
+    float caretX = GetCharacterX(m_caretPosition) - m_scrollOffset;
     
     if (caretX >= 0 && caretX <= textRect.width) {
         Pen caretPen(m_caretColor, 1.0f);
         
-        Point start(textRect.x + caretX, textRect.y + 1);
-        Point end(textRect.x + caretX, textRect.y + textRect.height - 1);
+        float top = textRect.y;
+        float height = textRect.height;
+        if (m_multiline) {
+            height = GetLineHeight();
+            top += line * height - m_verticalScrollOffset;
+        }
+        
+        Point start(textRect.x + caretX, top + 1);
+        Point end(textRect.x + caretX, top + height - 1);
         
         renderer->DrawLine(start, end, caretPen);
     }
 }
 
 void TextBox::Copy() {
-    if (HasSelection()) {
-        std::string selectedText = GetSelectedText();
-        // TODO: Implement clipboard copy functionality
-        // For now, this is a placeholder
+    // Password text stays in the box
+    if (HasSelection() && !m_passwordMode) {
+        SetClipboardText(GetSelectedText());
     }
 }
 
 void TextBox::Cut() {
-    if (HasSelection() && !m_isReadOnly) {
+    if (HasSelection() && !m_isReadOnly && !m_passwordMode) {
         Copy();
         DeleteSelection();
     }
 }
 
 void TextBox::Paste() {
-    if (!m_isReadOnly) {
-        // TODO: Implement clipboard paste functionality
-        // For now, this is a placeholder
-        // std::string clipboardText = GetClipboardText();
-        // InsertText(clipboardText);
+    if (m_isReadOnly) return;
+    
+    // The text arrives in pieces, each inserted after the last, so a large
+    // paste is never held whole outside the buffer; the pieces coalesce into
+    // one undo step
+    const int start = std::min(m_selectionStart, m_selectionEnd);
+    const int selectedLength = std::abs(m_selectionEnd - m_selectionStart);
+    int removeLength = selectedLength;
+    m_caretPosition = start + removeLength;
+    m_undo.Seal();
+    
+    // Reserving moves the buffer, so workers reading it stop first; a FindAll
+    // starts over on the pasted text at the end
+    const bool findAllWasRunning = m_findAllSearch.IsRunning();
+    StopSearchesForEdit();
+    
+    // The pieces raise one change for the whole paste, below, rather than
+    // flattening the text for OnTextChanged once per piece
+    m_deferTextNotification = true;
+    bool edited = false;
+    bool reserved = false;
+    bool lineEnded = false;
+    size_t pastedLength = 0;
+    ReadClipboardText([&](std::string_view chunk, size_t totalLength) {
+        if (lineEnded) return;
+        // A single-line box takes the first line only
+        if (!m_multiline) {
+            const size_t lineBreak = chunk.find_first_of("\r\n");
+            if (lineBreak != std::string_view::npos) {
+                chunk = chunk.substr(0, lineBreak);
+                lineEnded = true;
+            }
+        }
+        if (!reserved) {
+            m_text.Reserve(m_text.GetLength() - removeLength + totalLength);
+            reserved = true;
+        }
+        pastedLength += chunk.size();
+        
+        ReplaceRange(m_caretPosition - removeLength, removeLength, chunk, UndoJournal::EditKind::Paste);
+        removeLength = 0;
+        edited = true;
+    });
+    m_deferTextNotification = false;
+    m_undo.Seal();
+    
+    if (findAllWasRunning) {
+        m_findMatches.clear();
+        m_findAllSearch.Start(m_text.GetFirstSegment(), m_text.GetSecondSegment(), m_findText, 0, MAX_FIND_MATCHES);
+    }
+    
+    // The caret ends after the pasted text, which the length limit may have cut
+    const int insertedLength = m_caretPosition - start;
+    if (edited && (selectedLength > 0 || insertedLength > 0)) {
+        FrameArena::Scope scratchScope(GetFrameArena());
+        NotifyTextChanged(start, selectedLength, GetTextRange(start, insertedLength));
+    }
+    
+    // As with any single edit, one larger than the journal cannot be undone
+    if (pastedLength > m_undo.GetByteLimit()) {
+        m_undo.Clear();
     }
 }
 
 int TextBox::GetCharacterIndexAt(const Point& position) const {
-    // Simple implementation - just return position based on character width
-    // This is a placeholder implementation
-    Rect bounds = GetBounds();
-    Rect textRect = Rect(
-        bounds.x + GetPadding().left,
-        bounds.y + GetPadding().top,
-        bounds.width - GetPadding().left - GetPadding().right,
-        bounds.height - GetPadding().top - GetPadding().bottom
-    );
+    Rect textRect = GetTextRect();
     
-    if (position.x <= textRect.x) {
-        return 0;
+    size_t line = 0;
+    if (m_multiline) {
+        const float y = position.y - textRect.y + m_verticalScrollOffset;
+        line = (size_t)Clamp(y / GetLineHeight(), 0.0f, (float)(m_lines.GetLineCount() - 1));
     }
     
-    // Estimate character position based on average character width
-    float avgCharWidth = 8.0f; // Placeholder value
-    int charIndex = (int)((position.x - textRect.x) / avgCharWidth);
-    
-    return std::min(charIndex, (int)m_text.length());
+    size_t lineStart, lineLength;
+    GetLineRange(line, lineStart, lineLength);
+    // Binary search over the line's cumulative advances
+    const size_t column = GlyphAdvanceIndex::HitTest(GetLineOffsets(line), position.x - textRect.x + m_scrollOffset);
+    return (int)(lineStart + std::min(column, lineLength));
 }
 
 } // namespace miko
\ No newline at end of file
@@ -0,0 +1,264 @@
+#include "miko/widgets/TileView.h"
+#include "miko/core/Renderer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace miko {
+
+// Rows scrolled per wheel notch
+static const double WHEEL_ROWS = 3.0;
+
+TileView::TileView()
+    : m_itemCount(0)
+    , m_scrollOffset(0.0)
+    , m_firstRealized(0)
+    , m_refreshPending(false)
+    , m_arrangedOffset(0.0)
+    , m_arrangeValid(false)
+{
+    SetSize(Size(400, 300));
+    SetBackgroundColor(Color::White);
+    SetBorderColor(Color::FromRGBA(128, 128, 128, 255));
+    SetBorderWidth(1.0f);
+    SetPadding(Spacing(4, 4, 4, 4));
+    m_grid.SetSpacing(4.0f);
+}
+
+void TileView::SetItemFactory(ItemFactory factory) {
+    m_factory = std::move(factory);
+    // Widgets from the old factory are dropped rather than offered to the new one
+    for (const auto& item : m_realized) {
+        if (item) {
+            RemoveChild(item);
+        }
+    }
+    m_realized.clear();
+    m_recycled.clear();
+    m_firstRealized = 0;
+    Invalidate();
+}
+
+void TileView::SetItemCount(size_t count) {
+    if (count == m_itemCount) return;
+    
+    // Items past the new end are recycled by the next update
+    m_itemCount = count;
+    Invalidate();
+}
+
+void TileView::RefreshItems() {
+    m_refreshPending = true;
+    Invalidate();
+}
+
+void TileView::ScrollTo(double offset) {
+    offset = std::clamp(offset, 0.0, GetMaxScrollOffset());
+    if (offset != m_scrollOffset) {
+        m_scrollOffset = offset;
+        Invalidate();
+    }
+}
+
+void TileView::ScrollToItem(size_t index) {
+    if (index >= m_itemCount) return;
+    
+    const Rect area = GetItemArea();
+    const Rect item = m_grid.GetItemRect(index, area, m_scrollOffset);
+    if (item.y < area.y) {
+        ScrollBy(item.y - area.y);
+    } else if (item.Bottom() > area.Bottom()) {
+        // Items taller than the view show their top
+        ScrollBy(std::min(item.Bottom() - area.Bottom(), item.y - area.y));
+    }
+}
+
+double TileView::GetMaxScrollOffset() const {
+    const Rect area = GetItemArea();
+    return std::max(0.0, (double)m_grid.GetExtent(m_itemCount, area.width).height - area.height);
+}
+
+size_t TileView::GetItemAt(const Point& point) const {
+    const Rect area = GetItemArea();
+    if (!area.Contains(point)) return UniformGridLayout::NO_INDEX;
+    return m_grid.GetIndexAt(point, area, m_itemCount, m_scrollOffset);
+}
+
+Rect TileView::GetItemRect(size_t index) const {
+    return m_grid.GetItemRect(index, GetItemArea(), m_scrollOffset);
+}
+
+std::shared_ptr<Widget> TileView::GetRealizedItem(size_t index) const {
+    if (index < m_firstRealized || index - m_firstRealized >= m_realized.size()) return nullptr;
+    return m_realized[index - m_firstRealized];
+}
+
+void TileView::UpdateItems() {
+    // The item count or size may have changed since the offset was set
+    m_scrollOffset = std::clamp(m_scrollOffset, 0.0, GetMaxScrollOffset());
+    
+    const Rect area = GetItemArea();
+    size_t first = 0;
+    size_t last = 0;
+    if (m_factory) {
+        m_grid.GetVisibleRange(area, m_itemCount, m_scrollOffset, first, last);
+    }
+    
+    const bool rangeChanged = first != m_firstRealized || last - first != m_realized.size();
+    if (rangeChanged || m_refreshPending) {
+        // Items still in view keep their widget; the rest are recycled before
+        // the new ones are realized so the factory can reuse them straight away
+        m_nextRealized.assign(last - first, nullptr);
+        for (size_t i = 0; i < m_realized.size(); ++i) {
+            const size_t index = m_firstRealized + i;
+            if (!m_refreshPending && index >= first && index < last) {
+                m_nextRealized[index - first] = std::move(m_realized[i]);
+            } else if (m_realized[i]) {
+                RecycleItem(m_realized[i]);
+            }
+        }
+        m_realized.swap(m_nextRealized);
+        m_nextRealized.clear();
+        m_firstRealized = first;
+        m_refreshPending = false;
+    
+        for (size_t i = 0; i < m_realized.size(); ++i) {
+            if (!m_realized[i]) {
+                m_realized[i] = RealizeItem(first + i);
+                if (m_realized[i]) {
+                    m_realized[i]->Arrange(m_grid.GetItemRect(first + i, area, m_scrollOffset));
+                }
+            }
+        }
+    }
+    
+    // Only a scroll or resize moves the items that were already placed
+    if (!m_arrangeValid || m_arrangedOffset != m_scrollOffset || m_arrangedArea != area) {
+        for (size_t i = 0; i < m_realized.size(); ++i) {
+            if (m_realized[i]) {
+                m_realized[i]->Arrange(m_grid.GetItemRect(m_firstRealized + i, area, m_scrollOffset));
+            }
+        }
+        m_arrangedArea = area;
+        m_arrangedOffset = m_scrollOffset;
+        m_arrangeValid = true;
+    }
+}
+
+bool TileView::OnMouseEvent(const MouseEvent& event) {
+    if (!IsEnabled()) return false;
+    
+    // Realized items get the first chance, so tiles can have their own buttons
+    if (Widget::OnMouseEvent(event)) return true;
+    
+    if (event.type == EventType::MouseButtonPressed && HitTest(event.position)) {
+        SetFocused(true);
+        const size_t index = GetItemAt(event.position);
+        if (event.button == MouseButton::Left && index != UniformGridLayout::NO_INDEX && OnItemClicked) {
+            OnItemClicked(index);
+        }
+        return true;
+    }
+    
+    if (event.type == EventType::MouseScrolled && HitTest(event.position)) {
+        ScrollBy(-event.wheelDelta * WHEEL_ROWS * GetRowHeight());
+        return true;
+    }
+    
+    return false;
+}
+
+bool TileView::OnKeyEvent(const KeyEvent& event) {
+    if (!IsEnabled() || event.type != EventType::KeyPressed) {
+        return false;
+    }
+    
+    const double page = std::max(GetRowHeight(), (double)GetItemArea().height - GetRowHeight());
+    switch (event.keyCode) {
+        case KeyCode::Up:
+            ScrollBy(-GetRowHeight());
+            return true;
+        case KeyCode::Down:
+            ScrollBy(GetRowHeight());
+            return true;
+        case KeyCode::PageUp:
+            ScrollBy(-page);
+            return true;
+        case KeyCode::PageDown:
+            ScrollBy(page);
+            return true;
+        case KeyCode::Home:
+            ScrollTo(0.0);
+            return true;
+        case KeyCode::End:
+            ScrollTo(GetMaxScrollOffset());
+            return true;
+        default:
+            return Widget::OnKeyEvent(event);
+    }
+}
+
+Size TileView::MeasureDesiredSize(const Size& availableSize) {
+    return Size(
+        Clamp(400.0f, GetMinSize().width, GetMaxSize().width),
+        Clamp(300.0f, GetMinSize().height, GetMaxSize().height)
+    );
+}
+
+void TileView::OnRender(std::shared_ptr<Renderer> renderer) {
+    if (!IsVisible() || !renderer) return;
+    
+    UpdateItems();
+    
+    Brush backgroundBrush(GetBackgroundColor());
+    renderer->FillRectangle(GetBounds(), backgroundBrush);
+    
+    // Rows cut by the edges are clipped to the item area
+    renderer->PushClipRect(GetItemArea());
+    for (auto& child : GetChildren()) {
+        if (child && child->IsVisible()) {
+            child->Render(renderer);
+        }
+    }
+    renderer->PopClipRect();
+    
+    if (GetBorderWidth() > 0) {
+        Color borderColor = IsFocused() ? Color::FromRGBA(0, 120, 215, 255) : GetBorderColor();
+        renderer->DrawRectangle(GetBounds(), Pen(borderColor, GetBorderWidth()));
+    }
+}
+
+void TileView::RecycleItem(const std::shared_ptr<Widget>& item) {
+    RemoveChild(item);
+    m_recycled.push_back(item);
+}
+
+std::shared_ptr<Widget> TileView::RealizeItem(size_t index) {
+    std::shared_ptr<Widget> recycled;
+    if (!m_recycled.empty()) {
+        recycled = std::move(m_recycled.back());
+        m_recycled.pop_back();
+    }
+    
+    std::shared_ptr<Widget> item = m_factory(index, std::move(recycled));
+    if (item) {
+        AddChild(item);
+    }
+    return item;
+}
+
+double TileView::GetRowHeight() const {
+    return (double)m_grid.GetCellSize(GetItemArea().width).height + std::max(0.0f, m_grid.GetSpacing());
+}
+
+Rect TileView::GetItemArea() const {
+    const Rect bounds = GetBounds();
+    const Spacing padding = GetPadding();
+    return Rect(
+        bounds.x + padding.left,
+        bounds.y + padding.top,
+        std::max(0.0f, bounds.width - padding.Horizontal()),
+        std::max(0.0f, bounds.height - padding.Vertical())
+    );
+}
+
+} // namespace miko
@@ -0,0 +1,415 @@
+#include "miko/widgets/TreeView.h"
+#include "miko/core/Renderer.h"
+#include "miko/text/Utf8.h"
+#include <algorithm>
+
+namespace miko {
+
+static const float ROW_PADDING = 4.0f;
+// Longer labels are cut for display
+static const size_t MAX_LABEL_LENGTH = 256;
+
+// Expander marks of collapsed and expanded nodes
+static const char* const COLLAPSED_MARK = "\xE2\x96\xB8";
+static const char* const EXPANDED_MARK = "\xE2\x96\xBE";
+
+TreeView::TreeView()
+    : m_root(ImplicitTreap::NIL)
+    , m_selectedNode(TreeModel::NO_NODE)
+    , m_firstRow(0)
+    , m_font("Segoe UI", 12.0f, FontWeight::Normal, FontStyle::Normal)
+    , m_textColor(Color::TextColor)
+    , m_selectionColor(Color::PressedColor)
+    , m_indent(16.0f)
+{
+    SetSize(Size(300, 400));
+    SetBackgroundColor(Color::White);
+    SetBorderColor(Color::FromRGBA(128, 128, 128, 255));
+    SetBorderWidth(1.0f);
+    SetPadding(Spacing(2, 2, 2, 2));
+}
+
+void TreeView::SetModel(std::shared_ptr<const TreeModel> model) {
+    m_model = std::move(model);
+    m_collapsedRows.clear();
+    m_selectedNode = TreeModel::NO_NODE;
+    m_firstRow = 0;
+    
+    if (!m_model) {
+        m_expanded.clear();
+        m_rows.Reset(0);
+        m_root = ImplicitTreap::NIL;
+    } else {
+        // The root is always expanded; its children are the top-level rows
+        m_expanded.assign(m_model->GetNodeCount(), 0);
+        m_expanded[TreeModel::ROOT] = 1;
+        m_rows.Reset(m_model->GetNodeCount());
+        m_root = BuildRows(TreeModel::ROOT);
+    }
+    Invalidate();
+}
+
+void TreeView::Expand(NodeId node) {
+    if (!m_model || node == TreeModel::ROOT || !m_model->IsValid(node) || m_expanded[node]) return;
+    
+    const NodeId anchor = GetRowNode(m_firstRow);
+    m_expanded[node] = 1;
+    
+    // A node in no sequence is under an ancestor that has never been
+    // expanded; its rows are built along with that ancestor's
+    if (m_rows.IsInSequence(node)) {
+        uint32_t rows;
+        auto saved = m_collapsedRows.find(node);
+        if (saved != m_collapsedRows.end()) {
+            rows = saved->second;
+            m_collapsedRows.erase(saved);
+        } else {
+            rows = BuildRows(node);
+        }
+    
+        if (rows != ImplicitTreap::NIL) {
+            const uint32_t root = m_rows.GetRoot(node);
+            uint32_t& sequenceRoot = GetSequenceRoot(root);
+            uint32_t before, after;
+            m_rows.Split(root, m_rows.GetIndex(node) + 1, before, after);
+            sequenceRoot = m_rows.Merge(m_rows.Merge(before, rows), after);
+        }
+    }
+    
+    KeepFirstRow(anchor, node);
+    if (OnExpanded) {
+        OnExpanded(node);
+    }
+    Invalidate();
+}
+
+void TreeView::Collapse(NodeId node) {
+    if (!m_model || node == TreeModel::ROOT || !m_model->IsValid(node) || !m_expanded[node]) return;
+    
+    const NodeId anchor = GetRowNode(m_firstRow);
+    const bool selectionShown = GetNodeRow(m_selectedNode) != NO_ROW;
+    m_expanded[node] = 0;
+    
+    if (m_rows.IsInSequence(node)) {
+        // The node's rows run up to the next row at its depth or above
+        const uint32_t root = m_rows.GetRoot(node);
+        const size_t index = m_rows.GetIndex(node);
+        const size_t end = m_rows.FindFirstAtMost(root, index + 1, m_model->GetDepth(node));
+        if (end > index + 1) {
+            uint32_t& sequenceRoot = GetSequenceRoot(root);
+            uint32_t before, rest, rows, after;
+            m_rows.Split(root, index + 1, before, rest);
+            m_rows.Split(rest, end - index - 1, rows, after);
+            sequenceRoot = m_rows.Merge(before, after);
+            m_collapsedRows[node] = rows;
+        }
+    }
+    
+    KeepFirstRow(anchor, node);
+    // A selection hidden by the collapse moves up to the collapsed node
+    if (selectionShown && GetNodeRow(m_selectedNode) == NO_ROW) {
+        SetSelectedNode(node);
+    }
+    if (OnCollapsed) {
+        OnCollapsed(node);
+    }
+    Invalidate();
+}
+
+void TreeView::Toggle(NodeId node) {
+    if (IsExpanded(node)) {
+        Collapse(node);
+    } else {
+        Expand(node);
+    }
+}
+
+void TreeView::EnsureVisible(NodeId node) {
+    if (!m_model || !m_model->IsValid(node) || node == TreeModel::ROOT) return;
+    
+    // Expanding from the bottom up lets the topmost collapsed ancestor build all the rows in one pass
+    for (NodeId parent = m_model->GetParent(node); parent != TreeModel::ROOT; parent = m_model->GetParent(parent)) {
+        Expand(parent);
+    }
+    
+    const size_t row = GetNodeRow(node);
+    const size_t visible = GetVisibleRowCount();
+    if (row < m_firstRow) {
+        ScrollToRow(row);
+    } else if (row >= m_firstRow + visible) {
+        ScrollToRow(row - visible + 1);
+    }
+}
+
+TreeView::NodeId TreeView::GetRowNode(size_t row) const {
+    if (row >= GetRowCount()) return TreeModel::NO_NODE;
+    return m_rows.GetItem(m_root, row);
+}
+
+size_t TreeView::GetNodeRow(NodeId node) const {
+    if (!m_model || !m_model->IsValid(node) || !m_rows.IsInSequence(node)) return NO_ROW;
+    // Rows saved by a collapse are in a sequence of their own
+    if (m_rows.GetRoot(node) != m_root) return NO_ROW;
+    return m_rows.GetIndex(node);
+}
+
+void TreeView::SetSelectedNode(NodeId node) {
+    if (!m_model || !m_model->IsValid(node) || node == TreeModel::ROOT) {
+        node = TreeModel::NO_NODE;
+    }
+    if (node == m_selectedNode) return;
+    
+    m_selectedNode = node;
+    if (OnSelectionChanged) {
+        OnSelectionChanged(m_selectedNode);
+    }
+    Invalidate();
+}
+
+void TreeView::ScrollToRow(size_t row) {
+    const size_t firstRow = m_firstRow;
+    m_firstRow = row;
+    ClampScroll();
+    if (m_firstRow != firstRow) {
+        Invalidate();
+    }
+}
+
+size_t TreeView::GetVisibleRowCount() const {
+    return (size_t)std::max(1.0f, GetTextRect().height / GetRowHeight());
+}
+
+bool TreeView::OnMouseEvent(const MouseEvent& event) {
+    if (!IsEnabled()) return false;
+    
+    if (event.type == EventType::MouseButtonPressed && event.button == MouseButton::Left && HitTest(event.position)) {
+        SetFocused(true);
+    
+        const Rect textRect = GetTextRect();
+        const float y = event.position.y - textRect.y;
+        if (y >= 0.0f) {
+            const size_t row = m_firstRow + (size_t)(y / GetRowHeight());
+            const NodeId node = GetRowNode(row);
+            if (node != TreeModel::NO_NODE) {
+                const float expanderX = textRect.x + (m_model->GetDepth(node) - 1) * m_indent;
+                if (m_model->HasChildren(node) && event.position.x >= expanderX && event.position.x < expanderX + m_indent) {
+                    Toggle(node);
+                } else {
+                    SetSelectedNode(node);
+                }
+            }
+        }
+        return true;
+    }
+    
+    if (event.type == EventType::MouseScrolled && HitTest(event.position)) {
+        const ptrdiff_t delta = (ptrdiff_t)(-event.wheelDelta * 3.0f);
+        ScrollToRow((size_t)std::max<ptrdiff_t>(0, (ptrdiff_t)m_firstRow + delta));
+        return true;
+    }
+    
+    return false;
+}
+
+bool TreeView::OnKeyEvent(const KeyEvent& event) {
+    if (!IsEnabled() || event.type != EventType::KeyPressed || !m_model) {
+        return false;
+    }
+    
+    const size_t rowCount = GetRowCount();
+    const size_t page = GetVisibleRowCount();
+    const size_t row = GetNodeRow(m_selectedNode);
+    const NodeId node = m_selectedNode;
+    switch (event.keyCode) {
+        case KeyCode::Up:
+            SelectRow(row == NO_ROW ? m_firstRow : (row > 0 ? row - 1 : 0));
+            return true;
+        case KeyCode::Down:
+            SelectRow(row == NO_ROW ? m_firstRow : row + 1);
+            return true;
+        case KeyCode::PageUp:
+            SelectRow(row == NO_ROW ? m_firstRow : (row > page ? row - page : 0));
+            return true;
+        case KeyCode::PageDown:
+            SelectRow(row == NO_ROW ? m_firstRow : row + page);
+            return true;
+        case KeyCode::Home:
+            SelectRow(0);
+            return true;
+        case KeyCode::End:
+            SelectRow(rowCount > 0 ? rowCount - 1 : 0);
+            return true;
+        case KeyCode::Right:
+            // Expands a collapsed node, or steps into an expanded one
+            if (row != NO_ROW && m_model->HasChildren(node)) {
+                if (!IsExpanded(node)) {
+                    Expand(node);
+                } else {
+                    SelectRow(row + 1);
+                }
+            }
+            return true;
+        case KeyCode::Left:
+            // Collapses an expanded node, or steps out to the parent
+            if (row != NO_ROW) {
+                if (IsExpanded(node)) {
+                    Collapse(node);
+                } else if (m_model->GetParent(node) != TreeModel::ROOT) {
+                    SelectRow(GetNodeRow(m_model->GetParent(node)));
+                }
+            }
+            return true;
+        case KeyCode::Enter:
+            if (row != NO_ROW && OnNodeActivated) {
+                OnNodeActivated(node);
+            }
+            return true;
+        default:
+            return false;
+    }
+}
+
+Size TreeView::MeasureDesiredSize(const Size& availableSize) {
+    return Size(
+        Clamp(300.0f, GetMinSize().width, GetMaxSize().width),
+        Clamp(400.0f, GetMinSize().height, GetMaxSize().height)
+    );
+}
+
+void TreeView::OnRender(std::shared_ptr<Renderer> renderer) {
+    if (!IsVisible() || !renderer) return;
+    
+    // The widget may have been resized since the last frame
+    ClampScroll();
+    
+    Brush backgroundBrush(GetBackgroundColor());
+    renderer->FillRectangle(GetBounds(), backgroundBrush);
+    if (GetBorderWidth() > 0) {
+        Color borderColor = IsFocused() ? Color::FromRGBA(0, 120, 215, 255) : GetBorderColor();
+        renderer->DrawRectangle(GetBounds(), Pen(borderColor, GetBorderWidth()));
+    }
+    
+    if (m_model && m_root != ImplicitTreap::NIL) {
+        const Rect textRect = GetTextRect();
+        renderer->PushClipRect(textRect);
+    
+        // The first row is looked up once; the rest follow in order
+        const float rowHeight = GetRowHeight();
+        const float textHeight = rowHeight - ROW_PADDING;
+        const size_t rowsOnScreen = GetVisibleRowCount() + 1;
+        const Brush textBrush(m_textColor);
+        NodeId node = GetRowNode(m_firstRow);
+        for (size_t i = 0; i < rowsOnScreen && node != ImplicitTreap::NIL; ++i, node = m_rows.GetNext(node)) {
+            const float y = textRect.y + i * rowHeight;
+            if (node == m_selectedNode) {
+                renderer->FillRectangle(Rect(textRect.x, y, textRect.width, rowHeight), Brush(m_selectionColor));
+            }
+    
+            const float x = textRect.x + (m_model->GetDepth(node) - 1) * m_indent;
+            if (m_model->HasChildren(node)) {
+                renderer->DrawText(IsExpanded(node) ? EXPANDED_MARK : COLLAPSED_MARK,
+                                   Rect(x, y + ROW_PADDING / 2, m_indent, textHeight), m_font, textBrush, TextAlignment::Center);
+            }
+    
+            // Labels are laid out wider than the view so a long one is cut off by the clip rather than wrapped
+            const std::string_view label = GetFirstLine(m_model->GetText(node), MAX_LABEL_LENGTH);
+            if (!label.empty()) {
+                renderer->DrawText(label, Rect(x + m_indent, y + ROW_PADDING / 2, MAX_LABEL_LENGTH * m_font.size, textHeight),
+                                   m_font, textBrush, TextAlignment::Left);
+            }
+        }
+    
+        renderer->PopClipRect();
+    }
+    
+    for (auto& child : GetChildren()) {
+        if (child && child->IsVisible()) {
+            child->Render(renderer);
+        }
+    }
+}
+
+uint32_t TreeView::BuildRows(NodeId node) {
+    // Pre-order walk over the children, descending into expanded nodes. An
+    // expanded node below a collapsed one has never had rows built, so none
+    // of the nodes reached here is in a sequence yet
+    m_buildNodes.clear();
+    m_buildDepths.clear();
+    m_buildStack.clear();
+    NodeId current = m_model->GetFirstChild(node);
+    while (true) {
+        if (current == TreeModel::NO_NODE) {
+            if (m_buildStack.empty()) break;
+            current = m_buildStack.back();
+            m_buildStack.pop_back();
+            continue;
+        }
+    
+        m_buildNodes.push_back(current);
+        m_buildDepths.push_back(m_model->GetDepth(current));
+        if (m_expanded[current] && m_model->HasChildren(current)) {
+            m_buildStack.push_back(m_model->GetNextSibling(current));
+            current = m_model->GetFirstChild(current);
+        } else {
+            current = m_model->GetNextSibling(current);
+        }
+    }
+    return m_rows.Build(m_buildNodes.data(), m_buildDepths.data(), m_buildNodes.size());
+}
+
+uint32_t& TreeView::GetSequenceRoot(uint32_t root) {
+    // Rows saved by a collapse start with the collapsed node's first child
+    const NodeId owner = m_model->GetParent(m_rows.GetItem(root, 0));
+    return owner == TreeModel::ROOT ? m_root : m_collapsedRows[owner];
+}
+
+void TreeView::KeepFirstRow(NodeId anchor, NodeId fallback) {
+    // The node at the top stays there when rows above it come or go
+    size_t row = GetNodeRow(anchor);
+    if (row == NO_ROW) {
+        row = GetNodeRow(fallback);
+    }
+    if (row != NO_ROW) {
+        m_firstRow = row;
+    }
+    ClampScroll();
+}
+
+void TreeView::SelectRow(size_t row) {
+    const size_t rowCount = GetRowCount();
+    if (rowCount == 0 || row == NO_ROW) return;
+    
+    row = std::min(row, rowCount - 1);
+    SetSelectedNode(GetRowNode(row));
+    
+    const size_t visible = GetVisibleRowCount();
+    if (row < m_firstRow) {
+        ScrollToRow(row);
+    } else if (row >= m_firstRow + visible) {
+        ScrollToRow(row - visible + 1);
+    }
+}
+
+void TreeView::ClampScroll() {
+    const size_t rowCount = GetRowCount();
+    const size_t visible = GetVisibleRowCount();
+    const size_t maxFirstRow = rowCount > visible ? rowCount - visible : 0;
+    m_firstRow = std::min(m_firstRow, maxFirstRow);
+}
+
+float TreeView::GetRowHeight() const {
+    return m_font.size * 1.2f + ROW_PADDING;
+}
+
+Rect TreeView::GetTextRect() const {
+    const Rect bounds = GetBounds();
+    const Spacing padding = GetPadding();
+    return Rect(
+        bounds.x + padding.left,
+        bounds.y + padding.top,
+        bounds.width - padding.left - padding.right,
+        bounds.height - padding.top - padding.bottom
+    );
+}
+
+} // namespace miko
@@ -1,34 +1,56 @@
 #include "miko/widgets/Widget.h"
 #include "miko/core/Renderer.h"
 #include "miko/layout/Layout.h"
+#include "miko/layout/LayoutScheduler.h"
 #include <algorithm>
 
 namespace miko {
 
 Widget::Widget()
-    : bounds(0, 0, 0, 0)
-    , margin(0, 0, 0, 0)
-    , padding(0, 0, 0, 0)
-    , minSize(0, 0)
-    , maxSize(10000, 10000)
+    : OnClick(nullptr)
+    , OnMouseMove(nullptr)
+    , OnKeyPress(nullptr)
+    , layoutTree(std::make_shared<LayoutTree>())
+    , layoutNode(LayoutTree::InvalidNode)
+    , layout(nullptr)
     , hAlignment(HorizontalAlignment::Left)
     , vAlignment(VerticalAlignment::Top)
     , visibility(Visibility::Visible)
     , enabled(true)
     , focused(false)
     , hovered(false)
+    , layoutInvalid(false)
+    , renderInvalid(false)
+    , descendantLayoutInvalid(false)
+    , layoutBoundary(false)
+    , measureValid(false)
+    , arrangeValid(false)
     , backgroundColor(Color::Transparent)
     , borderColor(Color::Transparent)
     , borderWidth(0.0f)
     , cornerRadius(0.0f)
-    , layout(nullptr)
-    , OnClick(nullptr)
-    , OnMouseMove(nullptr)
-    , OnKeyPress(nullptr)
+    , tag(nullptr)
 {
+    // Every widget starts as the root of its own single-node tree
+    layoutNode = layoutTree->CreateNode(this);
+    layoutTree->SetBounds(layoutNode, Rect(0, 0, 0, 0));
+    layoutTree->SetMargin(layoutNode, Spacing(0, 0, 0, 0));
+    layoutTree->SetPadding(layoutNode, Spacing(0, 0, 0, 0));
+    layoutTree->SetMinSize(layoutNode, Size(0, 0));
+    layoutTree->SetMaxSize(layoutNode, Size(10000, 10000));
 }
 
-Widget::~Widget() = default;
+Widget::~Widget() {
+    layoutTree->ReleaseNode(layoutNode);
+    
+    // Children kept alive elsewhere become roots of their own trees; the rest
+    // are destroyed together with this tree
+    for (auto it = children.rbegin(); it != children.rend(); ++it) {
+        if (*it && it->use_count() > 1) {
+            (*it)->DetachLayoutSubtree();
+        }
+    }
+}
 
 void Widget::AddChild(std::shared_ptr<Widget> child) {
     if (!child || child->parent.lock()) return;
@@ -36,27 +58,64 @@ void Widget::AddChild(std::shared_ptr<Widget> child) {
     child->parent = shared_from_this();
     children.push_back(child);
     
+    // Splice the child's tree in as our last child, keeping pre-order
+    std::shared_ptr<LayoutTree> childTree = child->layoutTree;
+    LayoutTree::NodeId firstMoved = layoutTree->AppendSubtree(layoutNode, *childTree);
+    RebindLayoutNodes(layoutTree, firstMoved);
+    
     InvalidateLayout();
 }
 
 void Widget::RemoveChild(std::shared_ptr<Widget> child) {
-    auto it = std::find(children.begin(), children.end(), child);
-    if (it != children.end()) {
-        children.erase(it);
+    // Searched from the back, where recently added children are
+    auto it = std::find(children.rbegin(), children.rend(), child);
+    if (it != children.rend()) {
+        children.erase(std::next(it).base());
         child->parent.reset();
+        child->DetachLayoutSubtree();
         InvalidateLayout();
     }
 }
 
 void Widget::RemoveAllChildren() {
-    for (auto& child : children) {
-        child->parent.reset();
+    // Detach from the back so each extraction only shifts what follows it
+    for (auto it = children.rbegin(); it != children.rend(); ++it) {
+        (*it)->parent.reset();
+        (*it)->DetachLayoutSubtree();
     }
     children.clear();
     InvalidateLayout();
 }
 
+void Widget::DetachLayoutSubtree() {
+    std::shared_ptr<LayoutTree> oldTree = layoutTree;
+    auto newTree = std::make_shared<LayoutTree>();
+    LayoutTree::NodeId firstMoved = oldTree->ExtractSubtree(layoutNode, *newTree);
+    RebindLayoutNodes(newTree, 0);
+    RebindLayoutNodes(oldTree, firstMoved);
+}
+
+void Widget::RebindLayoutNodes(const std::shared_ptr<LayoutTree>& tree, LayoutTree::NodeId firstNode) {
+    if (firstNode == LayoutTree::InvalidNode) return;
+    
+    const size_t nodeCount = tree->GetNodeCount();
+    for (size_t node = firstNode; node < nodeCount; ++node) {
+        if (Widget* widget = tree->GetWidget(static_cast<LayoutTree::NodeId>(node))) {
+            // Nodes that only shifted within the tree keep their pointer, which
+            // saves a reference count update per node
+            if (widget->layoutTree != tree) {
+                widget->layoutTree = tree;
+            }
+            widget->layoutNode = static_cast<LayoutTree::NodeId>(node);
+        }
+    }
+}
+
 Size Widget::MeasureDesiredSize(const Size& availableSize) {
+    const Spacing margin = GetMargin();
+    const Spacing padding = GetPadding();
+    const Size minSize = GetMinSize();
+    const Size maxSize = GetMaxSize();
     if (layout) {
         // Calculate available size for content (excluding margin and padding)
         Size contentAvailableSize = Size(
@@ -86,17 +145,32 @@ Size Widget::MeasureDesiredSize(const Size& availableSize) {
 }
 
 void Widget::SetBounds(const Rect& bounds) {
-    this->bounds = bounds;
+    layoutTree->SetBounds(layoutNode, bounds);
     InvalidateLayout();
 }
 
 bool Widget::HitTest(const Point& point) const {
-    return bounds.Contains(point);
+    return GetBounds().Contains(point);
+}
+
+std::shared_ptr<Widget> Widget::FindWidgetAt(const Point& point) {
+    // Linear scan over the flattened subtree instead of recursing through children
+    LayoutTree::NodeId node = layoutTree->HitTest(layoutNode, point);
+    if (node == LayoutTree::InvalidNode) return nullptr;
+    
+    Widget* widget = layoutTree->GetWidget(node);
+    return widget ? widget->shared_from_this() : nullptr;
+}
+
+void Widget::SetPosition(const Point& position) {
+    layoutTree->Set(layoutNode, LayoutField::X, position.x);
+    layoutTree->Set(layoutNode, LayoutField::Y, position.y);
+    InvalidateLayout();
 }
 
 void Widget::SetSize(const Size& size) {
-    bounds.width = size.width;
-    bounds.height = size.height;
+    layoutTree->Set(layoutNode, LayoutField::Width, size.width);
+    layoutTree->Set(layoutNode, LayoutField::Height, size.height);
     InvalidateLayout();
 }
 
@@ -113,6 +187,16 @@ void Widget::ArrangeChildren(const Rect& finalRect) {
 }
 
 void Widget::Arrange(const Rect& finalRect) {
+    // Same slot and nothing changed inside: only boundaries further down may need work
+    if (arrangeValid && !layoutInvalid && finalRect == arrangeRect) {
+        if (descendantLayoutInvalid) {
+            UpdateLayout();
+        }
+        return;
+    }
+    
+    const Spacing margin = GetMargin();
+    const Spacing padding = GetPadding();
     // The finalRect includes margin and padding space, so we need to calculate the actual widget bounds
     Rect widgetBounds(
         finalRect.x + margin.left + padding.left,
@@ -120,7 +204,8 @@ void Widget::Arrange(const Rect& finalRect) {
         std::max(0.0f, finalRect.width - margin.Horizontal() - padding.Horizontal()),
         std::max(0.0f, finalRect.height - margin.Vertical() - padding.Vertical())
     );
-    SetBounds(widgetBounds);
+    // Straight to the tree: going through SetBounds would invalidate the parent being arranged
+    layoutTree->SetBounds(layoutNode, widgetBounds);
     if (layout) {
         // Calculate content area (excluding margin and padding)
         Rect contentRect(
@@ -131,13 +216,19 @@ void Widget::Arrange(const Rect& finalRect) {
         );
         layout->ArrangeChildren(children, contentRect);
     }
+    
+    arrangeRect = finalRect;
+    arrangeValid = true;
+    layoutInvalid = false;
+    descendantLayoutInvalid = false;
 }
 
 void Widget::SetVisibility(Visibility visibility) {
     if (this->visibility != visibility) {
         this->visibility = visibility;
+        layoutTree->SetVisible(layoutNode, visibility == Visibility::Visible);
         Invalidate();
-        InvalidateLayout();
+        InvalidateLayoutSlot();
     }
 }
 
@@ -177,8 +268,9 @@ void Widget::SetHovered(bool hovered) {
     
     Point Widget::LocalToGlobal(const Point& localPoint) const {
         Point globalPoint = localPoint;
-        globalPoint.x += bounds.x;
-        globalPoint.y += bounds.y;
+        const Point position = GetPosition();
+        globalPoint.x += position.x;
+        globalPoint.y += position.y;
         
         auto parentWidget = parent.lock();
         if (parentWidget) {
@@ -196,13 +288,16 @@ void Widget::SetHovered(bool hovered) {
             localPoint = parentWidget->GlobalToLocal(localPoint);
         }
         
-        localPoint.x -= bounds.x;
-        localPoint.y -= bounds.y;
+        const Point position = GetPosition();
+        localPoint.x -= position.x;
+        localPoint.y -= position.y;
         
         return localPoint;
     }
     
     Rect Widget::GetClientRect() const {
+        const Rect bounds = GetBounds();
+        const Spacing padding = GetPadding();
         return Rect(padding.left, padding.top, 
                    bounds.width - padding.Horizontal(), 
                    bounds.height - padding.Vertical());
@@ -211,14 +306,14 @@ void Widget::SetHovered(bool hovered) {
     void Widget::RenderBackground(std::shared_ptr<Renderer> renderer) {
         if (backgroundColor.a > 0.0f) {
             Brush brush(backgroundColor);
-            renderer->FillRectangle(bounds, brush);
+            renderer->FillRectangle(GetBounds(), brush);
         }
     }
     
     void Widget::RenderBorder(std::shared_ptr<Renderer> renderer) {
         if (borderWidth > 0.0f && borderColor.a > 0.0f) {
             Pen pen(borderColor, borderWidth);
-            renderer->DrawRectangle(bounds, pen);
+            renderer->DrawRectangle(GetBounds(), pen);
         }
     }
     
@@ -232,20 +327,27 @@ void Widget::SetHovered(bool hovered) {
     
     void Widget::UpdateLayout() {
         if (layoutInvalid) {
-            if (layout) {
-                Size availableSize = Size(bounds.width - padding.Horizontal(), 
-                                         bounds.height - padding.Vertical());
-                layout->MeasureDesiredSize(children, availableSize);
-                
-                Rect contentRect = GetClientRect();
-                layout->ArrangeChildren(children, contentRect);
+            // A boundary keeps its slot, so laying it out again in the same one is enough;
+            // one never placed is laid out when its parent first places it
+            if (arrangeValid) {
+                Arrange(arrangeRect);
+            }
+            return;
+        }
+        if (!descendantLayoutInvalid) return;
+        
+        descendantLayoutInvalid = false;
+        for (auto& child : children) {
+            if (child && child->NeedsLayout()) {
+                child->UpdateLayout();
             }
-            layoutInvalid = false;
         }
     }
     
     Size Widget::CalculateDesiredSize(const Size& availableSize) {
-        Size desiredSize = minSize;
+        const Spacing padding = GetPadding();
+        const Size maxSize = GetMaxSize();
+        Size desiredSize = GetMinSize();
         
         if (layout) {
             Size layoutSize = layout->MeasureDesiredSize(children, availableSize);
@@ -311,8 +413,99 @@ bool Widget::OnKeyEvent(const KeyEvent& event) {
 
 
 void Widget::InvalidateLayout() {
-    // Mark layout as needing update
-    // In a real implementation, this would trigger a layout pass
+    // Up to the boundary every widget's size may change, so each is measured and arranged again.
+    // A widget never placed has no slot of its own to be laid out in, so its parent is marked too
+    Widget* widget = this;
+    bool alreadyInvalid = false;
+    while (true) {
+        alreadyInvalid = widget->layoutInvalid;
+        widget->layoutInvalid = true;
+        widget->measureValid = false;
+        auto parentWidget = widget->parent.lock();
+        if (!parentWidget || (widget->arrangeValid && widget->IsLayoutBoundary())) break;
+        widget = parentWidget.get();
+    }
+    
+    // Above it only the path down to the boundary is marked
+    for (auto ancestor = widget->parent.lock(); ancestor && !ancestor->descendantLayoutInvalid; ancestor = ancestor->parent.lock()) {
+        ancestor->descendantLayoutInvalid = true;
+    }
+    
+    // A boundary that was dirty already is queued already
+    if (alreadyInvalid) return;
+    Widget* root = widget;
+    for (auto ancestor = widget->parent.lock(); ancestor; ancestor = ancestor->parent.lock()) {
+        root = ancestor.get();
+    }
+    if (root->layoutScheduler) {
+        root->layoutScheduler->Schedule(widget->shared_from_this());
+    }
+}
+
+void Widget::InvalidateLayoutSlot() {
+    // The slot the parent gives this widget changes, so the parent is laid out again even past a boundary
+    InvalidateLayout();
+    if (auto parentWidget = parent.lock()) {
+        parentWidget->InvalidateLayout();
+    }
+}
+
+bool Widget::IsLayoutBoundary() const {
+    if (layoutBoundary) return true;
+    
+    auto parentWidget = parent.lock();
+    if (!parentWidget || !parentWidget->MeasuresChildren()) return true;
+    
+    // A fixed size does not follow the content
+    return HasFixedSize();
+}
+
+bool Widget::HasFixedSize() const {
+    const Size minSize = GetMinSize();
+    const Size maxSize = GetMaxSize();
+    return minSize.width >= maxSize.width && minSize.height >= maxSize.height;
+}
+
+void Widget::InvalidateMeasure() {
+    // Without a measurement to compare against, nothing can be ruled out
+    if (!arrangeValid || !measureValid) {
+        InvalidateLayout();
+        return;
+    }
+    // Measure clamps to the fixed size, so the answer cannot change; it is
+    // still dropped so the next pass asks again instead of trusting it
+    if (HasFixedSize()) {
+        measureValid = false;
+        return;
+    }
+    
+    // Measured again at the size last offered; the parents only care if the answer differs
+    const Size previousSize = measuredSize;
+    measureValid = false;
+    if (Measure(measureAvailable) != previousSize) {
+        InvalidateLayout();
+    }
+}
+
+Size Widget::Measure(const Size& availableSize) {
+    if (!measureValid || availableSize != measureAvailable) {
+        // Clamped here rather than trusted to each override, so a widget whose
+        // min and max size agree always measures the same and can be a boundary
+        const Size desiredSize = MeasureDesiredSize(availableSize);
+        const Size minSize = GetMinSize();
+        const Size maxSize = GetMaxSize();
+        measuredSize = Size(
+            std::max(minSize.width, std::min(maxSize.width, desiredSize.width)),
+            std::max(minSize.height, std::min(maxSize.height, desiredSize.height))
+        );
+        measureAvailable = availableSize;
+        measureValid = true;
+    }
+    return measuredSize;
+}
+
+bool Widget::MeasuresChildren() const {
+    return layout && layout->MeasuresChildren();
 }
 
 void Widget::Render(std::shared_ptr<Renderer> renderer) {